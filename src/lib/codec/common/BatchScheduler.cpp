@@ -0,0 +1,124 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "BatchScheduler.h"
+#include "CodecExecutor.h"
+#include "spdlog/spdlog.h"
+
+#include <filesystem>
+#include <thread>
+
+namespace grk
+{
+BatchScheduler::BatchScheduler(uint32_t numConcurrent, uint64_t maxBytesInFlight)
+	: numConcurrent_(numConcurrent ? numConcurrent : std::thread::hardware_concurrency()),
+	  maxBytesInFlight_(maxBytesInFlight ? maxBytesInFlight : batchDefaultMaxBytesInFlight),
+	  numInFlight_(0), bytesInFlight_(0), numProcessed_(0), bytesProcessed_(0), elapsed_(0)
+{
+	if(!numConcurrent_)
+		numConcurrent_ = 1;
+}
+void BatchScheduler::acquire(uint64_t numBytes)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	cond_.wait(lk, [this, numBytes] {
+		return numInFlight_ == 0 ||
+			   (numInFlight_ < numConcurrent_ && bytesInFlight_ + numBytes <= maxBytesInFlight_);
+	});
+	numInFlight_++;
+	bytesInFlight_ += numBytes;
+}
+void BatchScheduler::release(uint64_t numBytes)
+{
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		numInFlight_--;
+		bytesInFlight_ -= numBytes;
+	}
+	cond_.notify_all();
+}
+uint32_t BatchScheduler::run(const std::string& dir, BatchProcessor process)
+{
+	uint32_t numSucceeded = 0;
+	uint64_t bytesSucceeded = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	auto fileSize = [](const std::filesystem::directory_entry& entry) {
+		std::error_code ec;
+		uint64_t fileBytes = entry.is_regular_file(ec) ? entry.file_size(ec) : 0;
+
+		return ec ? 0 : fileBytes;
+	};
+	if(numConcurrent_ == 1)
+	{
+		for(const auto& entry : std::filesystem::directory_iterator(dir))
+		{
+			if(process(entry.path().filename().string()) == 1)
+			{
+				numSucceeded++;
+				bytesSucceeded += fileSize(entry);
+			}
+		}
+	}
+	else
+	{
+		// files are dispatched to batch threads, which are independent of both the
+		// library executor and the codec executor, since codecs block on these executors
+		tf::Executor batchExecutor(numConcurrent_);
+		for(const auto& entry : std::filesystem::directory_iterator(dir))
+		{
+			uint64_t fileBytes = fileSize(entry);
+			acquire(fileBytes);
+			batchExecutor.silent_async([this, process, fileBytes, &numSucceeded, &bytesSucceeded,
+										fileName = entry.path().filename().string()] {
+				int rc = 0;
+				try
+				{
+					rc = process(fileName);
+				}
+				catch([[maybe_unused]] std::bad_alloc& ba)
+				{
+					spdlog::error("Out of memory while processing {}", fileName);
+				}
+				if(rc == 1)
+				{
+					std::unique_lock<std::mutex> lk(mutex_);
+					numSucceeded++;
+					bytesSucceeded += fileBytes;
+				}
+				release(fileBytes);
+			});
+		}
+		batchExecutor.wait_for_all();
+	}
+	elapsed_ += std::chrono::high_resolution_clock::now() - start;
+	numProcessed_ += numSucceeded;
+	bytesProcessed_ += bytesSucceeded;
+
+	return numSucceeded;
+}
+void BatchScheduler::printThroughput(const std::string& operation)
+{
+	double seconds = elapsed_.count();
+	if(!numProcessed_ || seconds <= 0)
+		return;
+	spdlog::info("{} {} images in {:.3f} s with {} concurrent file(s): "
+				 "{:.2f} images/s, {:.2f} MB/s", operation, numProcessed_, seconds,
+				 numConcurrent_, numProcessed_ / seconds,
+				 (double)bytesProcessed_ / (1024.0 * 1024.0) / seconds);
+}
+
+} // namespace grk
@@ -0,0 +1,93 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace grk
+{
+/**
+ * Default number of bytes that may be in flight for a batch : 1 GB
+ */
+const uint64_t batchDefaultMaxBytesInFlight = (uint64_t)1 << 30;
+
+/**
+ * Processes all files in a directory, running several codecs concurrently.
+ *
+ * Each file is processed by its own codec on a dedicated batch thread, while all
+ * codecs share the library executor for their tile and code block tasks. Reading,
+ * coding and writing of different files therefore overlap. A file is only started
+ * once its size fits within the in-flight byte budget, unless no other file is in flight.
+ */
+class BatchScheduler
+{
+  public:
+	/**
+	 * Process file
+	 *
+	 * @param fileName 	file name, relative to batch directory
+	 *
+	 * @return 0 for failure, 1 for success, and 2 if file is not suitable for processing
+	 */
+	typedef std::function<int(const std::string& fileName)> BatchProcessor;
+
+	/**
+	 * Create batch scheduler
+	 *
+	 * @param numConcurrent 		number of files processed concurrently : 0 selects
+	 * 								the hardware concurrency
+	 * @param maxBytesInFlight 		maximum total size of files in flight : 0 selects
+	 * 								the default budget
+	 */
+	BatchScheduler(uint32_t numConcurrent, uint64_t maxBytesInFlight);
+	/**
+	 * Process all files in directory
+	 *
+	 * @param dir 		directory
+	 * @param process 	file processor, which must be safe to call concurrently
+	 *
+	 * @return number of files successfully processed
+	 */
+	uint32_t run(const std::string& dir, BatchProcessor process);
+	/**
+	 * Log aggregate throughput of all runs
+	 *
+	 * @param operation 	operation name
+	 */
+	void printThroughput(const std::string& operation);
+
+  private:
+	void acquire(uint64_t numBytes);
+	void release(uint64_t numBytes);
+
+	uint32_t numConcurrent_;
+	uint64_t maxBytesInFlight_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	uint32_t numInFlight_;
+	uint64_t bytesInFlight_;
+	uint32_t numProcessed_;
+	uint64_t bytesProcessed_;
+	std::chrono::duration<double> elapsed_;
+};
+
+} // namespace grk
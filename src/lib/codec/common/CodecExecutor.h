@@ -0,0 +1,57 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#ifndef _MSC_VER
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#ifdef __clang__
+#pragma GCC diagnostic ignored "-Wimplicit-int-float-conversion"
+#endif
+#endif
+#include <taskflow/taskflow.hpp>
+#ifndef _MSC_VER
+#pragma GCC diagnostic pop
+#endif
+
+#include <thread>
+
+namespace grk
+{
+/**
+ * Executor shared by the codec layer (image format encoders, batch processing).
+ * It is independent of the library executor, so codec tasks may block
+ * on their results from inside library worker threads.
+ */
+class CodecExecutor
+{
+  public:
+	static tf::Executor* instance(uint32_t numthreads)
+	{
+		static tf::Executor singleton(numthreads ? numthreads
+												 : std::thread::hardware_concurrency());
+
+		return &singleton;
+	}
+	static tf::Executor* get()
+	{
+		return instance(0);
+	}
+};
+
+} // namespace grk
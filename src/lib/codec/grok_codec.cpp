@@ -19,6 +19,7 @@
 #include "GrkDecompress.h"
 #include "GrkCompress.h"
 #include "GrkCompareImages.h"
+#include "GrkTranscode.h"
 
 int GRK_CALLCONV grk_codec_dump(int argc, char* argv[])
 {
@@ -36,3 +37,7 @@ int GRK_CALLCONV grk_codec_compare_images(int argc, char* argv[])
 {
 	return grk::GrkCompareImages().main(argc, argv);
 }
+int GRK_CALLCONV grk_codec_transcode(int argc, char* argv[])
+{
+	return grk::GrkTranscode().main(argc, argv);
+}
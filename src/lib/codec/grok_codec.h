@@ -70,6 +70,18 @@ GRK_API int grk_codec_decompress(int argc, char* argv[]);
  */
 GRK_API int grk_codec_compare_images(int argc, char* argv[]);
 
+/**
+ * Transcode compressed image.
+ *
+ * Pass grk_transcode command line arguments
+ *
+ * @param argc
+ * @param argv
+ *
+ * return 0 if successful
+ */
+GRK_API int grk_codec_transcode(int argc, char* argv[]);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,7 @@
 
 #include "common.h"
 #include "FileStreamIO.h"
+#include "CodecExecutor.h"
 
 struct my_error_mgr
 {
@@ -54,6 +55,55 @@ METHODDEF(void) my_error_exit(j_common_ptr cinfo)
 	longjmp(myerr->setjmp_buffer, 1);
 }
 
+// JPEG markers used to stitch stripes together
+const uint8_t jpegMarkerSOF0 = 0xC0;
+const uint8_t jpegMarkerSOF1 = 0xC1;
+const uint8_t jpegMarkerRST0 = 0xD0;
+const uint8_t jpegMarkerSOI = 0xD8;
+const uint8_t jpegMarkerEOI = 0xD9;
+const uint8_t jpegMarkerSOS = 0xDA;
+const uint8_t jpegMarkerDRI = 0xDD;
+
+// maximum number of MCUs in restart interval
+const uint32_t jpegMaxRestartInterval = 65535;
+// minimum number of interleaved bytes compressed as one stripe
+const uint64_t jpegMinBytesPerStripe = 256 * 1024;
+// initial size of in-memory stripe destination
+const size_t jpegStripeDestinationSize = 64 * 1024;
+
+/* destination manager that compresses to a growable memory buffer */
+struct vector_destination_mgr
+{
+	struct jpeg_destination_mgr pub; /* "public" fields */
+
+	std::vector<uint8_t>* buf;
+};
+
+METHODDEF(void) vector_init_destination(j_compress_ptr cinfo)
+{
+	auto dest = (vector_destination_mgr*)cinfo->dest;
+	dest->buf->resize(jpegStripeDestinationSize);
+	dest->pub.next_output_byte = dest->buf->data();
+	dest->pub.free_in_buffer = dest->buf->size();
+}
+
+METHODDEF(boolean) vector_empty_output_buffer(j_compress_ptr cinfo)
+{
+	auto dest = (vector_destination_mgr*)cinfo->dest;
+	size_t used = dest->buf->size();
+	dest->buf->resize(used * 2);
+	dest->pub.next_output_byte = dest->buf->data() + used;
+	dest->pub.free_in_buffer = dest->buf->size() - used;
+
+	return (boolean)TRUE;
+}
+
+METHODDEF(void) vector_term_destination(j_compress_ptr cinfo)
+{
+	auto dest = (vector_destination_mgr*)cinfo->dest;
+	dest->buf->resize(dest->buf->size() - dest->pub.free_in_buffer);
+}
+
 /*
  * SOME FINE POINTS:
  *
@@ -334,8 +384,76 @@ cleanup:
 
 JPEGFormat::JPEGFormat(void)
 	: success(true), buffer(nullptr), buffer32s(nullptr), color_space(JCS_UNKNOWN), adjust(0),
-	  readFromStdin(false), planes{0, 0, 0}
+	  readFromStdin(false), planes{0, 0, 0, 0}, parallel_(false), compressStarted_(false),
+	  stripeRows_(0), restartInterval_(0), rowBytes_(0), rowsEncoded_(0), stripesWritten_(0),
+	  currentStripe_(nullptr)
 {}
+void JPEGFormat::initCompressor(j_compress_ptr info, JDIMENSION height)
+{
+	/* First we supply a description of the input image_.
+	 * Four fields of the cinfo struct must be filled in:
+	 */
+	info->image_width = image_->decompressWidth; /* image_ width and height, in pixels */
+	info->image_height = height;
+	info->input_components = (int)image_->decompressNumComps; /* # of color components per pixel */
+	info->in_color_space = color_space; /* colorspace of input image_ */
+
+	/* Now use the library's routine to set default compression parameters.
+	 * (You must set at least cinfo.in_color_space before calling this,
+	 * since the defaults depend on the source color space.)
+	 */
+	jpeg_set_defaults(info);
+
+	/* Now you can set any non-default parameters you wish to.
+	 * Here we just illustrate the use of quality (quantization table) scaling:
+	 */
+	jpeg_set_quality(info,
+					 (int)((compressionLevel_ == GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT)
+							   ? 90
+							   : compressionLevel_),
+					 (boolean)TRUE /* limit to baseline-JPEG values */);
+
+	// set resolution
+	if(image_->capture_resolution[0] > 0 && image_->capture_resolution[1] > 0)
+	{
+		info->density_unit = 2; // dots per cm
+		info->X_density = (uint16_t)(image_->capture_resolution[0] / 100.0 + 0.5);
+		info->Y_density = (uint16_t)(image_->capture_resolution[1] / 100.0 + 0.5);
+	}
+}
+/**
+ * Stripes are only used if the image can be split into at least two stripes,
+ * each holding a whole number of MCU rows and at most 65535 MCUs,
+ * the maximum restart interval.
+ * Must be called once cinfo has been initialized with the full image dimensions.
+ */
+bool JPEGFormat::useParallelEncode(void)
+{
+	if(concurrency_ <= 1 || cinfo.image_height > JPEG_MAX_DIMENSION ||
+	   cinfo.image_width > JPEG_MAX_DIMENSION)
+		return false;
+	uint32_t mcuWidth = DCTSIZE;
+	uint32_t mcuHeight = DCTSIZE;
+	if(cinfo.num_components > 1)
+	{
+		for(int i = 0; i < cinfo.num_components; ++i)
+		{
+			auto comp = cinfo.comp_info + i;
+			mcuWidth = std::max<uint32_t>(mcuWidth, (uint32_t)comp->h_samp_factor * DCTSIZE);
+			mcuHeight = std::max<uint32_t>(mcuHeight, (uint32_t)comp->v_samp_factor * DCTSIZE);
+		}
+	}
+	uint32_t mcusPerRow = (cinfo.image_width + mcuWidth - 1) / mcuWidth;
+	uint32_t maxStripeRows = (jpegMaxRestartInterval / mcusPerRow) * mcuHeight;
+	stripeRows_ = (uint32_t)((jpegMinBytesPerStripe + rowBytes_ - 1) / rowBytes_);
+	stripeRows_ = ((stripeRows_ + mcuHeight - 1) / mcuHeight) * mcuHeight;
+	stripeRows_ = std::min<uint32_t>(stripeRows_, maxStripeRows);
+	if(stripeRows_ == 0 || stripeRows_ >= cinfo.image_height)
+		return false;
+	restartInterval_ = (stripeRows_ / mcuHeight) * mcusPerRow;
+
+	return true;
+}
 
 bool JPEGFormat::encodeHeader(void)
 {
@@ -372,9 +490,6 @@ bool JPEGFormat::encodeHeader(void)
 	 * Note that this struct must live as long as the main JPEG parameter
 	 * struct, to avoid dangling-pointer problems.
 	 */
-	JDIMENSION image_width = image_->x1 - image_->x0; /* input image_ width */
-	JDIMENSION image_height = image_->y1 - image_->y0; /* input image_ height */
-
 	// sub-sampling not supported at the moment
 	if(isFinalOutputSubsampled(image_))
 	{
@@ -466,8 +581,12 @@ bool JPEGFormat::encodeHeader(void)
 	/* Now we can initialize the JPEG compression object. */
 	jpeg_create_compress(&cinfo);
 
-	/* Step 2: specify data destination (eg, a file) */
-	/* Note: steps 2 and 3 can be done in either order. */
+	/* Step 2: set parameters for compression */
+	initCompressor(&cinfo, image_->decompressHeight);
+	rowBytes_ = (uint64_t)width * decompressNumComps;
+	parallel_ = useParallelEncode();
+
+	/* Step 3: specify data destination (eg, a file) */
 
 	/* Here we use the library-supplied code to send compressed data to a
 	 * stdio stream.  You can also write your own code to do something else.
@@ -477,51 +596,23 @@ bool JPEGFormat::encodeHeader(void)
 	if(!openFile())
 		return false;
 
-	jpeg_stdio_dest(&cinfo, fileStream_);
-
-	/* Step 3: set parameters for compression */
-
-	/* First we supply a description of the input image_.
-	 * Four fields of the cinfo struct must be filled in:
-	 */
-	cinfo.image_width = image_width; /* image_ width and height, in pixels */
-	cinfo.image_height = image_height;
-	cinfo.input_components = (int)decompressNumComps; /* # of color components per pixel */
-	cinfo.in_color_space = color_space; /* colorspace of input image_ */
-
-	/* Now use the library's routine to set default compression parameters.
-	 * (You must set at least cinfo.in_color_space before calling this,
-	 * since the defaults depend on the source color space.)
-	 */
-	jpeg_set_defaults(&cinfo);
-
-	/* Now you can set any non-default parameters you wish to.
-	 * Here we just illustrate the use of quality (quantization table) scaling:
-	 */
-	jpeg_set_quality(&cinfo,
-					 (int)((compressionLevel_ == GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT)
-							   ? 90
-							   : compressionLevel_),
-					 (boolean)TRUE /* limit to baseline-JPEG values */);
-
-	// set resolution
-	if(image_->capture_resolution[0] > 0 && image_->capture_resolution[1] > 0)
+	// stripes are compressed to memory, and the stitched stream is written in order
+	if(!parallel_)
 	{
-		cinfo.density_unit = 2; // dots per cm
-		cinfo.X_density = (uint16_t)(image_->capture_resolution[0] / 100.0 + 0.5);
-		cinfo.Y_density = (uint16_t)(image_->capture_resolution[1] / 100.0 + 0.5);
-	}
+		jpeg_stdio_dest(&cinfo, fileStream_);
 
-	/* Step 4: Start compressor */
+		/* Step 4: Start compressor */
 
-	/* TRUE ensures that we will write a complete interchange-JPEG file.
-	 * Pass TRUE unless you are very sure of what you're doing.
-	 */
-	jpeg_start_compress(&cinfo, (boolean)TRUE);
-	if(image_->meta && image_->meta->color.icc_profile_buf)
-	{
-		write_icc_profile(&cinfo, image_->meta->color.icc_profile_buf,
-						  image_->meta->color.icc_profile_len);
+		/* TRUE ensures that we will write a complete interchange-JPEG file.
+		 * Pass TRUE unless you are very sure of what you're doing.
+		 */
+		jpeg_start_compress(&cinfo, (boolean)TRUE);
+		compressStarted_ = true;
+		if(image_->meta && image_->meta->color.icc_profile_buf)
+		{
+			write_icc_profile(&cinfo, image_->meta->color.icc_profile_buf,
+							  image_->meta->color.icc_profile_len);
+		}
 	}
 	encodeState = IMAGE_FORMAT_ENCODED_HEADER;
 
@@ -529,6 +620,20 @@ bool JPEGFormat::encodeHeader(void)
 }
 bool JPEGFormat::encodePixels(void)
 {
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
+	if(parallel_)
+	{
+		uint32_t height = cinfo.image_height;
+		for(uint32_t y = 0; y < height; y += stripeRows_)
+		{
+			if(!dispatchStripe(new JPEGStripe(y, std::min<uint32_t>(stripeRows_, height - y))))
+				return false;
+		}
+
+		return true;
+	}
+
 	/* Step 5: while (scan lines remain to be written) */
 	/*           jpeg_write_scanlines(...); */
 
@@ -557,10 +662,240 @@ bool JPEGFormat::encodePixels(void)
 
 	return true;
 }
+/***
+ * library-orchestrated pixel encoding: strips are either written directly
+ * as scanlines, or gathered into stripes that are compressed asynchronously
+ */
+bool JPEGFormat::encodePixelsCore(uint32_t threadId, grk_io_buf pixels)
+{
+	uint32_t height = cinfo.image_height;
+	uint32_t numRows = (uint32_t)(pixels.len_ / rowBytes_);
+	bool rc = numRows && rowsEncoded_ + numRows <= height;
+	if(rc && !parallel_)
+	{
+		for(uint32_t i = 0; i < numRows; ++i)
+		{
+			JSAMPROW row_pointer[1];
+			row_pointer[0] = pixels.data_ + i * rowBytes_;
+			jpeg_write_scanlines(&cinfo, row_pointer, 1);
+		}
+		rowsEncoded_ += numRows;
+	}
+	else if(rc)
+	{
+		auto src = pixels.data_;
+		uint32_t rowsLeft = numRows;
+		while(rc && rowsLeft)
+		{
+			if(!currentStripe_)
+			{
+				currentStripe_ = new JPEGStripe(
+					rowsEncoded_, std::min<uint32_t>(stripeRows_, height - rowsEncoded_));
+				currentStripe_->rows_.reserve(currentStripe_->numRows_ * rowBytes_);
+			}
+			uint32_t stripeRowsLeft =
+				currentStripe_->numRows_ - (uint32_t)(currentStripe_->rows_.size() / rowBytes_);
+			uint32_t rowsToCopy = std::min<uint32_t>(rowsLeft, stripeRowsLeft);
+			currentStripe_->rows_.insert(currentStripe_->rows_.end(), src,
+										 src + rowsToCopy * rowBytes_);
+			src += rowsToCopy * rowBytes_;
+			rowsLeft -= rowsToCopy;
+			rowsEncoded_ += rowsToCopy;
+			if(rowsToCopy == stripeRowsLeft)
+			{
+				rc = dispatchStripe(currentStripe_);
+				currentStripe_ = nullptr;
+			}
+		}
+	}
+	ioReclaimBuffer(threadId, pixels);
+	if(!rc)
+	{
+		spdlog::error("JPEGFormat::encodePixelsCore: error in pixels encode");
+		encodeState |= IMAGE_FORMAT_ERROR;
+		return false;
+	}
+	if(rowsEncoded_ == height)
+		return encodeFinish();
+
+	return true;
+}
+/**
+ * Queue stripe for asynchronous compression, and write completed stripes in order,
+ * bounding the number of stripes in flight
+ */
+bool JPEGFormat::dispatchStripe(JPEGStripe* stripe)
+{
+	auto executor = grk::CodecExecutor::instance(concurrency_);
+	pendingStripes_.emplace_back(
+		stripe, executor->async([this, stripe] { stripe->success_ = compressStripe(stripe); }));
+	bool finalStripe = stripe->y0_ + stripe->numRows_ == cinfo.image_height;
+
+	return drainPending(finalStripe ? 0 : concurrency_);
+}
+/**
+ * Write completed stripes in order, waiting for stripes to complete
+ * while more than maxPending stripes are outstanding
+ */
+bool JPEGFormat::drainPending(size_t maxPending)
+{
+	bool rc = true;
+	while(!pendingStripes_.empty())
+	{
+		auto& front = pendingStripes_.front();
+		if(rc && pendingStripes_.size() <= maxPending &&
+		   front.second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			break;
+		front.second.wait();
+		auto stripe = front.first;
+		if(rc)
+			rc = stripe->success_ && writeStripe(stripe);
+		delete stripe;
+		pendingStripes_.pop_front();
+	}
+
+	return rc;
+}
+/**
+ * Compress stripe as a stand-alone baseline JPEG in memory.
+ * All stripes share quantization and Huffman tables, since they are
+ * compressed with identical parameters.
+ */
+bool JPEGFormat::compressStripe(JPEGStripe* stripe)
+{
+	std::vector<uint8_t> interleaved;
+	if(stripe->rows_.empty())
+	{
+		interleaved.resize(stripe->numRows_ * rowBytes_);
+		int32_t* stripePlanes[4];
+		for(uint16_t i = 0; i < image_->decompressNumComps; ++i)
+			stripePlanes[i] = (int32_t*)planes[i] + (uint64_t)stripe->y0_ * image_->comps[i].stride;
+		std::unique_ptr<grk::PlanarToInterleaved<int32_t>> iter(
+			grk::InterleaverFactory<int32_t>::makeInterleaver(8));
+		if(!iter)
+			return false;
+		iter->interleave(stripePlanes, image_->decompressNumComps, interleaved.data(),
+						 image_->decompressWidth, image_->comps[0].stride, rowBytes_,
+						 stripe->numRows_, adjust);
+	}
+
+	return compressStripeRows(stripe,
+							  stripe->rows_.empty() ? interleaved.data() : stripe->rows_.data());
+}
+bool JPEGFormat::compressStripeRows(JPEGStripe* stripe, const uint8_t* rows)
+{
+	struct jpeg_compress_struct stripeInfo;
+	struct my_error_mgr jerr;
+	struct vector_destination_mgr dest;
+	dest.buf = &stripe->compressed_;
+	stripeInfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = my_error_exit;
+	if(setjmp(jerr.setjmp_buffer))
+	{
+		jpeg_destroy_compress(&stripeInfo);
+		return false;
+	}
+	jpeg_create_compress(&stripeInfo);
+	stripeInfo.dest = &dest.pub;
+	dest.pub.init_destination = vector_init_destination;
+	dest.pub.empty_output_buffer = vector_empty_output_buffer;
+	dest.pub.term_destination = vector_term_destination;
+	initCompressor(&stripeInfo, stripe->numRows_);
+	jpeg_start_compress(&stripeInfo, (boolean)TRUE);
+	if(stripe->y0_ == 0 && image_->meta && image_->meta->color.icc_profile_buf)
+	{
+		write_icc_profile(&stripeInfo, image_->meta->color.icc_profile_buf,
+						  image_->meta->color.icc_profile_len);
+	}
+	while(stripeInfo.next_scanline < stripeInfo.image_height)
+	{
+		JSAMPROW row_pointer[1];
+		row_pointer[0] = (JSAMPROW)(rows + stripeInfo.next_scanline * rowBytes_);
+		jpeg_write_scanlines(&stripeInfo, row_pointer, 1);
+	}
+	jpeg_finish_compress(&stripeInfo);
+	jpeg_destroy_compress(&stripeInfo);
+
+	return true;
+}
+/**
+ * Append stripe to output stream.
+ * The first stripe contributes the stream header, with its frame height patched
+ * to the full image height and a restart interval marker inserted before the scan header.
+ * Subsequent stripes only contribute their entropy-coded segments,
+ * each preceded by a restart marker.
+ */
+bool JPEGFormat::writeStripe(JPEGStripe* stripe)
+{
+	auto& data = stripe->compressed_;
+	size_t len = data.size();
+	if(len < 4 || data[0] != 0xFF || data[1] != jpegMarkerSOI || data[len - 2] != 0xFF ||
+	   data[len - 1] != jpegMarkerEOI)
+		return false;
+	// locate frame header and scan header
+	size_t sof = 0;
+	size_t sos = 0;
+	size_t pos = 2;
+	while(!sos && pos + 4 <= len)
+	{
+		if(data[pos] != 0xFF)
+			return false;
+		uint8_t marker = data[pos + 1];
+		if(marker == jpegMarkerSOF0 || marker == jpegMarkerSOF1)
+			sof = pos;
+		else if(marker == jpegMarkerSOS)
+			sos = pos;
+		pos += 2 + (size_t)((data[pos + 2] << 8) | data[pos + 3]);
+	}
+	if(!sof || !sos || pos > len - 2)
+		return false;
+	size_t entropyBegin = pos;
+	if(stripesWritten_ == 0)
+	{
+		uint32_t height = cinfo.image_height;
+		data[sof + 5] = (uint8_t)(height >> 8);
+		data[sof + 6] = (uint8_t)height;
+		uint8_t dri[] = {0xFF, jpegMarkerDRI, 0, 4, (uint8_t)(restartInterval_ >> 8),
+						 (uint8_t)restartInterval_};
+		if(fwrite(data.data(), 1, sos, fileStream_) != sos ||
+		   fwrite(dri, 1, sizeof(dri), fileStream_) != sizeof(dri) ||
+		   fwrite(data.data() + sos, 1, entropyBegin - sos, fileStream_) != entropyBegin - sos)
+			return false;
+	}
+	else
+	{
+		uint8_t rst[] = {0xFF, (uint8_t)(jpegMarkerRST0 + ((stripesWritten_ - 1) & 7))};
+		if(fwrite(rst, 1, sizeof(rst), fileStream_) != sizeof(rst))
+			return false;
+	}
+	size_t entropyLength = len - 2 - entropyBegin;
+	if(fwrite(data.data() + entropyBegin, 1, entropyLength, fileStream_) != entropyLength)
+		return false;
+	stripesWritten_++;
+
+	return true;
+}
 bool JPEGFormat::encodeFinish(void)
 {
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
+	encodeState |= IMAGE_FORMAT_ENCODED_PIXELS;
+	if(parallel_)
+	{
+		// flush stripes, then terminate stitched stream
+		delete currentStripe_;
+		currentStripe_ = nullptr;
+		if(!drainPending(0))
+			success = false;
+		uint8_t eoi[] = {0xFF, jpegMarkerEOI};
+		if(success && fwrite(eoi, 1, sizeof(eoi), fileStream_) != sizeof(eoi))
+			success = false;
+	}
 	/* Step 6: Finish compression */
-	jpeg_finish_compress(&cinfo);
+	else if(compressStarted_)
+	{
+		jpeg_finish_compress(&cinfo);
+	}
 
 	/* Step 7: release JPEG compression object */
 
@@ -568,7 +903,9 @@ bool JPEGFormat::encodeFinish(void)
 	jpeg_destroy_compress(&cinfo);
 
 	delete[] buffer;
+	buffer = nullptr;
 	delete[] buffer32s;
+	buffer32s = nullptr;
 
 	/* After finish_compress, we can close the output file. */
 	return ImageFormat::encodeFinish() && success;
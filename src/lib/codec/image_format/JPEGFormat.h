@@ -26,6 +26,26 @@ typedef unsigned char boolean;
 #include "iccjpeg.h"
 #include "convert.h"
 
+#include <vector>
+#include <deque>
+#include <future>
+
+/**
+ * Horizontal stripe of the image that is compressed independently of other stripes,
+ * and then stitched into the single scan, with restart markers between stripes
+ */
+struct JPEGStripe
+{
+	JPEGStripe(uint32_t y0, uint32_t numRows) : y0_(y0), numRows_(numRows), success_(false) {}
+	// first row of stripe
+	uint32_t y0_;
+	uint32_t numRows_;
+	// interleaved rows : empty if rows are to be interleaved from image planes
+	std::vector<uint8_t> rows_;
+	std::vector<uint8_t> compressed_;
+	bool success_;
+};
+
 class JPEGFormat : public ImageFormat
 {
   public:
@@ -36,7 +56,17 @@ class JPEGFormat : public ImageFormat
 	bool encodeFinish(void) override;
 	grk_image* decode(const std::string& filename, grk_cparameters* parameters) override;
 
+  protected:
+	bool encodePixelsCore(uint32_t threadId, grk_io_buf pixels) override;
+
   private:
+	void initCompressor(j_compress_ptr info, JDIMENSION height);
+	bool useParallelEncode(void);
+	bool dispatchStripe(JPEGStripe* stripe);
+	bool compressStripe(JPEGStripe* stripe);
+	bool compressStripeRows(JPEGStripe* stripe, const uint8_t* rows);
+	bool writeStripe(JPEGStripe* stripe);
+	bool drainPending(size_t maxPending);
 	grk_image* jpegtoimage(const char* filename, grk_cparameters* parameters);
 	bool imagetojpeg(grk_image* image, const char* filename, uint32_t compressionLevel);
 
@@ -54,5 +84,16 @@ class JPEGFormat : public ImageFormat
 	 * to any one struct (and its associated working data) as a "JPEG object".
 	 */
 	struct jpeg_compress_struct cinfo;
-	int32_t const* planes[3];
+	int32_t const* planes[4];
+
+	// parallel stripe encoding
+	bool parallel_;
+	bool compressStarted_;
+	uint32_t stripeRows_;
+	uint32_t restartInterval_;
+	uint64_t rowBytes_;
+	uint32_t rowsEncoded_;
+	uint32_t stripesWritten_;
+	JPEGStripe* currentStripe_;
+	std::deque<std::pair<JPEGStripe*, std::future<void>>> pendingStripes_;
 };
@@ -33,11 +33,19 @@
 #include <locale>
 #include "common.h"
 #include "FileStreamIO.h"
+#include "CodecExecutor.h"
+#include <zlib.h>
 
 #define PNG_MAGIC "\x89PNG\x0d\x0a\x1a\x0a"
 #define MAGIC_SIZE 8
 /* PNG allows bits per sample: 1, 2, 4, 8, 16 */
 
+// minimum number of filtered bytes deflated as one independent block:
+// smaller blocks lose too much compression to the reset LZ77 window
+const size_t pngMinBytesPerBlock = 256 * 1024;
+// maximum IDAT chunk length
+const size_t pngMaxIDATLength = 1024 * 1024;
+
 static bool pngWarningHandlerVerbose = true;
 
 static void png_warning_fn([[maybe_unused]] png_structp png_ptr, png_const_charp warning_message)
@@ -66,10 +74,86 @@ static void user_error_fn([[maybe_unused]] png_structp png_ptr, png_const_charp
 	spdlog::error("libpng error: {}", message);
 }
 
+static uint8_t paethPredictor(uint8_t a, uint8_t b, uint8_t c)
+{
+	int32_t p = (int32_t)a + b - c;
+	int32_t pa = abs(p - a);
+	int32_t pb = abs(p - b);
+	int32_t pc = abs(p - c);
+	if(pa <= pb && pa <= pc)
+		return a;
+
+	return (pb <= pc) ? b : c;
+}
+
+static uint64_t filterCost(const uint8_t* buf, size_t len)
+{
+	uint64_t sum = 0;
+	for(size_t i = 0; i < len; ++i)
+		sum += (uint64_t)abs((int8_t)buf[i]);
+
+	return sum;
+}
+
+/**
+ * Filter one row, choosing the filter type with the same minimum sum of
+ * absolute differences heuristic as libpng.
+ *
+ * @param row 		row to filter
+ * @param prev 		previous (unfiltered) row, or nullptr for first row of image
+ * @param rowBytes 	number of bytes in row
+ * @param bpp 		bytes per complete pixel, rounded up to 1
+ * @param adaptive 	if false, filter type NONE is used
+ * @param dest 		destination : filter type byte followed by filtered row
+ * @param scratch 	scratch buffer of 4 * rowBytes
+ */
+static void filterRow(const uint8_t* row, const uint8_t* prev, size_t rowBytes, size_t bpp,
+					  bool adaptive, uint8_t* dest, uint8_t* scratch)
+{
+	if(!adaptive)
+	{
+		dest[0] = PNG_FILTER_VALUE_NONE;
+		memcpy(dest + 1, row, rowBytes);
+		return;
+	}
+	uint8_t* candidates[4] = {scratch, scratch + rowBytes, scratch + 2 * rowBytes,
+							  scratch + 3 * rowBytes};
+	for(size_t i = 0; i < rowBytes; ++i)
+	{
+		uint8_t left = i >= bpp ? row[i - bpp] : 0;
+		uint8_t up = prev ? prev[i] : 0;
+		uint8_t upLeft = (prev && i >= bpp) ? prev[i - bpp] : 0;
+		candidates[0][i] = (uint8_t)(row[i] - left);
+		candidates[1][i] = (uint8_t)(row[i] - up);
+		candidates[2][i] = (uint8_t)(row[i] - (uint8_t)(((uint32_t)left + up) >> 1));
+		candidates[3][i] = (uint8_t)(row[i] - paethPredictor(left, up, upLeft));
+	}
+	uint8_t best = PNG_FILTER_VALUE_NONE;
+	uint64_t bestCost = filterCost(row, rowBytes);
+	for(uint8_t f = 0; f < 4; ++f)
+	{
+		uint64_t cost = filterCost(candidates[f], rowBytes);
+		if(cost < bestCost)
+		{
+			bestCost = cost;
+			best = (uint8_t)(f + 1);
+		}
+	}
+	dest[0] = best;
+	memcpy(dest + 1, best == PNG_FILTER_VALUE_NONE ? row : candidates[best - 1], rowBytes);
+}
+
 PNGFormat::PNGFormat()
 	: info_(nullptr), png(nullptr), row_buf(nullptr), row_buf_array(nullptr), row32s(nullptr),
-	  colorSpace_(GRK_CLRSPC_UNKNOWN), prec(0), nr_comp(0)
+	  colorSpace_(GRK_CLRSPC_UNKNOWN), prec(0), nr_comp(0), parallel_(false), rowBytes_(0),
+	  rowsEncoded_(0), adler_(1), wroteZlibHeader_(false)
 {}
+int PNGFormat::zlibLevel(void)
+{
+	return (int)((compressionLevel_ == GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT)
+					 ? 0
+					 : std::min<uint32_t>(compressionLevel_, Z_BEST_COMPRESSION));
+}
 
 bool PNGFormat::encodeHeader(void)
 {
@@ -86,6 +170,8 @@ bool PNGFormat::encodeHeader(void)
 		spdlog::error("Sub-sampled images not supported");
 		return false;
 	}
+	if(!areAllComponentsSameSubsampling(image_))
+		return false;
 
 	memset(&sig_bit, 0, sizeof(sig_bit));
 
@@ -101,15 +187,12 @@ bool PNGFormat::encodeHeader(void)
 	}
 	for(i = 1; i < nr_comp; ++i)
 	{
-		if(image_->comps[0].dx != image_->comps[i].dx)
-			break;
-		if(image_->comps[0].dy != image_->comps[i].dy)
-			break;
 		if(image_->comps[0].prec != image_->comps[i].prec)
 			break;
 		if(image_->comps[0].sgnd != image_->comps[i].sgnd)
 			break;
-		if(!image_->comps[i].data)
+		// component data is not present for library-orchestrated encoding
+		if(image_->comps[0].data && !image_->comps[i].data)
 		{
 			spdlog::error("imagetopng: component {} is null.", i);
 			return false;
@@ -197,10 +280,7 @@ bool PNGFormat::encodeHeader(void)
 	 * color_type == PNG_COLOR_TYPE_RGB_ALPHA) && bit_depth < 8
 	 *
 	 */
-	png_set_compression_level(png,
-							  (int)((compressionLevel_ == GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT)
-										? 0
-										: compressionLevel_));
+	png_set_compression_level(png, zlibLevel());
 
 	if(nr_comp >= 3)
 	{ /* RGB(A) */
@@ -273,6 +353,7 @@ bool PNGFormat::encodeHeader(void)
 			spdlog::error("Invalid PNG row size");
 			goto beach;
 		}
+		rowBytes_ = png_row_size;
 		row_buf = (png_bytep)malloc(png_row_size);
 		if(row_buf == nullptr)
 		{
@@ -293,8 +374,22 @@ bool PNGFormat::encodeHeader(void)
 beach:
 	return !fails;
 }
+bool PNGFormat::useParallelEncode(void)
+{
+	if(concurrency_ <= 1 || !rowBytes_)
+		return false;
+	uint64_t rawBytes = (uint64_t)(rowBytes_ + 1) * maxY(image_->comps->h);
+
+	return rawBytes >= 2 * pngMinBytesPerBlock;
+}
 bool PNGFormat::encodePixels(void)
 {
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
+	parallel_ = useParallelEncode();
+	if(parallel_)
+		return encodePixelsParallel();
+
 	int32_t const* planes[4];
 	for(uint16_t compno = 0; compno < nr_comp; ++compno)
 		planes[compno] = image_->comps[compno].data;
@@ -318,21 +413,271 @@ bool PNGFormat::encodePixels(void)
 
 	return true;
 }
-bool PNGFormat::encodeFinish(void)
+/***
+ * application-orchestrated pixel encoding: row blocks are interleaved, filtered
+ * and deflated concurrently, and then written in order as IDAT chunks
+ */
+bool PNGFormat::encodePixelsParallel(void)
+{
+	int32_t* planes[4];
+	for(uint16_t compno = 0; compno < nr_comp; ++compno)
+		planes[compno] = image_->comps[compno].data;
+	int32_t adjust = image_->comps[0].sgnd ? 1 << (prec - 1) : 0;
+	uint32_t height = maxY(image_->comps->h);
+	uint32_t width = image_->comps[0].w;
+	uint32_t stride = image_->comps[0].stride;
+	uint32_t rowsPerBlock =
+		(uint32_t)std::max<size_t>(1, (pngMinBytesPerBlock + rowBytes_) / (rowBytes_ + 1));
+	uint32_t numBlocks = (height + rowsPerBlock - 1) / rowsPerBlock;
+	auto executor = grk::CodecExecutor::instance(concurrency_);
+
+	// blocks are compressed in batches, to bound memory usage
+	for(uint32_t batchBegin = 0; batchBegin < numBlocks; batchBegin += concurrency_)
+	{
+		uint32_t batchEnd = std::min<uint32_t>(numBlocks, batchBegin + concurrency_);
+		std::vector<PNGDeflateBlock> blocks(batchEnd - batchBegin);
+		tf::Taskflow taskflow;
+		for(uint32_t b = batchBegin; b < batchEnd; ++b)
+		{
+			auto block = &blocks[b - batchBegin];
+			taskflow.emplace([this, block, b, numBlocks, rowsPerBlock, height, width, stride,
+							  adjust, &planes] {
+				uint32_t y0 = b * rowsPerBlock;
+				uint32_t rows = std::min<uint32_t>(rowsPerBlock, height - y0);
+				// also interleave the row above the block, which the filters may reference
+				uint32_t rowsAbove = y0 ? 1 : 0;
+				std::unique_ptr<uint8_t[]> packed(new uint8_t[(rows + rowsAbove) * rowBytes_]);
+				int32_t* src[4];
+				for(uint16_t compno = 0; compno < nr_comp; ++compno)
+					src[compno] = planes[compno] + (uint64_t)(y0 - rowsAbove) * stride;
+				std::unique_ptr<grk::PlanarToInterleaved<int32_t>> iter(
+					grk::InterleaverFactory<int32_t>::makeInterleaver(
+						prec == 16 ? grk::packer16BitBE : prec));
+				if(!iter)
+					return;
+				iter->interleave(src, nr_comp, packed.get(), width, stride, rowBytes_,
+								 rows + rowsAbove, adjust);
+				block->success_ = compressRows(packed.get() + rowsAbove * rowBytes_,
+											   rowsAbove ? packed.get() : nullptr, rows,
+											   b == numBlocks - 1, block);
+			});
+		}
+		executor->run(taskflow).wait();
+		for(uint32_t b = batchBegin; b < batchEnd; ++b)
+		{
+			auto block = &blocks[b - batchBegin];
+			if(!block->success_ || !writeBlock(block, b == numBlocks - 1))
+				return false;
+		}
+	}
+
+	return true;
+}
+/***
+ * library-orchestrated pixel encoding: each strip is deflated asynchronously
+ * while strips are still being decompressed
+ */
+bool PNGFormat::encodePixelsCore(uint32_t threadId, grk_io_buf pixels)
+{
+	parallel_ = true;
+	uint32_t height = maxY(image_->comps->h);
+	uint32_t numRows = (uint32_t)(pixels.len_ / rowBytes_);
+	if(!numRows || rowsEncoded_ + numRows > height)
+	{
+		spdlog::error("PNGFormat::encodePixelsCore: invalid strip of {} rows", numRows);
+		encodeState |= IMAGE_FORMAT_ERROR;
+		return false;
+	}
+	bool finalBlock = rowsEncoded_ + numRows == height;
+	auto block = new PNGDeflateBlock();
+	block->pixels_ = pixels;
+	auto prevRow = lastRow_;
+	lastRow_.assign(pixels.data_ + (numRows - 1) * rowBytes_, pixels.data_ + numRows * rowBytes_);
+	rowsEncoded_ += numRows;
+	auto compressor = [this, block, prevRow = std::move(prevRow), numRows, finalBlock] {
+		block->success_ = compressRows(block->pixels_.data_,
+									   prevRow.empty() ? nullptr : prevRow.data(), numRows,
+									   finalBlock, block);
+	};
+	if(concurrency_ > 1)
+	{
+		pendingBlocks_.emplace_back(block,
+									grk::CodecExecutor::instance(concurrency_)->async(compressor));
+	}
+	else
+	{
+		compressor();
+		pendingBlocks_.emplace_back(block, std::future<void>());
+	}
+	// write completed blocks, bounding the number of strips in flight
+	if(!drainPending(threadId, finalBlock ? 0 : concurrency_))
+	{
+		spdlog::error("PNGFormat::encodePixelsCore: error in pixels encode");
+		encodeState |= IMAGE_FORMAT_ERROR;
+		return false;
+	}
+	if(finalBlock)
+		return encodeFinish();
+
+	return true;
+}
+/**
+ * Write completed blocks in order, waiting for blocks to complete
+ * while more than maxPending blocks are outstanding.
+ * Each strip buffer is returned to the library once its block has been written.
+ */
+bool PNGFormat::drainPending(uint32_t threadId, size_t maxPending)
+{
+	bool success = true;
+	while(!pendingBlocks_.empty())
+	{
+		auto& front = pendingBlocks_.front();
+		if(front.second.valid())
+		{
+			if(success && pendingBlocks_.size() <= maxPending &&
+			   front.second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				break;
+			front.second.wait();
+		}
+		auto block = front.first;
+		bool finalBlock = rowsEncoded_ == maxY(image_->comps->h) && pendingBlocks_.size() == 1;
+		if(success)
+			success = block->success_ && writeBlock(block, finalBlock);
+		ioReclaimBuffer(threadId, block->pixels_);
+		delete block;
+		pendingBlocks_.pop_front();
+	}
+
+	return success;
+}
+/**
+ * Filter and deflate a block of rows as a raw deflate stream that ends on a byte
+ * boundary, so that blocks can be concatenated into a single zlib stream
+ *
+ * @param rows 			packed rows
+ * @param prevRow 		row preceding the block, or nullptr if block begins the image
+ * @param numRows 		number of rows in block
+ * @param finalBlock 	true if this block terminates the deflate stream
+ * @param block 		destination block
+ */
+bool PNGFormat::compressRows(const uint8_t* rows, const uint8_t* prevRow, uint32_t numRows,
+							 bool finalBlock, PNGDeflateBlock* block)
+{
+	int level = zlibLevel();
+	bool adaptive = level != Z_NO_COMPRESSION && prec >= 8;
+	size_t bpp = std::max<size_t>(1, ((size_t)nr_comp * prec) >> 3);
+	size_t filteredLength = (rowBytes_ + 1) * numRows;
+	std::unique_ptr<uint8_t[]> filtered(new uint8_t[filteredLength]);
+	std::unique_ptr<uint8_t[]> scratch(adaptive ? new uint8_t[4 * rowBytes_] : nullptr);
+	auto prev = prevRow;
+	auto row = rows;
+	for(uint32_t i = 0; i < numRows; ++i)
+	{
+		filterRow(row, prev, rowBytes_, bpp, adaptive, filtered.get() + i * (rowBytes_ + 1),
+				  scratch.get());
+		prev = row;
+		row += rowBytes_;
+	}
+	block->rawLength_ = filteredLength;
+	block->adler_ = adler32_z(1, filtered.get(), filteredLength);
+
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if(deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8,
+					adaptive ? Z_FILTERED : Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+	auto& out = block->compressed_;
+	out.resize(deflateBound(&zs, (uLong)filteredLength) + 16);
+	size_t inPos = 0;
+	size_t outPos = 0;
+	int flush = Z_NO_FLUSH;
+	int rc = Z_OK;
+	do
+	{
+		size_t inChunk = std::min<size_t>(filteredLength - inPos, UINT_MAX);
+		zs.next_in = filtered.get() + inPos;
+		zs.avail_in = (uInt)inChunk;
+		inPos += inChunk;
+		if(inPos == filteredLength)
+			flush = finalBlock ? Z_FINISH : Z_SYNC_FLUSH;
+		do
+		{
+			if(outPos == out.size())
+				out.resize(out.size() * 2);
+			zs.next_out = out.data() + outPos;
+			zs.avail_out = (uInt)std::min<size_t>(out.size() - outPos, UINT_MAX);
+			rc = deflate(&zs, flush);
+			outPos = (size_t)(zs.next_out - out.data());
+		} while(rc != Z_STREAM_ERROR && zs.avail_out == 0);
+	} while(rc != Z_STREAM_ERROR && flush == Z_NO_FLUSH);
+	deflateEnd(&zs);
+	out.resize(outPos);
+
+	return finalBlock ? rc == Z_STREAM_END : rc == Z_OK;
+}
+/**
+ * Append block to zlib stream, and write stream as IDAT chunks
+ */
+bool PNGFormat::writeBlock(PNGDeflateBlock* block, bool finalBlock)
 {
+	auto& data = block->compressed_;
+	if(!wroteZlibHeader_)
+	{
+		int level = zlibLevel();
+		uint32_t flevel = level < 2 ? 0 : (level < 6 ? 1 : (level == 6 ? 2 : 3));
+		uint32_t header = (0x78 << 8) | (flevel << 6);
+		header += 31 - (header % 31);
+		data.insert(data.begin(), {(uint8_t)(header >> 8), (uint8_t)header});
+		wroteZlibHeader_ = true;
+	}
+	adler_ = adler32_combine((uLong)adler_, (uLong)block->adler_, (z_off_t)block->rawLength_);
+	if(finalBlock)
+	{
+		for(int32_t shift = 24; shift >= 0; shift -= 8)
+			data.push_back((uint8_t)(adler_ >> shift));
+	}
 	if(setjmp(png_jmpbuf(png)))
 		return false;
+	for(size_t offset = 0; offset < data.size(); offset += pngMaxIDATLength)
+	{
+		png_write_chunk(png, (png_const_bytep) "IDAT", data.data() + offset,
+						std::min<size_t>(pngMaxIDATLength, data.size() - offset));
+	}
 
+	return true;
+}
+/**
+ * Terminate image. If image data was written as raw IDAT chunks, png_write_end
+ * cannot be used, since libpng is not aware of IDAT chunks it did not write itself
+ */
+bool PNGFormat::writeEnd(void)
+{
+	if(setjmp(png_jmpbuf(png)))
+		return false;
+	if(parallel_)
+		png_write_chunk(png, (png_const_bytep) "IEND", nullptr, 0);
+	else
+		png_write_end(png, info_);
+
+	return true;
+}
+bool PNGFormat::encodeFinish(void)
+{
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
+	encodeState |= IMAGE_FORMAT_ENCODED_PIXELS;
+	bool rc = true;
 	if(png)
 	{
-		png_write_end(png, info_);
+		rc = writeEnd();
 		png_destroy_write_struct(&png, &info_);
 	}
 	free(row_buf);
+	row_buf = nullptr;
 	free(row32s);
-	bool rc = ImageFormat::encodeFinish();
+	row32s = nullptr;
 
-	return rc;
+	return ImageFormat::encodeFinish() && rc;
 }
 grk_image* PNGFormat::decode(const std::string& filename, grk_cparameters* parameters)
 {
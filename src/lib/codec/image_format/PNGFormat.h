@@ -19,9 +19,27 @@
 #include "ImageFormat.h"
 #include <png.h>
 #include <string>
+#include <vector>
+#include <deque>
+#include <future>
 
 void pngSetVerboseFlag(bool verbose);
 
+/**
+ * Row group that is filtered and deflated independently of other groups,
+ * and then stitched into the single IDAT zlib stream
+ */
+struct PNGDeflateBlock
+{
+	PNGDeflateBlock() : adler_(1), rawLength_(0), success_(false), pixels_{} {}
+	std::vector<uint8_t> compressed_;
+	uint64_t adler_;
+	uint64_t rawLength_;
+	bool success_;
+	// library-orchestrated strip to be returned to the pool once compressed
+	grk_io_buf pixels_;
+};
+
 class PNGFormat : public ImageFormat
 {
   public:
@@ -32,8 +50,19 @@ class PNGFormat : public ImageFormat
 	bool encodeFinish(void) override;
 	grk_image* decode(const std::string& filename, grk_cparameters* parameters) override;
 
+  protected:
+	bool encodePixelsCore(uint32_t threadId, grk_io_buf pixels) override;
+
   private:
 	grk_image* do_decode(grk_cparameters* params);
+	bool encodePixelsParallel(void);
+	bool compressRows(const uint8_t* rows, const uint8_t* prevRow, uint32_t numRows,
+					  bool finalBlock, PNGDeflateBlock* block);
+	bool writeBlock(PNGDeflateBlock* block, bool finalBlock);
+	bool drainPending(uint32_t threadId, size_t maxPending);
+	bool writeEnd(void);
+	bool useParallelEncode(void);
+	int zlibLevel(void);
 
 	png_infop info_;
 	png_structp png;
@@ -43,4 +72,13 @@ class PNGFormat : public ImageFormat
 	GRK_COLOR_SPACE colorSpace_;
 	uint8_t prec;
 	uint16_t nr_comp;
+
+	// parallel IDAT encoding
+	bool parallel_;
+	size_t rowBytes_;
+	uint32_t rowsEncoded_;
+	uint64_t adler_;
+	bool wroteZlibHeader_;
+	std::vector<uint8_t> lastRow_;
+	std::deque<std::pair<PNGDeflateBlock*, std::future<void>>> pendingBlocks_;
 };
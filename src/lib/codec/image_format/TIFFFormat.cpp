@@ -256,8 +256,12 @@ bool TIFFFormat::encodeHeader(TIFF* tif)
 								  "not supported.");
 					goto cleanup;
 				}
-				chroma_subsample_x = image_->comps[1].dx;
-				chroma_subsample_y = image_->comps[1].dy;
+				// upsampled chroma is written at full resolution
+				if(subsampled)
+				{
+					chroma_subsample_x = image_->comps[1].dx;
+					chroma_subsample_y = image_->comps[1].dy;
+				}
 				tiPhoto = PHOTOMETRIC_YCBCR;
 				break;
 			case GRK_CLRSPC_DEFAULT_CIE:
@@ -24,6 +24,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <string>
 
 #include "grk_apps_config.h"
@@ -104,6 +105,8 @@ static void compare_images_help_display(void)
 					"image; comma separated list of four integers: x0,y0,x1,y1 \n");
 	fprintf(stdout, "  If sub-region is set, then test images dimensions must "
 					"match sub-region exactly\n");
+	fprintf(stdout, "  -S \t OPTIONAL \t Calculate structural similarity (SSIM) "
+					"of each component\n");
 	fprintf(stdout, "\n");
 }
 
@@ -443,6 +446,48 @@ static int imageToPNG(const grk_image* src, const char* filename, uint16_t compn
 
 	return EXIT_SUCCESS;
 }
+
+/*******************************************************************************
+ * Create image of absolute differences between base region and test image
+ *******************************************************************************/
+static grk_image* createDiffImage(const grk_image* base, const grk_image* test,
+								  const uint32_t* region)
+{
+	auto params = std::make_unique<grk_image_comp[]>(test->numcomps);
+	for(uint16_t compno = 0; compno < test->numcomps; compno++)
+	{
+		auto testComp = test->comps + compno;
+		auto param = params.get() + compno;
+		memset(param, 0, sizeof(grk_image_comp));
+		param->dx = 1;
+		param->dy = 1;
+		param->sgnd = testComp->sgnd;
+		param->prec = testComp->prec;
+		param->h = testComp->h;
+		param->w = testComp->w;
+	}
+	auto diff = grk_image_new(test->numcomps, params.get(), GRK_CLRSPC_UNKNOWN);
+	if(!diff)
+		return nullptr;
+	uint32_t x0 = region ? region[0] : 0;
+	uint32_t y0 = region ? region[1] : 0;
+	for(uint16_t compno = 0; compno < diff->numcomps; compno++)
+	{
+		auto diffComp = diff->comps + compno;
+		auto baseComp = base->comps + compno;
+		auto testComp = test->comps + compno;
+		for(uint32_t j = 0; j < diffComp->h; ++j)
+		{
+			auto basePtr = baseComp->data + x0 + (size_t)(y0 + j) * baseComp->stride;
+			auto testPtr = testComp->data + (size_t)j * testComp->stride;
+			auto diffPtr = diffComp->data + (size_t)j * diffComp->stride;
+			for(uint32_t i = 0; i < diffComp->w; ++i)
+				diffPtr[i] = (int32_t)llabs((int64_t)basePtr[i] - testPtr[i]);
+		}
+	}
+
+	return diff;
+}
 #endif
 
 struct test_cmp_parameters
@@ -457,6 +502,7 @@ struct test_cmp_parameters
 	char separator_test[2];
 	float region[4];
 	bool regionSet;
+	bool ssim;
 };
 class GrokOutput : public TCLAP::StdOutput
 {
@@ -481,6 +527,7 @@ static int parse_cmdline_cmp(int argc, char** argv, test_cmp_parameters* param)
 	param->separator_base[0] = 0;
 	param->separator_test[0] = 0;
 	param->regionSet = false;
+	param->ssim = false;
 
 	try
 	{
@@ -509,6 +556,7 @@ static int parse_cmdline_cmp(int argc, char** argv, test_cmp_parameters* param)
 
 		TCLAP::ValueArg<std::string> regionArg("R", "SubRegion", "Base image region to compare with. Must equal test image dimensions.", false, "",
 											   "string", cmd);
+		TCLAP::SwitchArg ssimArg("S", "SSIM", "Structural similarity", cmd);
 
 		cmd.parse(argc, argv);
 
@@ -560,6 +608,7 @@ static int parse_cmdline_cmp(int argc, char** argv, test_cmp_parameters* param)
 				param->regionSet = true;
 			}
 		}
+		param->ssim = ssimArg.isSet();
 
 		if(param->nbcomp == 0)
 		{
@@ -709,11 +758,13 @@ int GrkCompareImages::main(int argc, char** argv)
 	char *testFileName = nullptr, *baseFileName = nullptr, *filenamePNGdiff = nullptr;
 	size_t memsizebasefilename, memsizetestfilename;
 	size_t memsizedifffilename;
-	uint32_t nbPixelDiff = 0;
+	uint64_t nbPixelDiff = 0;
 	double sumDiff = 0.0;
 	/* Structures to store image parameters and data*/
 	grk_image *imageBase = nullptr, *imageTest = nullptr, *imageDiff = nullptr;
-	grk_image_comp* param_image_diff = nullptr;
+	grk_image_comp_metrics* metrics = nullptr;
+	uint32_t region[4];
+	const uint32_t* compareRegion = nullptr;
 	int decod_format;
 	if(parse_cmdline_cmp(argc, argv, &inParam))
 	{
@@ -830,7 +881,6 @@ int GrkCompareImages::main(int argc, char** argv)
 	strcpy(testFileName, inParam.test_filename);
 	strcat(testFileName, ".test");
 
-	param_image_diff = (grk_image_comp*)malloc(imageBase->numcomps * sizeof(grk_image_comp));
 	spdlog::info("Step 1 -> Header comparison");
 	if(imageBase->numcomps != imageTest->numcomps)
 	{
@@ -887,69 +937,36 @@ int GrkCompareImages::main(int argc, char** argv)
 						  testComp->prec);
 			goto cleanup;
 		}
-
-		param_image_diff[compno].x0 = 0;
-		param_image_diff[compno].y0 = 0;
-		param_image_diff[compno].dx = 1;
-		param_image_diff[compno].dy = 1;
-		param_image_diff[compno].sgnd = testComp->sgnd;
-		param_image_diff[compno].prec = testComp->prec;
-		param_image_diff[compno].h = testComp->h;
-		param_image_diff[compno].w = testComp->w;
 	}
 
-	imageDiff = grk_image_new(imageBase->numcomps, param_image_diff, GRK_CLRSPC_UNKNOWN);
-	free(param_image_diff);
-	param_image_diff = nullptr;
 	spdlog::info("Step 2 -> measurement comparison");
+	if(inParam.regionSet)
+	{
+		for(uint32_t i = 0; i < 4; ++i)
+			region[i] = (uint32_t)inParam.region[i];
+		compareRegion = region;
+	}
+	metrics = new grk_image_comp_metrics[imageBase->numcomps];
+	if(!grk_compare_images(imageBase, imageTest, compareRegion, inParam.ssim, metrics))
+		goto cleanup;
 
 	memsizedifffilename = strlen(inParam.test_filename) + 1 + 5 + 2 + 4;
 	filenamePNGdiff = (char*)malloc(memsizedifffilename);
 	strcpy(filenamePNGdiff, inParam.test_filename);
 	strcat(filenamePNGdiff, ".diff");
-	for(compno = 0; compno < imageDiff->numcomps; compno++)
+	for(compno = 0; compno < imageBase->numcomps; compno++)
 	{
-		double SE = 0, PEAK = 0;
-		double MSE = 0;
-		auto diffComp = imageDiff->comps + compno;
-		auto baseComp = imageBase->comps + compno;
-		auto testComp = imageTest->comps + compno;
-		uint32_t x0 = 0;
-		uint32_t y0 = 0;
-		uint32_t x1 = diffComp->w;
-		uint32_t y1 = diffComp->h;
-		// one region for all components
-		if(inParam.regionSet)
-		{
-			x0 = (uint32_t)inParam.region[0];
-			y0 = (uint32_t)inParam.region[1];
-			x1 = (uint32_t)inParam.region[2];
-			y1 = (uint32_t)inParam.region[3];
-		}
-		for(uint32_t j = y0; j < y1; ++j)
+		auto compMetrics = metrics + compno;
+		double PEAK = compMetrics->peak;
+		double MSE = compMetrics->mse;
+		nbPixelDiff += compMetrics->num_diff;
+		sumDiff += compMetrics->sum_diff;
+		if(inParam.ssim)
 		{
-			for(uint32_t i = x0; i < x1; ++i)
-			{
-				auto baseIndex = i + j * baseComp->stride;
-				auto testIndex = (i - x0) + (j - y0) * testComp->stride;
-				auto basePixel = baseComp->data[baseIndex];
-				auto testPixel = testComp->data[testIndex];
-				int64_t diff = basePixel - testPixel;
-				auto absDiff = llabs(diff);
-				if(absDiff > 0)
-				{
-					diffComp->data[testIndex] = (int32_t)absDiff;
-					sumDiff += (double)diff;
-					nbPixelDiff++;
-
-					SE += (double)diff * (double)diff;
-					PEAK = (PEAK > (double)absDiff) ? PEAK : (double)absDiff;
-				}
-				else
-					diffComp->data[testIndex] = 0;
-			}
+			spdlog::info("<DartMeasurement name=\"SSIM_{}\" type=\"numeric/double\"> "
+						 "{} </DartMeasurement>",
+						 compno, compMetrics->ssim);
 		}
-		MSE = SE / ((uint64_t)diffComp->w * diffComp->h);
 
 		if(!inParam.nr_flag && (inParam.tabMSEvalues != nullptr) &&
 		   (inParam.tabPEAKvalues != nullptr))
@@ -961,6 +978,9 @@ int GrkCompareImages::main(int argc, char** argv)
 			spdlog::info("<DartMeasurement name=\"MSE_{}\" type=\"numeric/double\"> "
 						 "{} </DartMeasurement>",
 						 compno, MSE);
+			spdlog::info("<DartMeasurement name=\"PSNR_{}\" type=\"numeric/double\"> "
+						 "{} </DartMeasurement>",
+						 compno, compMetrics->psnr);
 
 			if((MSE > inParam.tabMSEvalues[compno]) || (PEAK > inParam.tabPEAKvalues[compno]))
 			{
@@ -991,6 +1011,9 @@ int GrkCompareImages::main(int argc, char** argv)
 				spdlog::info("<DartMeasurement name=\"MSE_{}\" "
 							 "type=\"numeric/double\"> {} </DartMeasurement>",
 							 compno, MSE);
+				spdlog::info("<DartMeasurement name=\"PSNR_{}\" "
+							 "type=\"numeric/double\"> {} </DartMeasurement>",
+							 compno, compMetrics->psnr);
 #ifdef GROK_HAVE_LIBPNG
 				{
 					char* filenamePNGbase_it_comp = nullptr;
@@ -1037,7 +1060,10 @@ int GrkCompareImages::main(int argc, char** argv)
 									 "type=\"image/png\"> {} </DartMeasurementFile>",
 									 compno, filenamePNGtest_it_comp);
 					}
-					if(imageToPNG(imageDiff, filenamePNGdiff_it_comp, compno) == EXIT_SUCCESS)
+					if(!imageDiff)
+						imageDiff = createDiffImage(imageBase, imageTest, compareRegion);
+					if(imageDiff &&
+					   imageToPNG(imageDiff, filenamePNGdiff_it_comp, compno) == EXIT_SUCCESS)
 					{
 						spdlog::info("<DartMeasurementFile name=\"DiffferenceImage_{}\" "
 									 "type=\"image/png\"> {} </DartMeasurementFile>",
@@ -1054,7 +1080,7 @@ int GrkCompareImages::main(int argc, char** argv)
 	spdlog::info("---- TEST SUCCEEDED ----");
 	failed = 0;
 cleanup:
-	free(param_image_diff);
+	delete[] metrics;
 	grk_object_unref(&imageBase->obj);
 	grk_object_unref(&imageTest->obj);
 	grk_object_unref(&imageDiff->obj);
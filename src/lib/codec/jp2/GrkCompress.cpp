@@ -65,6 +65,7 @@ using namespace grk;
 #include "spdlog/sinks/basic_file_sink.h"
 #include "exif.h"
 #include "GrkCompress.h"
+#include "BatchScheduler.h"
 
 void exit_func()
 {
@@ -157,6 +158,12 @@ static void compress_help_display(void)
 	fprintf(stdout, "[-y|-in_dir] <dir>\n");
 	fprintf(stdout, "    Uncompressed file directory\n");
 	fprintf(stdout, "    When using this option [out_fmt] must be used\n");
+	fprintf(stdout, "[-j|-batch_threads] <number of files>\n");
+	fprintf(stdout, "    Number of files in [in_dir] that are compressed concurrently.\n");
+	fprintf(stdout, "    A value of 0 selects the number of hardware threads. Default: 1\n");
+	fprintf(stdout, "[-B|-batch_memory] <MB>\n");
+	fprintf(stdout, "    Maximum total size of input files in flight, when compressing\n");
+	fprintf(stdout, "    files concurrently. Default: 1024\n");
 	fprintf(stdout, "[-O|-out_fmt] <J2K|J2C|JP2>\n");
 	fprintf(stdout, "    Output format for compressed files.\n");
 	fprintf(stdout, "    Required only if [in_dir] is used\n");
@@ -198,6 +205,13 @@ static void compress_help_display(void)
 					"blocks. (default) (slightly higher PSRN than algorithm 1)\n");
 	fprintf(stdout, "    1: Bisection search for optimal threshold using only feasible truncation "
 					"points, on convex hull.\n");
+	fprintf(stdout, "[-pass_truncation_margin] <margin>\n");
+	fprintf(stdout, "    Skip coding of passes that rate control is certain to discard.\n"
+					"    Passes are skipped when their distortion-rate slope falls below the\n"
+					"    estimated final layer threshold divided by margin.\n"
+					"    Margin must be >= 1: larger values are safer but skip fewer passes.\n"
+					"    Only used when the final layer is rate limited with -r.\n"
+					"    Default: 0 (disabled)\n");
 	fprintf(stdout, "[-n|-num_resolutions] <number of resolutions>\n");
 	fprintf(stdout, "    Number of resolutions.\n");
 	fprintf(stdout, "    This value corresponds to the (number of DWT decompositions + 1). \n");
@@ -321,6 +335,11 @@ static void compress_help_display(void)
 	fprintf(stdout, "    Path to T1 plugin.\n");
 	fprintf(stdout, "[-H|-num_threads] <number of threads>\n");
 	fprintf(stdout, "    Number of threads used by libgrokj2k library.\n");
+	fprintf(stdout, "[-memory_flags] <memory flags>\n");
+	fprintf(stdout, "    Or'd combination of memory allocation flags for large buffers:\n"
+					"    1 - back with transparent huge pages (Linux only)\n"
+					"    2 - clear from worker threads, for NUMA first-touch placement\n"
+					"    Default: 0\n");
 	fprintf(stdout, "[-G|-device_id] <device ID>\n");
 	fprintf(stdout, "    (GPU) Specify which GPU accelerator to run codec on.\n");
 	fprintf(stdout, "    A value of -1 will specify all devices.\n");
@@ -343,7 +362,8 @@ static GRK_PROG_ORDER getProgression(const char progression[4])
 
 	return GRK_PROG_UNKNOWN;
 }
-CompressInitParams::CompressInitParams() : initialized(false), transferExifTags(false)
+CompressInitParams::CompressInitParams()
+	: initialized(false), transferExifTags(false), batchThreads(1), batchMaxBytesInFlight(0)
 {
 	pluginPath[0] = 0;
 	memset(&inputFolder, 0, sizeof(inputFolder));
@@ -475,15 +495,17 @@ int GrkCompress::main(int argc, char** argv)
 			return 0;
 		size_t numCompressedFiles = 0;
 
-		// cache certain settings
-		grk_cparameters parametersCache = initParams.parameters;
+		// Exif transfer is not thread safe
+		BatchScheduler batch(initParams.transferExifTags ? 1 : initParams.batchThreads,
+							 initParams.batchMaxBytesInFlight);
 		auto start = std::chrono::high_resolution_clock::now();
 		for(uint32_t i = 0; i < initParams.parameters.repeats; ++i)
 		{
 			if(!initParams.inputFolder.set_imgdir)
 			{
-				initParams.parameters = parametersCache;
-				if(compress("", &initParams) == 0)
+				// compress with copy of cached settings
+				grk_cparameters parameters = initParams.parameters;
+				if(compress("", &initParams, &parameters) == 0)
 				{
 					success = 1;
 					goto cleanup;
@@ -492,13 +514,14 @@ int GrkCompress::main(int argc, char** argv)
 			}
 			else
 			{
-				for(const auto& entry :
-					std::filesystem::directory_iterator(initParams.inputFolder.imgdirpath))
-				{
-					initParams.parameters = parametersCache;
-					if(compress(entry.path().filename().string(), &initParams) == 1)
-						numCompressedFiles++;
-				}
+				// each file is compressed with its own copy of the cached settings,
+				// so that files can be compressed concurrently
+				numCompressedFiles += batch.run(
+					initParams.inputFolder.imgdirpath,
+					[this, &initParams](const std::string& fileName) {
+						grk_cparameters parameters = initParams.parameters;
+						return compress(fileName, &initParams, &parameters);
+					});
 			}
 		}
 		auto finish = std::chrono::high_resolution_clock::now();
@@ -509,6 +532,8 @@ int GrkCompress::main(int argc, char** argv)
 						 (elapsed.count() * 1000) / (double)numCompressedFiles,
 						 numCompressedFiles > 1 ? "ms/image" : "ms");
 		}
+		if(initParams.inputFolder.set_imgdir)
+			batch.printThroughput("compressed");
 	}
 	catch(std::bad_alloc& ba)
 	{
@@ -547,6 +572,7 @@ int GrkCompress::pluginMain(int argc, char** argv, CompressInitParams* initParam
 	tiffSetErrorAndWarningHandlers(initParams->parameters.verbose);
 #endif
 	initParams->initialized = true;
+	grk_set_memory_flags(initParams->parameters.memoryFlags);
 	// load plugin but do not actually create codec
 	if(!grk_initialize(initParams->pluginPath, initParams->parameters.numThreads))
 	{
@@ -641,9 +667,16 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 
 		TCLAP::ValueArg<std::string> outDirArg("a", "out_dir", "Output directory", false, "",
 											   "string", cmd);
+		TCLAP::ValueArg<uint64_t> batchMemoryArg(
+			"B", "batch_memory", "Maximum MB of input files in flight in batch mode", false, 0,
+			"unsigned integer", cmd);
 		TCLAP::ValueArg<uint32_t> rateControlAlgoArg("A", "rate_control_algorithm",
 													 "Rate control algorithm", false, 0,
 													 "unsigned integer", cmd);
+		TCLAP::ValueArg<double> passTruncationMarginArg(
+			"", "pass_truncation_margin",
+			"Safety margin for skipping passes below rate control threshold", false, 0, "double",
+			cmd);
 		TCLAP::ValueArg<std::string> codeBlockDimArg(
 			"b", "code_block_dims", "Code block dimensions", false, "", "string", cmd);
 
@@ -671,9 +704,14 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 											 cmd);
 		TCLAP::ValueArg<uint32_t> numThreadsArg("H", "num_threads", "Number of threads", false, 0,
 												"unsigned integer", cmd);
+		TCLAP::ValueArg<uint32_t> memoryFlagsArg("", "memory_flags", "Memory allocation flags",
+												 false, 0, "unsigned integer", cmd);
 		TCLAP::ValueArg<std::string> inputFileArg("i", "in_file", "Input file", false, "", "string",
 												  cmd);
 		TCLAP::SwitchArg irreversibleArg("I", "irreversible", "Irreversible", cmd);
+		TCLAP::ValueArg<uint32_t> batchThreadsArg("j", "batch_threads",
+												  "Number of files compressed concurrently", false,
+												  1, "unsigned integer", cmd);
 		TCLAP::ValueArg<uint32_t> durationArg("J", "duration", "Duration in seconds", false, 0,
 											  "unsigned integer", cmd);
 		// Kernel build flags:
@@ -742,6 +780,10 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 		cmd.parse(argc, argv);
 
 		initParams->transferExifTags = transferExifTagsArg.isSet();
+		if(batchThreadsArg.isSet())
+			initParams->batchThreads = batchThreadsArg.getValue();
+		if(batchMemoryArg.isSet())
+			initParams->batchMaxBytesInFlight = batchMemoryArg.getValue() * 1024 * 1024;
 		if(logfileArg.isSet())
 		{
 			auto file_logger = spdlog::basic_logger_mt("grk_compress", logfileArg.getValue());
@@ -781,8 +823,18 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 					(GRK_RATE_CONTROL_ALGORITHM)rateControlAlgoArg.getValue();
 		}
 
+		if(passTruncationMarginArg.isSet())
+		{
+			double margin = passTruncationMarginArg.getValue();
+			if(margin != 0 && margin < 1.0)
+				spdlog::warn("Pass truncation margin {} is less than 1. Ignoring", margin);
+			else
+				parameters->passTruncationMargin = margin;
+		}
 		if(numThreadsArg.isSet())
 			parameters->numThreads = numThreadsArg.getValue();
+		if(memoryFlagsArg.isSet())
+			parameters->memoryFlags = memoryFlagsArg.getValue();
 
 		if(deviceIdArg.isSet())
 			parameters->deviceId = deviceIdArg.getValue();
@@ -2222,29 +2274,30 @@ cleanup:
 
 // returns 0 if failed, 1 if succeeded,
 // and 2 if file is not suitable for compression
-int GrkCompress::compress(const std::string& inputFile, CompressInitParams* initParams)
+int GrkCompress::compress(const std::string& inputFile, CompressInitParams* initParams,
+						  grk_cparameters* parameters)
 {
 	// clear for next file compress
-	initParams->parameters.write_capture_resolution_from_file = false;
+	parameters->write_capture_resolution_from_file = false;
 	// don't reset format if reading from STDIN
-	if(initParams->parameters.infile[0])
-		initParams->parameters.decod_format = GRK_FMT_UNK;
+	if(parameters->infile[0])
+		parameters->decod_format = GRK_FMT_UNK;
 	if(initParams->inputFolder.set_imgdir)
 	{
 		if(nextFile(inputFile, &initParams->inputFolder,
 					initParams->outFolder.set_imgdir ? &initParams->outFolder
 													 : &initParams->inputFolder,
-					&initParams->parameters))
+					parameters))
 		{
 			return 2;
 		}
 	}
 	grk_plugin_compress_user_callback_info callbackInfo;
 	memset(&callbackInfo, 0, sizeof(grk_plugin_compress_user_callback_info));
-	callbackInfo.compressor_parameters = &initParams->parameters;
+	callbackInfo.compressor_parameters = parameters;
 	callbackInfo.image = nullptr;
-	callbackInfo.output_file_name = initParams->parameters.outfile;
-	callbackInfo.input_file_name = initParams->parameters.infile;
+	callbackInfo.output_file_name = parameters->outfile;
+	callbackInfo.input_file_name = parameters->infile;
 	callbackInfo.transferExifTags = initParams->transferExifTags;
 
 	return pluginCompressCallback(&callbackInfo) ? 1 : 0;
@@ -31,6 +31,10 @@ struct CompressInitParams
 	grk_img_fol inputFolder;
 	grk_img_fol outFolder;
 	bool transferExifTags;
+	// number of files compressed concurrently in batch mode
+	uint32_t batchThreads;
+	// maximum total size of input files in flight in batch mode
+	uint64_t batchMaxBytesInFlight;
 };
 
 class GrkCompress
@@ -43,7 +47,8 @@ class GrkCompress
   private:
 	int pluginMain(int argc, char** argv, CompressInitParams* initParams);
 	int parseCommandLine(int argc, char** argv, CompressInitParams* initParams);
-	int compress(const std::string& inputFile, CompressInitParams* initParams);
+	int compress(const std::string& inputFile, CompressInitParams* initParams,
+				 grk_cparameters* parameters);
 };
 
 } // namespace grk
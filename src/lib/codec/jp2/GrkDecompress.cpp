@@ -60,6 +60,7 @@
 #include "spdlog/sinks/basic_file_sink.h"
 #include "exif.h"
 #include "GrkDecompress.h"
+#include "BatchScheduler.h"
 
 namespace grk
 {
@@ -117,6 +118,12 @@ static void decompress_help_display(void)
 					"\n"
 					"  [-y | -in_dir] <directory> \n"
 					"   Compressed image file directory\n"
+					"  [-j | -batch_threads] <number of files>\n"
+					"   Number of files in [in_dir] that are decompressed concurrently.\n"
+					"   A value of 0 selects the number of hardware threads. Default: 1\n"
+					"  [-B | -batch_memory] <MB>\n"
+					"   Maximum total size of input files in flight, when decompressing\n"
+					"   files concurrently. Default: 1024\n"
 					"  [-O | -out_fmt] <PBM|PGM|PPM|PNM|PAM|PGX|PNG|BMP|TIF|RAW|RAWL>\n"
 					"    REQUIRED only if [in_dir] option is used\n"
 					"   Output format for decompressed images.\n");
@@ -139,6 +146,11 @@ static void decompress_help_display(void)
 					"    Path to T1 plugin.\n");
 	fprintf(stdout, "  [-H | -num_threads] <number of threads>\n"
 					"    Number of threads used by libgrokj2k library.\n");
+	fprintf(stdout, "  [-memory_flags] <memory flags>\n"
+					"    Or'd combination of memory allocation flags for large buffers:\n"
+					"    1 - back with transparent huge pages (Linux only)\n"
+					"    2 - clear from worker threads, for NUMA first-touch placement\n"
+					"    Default: 0\n");
 	fprintf(stdout,
 			"  [-c|-compression] <compression method>\n"
 			"   Compress output image data. Currently, this option is only applicable when\n"
@@ -178,6 +190,8 @@ static void decompress_help_display(void)
 					"    Force output image colorspace to RGB\n"
 					"  [-u | -upsample]\n"
 					"    components will be upsampled to image size\n"
+					"  [-U | -upsample_filter] <nearest|bilinear>\n"
+					"    filter used to upsample components (default nearest). Implies -u\n"
 					"  [-s | -split_pnm]\n"
 					"    Split output components to different files when writing to PNM\n");
 	fprintf(
@@ -406,6 +420,9 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 
 		TCLAP::ValueArg<std::string> outDirArg("a", "out_dir", "Output Directory", false, "",
 											   "string", cmd);
+		TCLAP::ValueArg<uint64_t> batchMemoryArg(
+			"B", "batch_memory", "Maximum MB of input files in flight in batch mode", false, 0,
+			"unsigned integer", cmd);
 		TCLAP::ValueArg<std::string> compressionArg("c", "compression", "compression Type", false,
 													"", "string", cmd);
 		TCLAP::ValueArg<std::string> decodeRegionArg("d", "region", "Decompress Region", false, "",
@@ -421,8 +438,13 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 											 cmd);
 		TCLAP::ValueArg<uint32_t> numThreadsArg("H", "num_threads", "Number of threads", false, 0,
 												"unsigned integer", cmd);
+		TCLAP::ValueArg<uint32_t> memoryFlagsArg("", "memory_flags", "Memory allocation flags",
+												 false, 0, "unsigned integer", cmd);
 		TCLAP::ValueArg<std::string> inputFileArg("i", "in_file", "Input file", false, "", "string",
 												  cmd);
+		TCLAP::ValueArg<uint32_t> batchThreadsArg("j", "batch_threads",
+												  "Number of files decompressed concurrently",
+												  false, 1, "unsigned integer", cmd);
 		TCLAP::ValueArg<uint16_t> layerArg("l", "layer", "layer", false, 0, "unsigned integer",
 										   cmd);
 		TCLAP::ValueArg<uint32_t> randomAccessArg("m", "random_access",
@@ -448,6 +470,8 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 		TCLAP::ValueArg<uint32_t> tileArg("t", "tile_info", "Input tile index", false, 0,
 										  "unsigned integer", cmd);
 		TCLAP::SwitchArg upsampleArg("u", "upsample", "Upsample", cmd);
+		TCLAP::ValueArg<std::string> upsampleFilterArg("U", "upsample_filter", "Upsample filter",
+													   false, "", "string", cmd);
 		TCLAP::SwitchArg verboseArg("v", "verbose", "Verbose", cmd);
 		TCLAP::SwitchArg transferExifTagsArg("V", "transfer_exif_tags", "Transfer Exif tags", cmd);
 		TCLAP::ValueArg<std::string> logfileArg("W", "logfile", "Log file", false, "", "string",
@@ -461,6 +485,10 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 		cmd.parse(argc, argv);
 
 		initParams->transferExifTags = transferExifTagsArg.isSet();
+		if(batchThreadsArg.isSet())
+			initParams->batchThreads = batchThreadsArg.getValue();
+		if(batchMemoryArg.isSet())
+			initParams->batchMaxBytesInFlight = batchMemoryArg.getValue() * 1024 * 1024;
 
 		parameters->verbose_ = verboseArg.isSet();
 		bool useStdio = inputFileArg.isSet() && outForArg.isSet() && !outputFileArg.isSet();
@@ -478,13 +506,21 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 
 		parameters->io_xml = xmlArg.isSet();
 		parameters->force_rgb = forceRgbArg.isSet();
-		if(upsampleArg.isSet())
+		if(upsampleArg.isSet() || upsampleFilterArg.isSet())
 		{
 			if(reduceArg.isSet())
 				spdlog::warn("Cannot upsample when reduce argument set. Ignoring");
 			else
 				parameters->upsample = true;
 		}
+		if(upsampleFilterArg.isSet())
+		{
+			auto filter = upsampleFilterArg.getValue();
+			if(filter == "bilinear")
+				parameters->upsample_filter = GRK_UPSAMPLE_BILINEAR;
+			else if(filter != "nearest")
+				spdlog::warn("Unrecognized upsample filter {}. Using nearest", filter);
+		}
 		parameters->split_pnm = splitPnmArg.isSet();
 		if(compressionArg.isSet())
 		{
@@ -652,6 +688,8 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 			return 1;
 		if(numThreadsArg.isSet())
 			parameters->numThreads = numThreadsArg.getValue();
+		if(memoryFlagsArg.isSet())
+			parameters->memoryFlags = memoryFlagsArg.getValue();
 		if(decodeRegionArg.isSet())
 		{
 			size_t size_optarg = (size_t)strlen(decodeRegionArg.getValue().c_str()) + 1U;
@@ -773,6 +811,7 @@ int GrkDecompress::decompress(const std::string& fileName, DecompressInitParams*
 	info.header_info.decompressFormat = info.cod_format;
 	info.header_info.forceRGB = info.decompressor_parameters->force_rgb;
 	info.header_info.upsample = info.decompressor_parameters->upsample;
+	info.header_info.upsampleFilter = info.decompressor_parameters->upsample_filter;
 	info.header_info.precision = info.decompressor_parameters->precision;
 	info.header_info.numPrecision = info.decompressor_parameters->numPrecision;
 	info.header_info.splitByComponent = info.decompressor_parameters->split_pnm;
@@ -796,6 +835,25 @@ int GrkDecompress::decompress(const std::string& fileName, DecompressInitParams*
 	return 1;
 }
 
+int GrkDecompress::decompressBatchFile(const std::string& fileName,
+									   DecompressInitParams* initParams)
+{
+	// each file has its own decompressor and parameters,
+	// so that files can be decompressed concurrently
+	DecompressInitParams fileParams;
+	fileParams.initialized = initParams->initialized;
+	fileParams.parameters = initParams->parameters;
+	fileParams.inputFolder = initParams->inputFolder;
+	fileParams.outFolder = initParams->outFolder;
+	fileParams.transferExifTags = initParams->transferExifTags;
+	if(initParams->inputFolder.imgdirpath)
+		fileParams.inputFolder.imgdirpath = strdup(initParams->inputFolder.imgdirpath);
+	if(initParams->outFolder.imgdirpath)
+		fileParams.outFolder.imgdirpath = strdup(initParams->outFolder.imgdirpath);
+	GrkDecompress decompressor;
+
+	return decompressor.decompress(fileName, &fileParams);
+}
 int GrkDecompress::pluginMain(int argc, char** argv, DecompressInitParams* initParams)
 {
 	grk_dircnt* dirptr = nullptr;
@@ -813,6 +871,7 @@ int GrkDecompress::pluginMain(int argc, char** argv, DecompressInitParams* initP
 	pngSetVerboseFlag(initParams->parameters.verbose_);
 #endif
 	initParams->initialized = true;
+	grk_set_memory_flags(initParams->parameters.memoryFlags);
 	// loads plugin but does not actually create codec
 	if(!grk_initialize(initParams->pluginPath, initParams->parameters.numThreads))
 	{
@@ -1316,6 +1375,9 @@ int GrkDecompress::main(int argc, char** argv)
 			rc = EXIT_SUCCESS;
 			goto cleanup;
 		}
+		// Exif transfer is not thread safe
+		BatchScheduler batch(initParams.transferExifTags ? 1 : initParams.batchThreads,
+							 initParams.batchMaxBytesInFlight);
 		auto start = std::chrono::high_resolution_clock::now();
 		for(uint32_t i = 0; i < initParams.parameters.repeats; ++i)
 		{
@@ -1334,15 +1396,16 @@ int GrkDecompress::main(int argc, char** argv)
 			}
 			else
 			{
-				for(const auto& entry :
-					std::filesystem::directory_iterator(initParams.inputFolder.imgdirpath))
-				{
-					if(decompress(entry.path().filename().string(), &initParams) == 1)
-						numDecompressed++;
-				}
+				numDecompressed += batch.run(
+					initParams.inputFolder.imgdirpath,
+					[&initParams](const std::string& fileName) {
+						return decompressBatchFile(fileName, &initParams);
+					});
 			}
 		}
 		printTiming(numDecompressed, std::chrono::high_resolution_clock::now() - start);
+		if(initParams.inputFolder.set_imgdir)
+			batch.printThroughput("decompressed");
 	}
 	catch([[maybe_unused]] std::bad_alloc& ba)
 	{
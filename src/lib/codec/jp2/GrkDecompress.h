@@ -23,7 +23,8 @@ namespace grk
 {
 struct DecompressInitParams
 {
-	DecompressInitParams() : initialized(false), transferExifTags(false)
+	DecompressInitParams()
+		: initialized(false), transferExifTags(false), batchThreads(1), batchMaxBytesInFlight(0)
 	{
 		pluginPath[0] = 0;
 		memset(&inputFolder, 0, sizeof(inputFolder));
@@ -41,6 +42,10 @@ struct DecompressInitParams
 	grk_img_fol inputFolder;
 	grk_img_fol outFolder;
 	bool transferExifTags;
+	// number of files decompressed concurrently in batch mode
+	uint32_t batchThreads;
+	// maximum total size of input files in flight in batch mode
+	uint64_t batchMaxBytesInFlight;
 };
 
 class GrkDecompress
@@ -57,6 +62,7 @@ class GrkDecompress
 	bool encodeInit(grk_plugin_decompress_callback_info* info);
 	// returns 0 for failure, 1 for success, and 2 if file is not suitable for decoding
 	int decompress(const std::string& fileName, DecompressInitParams* initParams);
+	static int decompressBatchFile(const std::string& fileName, DecompressInitParams* initParams);
 	int pluginMain(int argc, char** argv, DecompressInitParams* initParams);
 	bool parsePrecision(const char* option, grk_decompress_parameters* parameters);
 	int loadImages(grk_dircnt* dirptr, char* imgdirpath);
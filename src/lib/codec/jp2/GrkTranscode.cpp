@@ -0,0 +1,274 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include "grk_config.h"
+#include "common.h"
+#define TCLAP_NAMESTARTSTRING "-"
+#include "tclap/CmdLine.h"
+#include "grk_string.h"
+#include "GrkTranscode.h"
+
+namespace grk
+{
+
+struct TranscodeInitParams
+{
+	TranscodeInitParams() : numThreads(0), verbose(false)
+	{
+		infile[0] = 0;
+		outfile[0] = 0;
+		grk_transcode_set_default_params(&parameters);
+	}
+	char infile[GRK_PATH_LEN];
+	char outfile[GRK_PATH_LEN];
+	uint32_t numThreads;
+	bool verbose;
+	grk_transcode_parameters parameters;
+};
+
+static void transcode_help_display(void)
+{
+	fprintf(stdout,
+			"\nThis is the grk_transcode utility from the Grok project.\n"
+			"It re-packetizes a JPEG 2000 code stream without decompressing it:\n"
+			"resolutions and quality layers can be discarded, and progression order,\n"
+			"tile parts and PLT/TLM markers can be changed.\n"
+			"Optionally, Part 1 code blocks can be re-encoded with the HT block coder.\n"
+			"It has been compiled against Grok library v%s.\n\n",
+			grk_version());
+
+	fprintf(stdout, "Parameters:\n");
+	fprintf(stdout, "-----------\n");
+	fprintf(stdout, "\n");
+	fprintf(stdout, "  -i <compressed file>\n");
+	fprintf(stdout, "    REQUIRED\n");
+	fprintf(stdout, "    Currently accepts J2K-files and JP2-files. The file type\n");
+	fprintf(stdout, "    is identified based on its suffix.\n");
+	fprintf(stdout, "  -o <compressed file>\n");
+	fprintf(stdout, "    REQUIRED\n");
+	fprintf(stdout, "    Output file: JP2 if its suffix is .jp2, otherwise J2K.\n");
+	fprintf(stdout, "  -r <reduce factor>\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Number of highest resolution levels to discard.\n");
+	fprintf(stdout, "    For multiple tile images, tile dimensions must be divisible\n");
+	fprintf(stdout, "    by 2^(reduce factor).\n");
+	fprintf(stdout, "  -l <number of quality layers>\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Maximum number of quality layers to keep.\n");
+	fprintf(stdout, "    By default all layers are kept.\n");
+	fprintf(stdout, "  -p <LRCP|RLCP|RPCL|PCRL|CPRL>\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Progression order. By default source progression order is kept.\n");
+	fprintf(stdout, "  -u <R|L|C>\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Divide packets of every tile into tile-parts.\n");
+	fprintf(stdout, "    Division is made by grouping Resolutions (R), Layers (L)\n");
+	fprintf(stdout, "    or Components (C).\n");
+	fprintf(stdout, "  -L\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Write PLT markers in tile-part header\n");
+	fprintf(stdout, "  -X\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Write TLM marker in main header\n");
+	fprintf(stdout, "  -J\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Re-encode Part 1 code blocks with High Throughput (HTJ2K) block coder.\n");
+	fprintf(stdout, "    Quantization indices are preserved, so reversible sources remain\n");
+	fprintf(stdout, "    lossless. All kept quality layers are merged into a single layer.\n");
+	fprintf(stdout, "  -H <number of threads>\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Number of threads used for parsing source packets\n");
+	fprintf(stdout, "    and re-encoding code blocks.\n");
+	fprintf(stdout, "    By default all available hardware threads are used.\n");
+	fprintf(stdout, "  -v\n");
+	fprintf(stdout, "    OPTIONAL\n");
+	fprintf(stdout, "    Enable informative messages\n");
+	fprintf(stdout, "    By default verbose mode is off.\n");
+	fprintf(stdout, "\n");
+}
+
+class GrokOutput : public TCLAP::StdOutput
+{
+  public:
+	virtual void usage([[maybe_unused]] TCLAP::CmdLineInterface& c)
+	{
+		transcode_help_display();
+	}
+};
+
+static GRK_PROG_ORDER getProgression(const char* progression)
+{
+	if(strncmp(progression, "LRCP", 4) == 0)
+		return GRK_LRCP;
+	if(strncmp(progression, "RLCP", 4) == 0)
+		return GRK_RLCP;
+	if(strncmp(progression, "RPCL", 4) == 0)
+		return GRK_RPCL;
+	if(strncmp(progression, "PCRL", 4) == 0)
+		return GRK_PCRL;
+	if(strncmp(progression, "CPRL", 4) == 0)
+		return GRK_CPRL;
+
+	return GRK_PROG_UNKNOWN;
+}
+
+static int parseCommandLine(int argc, char** argv, TranscodeInitParams* initParams)
+{
+	auto parameters = &initParams->parameters;
+	try
+	{
+		TCLAP::CmdLine cmd("grk_transcode command line", ' ', grk_version());
+
+		// set the output
+		GrokOutput output;
+		cmd.setOutput(&output);
+
+		TCLAP::ValueArg<std::string> inputArg("i", "input", "input file", false, "", "string", cmd);
+		TCLAP::ValueArg<std::string> outputArg("o", "output", "output file", false, "", "string",
+											   cmd);
+		TCLAP::ValueArg<uint32_t> reduceArg("r", "reduce", "reduce resolutions", false, 0,
+											"unsigned integer", cmd);
+		TCLAP::ValueArg<uint16_t> layerArg("l", "layer", "layer", false, 0, "unsigned integer",
+										   cmd);
+		TCLAP::ValueArg<std::string> progressionOrderArg(
+			"p", "progression_order", "Progression order", false, "", "string", cmd);
+		TCLAP::ValueArg<uint8_t> tpArg("u", "tile_parts", "Tile part generation", false, 0,
+									   "uint8_t", cmd);
+		TCLAP::SwitchArg pltArg("L", "PLT", "PLT marker", cmd);
+		TCLAP::SwitchArg tlmArg("X", "TLM", "TLM marker", cmd);
+		TCLAP::SwitchArg htArg("J", "HT", "Re-encode with HT block coder", cmd);
+		TCLAP::ValueArg<uint32_t> numThreadsArg("H", "num_threads", "Number of threads", false, 0,
+												"unsigned integer", cmd);
+		TCLAP::SwitchArg verboseArg("v", "verbose", "verbose", cmd);
+
+		cmd.parse(argc, argv);
+
+		if(!inputArg.isSet() || !outputArg.isSet())
+		{
+			spdlog::error("Required parameter is missing");
+			spdlog::error("Example: {} -i image.j2k -o out.j2k", argv[0]);
+			spdlog::error("Help: {} -h", argv[0]);
+			return 1;
+		}
+		GRK_CODEC_FORMAT decod_format;
+		if(!grk_decompress_detect_format(inputArg.getValue().c_str(), &decod_format))
+		{
+			spdlog::error("Unknown input file format: {} \n"
+						  "        Known file formats are *.j2k, *.jp2 or *.jpc",
+						  inputArg.getValue());
+			return 1;
+		}
+		if(grk::strcpy_s(initParams->infile, sizeof(initParams->infile),
+						 inputArg.getValue().c_str()) != 0 ||
+		   grk::strcpy_s(initParams->outfile, sizeof(initParams->outfile),
+						 outputArg.getValue().c_str()) != 0)
+		{
+			spdlog::error("Path is too long");
+			return 1;
+		}
+		switch(grk_get_file_format(initParams->outfile))
+		{
+			case GRK_FMT_J2K:
+				parameters->cod_format = GRK_FMT_J2K;
+				break;
+			case GRK_FMT_JP2:
+				parameters->cod_format = GRK_FMT_JP2;
+				break;
+			default:
+				spdlog::error("Unknown output file format: {} \n"
+							  "        Known file formats are *.j2k, *.jp2 or *.jpc",
+							  initParams->outfile);
+				return 1;
+		}
+		if(reduceArg.isSet())
+		{
+			if(reduceArg.getValue() >= GRK_J2K_MAXRLVLS)
+			{
+				spdlog::error("Reduce factor {} must be less than {}", reduceArg.getValue(),
+							  GRK_J2K_MAXRLVLS);
+				return 1;
+			}
+			parameters->reduce = (uint8_t)reduceArg.getValue();
+		}
+		if(layerArg.isSet())
+			parameters->max_layers = layerArg.getValue();
+		if(progressionOrderArg.isSet())
+		{
+			parameters->prog_order = getProgression(progressionOrderArg.getValue().c_str());
+			if(parameters->prog_order == GRK_PROG_UNKNOWN)
+			{
+				spdlog::error("Unrecognized progression order {} is not in "
+							  "{{LRCP, RLCP, RPCL, PCRL, CPRL}}",
+							  progressionOrderArg.getValue());
+				return 1;
+			}
+		}
+		if(tpArg.isSet())
+		{
+			parameters->newTilePartProgressionDivider = tpArg.getValue();
+			parameters->enableTilePartGeneration = true;
+		}
+		parameters->writePLT = pltArg.isSet();
+		parameters->writeTLM = tlmArg.isSet();
+		parameters->ht = htArg.isSet();
+		if(numThreadsArg.isSet())
+			initParams->numThreads = numThreadsArg.getValue();
+		initParams->verbose = verboseArg.isSet();
+	}
+	catch(TCLAP::ArgException& e) // catch any exceptions
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+int GrkTranscode::main(int argc, char* argv[])
+{
+	TranscodeInitParams initParams;
+	if(parseCommandLine(argc, argv, &initParams) == 1)
+		return EXIT_FAILURE;
+
+	grk_initialize(nullptr, initParams.numThreads);
+	grk_set_msg_handlers(initParams.verbose ? infoCallback : nullptr, nullptr, warningCallback,
+						 nullptr, errorCallback, nullptr);
+
+	grk_stream_params srcStreamParams;
+	memset(&srcStreamParams, 0, sizeof(srcStreamParams));
+	srcStreamParams.file = initParams.infile;
+	grk_stream_params destStreamParams;
+	memset(&destStreamParams, 0, sizeof(destStreamParams));
+	destStreamParams.file = initParams.outfile;
+
+	int rc = EXIT_SUCCESS;
+	if(!grk_transcode(&srcStreamParams, &destStreamParams, &initParams.parameters))
+	{
+		spdlog::error("grk_transcode: failed to transcode {} to {}", initParams.infile,
+					  initParams.outfile);
+		rc = EXIT_FAILURE;
+	}
+	grk_deinitialize();
+
+	return rc;
+}
+
+} // namespace grk
@@ -0,0 +1,50 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+CodeblockStateCache::~CodeblockStateCache()
+{
+	clear();
+}
+ICodeblockState* CodeblockStateCache::get(uint16_t compno, uint8_t resno, uint8_t bandIndex,
+										  uint32_t x, uint32_t y)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto iter = states_.find(CodeblockKey(compno, resno, bandIndex, x, y));
+
+	return iter != states_.end() ? iter->second : nullptr;
+}
+void CodeblockStateCache::put(uint16_t compno, uint8_t resno, uint8_t bandIndex, uint32_t x,
+							  uint32_t y, ICodeblockState* state)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto& entry = states_[CodeblockKey(compno, resno, bandIndex, x, y)];
+	if(entry != state)
+		delete entry;
+	entry = state;
+}
+void CodeblockStateCache::clear(void)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	for(auto& s : states_)
+		delete s.second;
+	states_.clear();
+}
+
+} // namespace grk
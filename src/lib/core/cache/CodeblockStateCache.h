@@ -0,0 +1,57 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace grk
+{
+/**
+ * Decoder state of a code block, kept across decompressions of a tile so that
+ * decompressing additional quality layers can resume where the previous
+ * decompression stopped
+ */
+struct ICodeblockState
+{
+	virtual ~ICodeblockState() = default;
+};
+
+/**
+ * Decoder states of the code blocks of a tile, keyed by component, resolution, band
+ * and code block origin.
+ *
+ * Lookups may be made concurrently; a given state is only ever accessed by the
+ * thread decoding its code block.
+ */
+class CodeblockStateCache
+{
+  public:
+	~CodeblockStateCache();
+	ICodeblockState* get(uint16_t compno, uint8_t resno, uint8_t bandIndex, uint32_t x, uint32_t y);
+	void put(uint16_t compno, uint8_t resno, uint8_t bandIndex, uint32_t x, uint32_t y,
+			 ICodeblockState* state);
+	void clear(void);
+
+  private:
+	typedef std::tuple<uint16_t, uint8_t, uint8_t, uint32_t, uint32_t> CodeblockKey;
+	std::mutex mutex_;
+	std::map<CodeblockKey, ICodeblockState*> states_;
+};
+
+} // namespace grk
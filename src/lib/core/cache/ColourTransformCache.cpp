@@ -0,0 +1,74 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "grk_includes.h"
+#include "lcms2.h"
+
+namespace grk
+{
+// 64 bit FNV-1a
+static uint64_t hashBytes(const uint8_t* bytes, size_t len)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for(size_t i = 0; i < len; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+ColourTransformCache* ColourTransformCache::get(void)
+{
+	static ColourTransformCache singleton;
+
+	return &singleton;
+}
+std::shared_ptr<void> ColourTransformCache::getTransform(const uint8_t* id, size_t len,
+														 uint32_t inType, uint32_t outType,
+														 uint32_t intent,
+														 const std::function<void*(void)>& create)
+{
+	uint64_t hash = hashBytes(id, len);
+	std::lock_guard<std::mutex> lock(mutex_);
+	for(auto it = entries_.begin(); it != entries_.end(); ++it)
+	{
+		if(it->hash == hash && it->inType == inType && it->outType == outType &&
+		   it->intent == intent && it->id.size() == len && !memcmp(it->id.data(), id, len))
+		{
+			entries_.splice(entries_.begin(), entries_, it);
+			return entries_.front().transform;
+		}
+	}
+	auto transform = create();
+	if(!transform)
+		return nullptr;
+	// transforms still in use by a caller outlive their eviction
+	std::shared_ptr<void> rc(transform, [](void* t) { cmsDeleteTransform((cmsHTRANSFORM)t); });
+	entries_.push_front({hash, std::vector<uint8_t>(id, id + len), inType, outType, intent, rc});
+	if(entries_.size() > maxEntries)
+		entries_.pop_back();
+
+	return rc;
+}
+void ColourTransformCache::clear(void)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+}
+
+} // namespace grk
@@ -0,0 +1,73 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace grk
+{
+/**
+ * Process-wide cache of compiled lcms2 colour transforms, so that a batch of
+ * images sharing an ICC profile only builds the transform once.
+ *
+ * Transforms are keyed by the bytes identifying the source colour space
+ * (e.g. the ICC profile) together with the pixel formats and rendering intent.
+ * Cached transforms must be created with cmsFLAGS_NOCACHE, so that
+ * they can be shared by all threads.
+ */
+class ColourTransformCache
+{
+  public:
+	static ColourTransformCache* get(void);
+	/**
+	 * Get transform, creating it if it is not cached
+	 *
+	 * @param id bytes identifying source colour space
+	 * @param len number of id bytes
+	 * @param inType lcms2 input pixel format
+	 * @param outType lcms2 output pixel format
+	 * @param intent rendering intent
+	 * @param create creates lcms2 transform, returning nullptr on failure
+	 * @return lcms2 transform, or nullptr if transform could not be created
+	 */
+	std::shared_ptr<void> getTransform(const uint8_t* id, size_t len, uint32_t inType,
+									   uint32_t outType, uint32_t intent,
+									   const std::function<void*(void)>& create);
+	void clear(void);
+
+  private:
+	struct Entry
+	{
+		uint64_t hash;
+		std::vector<uint8_t> id;
+		uint32_t inType;
+		uint32_t outType;
+		uint32_t intent;
+		std::shared_ptr<void> transform;
+	};
+	static constexpr size_t maxEntries = 16;
+	std::mutex mutex_;
+	// most recently used entries first
+	std::list<Entry> entries_;
+};
+
+} // namespace grk
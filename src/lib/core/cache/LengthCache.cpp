@@ -466,6 +466,46 @@ void TileLengthMarkers::seek(TileSet* tilesToDecompress, CodingParams* cp, Buffe
 	if(skip && !stream->seek(stream->tell() + skip))
 		throw CorruptTLMException();
 }
+/**
+ * Advise stream that tile parts of scheduled tiles will soon be read.
+ * Adjacent tile parts are coalesced into a single range.
+ *
+ * @param tilesToDecompress scheduled tiles
+ * @param firstSotPosition stream position of first SOT marker
+ * @param stream stream to advise
+ */
+void TileLengthMarkers::prefetch(TileSet* tilesToDecompress, uint64_t firstSotPosition,
+								 BufferedStream* stream)
+{
+	assert(stream);
+	if(!markers_ || !valid_)
+		return;
+	uint64_t position = firstSotPosition;
+	uint64_t rangeStart = 0;
+	uint64_t rangeLength = 0;
+	for(auto& m : *markers_)
+	{
+		for(auto& tilePart : *m.second)
+		{
+			if(tilePart.tileIndex_ < numSignalledTiles_ &&
+			   tilesToDecompress->isScheduled(tilePart.tileIndex_))
+			{
+				if(rangeLength && rangeStart + rangeLength == position)
+				{
+					rangeLength += tilePart.length_;
+				}
+				else
+				{
+					stream->advise(rangeStart, rangeLength, GRK_STREAM_ADVICE_WILLNEED);
+					rangeStart = position;
+					rangeLength = tilePart.length_;
+				}
+			}
+			position += tilePart.length_;
+		}
+	}
+	stream->advise(rangeStart, rangeLength, GRK_STREAM_ADVICE_WILLNEED);
+}
 
 bool TileLengthMarkers::writeBegin(uint16_t numTilePartsTotal)
 {
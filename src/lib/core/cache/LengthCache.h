@@ -116,6 +116,7 @@ struct TileLengthMarkers
 	void invalidate(void);
 	bool valid(void);
 	void seek(TileSet* tilesToDecompress, CodingParams* cp, BufferedStream* stream);
+	void prefetch(TileSet* tilesToDecompress, uint64_t firstSotPosition, BufferedStream* stream);
 	bool writeBegin(uint16_t numTilePartsTotal);
 	void push(uint16_t tileIndex, uint32_t tile_part_size);
 	bool writeEnd(void);
@@ -23,6 +23,8 @@
 
 #ifdef _WIN32
 #include <malloc.h>
+#else
+#include <sys/mman.h>
 #endif
 
 #ifndef SIZE_MAX
@@ -32,6 +34,20 @@
 namespace grk
 {
 const size_t grk_buffer_alignment = 64;
+// transparent huge page size (x86-64 and aarch64 with 4K base pages)
+const size_t grk_huge_page_size = 2 * 1024 * 1024;
+// smallest buffer that is cleared by the worker pool when first-touch placement is enabled
+const size_t grk_first_touch_min_size = 8 * grk_huge_page_size;
+static std::atomic<uint32_t> grk_memory_flags(0);
+
+void grk_set_memory_flags(uint32_t flags)
+{
+	grk_memory_flags = flags;
+}
+uint32_t grk_get_memory_flags(void)
+{
+	return grk_memory_flags;
+}
 uint32_t grk_make_aligned_width(uint32_t width)
 {
 	assert(width);
@@ -75,8 +91,49 @@ void* grk_calloc(size_t num, size_t size)
 }
 void* grk_aligned_malloc(size_t size)
 {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	if((grk_memory_flags & GRK_MEMORY_HUGE_PAGES) && size >= grk_huge_page_size)
+	{
+		// align to huge page boundary so that the whole block can be backed by huge pages
+		auto ptr = grk_aligned_alloc_N(grk_huge_page_size, size);
+		if(ptr)
+		{
+			size = ((size + grk_huge_page_size - 1) / grk_huge_page_size) * grk_huge_page_size;
+			madvise(ptr, size, MADV_HUGEPAGE);
+		}
+		return ptr;
+	}
+#endif
 	return grk_aligned_alloc_N(grk_buffer_alignment, size);
 }
+void grk_clear(void* ptr, size_t size)
+{
+	if(!(grk_memory_flags & GRK_MEMORY_FIRST_TOUCH) || size < grk_first_touch_min_size)
+	{
+		memset(ptr, 0, size);
+		return;
+	}
+	auto executor = ExecSingleton::get();
+	size_t numWorkers = executor->num_workers();
+	// clearing from inside the pool would block a worker on its own pool
+	if(numWorkers < 2 || executor->this_worker_id() >= 0)
+	{
+		memset(ptr, 0, size);
+		return;
+	}
+	// each worker clears one contiguous band of whole huge pages, so that
+	// the first touch of each page happens on a pool thread
+	size_t band = (size + numWorkers - 1) / numWorkers;
+	band = ((band + grk_huge_page_size - 1) / grk_huge_page_size) * grk_huge_page_size;
+	tf::Taskflow taskflow;
+	for(size_t offset = 0; offset < size; offset += band)
+	{
+		auto dest = (uint8_t*)ptr + offset;
+		auto len = std::min<size_t>(band, size - offset);
+		taskflow.emplace([dest, len] { memset(dest, 0, len); });
+	}
+	executor->run(taskflow).wait();
+}
 void grk_aligned_free(void* ptr)
 {
 #ifdef _WIN32
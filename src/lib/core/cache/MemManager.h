@@ -29,6 +29,16 @@
 namespace grk
 {
 uint32_t grk_make_aligned_width(uint32_t width);
+/**
+ Set memory allocation flags
+ @param flags or'd combination of GRK_MEMORY_* flags
+ */
+void grk_set_memory_flags(uint32_t flags);
+/**
+ Get memory allocation flags
+ @return or'd combination of GRK_MEMORY_* flags
+ */
+uint32_t grk_get_memory_flags(void);
 /**
  Allocate an uninitialized memory block
  @param size Bytes to allocate
@@ -49,6 +59,14 @@ void* grk_calloc(size_t numOfElements, size_t sizeOfElements);
  */
 void* grk_aligned_malloc(size_t size);
 void grk_aligned_free(void* ptr);
+/**
+ Zero a memory block. With GRK_MEMORY_FIRST_TOUCH set, large blocks are
+ cleared in bands by the worker pool, so that their pages are placed
+ on the NUMA nodes of the workers rather than on the node of the caller.
+ @param ptr  memory block
+ @param size Bytes to clear
+ */
+void grk_clear(void* ptr, size_t size);
 /**
  Reallocate memory blocks.
  @param m Pointer to previously allocated memory block
@@ -22,8 +22,8 @@ const uint16_t plWriteBufferLen = USHRT_MAX - 4;
 
 PLMarkerMgr::PLMarkerMgr()
 	: rawMarkers_(new PL_MARKERS()), currMarkerIter_(rawMarkers_->end()), totalBytesWritten_(0),
-	  isFinal_(false), stream_(nullptr), sequential_(false), packetLen_(0), currMarkerBufIndex_(0),
-	  currMarkerBuf_(nullptr), enabled_(true)
+	  simulatedMarkerOffset_(0), isFinal_(false), stream_(nullptr), sequential_(false),
+	  packetLen_(0), currMarkerBufIndex_(0), currMarkerBuf_(nullptr), enabled_(true)
 {}
 // compression
 PLMarkerMgr::PLMarkerMgr(BufferedStream* strm) : PLMarkerMgr()
@@ -60,6 +60,7 @@ void PLMarkerMgr::pushInit(bool isFinal)
 {
 	clearMarkers();
 	totalBytesWritten_ = 0;
+	simulatedMarkerOffset_ = 0;
 	isFinal_ = isFinal;
 }
 bool PLMarkerMgr::pushPL(uint32_t len)
@@ -82,7 +83,9 @@ bool PLMarkerMgr::pushPL(uint32_t len)
 			return false;
 		marker = currMarkerIter_->second;
 	}
-	else if(marker->back()->offset + numBytes > marker->back()->len)
+	// no buffers are allocated when simulating, so only the current marker's offset is tracked
+	else if((isFinal_ ? marker->back()->offset : simulatedMarkerOffset_) + numBytes >
+			plWriteBufferLen)
 	{
 		newMarker = true;
 		newMarkerId = rawMarkers_->size() & 0xFF;
@@ -104,6 +107,7 @@ bool PLMarkerMgr::pushPL(uint32_t len)
 		}
 		// account for marker header
 		totalBytesWritten_ += 2 + 2 + 1;
+		simulatedMarkerOffset_ = 1;
 	}
 	assert(buf);
 	if(isFinal_)
@@ -128,6 +132,7 @@ bool PLMarkerMgr::pushPL(uint32_t len)
 			return false;
 	}
 	totalBytesWritten_ += numBytes;
+	simulatedMarkerOffset_ += numBytes;
 
 	return true;
 }
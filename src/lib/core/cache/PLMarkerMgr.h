@@ -61,6 +61,8 @@ struct PLMarkerMgr
 	////////////////////////////////
 	// compress
 	uint32_t totalBytesWritten_;
+	// offset into current marker, when simulating
+	uint32_t simulatedMarkerOffset_;
 	bool isFinal_;
 	BufferedStream* stream_;
 	////////////////////////////////
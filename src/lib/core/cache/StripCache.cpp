@@ -21,7 +21,7 @@ Strip::Strip(GrkImage* outputImage, uint16_t index, uint32_t nominalHeight, uint
 	stripImg->y0 = outputImage->y0 + index * nominalHeight;
 	stripImg->y1 = std::min<uint32_t>(outputImage->y1, stripImg->y0 + nominalHeight);
 	stripImg->comps->y0 = reduceDim(stripImg->y0);
-	stripImg->comps->h = reduceDim(stripImg->y1 - stripImg->y0);
+	stripImg->comps->h = reduceDim(stripImg->y1) - stripImg->comps->y0;
 }
 Strip::~Strip(void)
 {
@@ -50,7 +50,7 @@ bool Strip::allocInterleaved(uint64_t len, BufPool* pool)
 	return stripImg->interleavedData.data_;
 }
 StripCache::StripCache()
-	: strips(nullptr), numTiles_(0), numStrips_(0), nominalStripHeight_(0), imageY0_(0),
+	: strips(nullptr), numTiles_(0), numStrips_(0), nominalStripHeight_(0), reduce_(0), imageY0_(0),
 	  packedRowBytes_(0), ioUserData_(nullptr), ioBufferCallback_(nullptr), initialized_(false),
 	  multiTile_(true)
 {}
@@ -92,6 +92,7 @@ void StripCache::init(uint32_t concurrency, uint16_t numTiles, uint32_t numStrip
 	numStrips_ = numStrips;
 	imageY0_ = outputImage->y0;
 	nominalStripHeight_ = nominalStripHeight;
+	reduce_ = reduce;
 	packedRowBytes_ = outputImage->packedRowBytes;
 	strips = new Strip*[numStrips];
 	for(uint16_t i = 0; i < numStrips_; ++i)
@@ -105,7 +106,10 @@ bool StripCache::ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint
 	if(!initialized_)
 		return false;
 
-	uint16_t stripId = (uint16_t)((yBegin + nominalStripHeight_ - 1) / nominalStripHeight_);
+	// yBegin is relative to the reduced tile, while the nominal strip height
+	// is expressed in canvas coordinates
+	uint32_t reducedStripHeight = nominalStripHeight_ >> reduce_;
+	uint16_t stripId = (uint16_t)((yBegin + reducedStripHeight - 1) / reducedStripHeight);
 	assert(stripId < numStrips_);
 	auto strip = strips[stripId];
 	auto dest = strip->stripImg;
@@ -170,23 +174,24 @@ bool StripCache::serialize(uint32_t threadId, GrkIOBuf buf)
 		return ioBufferCallback_(threadId, buf, ioUserData_);
 
 	std::queue<GrkIOBuf> buffersToSerialize;
+	std::unique_lock<std::mutex> heapLock(heapMutex_);
+	// 1. push to heap
+	serializeHeap.push(buf);
+	// 2. get all sequential buffers in heap
+	buf = serializeHeap.pop();
+	while(buf.data_)
 	{
-		std::unique_lock<std::mutex> lk(heapMutex_);
-		// 1. push to heap
-		serializeHeap.push(buf);
-		// 2. get all sequential buffers in heap
+		buffersToSerialize.push(buf);
 		buf = serializeHeap.pop();
-		while(buf.data_)
-		{
-			buffersToSerialize.push(buf);
-			buf = serializeHeap.pop();
-		}
 	}
 	// 3. serialize buffers
 	if(!buffersToSerialize.empty())
 	{
 		{
+			// acquire serialize lock before releasing heap lock, so that buffers
+			// popped by another thread cannot be serialized ahead of these buffers
 			std::unique_lock<std::mutex> lk(serializeMutex_);
+			heapLock.unlock();
 			while(!buffersToSerialize.empty())
 			{
 				auto b = buffersToSerialize.front();
@@ -130,6 +130,7 @@ class StripCache
 	uint16_t numTiles_;
 	uint32_t numStrips_;
 	uint32_t nominalStripHeight_;
+	uint8_t reduce_;
 	uint32_t imageY0_;
 	uint64_t packedRowBytes_;
 	void* ioUserData_;
@@ -24,7 +24,7 @@ namespace grk
 {
 CodeStream::CodeStream(BufferedStream* stream)
 	: codeStreamInfo(nullptr), headerImage_(nullptr), currentTileProcessor_(nullptr),
-	  stream_(stream), current_plugin_tile(nullptr)
+	  stream_(stream), current_plugin_tile(nullptr), transcoder_(nullptr)
 {}
 CodeStream::~CodeStream()
 {
@@ -56,6 +56,14 @@ grk_plugin_tile* CodeStream::getCurrentPluginTile()
 {
 	return current_plugin_tile;
 }
+Transcoder* CodeStream::getTranscoder(void)
+{
+	return transcoder_;
+}
+void CodeStream::setTranscoder(Transcoder* transcoder)
+{
+	transcoder_ = transcoder;
+}
 BufferedStream* CodeStream::getStream()
 {
 	return stream_;
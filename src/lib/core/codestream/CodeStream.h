@@ -85,6 +85,7 @@ const uint8_t MARKER_LENGTH_BYTES = 2;
 const uint8_t MARKER_PLUS_MARKER_LENGTH_BYTES = MARKER_BYTES + MARKER_LENGTH_BYTES;
 
 class GrkImage;
+class CodeStream;
 
 template<typename S, typename D>
 void j2k_write(const void* p_src_data, void* p_dest_data, uint64_t nb_elem)
@@ -109,6 +110,7 @@ struct ICodeStreamCompress
 	virtual bool init(grk_cparameters* p_param, GrkImage* p_image) = 0;
 	virtual bool start(void) = 0;
 	virtual bool compress(grk_plugin_tile* tile) = 0;
+	virtual CodeStream* getCodeStream(void) = 0;
 };
 
 struct ICodeStreamDecompress
@@ -122,12 +124,15 @@ struct ICodeStreamDecompress
 	virtual bool setDecompressRegion(grk_rect_single region) = 0;
 	virtual bool decompress(grk_plugin_tile* tile) = 0;
 	virtual bool decompressTile(uint16_t tileIndex) = 0;
+	virtual bool decompressRefine(uint16_t maxLayers) = 0;
 	virtual bool preProcess(void) = 0;
 	virtual bool postProcess(void) = 0;
 	virtual void dump(uint32_t flag, FILE* outputFileStream) = 0;
+	virtual CodeStream* getCodeStream(void) = 0;
 };
 
 class TileCache;
+class Transcoder;
 
 class CodeStream
 {
@@ -140,6 +145,8 @@ class CodeStream
 	GrkImage* getHeaderImage(void);
 	grk_plugin_tile* getCurrentPluginTile();
 	CodingParams* getCodingParams(void);
+	Transcoder* getTranscoder(void);
+	void setTranscoder(Transcoder* transcoder);
 	static std::string markerString(uint16_t marker);
 
   protected:
@@ -155,6 +162,8 @@ class CodeStream
 	BufferedStream* stream_;
 	std::map<uint32_t, TileProcessor*> processors_;
 	grk_plugin_tile* current_plugin_tile;
+	// set while code block data is transcoded instead of decompressed/compressed
+	Transcoder* transcoder_;
 };
 
 /** @name Exported functions */
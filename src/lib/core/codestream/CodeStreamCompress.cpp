@@ -307,6 +307,7 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 	cp_.coding_params_.enc_.writePLT = parameters->writePLT;
 	cp_.coding_params_.enc_.writeTLM = parameters->writeTLM;
 	cp_.coding_params_.enc_.rateControlAlgorithm = parameters->rateControlAlgorithm;
+	cp_.coding_params_.enc_.passTruncationMargin = parameters->passTruncationMargin;
 
 	/* tiles */
 	cp_.t_width = parameters->t_width;
@@ -618,6 +619,10 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 
 	return true;
 }
+CodeStream* CodeStreamCompress::getCodeStream(void)
+{
+	return this;
+}
 bool CodeStreamCompress::compress(grk_plugin_tile* tile)
 {
 	MinHeapPtr<TileProcessor, uint16_t, MinHeapLocker> heap;
@@ -645,7 +650,8 @@ bool CodeStreamCompress::compress(grk_plugin_tile* tile)
 			node[j].work([this, tile, tileIndex, &heap, &success] {
 				if(success)
 				{
-					auto tileProcessor = new TileProcessor(tileIndex, this, stream_, true, nullptr);
+					auto tileProcessor =
+						new TileProcessor(tileIndex, this, stream_, true, nullptr, nullptr);
 					tileProcessor->current_plugin_tile = tile;
 					if(!tileProcessor->preCompressTile() || !tileProcessor->doCompress())
 						success = false;
@@ -660,7 +666,7 @@ bool CodeStreamCompress::compress(grk_plugin_tile* tile)
 	{
 		for(uint16_t i = 0; i < numTiles; ++i)
 		{
-			auto tileProcessor = new TileProcessor(i, this, stream_, true, nullptr);
+			auto tileProcessor = new TileProcessor(i, this, stream_, true, nullptr, nullptr);
 			tileProcessor->current_plugin_tile = tile;
 			if(!tileProcessor->preCompressTile() || !tileProcessor->doCompress())
 			{
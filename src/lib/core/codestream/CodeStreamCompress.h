@@ -37,6 +37,7 @@ class CodeStreamCompress : public CodeStream, public ICodeStreamCompress
 	bool start(void);
 	bool init(grk_cparameters* p_param, GrkImage* p_image);
 	bool compress(grk_plugin_tile* tile);
+	CodeStream* getCodeStream(void);
 
   private:
 	bool init_header_writing(void);
@@ -26,8 +26,8 @@ namespace grk
 CodeStreamDecompress::CodeStreamDecompress(BufferedStream* stream)
 	: CodeStream(stream), expectSOD_(false), curr_marker_(0), headerError_(false),
 	  headerRead_(false), marker_scratch_(nullptr), marker_scratch_size_(0), outputImage_(nullptr),
-	  tileCache_(new TileCache()), ioBufferCallback(nullptr), ioUserData(nullptr),
-	  grkRegisterReclaimCallback_(nullptr)
+	  compositeHeader_(nullptr), tileCache_(new TileCache()), ioBufferCallback(nullptr),
+	  ioUserData(nullptr), grkRegisterReclaimCallback_(nullptr)
 {
 	decompressorState_.default_tcp_ = new TileCodingParams();
 	decompressorState_.lastSotReadPosition = 0;
@@ -106,6 +106,8 @@ CodeStreamDecompress::~CodeStreamDecompress()
 	delete[] marker_scratch_;
 	if(outputImage_)
 		grk_object_unref(&outputImage_->obj);
+	if(compositeHeader_)
+		grk_object_unref(&compositeHeader_->obj);
 	delete tileCache_;
 }
 bool CodeStreamDecompress::needsHeaderRead(void)
@@ -126,7 +128,8 @@ TileProcessor* CodeStreamDecompress::allocateProcessor(uint16_t tileIndex)
 	auto tileProcessor = tileCache ? tileCache->processor : nullptr;
 	if(!tileProcessor)
 	{
-		tileProcessor = new TileProcessor(tileIndex, this, stream_, false, &stripCache_);
+		tileProcessor = new TileProcessor(tileIndex, this, stream_, false, &stripCache_,
+										  &sparseBlockPool_);
 		tileCache_->put(tileIndex, tileProcessor);
 	}
 	currentTileProcessor_ = tileProcessor;
@@ -194,8 +197,10 @@ bool CodeStreamDecompress::readHeader(grk_header_info* header_info)
 			composite->decompressFormat = header_info->decompressFormat;
 			composite->forceRGB = header_info->forceRGB;
 			composite->upsample = header_info->upsample;
+			composite->upsampleFilter = header_info->upsampleFilter;
 			composite->precision = header_info->precision;
 			composite->numPrecision = header_info->numPrecision;
+			composite->outputDataType = header_info->outputDataType;
 			composite->splitByComponent = header_info->splitByComponent;
 		}
 	}
@@ -357,6 +362,9 @@ void CodeStreamDecompress::init(grk_decompress_core_params* parameters)
 	cp_.coding_params_.dec_.layer_ = parameters->max_layers;
 	cp_.coding_params_.dec_.reduce_ = parameters->reduce;
 	cp_.coding_params_.dec_.randomAccessFlags_ = parameters->randomAccessFlags_;
+	cp_.coding_params_.dec_.refine_ = parameters->tileCacheStrategy == GRK_TILE_CACHE_REFINE;
+	cp_.coding_params_.dec_.cacheTileImages_ =
+		parameters->tileCacheStrategy == GRK_TILE_CACHE_IMAGE;
 	tileCache_->setStrategy(parameters->tileCacheStrategy);
 
 	ioBufferCallback = parameters->io_buffer_callback;
@@ -367,9 +375,88 @@ bool CodeStreamDecompress::decompress(grk_plugin_tile* tile)
 {
 	procedure_list_.push_back(std::bind(&CodeStreamDecompress::decompressTiles, this));
 	current_plugin_tile = tile;
+	if(cp_.coding_params_.dec_.refine_)
+	{
+		if(compositeHeader_)
+			grk_object_unref(&compositeHeader_->obj);
+		compositeHeader_ = new GrkImage();
+		getCompositeImage()->copyHeader(compositeHeader_);
+	}
 
 	return decompressExec();
 }
+bool CodeStreamDecompress::decompressRefine(uint16_t maxLayers)
+{
+	auto& dec = cp_.coding_params_.dec_;
+	if(!dec.refine_ || !compositeHeader_ || !outputImage_)
+	{
+		GRK_ERROR("Refinement requires a previous decompression "
+				  "with GRK_TILE_CACHE_REFINE tile cache strategy");
+		return false;
+	}
+	if(dec.layer_ == 0 || (maxLayers != 0 && maxLayers <= dec.layer_))
+	{
+		GRK_ERROR("Refinement to %u layers must add to the %u layers already decompressed",
+				  maxLayers, dec.layer_);
+		return false;
+	}
+	if(cp_.ppm_marker || outputImage_->supportsStripCache(&cp_))
+	{
+		GRK_ERROR("Refinement is not supported with PPM marker or strip output");
+		return false;
+	}
+	dec.layer_ = maxLayers;
+	uint32_t numTiles = (uint32_t)cp_.t_grid_width * cp_.t_grid_height;
+	for(uint32_t i = 0; i < numTiles; ++i)
+	{
+		auto tcp = cp_.tcps + i;
+		tcp->numLayersToDecompress = maxLayers ? maxLayers : tcp->numlayers;
+	}
+
+	// restore composite image to its state before post processing
+	auto compositeImage = getCompositeImage();
+	compositeImage->all_components_data_free();
+	if(compositeImage->meta)
+	{
+		grk_object_unref(&compositeImage->meta->obj);
+		compositeImage->meta = nullptr;
+	}
+	compositeHeader_->copyHeader(compositeImage);
+	compositeImage->paletteApplied_ = false;
+	compositeImage->channelDefinitionApplied_ = false;
+	if(!createOutputImage())
+		return false;
+
+	bool success = true;
+	for(uint32_t i = 0; i < numTiles && success; ++i)
+	{
+		auto tileIndex = (uint16_t)i;
+		auto entry = tileCache_->get(tileIndex);
+		if(!decompressorState_.tilesToDecompress_.isScheduled(tileIndex) || !entry ||
+		   !entry->processor || !cp_.tcps[i].compressedTileData_)
+			continue;
+		auto processor = entry->processor;
+		if(!processor->prepareRefine() || !processor->decompressT2T1(outputImage_))
+		{
+			GRK_ERROR("Failed to refine tile %u/%u", tileIndex, numTiles);
+			success = false;
+		}
+		else
+		{
+			auto img = processor->getImage();
+			if(outputImage_->hasMultipleTiles && img && !outputImage_->composite(img))
+				success = false;
+		}
+		processor->release(success ? tileCache_->getStrategy() : GRK_TILE_CACHE_NONE);
+	}
+	if(!success)
+		return false;
+
+	// transfer output image to composite image
+	outputImage_->transferDataTo(compositeImage);
+
+	return true;
+}
 bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
 {
 	// 1. check if tile has already been decompressed
@@ -461,19 +548,22 @@ bool CodeStreamDecompress::decompressTiles(void)
 	}
 	if(!createOutputImage())
 		return false;
+	prefetchTLM();
 
 	auto numRequiredThreads =
 		std::min<uint32_t>((uint32_t)ExecSingleton::get()->num_workers(), numTilesToDecompress);
-	if(outputImage_->supportsStripCache(&cp_))
+	if(!transcoder_ && outputImage_->supportsStripCache(&cp_))
 	{
 		uint32_t numStrips = cp_.t_grid_height;
 		if(numTilesToDecompress == 1)
 		{
-			numStrips = (outputImage_->height() + outputImage_->rowsPerStrip - 1) /
+			numStrips = (outputImage_->comps->h + outputImage_->rowsPerStrip - 1) /
 						outputImage_->rowsPerStrip;
 		}
 		stripCache_.init((uint32_t)ExecSingleton::get()->num_workers(), cp_.t_grid_width, numStrips,
-						 numTilesToDecompress > 1 ? cp_.t_height : outputImage_->rowsPerStrip,
+						 numTilesToDecompress > 1
+							 ? cp_.t_height
+							 : outputImage_->rowsPerStrip << cp_.coding_params_.dec_.reduce_,
 						 cp_.coding_params_.dec_.reduce_, outputImage_, ioBufferCallback,
 						 ioUserData, grkRegisterReclaimCallback_);
 	}
@@ -808,12 +898,25 @@ bool CodeStreamDecompress::createOutputImage(void)
 		getCompositeImage()->copyHeader(outputImage_);
 	}
 
-	return outputImage_->supportsStripCache(&cp_) || outputImage_->allocCompositeData();
+	// transcoded tiles are never composited
+	return transcoder_ || outputImage_->supportsStripCache(&cp_) ||
+		   outputImage_->allocCompositeData();
 }
 bool CodeStreamDecompress::hasTLM(void)
 {
 	return cp_.tlm_markers && cp_.tlm_markers->valid();
 }
+/***
+ * Advise stream of scheduled tile parts, if enabled
+ */
+void CodeStreamDecompress::prefetchTLM(void)
+{
+	if(!hasTLM() || !codeStreamInfo ||
+	   !(cp_.coding_params_.dec_.randomAccessFlags_ & GRK_RANDOM_ACCESS_PREFETCH))
+		return;
+	cp_.tlm_markers->prefetch(&decompressorState_.tilesToDecompress_,
+							  codeStreamInfo->getMainHeaderEnd(), stream_);
+}
 /***
  * Skip past non-scheduled tiles
  */
@@ -846,6 +949,7 @@ bool CodeStreamDecompress::decompressTile(void)
 	auto tileProcessor = tileCache ? tileCache->processor : nullptr;
 	if(!tileCache || !tileCache->processor->getImage())
 	{
+		prefetchTLM();
 		// find first tile part
 		try
 		{
@@ -882,10 +986,12 @@ bool CodeStreamDecompress::decompressTile(void)
 		tileProcessor = currentTileProcessor_;
 		if(outputImage_->supportsStripCache(&cp_))
 		{
-			uint32_t numStrips = (outputImage_->height() + outputImage_->rowsPerStrip - 1) /
+			// strips are nominally rowsPerStrip high at the reduced resolution
+			uint32_t numStrips = (outputImage_->comps->h + outputImage_->rowsPerStrip - 1) /
 								 outputImage_->rowsPerStrip;
 			stripCache_.init((uint32_t)ExecSingleton::get()->num_workers(), 1, numStrips,
-							 outputImage_->rowsPerStrip, cp_.coding_params_.dec_.reduce_,
+							 outputImage_->rowsPerStrip << cp_.coding_params_.dec_.reduce_,
+							 cp_.coding_params_.dec_.reduce_,
 							 outputImage_, ioBufferCallback, ioUserData,
 							 grkRegisterReclaimCallback_);
 		}
@@ -1033,21 +1139,29 @@ bool CodeStreamDecompress::preProcess(void)
 }
 bool CodeStreamDecompress::postProcess(void)
 {
-	for(auto& img : getAllImages())
+	// precision conversion may have been fused with final stage of tile decompression
+	auto img = getCompositeImage();
+	std::vector<int8_t> precShift;
+	bool fusedPrecision = img->getFusedPrecisionShift(&cp_, headerImage_, precShift);
+	for(auto& tileImg : getAllImages())
 	{
-		if(!img->applyColour())
+		if(!tileImg->applyColour())
 			return false;
 	}
 
-	auto img = getCompositeImage();
 	img->applyColourManagement();
 	if(!img->convertToRGB(cp_.wholeTileDecompress_))
 		return false;
 	if(!img->greyToRGB())
 		return false;
-	img->convertPrecision();
+	if(fusedPrecision)
+		img->setFusedPrecision(headerImage_);
+	else
+		img->convertPrecision();
+	if(!img->execUpsample())
+		return false;
 
-	return img->execUpsample();
+	return img->convertToOutputDataType();
 }
 
 void CodeStreamDecompress::dump_tile_info(TileCodingParams* default_tile, uint32_t numcomps,
@@ -1150,6 +1264,10 @@ void CodeStreamDecompress::dump(uint32_t flag, FILE* outputFileStream)
 	if((flag & GRK_J2K_MH_IND) && codeStreamInfo)
 		codeStreamInfo->dump(outputFileStream);
 }
+CodeStream* CodeStreamDecompress::getCodeStream(void)
+{
+	return this;
+}
 void CodeStreamDecompress::dump_MH_info(FILE* outputFileStream)
 {
 	fprintf(outputFileStream, "Codestream info from main header: {\n");
@@ -51,6 +51,7 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	bool setDecompressRegion(grk_rect_single region);
 	bool decompress(grk_plugin_tile* tile);
 	bool decompressTile(uint16_t tileIndex);
+	bool decompressRefine(uint16_t maxLayers);
 	bool preProcess(void);
 	bool postProcess(void);
 	CodeStreamInfo* getCodeStreamInfo(void);
@@ -60,6 +61,7 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	GrkImage* getHeaderImage(void);
 	uint16_t getCurrentMarker(void);
 	void dump(uint32_t flag, FILE* outputFileStream);
+	CodeStream* getCodeStream(void);
 	bool needsHeaderRead(void);
 	void setExpectSOD();
 
@@ -98,6 +100,7 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	bool findNextSOT(TileProcessor* tileProcessor);
 	bool skipNonScheduledTLM(CodingParams* cp);
 	bool hasTLM(void);
+	void prefetchTLM(void);
 	void nextTLM(void);
 	bool decompressTiles(void);
 	bool decompressValidation(void);
@@ -326,8 +329,11 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	uint8_t* marker_scratch_;
 	uint16_t marker_scratch_size_;
 	GrkImage* outputImage_;
+	// composite image header before post processing, restored for refinement
+	GrkImage* compositeHeader_;
 	TileCache* tileCache_;
 	StripCache stripCache_;
+	SparseBlockPool sparseBlockPool_;
 	grk_io_pixels_callback ioBufferCallback;
 	void* ioUserData;
 	grk_io_register_reclaim_callback grkRegisterReclaimCallback_;
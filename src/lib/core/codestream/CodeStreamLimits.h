@@ -41,5 +41,6 @@ const uint16_t maxNumLayersJ2K = 65535;
 const uint32_t maxBitPlanesGRK = 31 - T1_NMSEDEC_FRACBITS;
 // const uint32_t max_bit_planes_bibo = maxSupportedPrecisionGRK + GRK_J2K_MAXRLVLS * 5;
 const uint16_t maxCompressLayersGRK = 100;
+const uint8_t maxCompressPassesGRK = 100;
 
 } // namespace grk
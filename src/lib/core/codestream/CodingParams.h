@@ -224,6 +224,8 @@ struct EncodingParams
 	bool writeTLM;
 	/* rate control algorithm */
 	uint32_t rateControlAlgorithm;
+	/* safety margin for skipping code passes below rate control threshold (0 disables) */
+	double passTruncationMargin;
 };
 
 struct DecodingParams
@@ -236,6 +238,11 @@ struct DecodingParams
 	uint16_t layer_;
 
 	uint32_t randomAccessFlags_;
+	/** if true, code block decoder state is retained so that decompression
+	 * can later be refined with more layers */
+	bool refine_;
+	/** if true, final tile images are retained in the tile cache */
+	bool cacheTileImages_;
 };
 
 /**
@@ -924,6 +924,10 @@ bool FileFormatCompress::compress(grk_plugin_tile* tile)
 
 	return rc;
 }
+CodeStream* FileFormatCompress::getCodeStream(void)
+{
+	return codeStream;
+}
 bool FileFormatCompress::end(void)
 {
 	/* write header */
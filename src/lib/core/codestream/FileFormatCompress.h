@@ -31,6 +31,7 @@ class FileFormatCompress : public FileFormat, public ICodeStreamCompress
 	bool init(grk_cparameters* p_param, GrkImage* p_image);
 	bool start(void);
 	bool compress(grk_plugin_tile* tile);
+	CodeStream* getCodeStream(void);
 
   private:
 	bool end(void);
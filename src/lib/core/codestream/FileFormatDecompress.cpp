@@ -320,6 +320,16 @@ bool FileFormatDecompress::decompressTile(uint16_t tileIndex)
 
 	return true;
 }
+bool FileFormatDecompress::decompressRefine(uint16_t maxLayers)
+{
+	if(!codeStream->decompressRefine(maxLayers))
+	{
+		GRK_ERROR("Failed to refine JP2 file");
+		return false;
+	}
+
+	return true;
+}
 uint32_t FileFormatDecompress::read_asoc(AsocBox* parent, uint8_t** header_data,
 										 uint32_t* header_data_size, uint32_t asocSize)
 {
@@ -399,6 +409,10 @@ void FileFormatDecompress::dump(uint32_t flag, FILE* outputFileStream)
 {
 	codeStream->dump(flag, outputFileStream);
 }
+CodeStream* FileFormatDecompress::getCodeStream(void)
+{
+	return codeStream;
+}
 bool FileFormatDecompress::readHeaderProcedureImpl(void)
 {
 	FileFormatBox box;
@@ -37,10 +37,12 @@ class FileFormatDecompress : public FileFormat, public ICodeStreamDecompress
 	bool setDecompressRegion(grk_rect_single region);
 	bool decompress(grk_plugin_tile* tile);
 	bool decompressTile(uint16_t tileIndex);
+	bool decompressRefine(uint16_t maxLayers);
 	bool end(void);
 	bool postProcess(void);
 	bool preProcess(void);
 	void dump(uint32_t flag, FILE* outputFileStream);
+	CodeStream* getCodeStream(void);
 
   private:
 	grk_color* getColour(void);
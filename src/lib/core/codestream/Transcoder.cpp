@@ -0,0 +1,610 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "grk_includes.h"
+#include "T1Part1.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace grk
+{
+/**
+ * Part 1 code block to be re-encoded with HT block coder
+ */
+struct HTTranscodeJob
+{
+	HTTranscodeJob(DecompressCodeblock* srcCblk, Subband* srcBand, uint8_t srcCblkSty,
+				   TranscodeBlock* destBlock)
+		: cblk(srcCblk), band(srcBand), cblk_sty(srcCblkSty), block(destBlock)
+	{}
+	DecompressCodeblock* cblk;
+	Subband* band;
+	uint8_t cblk_sty;
+	TranscodeBlock* block;
+};
+
+/**
+ * Re-encodes Part 1 code blocks with HT block coder.
+ *
+ * Code block is entropy decoded to quantization indices, which are then
+ * compressed as a single HT cleanup pass. Indices are coded as is, so no
+ * quantization takes place, for both reversible and irreversible sources.
+ */
+class HTBlockTranscoder
+{
+  public:
+	HTBlockTranscoder(TileCodingParams* tcp, uint32_t maxCblkW, uint32_t maxCblkH)
+		: decoder_(false, maxCblkW, maxCblkH),
+		  encoder_(T1Factory::makeT1HT(true, tcp, maxCblkW, maxCblkH)), cblk_(1),
+		  indices_((size_t)maxCblkW * maxCblkH)
+	{
+		if(cblk_.init())
+			cblk_.allocData(indices_.size());
+	}
+	~HTBlockTranscoder()
+	{
+		delete encoder_;
+	}
+	bool transcode(HTTranscodeJob* job)
+	{
+		if(!cblk_.passes)
+			return false;
+		auto src = job->cblk;
+		auto band = job->band;
+		DecompressBlockExec decompressBlock;
+		decompressBlock.cblk = src;
+		decompressBlock.bandOrientation = band->orientation;
+		decompressBlock.cblk_sty = job->cblk_sty;
+		if(!decoder_.decompressIndices(&decompressBlock, indices_.data()))
+			return false;
+		// block with no significant samples is not included in any packet
+		auto end = indices_.begin() + (std::ptrdiff_t)src->area();
+		if(std::all_of(indices_.begin(), end, [](int32_t v) { return v == 0; }))
+			return true;
+
+		cblk_.setRect(*src);
+		CompressBlockExec compressBlock;
+		compressBlock.cblk = &cblk_;
+		compressBlock.tiledp = indices_.data();
+		compressBlock.stride = src->width();
+		compressBlock.bandOrientation = band->orientation;
+		compressBlock.qmfbid = 1;
+		compressBlock.k_msbs = band->numbps;
+		if(!encoder_->compress(&compressBlock))
+			return false;
+		uint32_t len = cblk_.passes[0].len;
+		auto block = job->block;
+		block->numZeroBitPlanes = (uint8_t)(band->numbps - cblk_.numbps);
+		block->contributions.push_back(SegmentContribution(0, 1, len));
+		block->data.assign(cblk_.paddedCompressedStream, cblk_.paddedCompressedStream + len);
+
+		return true;
+	}
+
+  private:
+	t1_part1::T1Part1 decoder_;
+	T1Interface* encoder_;
+	CompressCodeblock cblk_;
+	std::vector<int32_t> indices_;
+};
+
+/**
+ * Re-encode all code blocks of a tile with HT block coder, in parallel
+ */
+static bool transcodeHT(TileProcessor* tileProcessor, std::vector<HTTranscodeJob>& jobs)
+{
+	if(jobs.empty())
+		return true;
+	auto tcp = tileProcessor->getTileCodingParams();
+	uint32_t maxCblkW = 0;
+	uint32_t maxCblkH = 0;
+	for(uint16_t compno = 0; compno < tileProcessor->getTile()->numcomps_; ++compno)
+	{
+		maxCblkW = std::max<uint32_t>(maxCblkW, 1U << tcp->tccps[compno].cblkw);
+		maxCblkH = std::max<uint32_t>(maxCblkH, 1U << tcp->tccps[compno].cblkh);
+	}
+	auto executor = ExecSingleton::get();
+	size_t numWorkers = executor->num_workers();
+	std::vector<std::unique_ptr<HTBlockTranscoder>> transcoders;
+	for(size_t i = 0; i < numWorkers; ++i)
+		transcoders.push_back(std::make_unique<HTBlockTranscoder>(tcp, maxCblkW, maxCblkH));
+	if(numWorkers == 1)
+	{
+		for(auto& job : jobs)
+		{
+			if(!transcoders[0]->transcode(&job))
+				return false;
+		}
+		return true;
+	}
+	std::atomic<size_t> next(0);
+	std::atomic<bool> success(true);
+	tf::Taskflow taskflow;
+	for(size_t i = 0; i < numWorkers; ++i)
+	{
+		taskflow.emplace([&transcoders, &jobs, &next, &success, executor] {
+			auto transcoder = transcoders[(size_t)executor->this_worker_id()].get();
+			size_t index;
+			while(success && (index = next++) < jobs.size())
+			{
+				if(!transcoder->transcode(&jobs[index]))
+					success = false;
+			}
+		});
+	}
+	executor->run(taskflow).wait();
+
+	return success;
+}
+
+/**
+ * Check if tile coding parameters match, for all coding parameters that are
+ * carried over to transcoded code stream
+ */
+static bool sameCodingParams(TileCodingParams* tcp0, TileCodingParams* tcp, uint16_t numcomps,
+							 bool compareProgression)
+{
+	if(tcp->csty != tcp0->csty || tcp->numlayers != tcp0->numlayers || tcp->mct != tcp0->mct)
+		return false;
+	if(compareProgression && tcp->prg != tcp0->prg)
+		return false;
+	for(uint16_t compno = 0; compno < numcomps; ++compno)
+	{
+		auto tccp0 = tcp0->tccps + compno;
+		auto tccp = tcp->tccps + compno;
+		if(tccp->csty != tccp0->csty || tccp->numresolutions != tccp0->numresolutions ||
+		   tccp->cblkw != tccp0->cblkw || tccp->cblkh != tccp0->cblkh ||
+		   tccp->cblk_sty != tccp0->cblk_sty || tccp->qmfbid != tccp0->qmfbid ||
+		   tccp->qntsty != tccp0->qntsty || tccp->numgbits != tccp0->numgbits ||
+		   tccp->roishift != tccp0->roishift)
+			return false;
+		for(uint32_t resno = 0; resno < tccp->numresolutions; ++resno)
+		{
+			if(tccp->precWidthExp[resno] != tccp0->precWidthExp[resno] ||
+			   tccp->precHeightExp[resno] != tccp0->precHeightExp[resno])
+				return false;
+		}
+		uint32_t numBands = 3U * tccp->numresolutions - 2U;
+		for(uint32_t bandno = 0; bandno < numBands; ++bandno)
+		{
+			if(tccp->stepsizes[bandno].expn != tccp0->stepsizes[bandno].expn ||
+			   tccp->stepsizes[bandno].mant != tccp0->stepsizes[bandno].mant)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+Transcoder::Transcoder(grk_transcode_parameters* parameters)
+	: parameters_(*parameters), numLayers_(0), tx0_(0), ty0_(0), t_width_(0), t_height_(0)
+{}
+bool Transcoder::transcode(ICodeStreamDecompress* src, ICodeStreamCompress* dest)
+{
+	if(!src->readHeader(nullptr) || !src->preProcess())
+		return false;
+	if(!src->setDecompressRegion(grk_rect_single(0, 0, 0, 0)))
+		return false;
+	auto srcCodeStream = src->getCodeStream();
+	auto srcCp = srcCodeStream->getCodingParams();
+	tiles_.resize((size_t)srcCp->t_grid_width * srcCp->t_grid_height);
+
+	// 1. T2 decompress: collect code block data
+	srcCodeStream->setTranscoder(this);
+	bool rc = src->decompress(nullptr);
+	srcCodeStream->setTranscoder(nullptr);
+	if(!rc)
+		return false;
+
+	// tile coding parameters are only complete once tile headers have been parsed
+	auto srcImage = src->getImage();
+	if(!validate(srcCp, srcImage))
+		return false;
+
+	// 2. T2 compress: re-packetize code block data
+	grk_cparameters parameters;
+	setParameters(srcCp, srcImage, &parameters);
+	auto image = createImage(srcImage);
+	rc = dest->init(&parameters, image);
+	if(rc)
+	{
+		auto destCodeStream = dest->getCodeStream();
+		rc = copyCodingParams(srcCp, destCodeStream->getCodingParams(), image->numcomps);
+		if(rc)
+		{
+			destCodeStream->setTranscoder(this);
+			rc = dest->start() && dest->compress(nullptr);
+			destCodeStream->setTranscoder(nullptr);
+		}
+	}
+	grk_object_unref(&image->obj);
+
+	return rc;
+}
+bool Transcoder::validate(CodingParams* cp, GrkImage* headerImage)
+{
+	auto tcp0 = cp->tcps;
+	uint32_t numTiles = (uint32_t)cp->t_grid_width * cp->t_grid_height;
+	bool keepProgression = parameters_.prog_order == GRK_PROG_UNKNOWN;
+	for(uint32_t tileno = 0; tileno < numTiles; ++tileno)
+	{
+		auto tcp = cp->tcps + tileno;
+		if(!sameCodingParams(tcp0, tcp, headerImage->numcomps, keepProgression))
+		{
+			GRK_ERROR("Transcode: coding parameters of tile %u differ from those of tile 0",
+					  tileno);
+			return false;
+		}
+		if(tcp->getNumProgressions() > 1)
+		{
+			GRK_WARN("Transcode: progression order changes in tile %u are not transcoded",
+					 tileno);
+		}
+	}
+	if(parameters_.ht)
+	{
+		if(tcp0->isHT())
+		{
+			GRK_WARN("Transcode: source code blocks are already HT coded, and will be copied");
+		}
+		else
+		{
+			for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
+			{
+				if(tcp0->tccps[compno].roishift)
+				{
+					GRK_ERROR("Transcode: HT re-encoding of region of interest is not supported");
+					return false;
+				}
+			}
+		}
+	}
+	if(tcp0->mct == 2)
+	{
+		GRK_ERROR("Transcode: custom multiple component transform is not supported");
+		return false;
+	}
+	for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
+	{
+		if(parameters_.reduce >= tcp0->tccps[compno].numresolutions)
+		{
+			GRK_ERROR("Transcode: reduce %u must be less than number of resolutions %u",
+					  parameters_.reduce, tcp0->tccps[compno].numresolutions);
+			return false;
+		}
+	}
+	numLayers_ = tcp0->numlayers;
+	if(parameters_.max_layers && parameters_.max_layers < numLayers_)
+		numLayers_ = parameters_.max_layers;
+	// HT re-encoding merges all kept layers into a single layer
+	if(parameters_.ht && !tcp0->isHT())
+		numLayers_ = 1;
+	if(numLayers_ > maxCompressLayersGRK)
+	{
+		GRK_ERROR("Transcode: number of layers %u is greater than maximum %u", numLayers_,
+				  maxCompressLayersGRK);
+		return false;
+	}
+
+	// reduced canvas and tile grid
+	uint32_t reduce = parameters_.reduce;
+	canvas_ = grk_rect32(ceildivpow2<uint32_t>(headerImage->x0, reduce),
+						 ceildivpow2<uint32_t>(headerImage->y0, reduce),
+						 ceildivpow2<uint32_t>(headerImage->x1, reduce),
+						 ceildivpow2<uint32_t>(headerImage->y1, reduce));
+	tx0_ = ceildivpow2<uint32_t>(cp->tx0, reduce);
+	ty0_ = ceildivpow2<uint32_t>(cp->ty0, reduce);
+	// tile boundaries of a multiple tile grid are only preserved at reduced resolution
+	// if tile dimensions are divisible by 2^reduce
+	uint32_t reduceMask = (1U << reduce) - 1;
+	if((cp->t_grid_width > 1 && (cp->t_width & reduceMask)) ||
+	   (cp->t_grid_height > 1 && (cp->t_height & reduceMask)))
+	{
+		GRK_ERROR("Transcode: tile dimensions (%u,%u) must be divisible by 2^%u", cp->t_width,
+				  cp->t_height, reduce);
+		return false;
+	}
+	t_width_ = cp->t_grid_width > 1 ? cp->t_width >> reduce : canvas_.x1 - tx0_;
+	t_height_ = cp->t_grid_height > 1 ? cp->t_height >> reduce : canvas_.y1 - ty0_;
+	if(!canvas_.valid() || tx0_ + t_width_ <= canvas_.x0 || ty0_ + t_height_ <= canvas_.y0 ||
+	   ceildiv<uint32_t>(canvas_.x1 - tx0_, t_width_) != cp->t_grid_width ||
+	   ceildiv<uint32_t>(canvas_.y1 - ty0_, t_height_) != cp->t_grid_height)
+	{
+		GRK_ERROR("Transcode: tile grid can not be preserved at reduce %u", reduce);
+		return false;
+	}
+
+	return true;
+}
+GrkImage* Transcoder::createImage(GrkImage* srcImage)
+{
+	auto image = new GrkImage();
+	srcImage->copyHeader(image);
+	image->x0 = canvas_.x0;
+	image->y0 = canvas_.y0;
+	image->x1 = canvas_.x1;
+	image->y1 = canvas_.y1;
+	for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		comp->x0 = ceildiv<uint32_t>(canvas_.x0, comp->dx);
+		comp->y0 = ceildiv<uint32_t>(canvas_.y0, comp->dy);
+		comp->w = ceildiv<uint32_t>(canvas_.x1, comp->dx) - comp->x0;
+		comp->h = ceildiv<uint32_t>(canvas_.y1, comp->dy) - comp->y0;
+		comp->stride = 0;
+	}
+	// JP2 needs a colour space
+	if(image->color_space == GRK_CLRSPC_UNKNOWN)
+		image->color_space = image->numcomps >= 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY;
+
+	return image;
+}
+void Transcoder::setParameters(CodingParams* cp, GrkImage* srcImage, grk_cparameters* parameters)
+{
+	auto tcp = cp->tcps;
+	auto tccp = tcp->tccps;
+	grk_compress_set_default_params(parameters);
+	parameters->cod_format = parameters_.cod_format;
+	parameters->rsiz = GRK_PROFILE_NONE;
+
+	// coding parameters: these are overwritten by copyCodingParams
+	// once compressor has been initialized
+	parameters->numresolution = (uint8_t)(tccp->numresolutions - parameters_.reduce);
+	parameters->cblockw_init = 1U << tccp->cblkw;
+	parameters->cblockh_init = 1U << tccp->cblkh;
+	parameters->cblk_sty = parameters_.ht && !tcp->isHT() ? GRK_CBLKSTY_HT : tccp->cblk_sty;
+	parameters->irreversible = tccp->qmfbid == 0;
+	parameters->csty = tcp->csty;
+	parameters->numgbits = tccp->numgbits;
+	parameters->numlayers = numLayers_;
+	parameters->prog_order =
+		parameters_.prog_order == GRK_PROG_UNKNOWN ? tcp->prg : parameters_.prog_order;
+
+	// tiles
+	parameters->tile_size_on = true;
+	parameters->tx0 = tx0_;
+	parameters->ty0 = ty0_;
+	parameters->t_width = t_width_;
+	parameters->t_height = t_height_;
+
+	// tile parts and markers
+	parameters->enableTilePartGeneration = parameters_.enableTilePartGeneration;
+	parameters->newTilePartProgressionDivider = parameters_.newTilePartProgressionDivider;
+	parameters->writePLT = parameters_.writePLT;
+	parameters->writeTLM = parameters_.writeTLM;
+
+	// comments
+	parameters->num_comments = std::min<size_t>(cp->num_comments, GRK_NUM_COMMENTS_SUPPORTED);
+	for(size_t i = 0; i < parameters->num_comments; ++i)
+	{
+		parameters->comment[i] = cp->comment[i];
+		parameters->comment_len[i] = cp->comment_len[i];
+		parameters->is_binary_comment[i] = cp->isBinaryComment[i];
+	}
+
+	// resolution boxes: sample density is divided by 2^reduce
+	double scale = 1.0 / (double)(1U << parameters_.reduce);
+	if(srcImage->has_capture_resolution)
+	{
+		parameters->write_capture_resolution = true;
+		for(uint32_t i = 0; i < 2; ++i)
+			parameters->capture_resolution[i] = srcImage->capture_resolution[i] * scale;
+	}
+	if(srcImage->has_display_resolution)
+	{
+		parameters->write_display_resolution = true;
+		for(uint32_t i = 0; i < 2; ++i)
+			parameters->display_resolution[i] = srcImage->display_resolution[i] * scale;
+	}
+}
+bool Transcoder::copyCodingParams(CodingParams* srcCp, CodingParams* destCp, uint16_t numcomps)
+{
+	if(destCp->t_grid_width != srcCp->t_grid_width ||
+	   destCp->t_grid_height != srcCp->t_grid_height)
+	{
+		GRK_ERROR("Transcode: tile grid (%u,%u) differs from source tile grid (%u,%u)",
+				  destCp->t_grid_width, destCp->t_grid_height, srcCp->t_grid_width,
+				  srcCp->t_grid_height);
+		return false;
+	}
+	uint32_t numTiles = (uint32_t)destCp->t_grid_width * destCp->t_grid_height;
+	for(uint32_t tileno = 0; tileno < numTiles; ++tileno)
+	{
+		auto srcTcp = srcCp->tcps + tileno;
+		auto destTcp = destCp->tcps + tileno;
+		destTcp->csty = srcTcp->csty;
+		destTcp->mct = srcTcp->mct;
+		destTcp->numlayers = numLayers_;
+		destTcp->numpocs = 0;
+		if(parameters_.prog_order != GRK_PROG_UNKNOWN)
+			destTcp->prg = parameters_.prog_order;
+		else
+			destTcp->prg = srcTcp->prg;
+		for(uint16_t compno = 0; compno < numcomps; ++compno)
+		{
+			auto srcTccp = srcTcp->tccps + compno;
+			auto destTccp = destTcp->tccps + compno;
+			uint8_t numResolutions = (uint8_t)(srcTccp->numresolutions - parameters_.reduce);
+			destTccp->csty = srcTccp->csty;
+			destTccp->numresolutions = numResolutions;
+			destTccp->cblkw = srcTccp->cblkw;
+			destTccp->cblkh = srcTccp->cblkh;
+			destTccp->cblk_sty =
+				destTcp->isHT() && !srcTcp->isHT() ? GRK_CBLKSTY_HT : srcTccp->cblk_sty;
+			destTccp->qmfbid = srcTccp->qmfbid;
+			destTccp->qntsty = srcTccp->qntsty;
+			destTccp->numgbits = srcTccp->numgbits;
+			destTccp->roishift = srcTccp->roishift;
+			destTccp->dc_level_shift_ = srcTccp->dc_level_shift_;
+			for(uint32_t resno = 0; resno < numResolutions; ++resno)
+			{
+				destTccp->precWidthExp[resno] = srcTccp->precWidthExp[resno];
+				destTccp->precHeightExp[resno] = srcTccp->precHeightExp[resno];
+			}
+			// step sizes of kept sub-bands are unchanged, as sub-band gains
+			// do not depend on decomposition level. For derived quantization,
+			// the LL step size is also unchanged, since the number of
+			// decomposition levels and the LL decomposition level are
+			// reduced by the same amount
+			uint32_t numBands = 3U * numResolutions - 2U;
+			for(uint32_t bandno = 0; bandno < numBands; ++bandno)
+				destTccp->stepsizes[bandno] = srcTccp->stepsizes[bandno];
+		}
+		// keep HT capabilities marker consistent with step sizes
+		destTcp->qcd_->push(destTcp->tccps->stepsizes);
+	}
+
+	return true;
+}
+bool Transcoder::ingest(TileProcessor* tileProcessor)
+{
+	auto tile = tileProcessor->getTile();
+	auto tcp = tileProcessor->getTileCodingParams();
+	auto& blocks = tiles_[tileProcessor->getIndex()];
+	bool reencodeHT = parameters_.ht && !tcp->isHT();
+	std::vector<HTTranscodeJob> htJobs;
+	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+	{
+		auto tilec = tile->comps + compno;
+		uint8_t numResolutions = (uint8_t)(tilec->numresolutions - parameters_.reduce);
+		for(uint8_t resno = 0; resno < numResolutions; ++resno)
+		{
+			auto res = tilec->resolutions_ + resno;
+			for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+			{
+				auto band = res->tileBand + bandIndex;
+				for(auto prc : band->precincts)
+				{
+					for(uint64_t cblkno = 0; cblkno < prc->getNumCblks(); ++cblkno)
+					{
+						auto cblk = prc->tryGetDecompressedBlockPtr(cblkno);
+						if(!cblk || cblk->contributions.empty())
+							continue;
+						auto& block = blocks[TranscodeBlockKey(compno, resno, bandIndex,
+															   prc->precinctIndex, cblkno)];
+						if(reencodeHT)
+						{
+							htJobs.push_back(HTTranscodeJob(cblk, band, tcp->tccps[compno].cblk_sty,
+															&block));
+							continue;
+						}
+						block.numZeroBitPlanes = (uint8_t)(band->numbps - cblk->numbps);
+						block.contributions = cblk->contributions;
+						block.data.resize(cblk->getSegBuffersLen());
+						if(!block.data.empty())
+							cblk->copyToContiguousBuffer(block.data.data());
+						size_t numBytes = 0;
+						for(auto& c : block.contributions)
+							numBytes += c.numBytes;
+						if(numBytes != block.data.size())
+						{
+							GRK_ERROR("Transcode: tile %u code block data length %u does not "
+									  "match contributed length %u",
+									  tileProcessor->getIndex(), block.data.size(), numBytes);
+							return false;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return !reencodeHT || transcodeHT(tileProcessor, htJobs);
+}
+bool Transcoder::fill(TileProcessor* tileProcessor)
+{
+	auto tile = tileProcessor->getTile();
+	auto& blocks = tiles_[tileProcessor->getIndex()];
+	uint16_t numLayers = tileProcessor->getTileCodingParams()->numlayers;
+	size_t numFilled = 0;
+	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+	{
+		auto tilec = tile->comps + compno;
+		for(uint8_t resno = 0; resno < tilec->numresolutions; ++resno)
+		{
+			auto res = tilec->resolutions_ + resno;
+			for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+			{
+				auto band = res->tileBand + bandIndex;
+				for(auto prc : band->precincts)
+				{
+					for(uint64_t cblkno = 0; cblkno < prc->getNumCblks(); ++cblkno)
+					{
+						auto block = blocks.find(TranscodeBlockKey(compno, resno, bandIndex,
+																   prc->precinctIndex, cblkno));
+						if(block == blocks.end())
+							continue;
+						if(!fillBlock(band, prc->getCompressedBlockPtr(cblkno), &block->second,
+									  numLayers))
+							return false;
+						numFilled++;
+					}
+				}
+			}
+		}
+	}
+	if(numFilled != blocks.size())
+	{
+		GRK_ERROR("Transcode: tile %u: %u of %u code blocks have no matching code block",
+				  tileProcessor->getIndex(), blocks.size() - numFilled, blocks.size());
+		return false;
+	}
+
+	return true;
+}
+bool Transcoder::fillBlock(Subband* band, CompressCodeblock* cblk, TranscodeBlock* block,
+						   uint16_t numLayers)
+{
+	if(block->numZeroBitPlanes > band->numbps)
+	{
+		GRK_ERROR("Transcode: %u missing code block bit planes is greater than %u band bit planes",
+				  block->numZeroBitPlanes, band->numbps);
+		return false;
+	}
+	cblk->numbps = (uint8_t)(band->numbps - block->numZeroBitPlanes);
+
+	// each contribution becomes a terminated run of passes, so that T2
+	// signals exactly the same segment lengths as were parsed from source
+	uint32_t passno = 0;
+	size_t offset = 0;
+	for(auto& c : block->contributions)
+	{
+		if(c.layno >= numLayers || !c.numPasses ||
+		   passno + c.numPasses > maxCompressPassesGRK)
+		{
+			GRK_ERROR("Transcode: invalid contribution of %u passes to layer %u", c.numPasses,
+					  c.layno);
+			return false;
+		}
+		auto layer = cblk->layers + c.layno;
+		if(!layer->numpasses)
+			layer->data = block->data.data() + offset;
+		auto pass = cblk->passes + passno + c.numPasses - 1;
+		pass->len = c.numBytes;
+		pass->term = 1;
+		layer->numpasses += c.numPasses;
+		layer->len += c.numBytes;
+		passno += c.numPasses;
+		offset += c.numBytes;
+	}
+	cblk->numPassesTotal = passno;
+
+	return true;
+}
+
+} // namespace grk
@@ -0,0 +1,98 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace grk
+{
+/**
+ * Compressed data of a single code block, as parsed from source code stream
+ */
+struct TranscodeBlock
+{
+	TranscodeBlock() : numZeroBitPlanes(0) {}
+	uint8_t numZeroBitPlanes;
+	// per-packet segment contributions, in code stream order
+	std::vector<SegmentContribution> contributions;
+	// concatenated contribution data
+	std::vector<uint8_t> data;
+};
+
+// (component, resolution, band, precinct, code block)
+typedef std::tuple<uint16_t, uint8_t, uint8_t, uint64_t, uint64_t> TranscodeBlockKey;
+
+/**
+ * Compressed-domain transcoder
+ *
+ * Source code stream is decompressed up to and including T2: parsed code block
+ * contributions are collected for all kept resolutions and layers.
+ * Destination code stream is then compressed with T1 replaced by these
+ * contributions, so packets are simply re-generated with the new
+ * progression order, tile parts and markers.
+ * No entropy decoding or wavelet transform takes place.
+ *
+ * Optionally, Part 1 code blocks are entropy decoded to quantization indices
+ * during ingestion, and re-encoded with the HT block coder as a single
+ * cleanup pass in a single layer.
+ */
+class Transcoder
+{
+  public:
+	explicit Transcoder(grk_transcode_parameters* parameters);
+	/**
+	 * Transcode source code stream into destination code stream
+	 *
+	 * @param src source code stream, before header has been read
+	 * @param dest destination code stream, before it has been initialized
+	 */
+	bool transcode(ICodeStreamDecompress* src, ICodeStreamCompress* dest);
+	/**
+	 * Collect parsed code block data from decompressed tile (after T2)
+	 */
+	bool ingest(TileProcessor* tileProcessor);
+	/**
+	 * Fill compressed tile code blocks with collected code block data (in place of T1)
+	 */
+	bool fill(TileProcessor* tileProcessor);
+
+  private:
+	bool validate(CodingParams* cp, GrkImage* headerImage);
+	GrkImage* createImage(GrkImage* srcImage);
+	void setParameters(CodingParams* cp, GrkImage* srcImage, grk_cparameters* parameters);
+	bool copyCodingParams(CodingParams* srcCp, CodingParams* destCp, uint16_t numcomps);
+	bool fillBlock(Subband* band, CompressCodeblock* cblk, TranscodeBlock* block,
+				   uint16_t numLayers);
+
+	grk_transcode_parameters parameters_;
+	// number of layers kept
+	uint16_t numLayers_;
+	// reduced canvas and tile grid
+	grk_rect32 canvas_;
+	uint32_t tx0_;
+	uint32_t ty0_;
+	uint32_t t_width_;
+	uint32_t t_height_;
+	// collected code blocks for each tile:
+	// tiles may be ingested concurrently, as each tile has its own map
+	std::vector<std::map<TranscodeBlockKey, TranscodeBlock>> tiles_;
+};
+
+} // namespace grk
@@ -50,11 +50,13 @@ void SIZMarker::subsampleAndReduceHeaderImageComponents(GrkImage* headerImage,
 	for(uint32_t i = 0; i < headerImage->numcomps; ++i)
 	{
 		auto comp = headerImage->comps + i;
-		auto compBounds = imageBounds.scaleDownCeil(comp->dx, comp->dy);
-		comp->w = ceildivpow2<uint32_t>(compBounds.width(), reduce);
-		comp->h = ceildivpow2<uint32_t>(compBounds.height(), reduce);
-		comp->x0 = ceildivpow2<uint32_t>(compBounds.x0, reduce);
-		comp->y0 = ceildivpow2<uint32_t>(compBounds.y0, reduce);
+		// reduce bounds rather than dimensions, to match reduced tile resolution bounds
+		auto reducedCompBounds =
+			imageBounds.scaleDownCeil(comp->dx, comp->dy).scaleDownCeilPow2(reduce);
+		comp->x0 = reducedCompBounds.x0;
+		comp->y0 = reducedCompBounds.y0;
+		comp->w = reducedCompBounds.width();
+		comp->h = reducedCompBounds.height();
 	}
 }
 
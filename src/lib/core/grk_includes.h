@@ -101,8 +101,15 @@
 #include "MemStream.h"
 #include "GrkMappedFile.h"
 #include "GrkMatrix.h"
+#include "ConvertDataType.h"
+#include "ColourConversion.h"
+#include "ImageCompare.h"
+#include "Upsampler.h"
+#include "ColourTransformCache.h"
 #include "GrkImage.h"
 #include "StripCache.h"
+#include "SparseBlockPool.h"
+#include "CodeblockStateCache.h"
 #include "grk_exceptions.h"
 #include "SparseBuffer.h"
 #include "BitIO.h"
@@ -126,6 +133,7 @@
 #include "t1_common.h"
 #include "T1Interface.h"
 #include "Codeblock.h"
+#include "SlopeThresholdEstimator.h"
 #include "PacketParser.h"
 #include "ResSimple.h"
 #include "Precinct.h"
@@ -148,6 +156,7 @@
 #include "TileCache.h"
 #include "T2Compress.h"
 #include "T2Decompress.h"
+#include "Transcoder.h"
 #include "grk_intmath.h"
 #include "plugin_bridge.h"
 #include "RateControl.h"
@@ -124,9 +124,15 @@ bool GRK_CALLCONV grk_initialize(const char* pluginPath, uint32_t numthreads)
 	return is_plugin_initialized;
 }
 
+GRK_API void GRK_CALLCONV grk_set_memory_flags(uint32_t flags)
+{
+	grk::grk_set_memory_flags(flags);
+}
+
 GRK_API void GRK_CALLCONV grk_deinitialize()
 {
 	grk_plugin_cleanup();
+	ColourTransformCache::get()->clear();
 	ExecSingleton::release();
 }
 
@@ -223,6 +229,13 @@ grk_image_meta* GRK_CALLCONV grk_image_meta_new(void)
 	return (grk_image_meta*)(new GrkImageMeta());
 }
 
+bool GRK_CALLCONV grk_compare_images(const grk_image* base, const grk_image* test,
+									 const uint32_t* region, bool ssim,
+									 grk_image_comp_metrics* metrics)
+{
+	return compareImages(base, test, region, ssim, metrics);
+}
+
 /* DECOMPRESSION FUNCTIONS*/
 
 static const char* JP2_RFC3745_MAGIC = "\x00\x00\x00\x0c\x6a\x50\x20\x20\x0d\x0a\x87\x0a";
@@ -391,6 +404,17 @@ bool GRK_CALLCONV grk_decompress_tile(grk_codec* codecWrapper, uint16_t tileInde
 	}
 	return false;
 }
+bool GRK_CALLCONV grk_decompress_refine(grk_codec* codecWrapper, uint16_t max_layers)
+{
+	if(codecWrapper)
+	{
+		auto codec = GrkCodec::getImpl(codecWrapper);
+		bool rc = codec->decompressor_ ? codec->decompressor_->decompressRefine(max_layers) : false;
+		rc = rc && (codec->decompressor_ ? codec->decompressor_->postProcess() : false);
+		return rc;
+	}
+	return false;
+}
 void GRK_CALLCONV grk_dump_codec(grk_codec* codecWrapper, uint32_t info_flag, FILE* output_stream)
 {
 	assert(codecWrapper);
@@ -500,12 +524,16 @@ void GRK_CALLCONV grk_compress_set_default_params(grk_cparameters* parameters)
 	parameters->deviceId = 0;
 	parameters->repeats = 1;
 }
-grk_codec* GRK_CALLCONV grk_compress_init(grk_stream_params* stream_params,
-										  grk_cparameters* parameters, grk_image* p_image)
+/**
+ * Create compression codec and its output stream
+ *
+ * @param stream_params	output stream parameters
+ * @param cod_format	output format
+ */
+static grk_codec* grk_compress_create_from_stream_params(grk_stream_params* stream_params,
+														 GRK_SUPPORTED_FILE_FMT cod_format)
 {
-	if(!parameters || !p_image)
-		return nullptr;
-	if(parameters->cod_format != GRK_FMT_J2K && parameters->cod_format != GRK_FMT_JP2)
+	if(cod_format != GRK_FMT_J2K && cod_format != GRK_FMT_JP2)
 	{
 		GRK_ERROR("Unknown stream format.");
 		return nullptr;
@@ -526,18 +554,18 @@ grk_codec* GRK_CALLCONV grk_compress_init(grk_stream_params* stream_params,
 		return nullptr;
 	}
 
-	grk_codec* codecWrapper = nullptr;
-	switch(parameters->cod_format)
-	{
-		case GRK_FMT_J2K: /* JPEG 2000 code stream */
-			codecWrapper = grk_compress_create(GRK_CODEC_J2K, stream);
-			break;
-		case GRK_FMT_JP2: /* JPEG 2000 compressed image data */
-			codecWrapper = grk_compress_create(GRK_CODEC_JP2, stream);
-			break;
-		default:
-			break;
-	}
+	return grk_compress_create(cod_format == GRK_FMT_J2K ? GRK_CODEC_J2K : GRK_CODEC_JP2,
+							   stream);
+}
+grk_codec* GRK_CALLCONV grk_compress_init(grk_stream_params* stream_params,
+										  grk_cparameters* parameters, grk_image* p_image)
+{
+	if(!parameters || !p_image)
+		return nullptr;
+	auto codecWrapper =
+		grk_compress_create_from_stream_params(stream_params, parameters->cod_format);
+	if(!codecWrapper)
+		return nullptr;
 
 	auto codec = GrkCodec::getImpl(codecWrapper);
 	bool rc = codec->compressor_ ? codec->compressor_->init(parameters, (GrkImage*)p_image) : false;
@@ -573,6 +601,42 @@ bool GRK_CALLCONV grk_compress(grk_codec* codecWrapper, grk_plugin_tile* tile)
 	}
 	return false;
 }
+void GRK_CALLCONV grk_transcode_set_default_params(grk_transcode_parameters* parameters)
+{
+	if(!parameters)
+		return;
+
+	memset(parameters, 0, sizeof(grk_transcode_parameters));
+	parameters->prog_order = GRK_PROG_UNKNOWN;
+	parameters->cod_format = GRK_FMT_J2K;
+}
+bool GRK_CALLCONV grk_transcode(grk_stream_params* src_stream_params,
+								grk_stream_params* dest_stream_params,
+								grk_transcode_parameters* parameters)
+{
+	if(!src_stream_params || !dest_stream_params || !parameters)
+		return false;
+	grk_decompress_core_params core_params;
+	grk_decompress_set_default_params(&core_params);
+	core_params.reduce = parameters->reduce;
+	core_params.max_layers = parameters->max_layers;
+	auto srcWrapper = grk_decompress_init(src_stream_params, &core_params);
+	if(!srcWrapper)
+		return false;
+	bool rc = false;
+	auto destWrapper =
+		grk_compress_create_from_stream_params(dest_stream_params, parameters->cod_format);
+	if(destWrapper)
+	{
+		Transcoder transcoder(parameters);
+		rc = transcoder.transcode(GrkCodec::getImpl(srcWrapper)->decompressor_,
+								  GrkCodec::getImpl(destWrapper)->compressor_);
+		grk_object_unref(destWrapper);
+	}
+	grk_object_unref(srcWrapper);
+
+	return rc;
+}
 static void grkFree_file(void* p_user_data)
 {
 	if(p_user_data)
@@ -220,6 +220,20 @@ typedef enum _GRK_SUPPORTED_FILE_FMT
 	GRK_FMT_JPG
 } GRK_SUPPORTED_FILE_FMT;
 
+/**
+ * Sample data type of decompressed image components
+ *
+ * Samples are clamped to the range of the data type.
+ */
+typedef enum _GRK_DATA_TYPE
+{
+	GRK_INT_32, /* default */
+	GRK_UINT_8,
+	GRK_UINT_16,
+	GRK_INT_16,
+	GRK_FLOAT_32
+} GRK_DATA_TYPE;
+
 #define GRK_PATH_LEN 4096 /* Maximum allowed filename size */
 #define GRK_MAX_LAYERS 100 /* Maximum number of quality layers */
 
@@ -346,6 +360,15 @@ typedef enum _grk_precision_mode
 	GRK_PREC_MODE_SCALE
 } grk_precision_mode;
 
+/**
+ * Upsampling filter for sub-sampled components
+ */
+typedef enum _GRK_UPSAMPLE_FILTER
+{
+	GRK_UPSAMPLE_NEAREST, /* replicate nearest sample */
+	GRK_UPSAMPLE_BILINEAR /* interpolate between neighbouring samples */
+} GRK_UPSAMPLE_FILTER;
+
 /**
  * Precision
  */
@@ -431,6 +454,20 @@ typedef struct _grk_header_info
 
 	grk_asoc asocs[GRK_NUM_ASOC_BOXES_SUPPORTED];
 	uint32_t num_asocs;
+
+	/******************************************
+	set by client only if not decompressing to file
+	*******************************************/
+	/* sample data type of decompressed image */
+	GRK_DATA_TYPE outputDataType;
+	/****************************************/
+
+	/******************************************
+	set by client only if decompressing to file
+	*******************************************/
+	/* filter used to upsample components */
+	GRK_UPSAMPLE_FILTER upsampleFilter;
+	/****************************************/
 } grk_header_info;
 
 typedef struct _grk_io_buf
@@ -471,7 +508,8 @@ typedef struct _grk_stream_params
 typedef enum _GRK_TILE_CACHE_STRATEGY
 {
 	GRK_TILE_CACHE_NONE, /* no tile caching */
-	GRK_TILE_CACHE_IMAGE /* cache final tile image */
+	GRK_TILE_CACHE_IMAGE, /* cache final tile image */
+	GRK_TILE_CACHE_REFINE /* cache code block decoder state, for grk_decompress_refine */
 } GRK_TILE_CACHE_STRATEGY;
 
 /**
@@ -564,6 +602,9 @@ typedef struct _grk_decompress_params
 	uint32_t kernelBuildOptions;
 	uint32_t repeats;
 	uint32_t numThreads;
+	uint32_t memoryFlags; /* or'd combination of GRK_MEMORY_* flags */
+	/* filter used to upsample components */
+	GRK_UPSAMPLE_FILTER upsample_filter;
 } grk_decompress_parameters;
 
 /**
@@ -595,8 +636,10 @@ typedef struct _grk_image_comp
 	GRK_CHANNEL_ASSOC association;
 	/* component registration coordinates */
 	uint16_t Xcrg, Ycrg;
-	/** image component data */
+	/** image component data : cast to data_type if it differs from GRK_INT_32 */
 	int32_t* data;
+	/** type of samples pointed to by data; stride is measured in samples */
+	GRK_DATA_TYPE data_type;
 } grk_image_comp;
 
 /* Image meta data: colour, IPTC and XMP */
@@ -650,6 +693,8 @@ typedef struct _grk_image
 	uint64_t packedRowBytes;
 	grk_image_meta* meta;
 	grk_image_comp* comps;
+	GRK_DATA_TYPE outputDataType;
+	GRK_UPSAMPLE_FILTER upsampleFilter;
 } grk_image;
 
 /*************************************************
@@ -759,6 +804,19 @@ GRK_API const char* GRK_CALLCONV grk_version(void);
  */
 GRK_API bool GRK_CALLCONV grk_initialize(const char* pluginPath, uint32_t numthreads);
 
+/**
+ * Memory allocation flags
+ */
+#define GRK_MEMORY_HUGE_PAGES 1 /* back large buffers with transparent huge pages (Linux) */
+#define GRK_MEMORY_FIRST_TOUCH 2 /* clear large shared buffers from worker threads (NUMA) */
+
+/**
+ * Set memory allocation flags. Should be called before any codec is created.
+ *
+ * @param flags 	or'd combination of GRK_MEMORY_* flags
+ */
+GRK_API void GRK_CALLCONV grk_set_memory_flags(uint32_t flags);
+
 /**
  * De-initialize library
  */
@@ -794,6 +852,47 @@ GRK_API grk_image* GRK_CALLCONV grk_image_new(uint16_t numcmpts, grk_image_comp*
 
 GRK_API grk_image_meta* GRK_CALLCONV grk_image_meta_new(void);
 
+/**
+ * Image comparison metrics for a single component
+ */
+typedef struct _grk_image_comp_metrics
+{
+	/** number of samples that differ */
+	uint64_t num_diff;
+	/** sum of sample differences (base - test) */
+	double sum_diff;
+	/** maximum absolute sample difference */
+	double peak;
+	/** mean squared error */
+	double mse;
+	/** peak signal to noise ratio in dB : infinite if components are identical */
+	double psnr;
+	/** mean structural similarity over 8x8 blocks : zero if not calculated */
+	double ssim;
+} grk_image_comp_metrics;
+
+/**
+ * Compare test image with base (reference) image, for example a decompressed
+ * image with its source image, without writing either image to file.
+ * Components are compared in parallel strips. All components must have
+ * GRK_INT_32 data type, so images decompressed with another output data type
+ * are rejected.
+ *
+ * @param base      base image
+ * @param test      test image, with same number of components, precision and sign
+ * as base image
+ * @param region    base component region x0,y0,x1,y1 to compare with test components,
+ * which must have the region dimensions. If nullptr, whole components are compared,
+ * and test components must have base component dimensions.
+ * @param ssim      if true, calculate structural similarity
+ * @param metrics   array of metrics, one per component
+ *
+ * @return true if images were compared, otherwise false
+ */
+GRK_API bool GRK_CALLCONV grk_compare_images(const grk_image* base, const grk_image* test,
+											 const uint32_t* region, bool ssim,
+											 grk_image_comp_metrics* metrics);
+
 /**
  * Detect jpeg 2000 format from file
  * Format is either GRK_FMT_J2K or GRK_FMT_JP2
@@ -904,6 +1003,22 @@ GRK_API bool GRK_CALLCONV grk_decompress(grk_codec* codec, grk_plugin_tile* tile
  */
 GRK_API bool GRK_CALLCONV grk_decompress_tile(grk_codec* codec, uint16_t tileIndex);
 
+/**
+ * Refine a previous decompression with additional quality layers
+ *
+ * Codec must have been initialized with GRK_TILE_CACHE_REFINE tile cache strategy
+ * and a non-zero number of layers, and grk_decompress must have completed successfully.
+ * Code blocks resume decoding from the state retained by the previous decompression,
+ * so only coding passes contributed by the new layers are decoded.
+ *
+ * @param	codec			decompression codec
+ * @param	max_layers		new number of quality layers to decompress: must be greater than
+ * 							the number previously decompressed, or 0 for all layers
+ *
+ * @return					true if successful, otherwise false
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_refine(grk_codec* codec, uint16_t max_layers);
+
 /* COMPRESSION FUNCTIONS*/
 
 /**
@@ -1032,6 +1147,14 @@ typedef struct _grk_cparameters
 	bool writePLT;
 	bool writeTLM;
 	bool verbose;
+	/* Skip coding of passes that rate control is certain to discard.
+	 * A pass is skipped when its distortion-rate slope falls below the
+	 * estimated final layer threshold divided by this margin.
+	 * Must be >= 1 (larger is safer); 0 disables. Only used when
+	 * the final layer is rate limited with -r, since its byte budget
+	 * bounds the threshold */
+	double passTruncationMargin;
+	uint32_t memoryFlags; /* or'd combination of GRK_MEMORY_* flags */
 } grk_cparameters;
 
 /**
@@ -1075,6 +1198,60 @@ GRK_API grk_codec* GRK_CALLCONV grk_compress_init(grk_stream_params* stream_para
  */
 GRK_API bool GRK_CALLCONV grk_compress(grk_codec* codec, grk_plugin_tile* tile);
 
+/**
+ * Transcoding parameters
+ */
+typedef struct _grk_transcode_parameters
+{
+	/** number of highest resolution levels to be discarded */
+	uint8_t reduce;
+	/** maximum number of quality layers to keep: if zero, all layers are kept */
+	uint16_t max_layers;
+	/** progression order: if GRK_PROG_UNKNOWN, source progression order is kept */
+	GRK_PROG_ORDER prog_order;
+	/** enable tile part generation */
+	bool enableTilePartGeneration;
+	/** new tile part progression divider */
+	uint8_t newTilePartProgressionDivider;
+	/** write PLT marker */
+	bool writePLT;
+	/** write TLM marker */
+	bool writeTLM;
+	/** re-encode Part 1 code blocks with High Throughput (Part 15) block coder */
+	bool ht;
+	/** output file format : GRK_FMT_J2K or GRK_FMT_JP2 */
+	GRK_SUPPORTED_FILE_FMT cod_format;
+} grk_transcode_parameters;
+
+/**
+ Set transcoding parameters to default values:
+
+ Keep all resolutions and layers
+ Keep source progression order
+ No tile parts, PLT or TLM markers
+ Keep source block coder
+
+ @param parameters Transcoding parameters
+ */
+GRK_API void GRK_CALLCONV grk_transcode_set_default_params(grk_transcode_parameters* parameters);
+
+/**
+ * Transcode a JPEG 2000 code stream without entropy decoding or wavelet transform.
+ * Compressed code block data is re-packetized: highest resolutions and quality layers
+ * may be discarded, and progression order, tile parts and TLM/PLT markers may be changed.
+ * Optionally, Part 1 code blocks are entropy decoded to quantization indices
+ * and re-encoded with the High Throughput block coder, producing a single quality layer.
+ *
+ * @param src_stream_params		source stream parameters
+ * @param dest_stream_params	destination stream parameters
+ * @param parameters			transcoding parameters
+ *
+ * @return 				Returns true if successful, returns false otherwise
+ */
+GRK_API bool GRK_CALLCONV grk_transcode(grk_stream_params* src_stream_params,
+										grk_stream_params* dest_stream_params,
+										grk_transcode_parameters* parameters);
+
 /**
  * Dump codec information to file
  *
@@ -1330,6 +1507,8 @@ GRK_API bool GRK_CALLCONV grk_set_MCT(grk_cparameters* parameters, float* encodi
 #define GRK_RANDOM_ACCESS_PLT 1 /* use PLT marker if present */
 #define GRK_RANDOM_ACCESS_TLM 2 /* use TLM marker if present */
 #define GRK_RANDOM_ACCESS_PLM 4 /* use PLM marker if present */
+#define GRK_RANDOM_ACCESS_PREFETCH 8 /* prefetch scheduled tile parts of mapped file using TLM */
+#define GRK_RANDOM_ACCESS_RELEASE 16 /* release consumed tile parts of mapped file */
 
 /*************************************************************************************
  Plugin Interface
@@ -30,6 +30,71 @@ namespace grk
 namespace HWY_NAMESPACE
 {
 	using namespace hwy::HWY_NAMESPACE;
+	/**
+	 * Row of decompressed output for a tile component: either written back to
+	 * the tile buffer, or to the component's destination window in the composite image
+	 */
+	class DestRow
+	{
+	  public:
+		DestRow(const ScheduleInfo& info, size_t index, int32_t* src, uint32_t y, uint32_t width)
+			: src_(src), width_(width), dest32_(nullptr), dest_(nullptr), dataType_(GRK_INT_32)
+		{
+			// tile buffer may have more rows than tile component window
+			if(index >= info.dest.size() || y >= info.dest[index].height_)
+				return;
+			auto& dest = info.dest[index];
+			dataType_ = dest.dataType_;
+			auto row = (uint8_t*)dest.buf_ + (size_t)y * dest.stride_ * dataTypeSize(dataType_);
+			if(dataType_ == GRK_INT_32)
+				dest32_ = (int32_t*)row;
+			else
+				dest_ = row;
+		}
+		template<class D, class V>
+		void store(D d, V v, size_t x)
+		{
+			if(dest32_ && x + Lanes(d) <= width_)
+			{
+				StoreU(v, d, dest32_ + x);
+				return;
+			}
+			// partial vector at end of row goes through padded tile buffer
+			Store(v, d, src_ + x);
+			if(dest32_)
+				memcpy(dest32_ + x, src_ + x, (width_ - x) * sizeof(int32_t));
+		}
+		void flush(void)
+		{
+			if(dest_)
+				grk::convertDataType(dest_, src_, width_, dataType_);
+		}
+
+	  private:
+		int32_t* src_;
+		uint32_t width_;
+		int32_t* dest32_;
+		uint8_t* dest_;
+		GRK_DATA_TYPE dataType_;
+	};
+
+	/**
+	 * Convert precision of clamped samples: left shift, or right shift
+	 * rounding towards zero (as integer division does) if shift is negative
+	 */
+	template<class D, class V>
+	V convertPrecision(D d, V v, int32_t shift)
+	{
+		if(shift > 0)
+			return ShiftLeftSame(v, shift);
+		if(shift < 0)
+		{
+			auto bias = And(BroadcastSignBit(v), Set(d, (1 << -shift) - 1));
+			return ShiftRightSame(v + bias, -shift);
+		}
+		return v;
+	}
+
 	/**
 	 * Apply dc shift for irreversible decompressed image.
 	 * (assumes mono with no  MCT)
@@ -40,22 +105,26 @@ namespace HWY_NAMESPACE
 	  public:
 		void transform(ScheduleInfo info)
 		{
-			auto highestResBuffer =
-				info.tile->comps[info.compno].getWindow()->getResWindowBufferHighestSimpleF();
+			auto window = info.tile->comps[info.compno].getWindow();
+			auto highestResBuffer = window->getResWindowBufferHighestSimpleF();
+			auto width = window->bounds().width();
 			std::vector<ShiftInfo>& shiftInfo = info.shiftInfo;
-			auto index = (uint64_t)info.yBegin * highestResBuffer.stride_;
-			auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * highestResBuffer.stride_;
-			auto chan0 = (float*)highestResBuffer.buf_;
 			const HWY_FULL(int32_t) di;
 			const HWY_FULL(float) df;
 			auto vshift = Set(di, shiftInfo[0]._shift);
 			auto vmin = Set(di, shiftInfo[0]._min);
 			auto vmax = Set(di, shiftInfo[0]._max);
-			size_t begin = index;
-			for(auto j = begin; j < begin + chunkSize; j += Lanes(di))
+			auto precShift = shiftInfo[0]._precShift;
+			for(uint32_t y = info.yBegin; y < info.yEnd; ++y)
 			{
-				auto ni = Clamp(NearestInt(Load(df, chan0 + j)) + vshift, vmin, vmax);
-				Store(ni, di, (int32_t*)(chan0 + j));
+				auto chan0 = highestResBuffer.buf_ + (uint64_t)y * highestResBuffer.stride_;
+				DestRow dest0(info, 0, (int32_t*)chan0, y, width);
+				for(size_t x = 0; x < width; x += Lanes(di))
+				{
+					auto v = Clamp(NearestInt(Load(df, chan0 + x)) + vshift, vmin, vmax);
+					dest0.store(di, convertPrecision(di, v, precShift), x);
+				}
+				dest0.flush();
 			}
 			if(info.stripCache_->isInitialized() && !info.stripCache_->isMultiTile())
 				info.stripCache_->ingestStrip(ExecSingleton::threadId(), info.tile, info.yBegin,
@@ -73,22 +142,25 @@ namespace HWY_NAMESPACE
 	  public:
 		void transform(ScheduleInfo info)
 		{
-			auto highestResBufferStride =
-				info.tile->comps[info.compno].getWindow()->getResWindowBufferHighestStride();
-			auto index = (uint64_t)info.yBegin * highestResBufferStride;
-			auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * highestResBufferStride;
+			auto window = info.tile->comps[info.compno].getWindow();
+			auto highestResBuffer = window->getResWindowBufferHighestSimple();
+			auto width = window->bounds().width();
 			std::vector<ShiftInfo>& shiftInfo = info.shiftInfo;
-			auto chan0 =
-				info.tile->comps[info.compno].getWindow()->getResWindowBufferHighestSimple().buf_;
 			const HWY_FULL(int32_t) di;
 			auto vshift = Set(di, shiftInfo[0]._shift);
 			auto vmin = Set(di, shiftInfo[0]._min);
 			auto vmax = Set(di, shiftInfo[0]._max);
-			size_t begin = index;
-			for(auto j = begin; j < begin + chunkSize; j += Lanes(di))
+			auto precShift = shiftInfo[0]._precShift;
+			for(uint32_t y = info.yBegin; y < info.yEnd; ++y)
 			{
-				auto ni = Clamp(Load(di, chan0 + j) + vshift, vmin, vmax);
-				Store(ni, di, chan0 + j);
+				auto chan0 = highestResBuffer.buf_ + (uint64_t)y * highestResBuffer.stride_;
+				DestRow dest0(info, 0, chan0, y, width);
+				for(size_t x = 0; x < width; x += Lanes(di))
+				{
+					auto v = Clamp(Load(di, chan0 + x) + vshift, vmin, vmax);
+					dest0.store(di, convertPrecision(di, v, precShift), x);
+				}
+				dest0.flush();
 			}
 			if(info.stripCache_->isInitialized() && !info.stripCache_->isMultiTile())
 				info.stripCache_->ingestStrip(ExecSingleton::threadId(), info.tile, info.yBegin,
@@ -104,17 +176,18 @@ namespace HWY_NAMESPACE
 	  public:
 		void transform(ScheduleInfo info)
 		{
-			auto highestResBufferStride =
-				info.tile->comps[info.compno].getWindow()->getResWindowBufferHighestStride();
-			auto index = (uint64_t)info.yBegin * highestResBufferStride;
-			auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * highestResBufferStride;
+			auto window = info.tile->comps[info.compno].getWindow();
+			auto highestResBufferStride = window->getResWindowBufferHighestStride();
+			auto width = window->bounds().width();
 			std::vector<ShiftInfo>& shiftInfo = info.shiftInfo;
-			auto chan0 = info.tile->comps[0].getWindow()->getResWindowBufferHighestSimple().buf_;
-			auto chan1 = info.tile->comps[1].getWindow()->getResWindowBufferHighestSimple().buf_;
-			auto chan2 = info.tile->comps[2].getWindow()->getResWindowBufferHighestSimple().buf_;
+			auto buf0 = info.tile->comps[0].getWindow()->getResWindowBufferHighestSimple().buf_;
+			auto buf1 = info.tile->comps[1].getWindow()->getResWindowBufferHighestSimple().buf_;
+			auto buf2 = info.tile->comps[2].getWindow()->getResWindowBufferHighestSimple().buf_;
 			int32_t shift[3] = {shiftInfo[0]._shift, shiftInfo[1]._shift, shiftInfo[2]._shift};
 			int32_t _min[3] = {shiftInfo[0]._min, shiftInfo[1]._min, shiftInfo[2]._min};
 			int32_t _max[3] = {shiftInfo[0]._max, shiftInfo[1]._max, shiftInfo[2]._max};
+			int32_t precShift[3] = {shiftInfo[0]._precShift, shiftInfo[1]._precShift,
+									shiftInfo[2]._precShift};
 
 			const HWY_FULL(int32_t) di;
 			auto vdcr = Set(di, shift[0]);
@@ -127,18 +200,33 @@ namespace HWY_NAMESPACE
 			auto maxg = Set(di, _max[1]);
 			auto maxb = Set(di, _max[2]);
 
-			size_t begin = index;
-			for(auto j = begin; j < begin + chunkSize; j += Lanes(di))
+			for(uint32_t y = info.yBegin; y < info.yEnd; ++y)
 			{
-				auto y = Load(di, chan0 + j);
-				auto u = Load(di, chan1 + j);
-				auto v = Load(di, chan2 + j);
-				auto g = y - ShiftRight<2>(u + v);
-				auto r = v + g;
-				auto b = u + g;
-				Store(Clamp(r + vdcr, minr, maxr), di, chan0 + j);
-				Store(Clamp(g + vdcg, ming, maxg), di, chan1 + j);
-				Store(Clamp(b + vdcb, minb, maxb), di, chan2 + j);
+				auto index = (uint64_t)y * highestResBufferStride;
+				auto chan0 = buf0 + index;
+				auto chan1 = buf1 + index;
+				auto chan2 = buf2 + index;
+				DestRow dest0(info, 0, chan0, y, width);
+				DestRow dest1(info, 1, chan1, y, width);
+				DestRow dest2(info, 2, chan2, y, width);
+				for(size_t x = 0; x < width; x += Lanes(di))
+				{
+					auto vy = Load(di, chan0 + x);
+					auto vu = Load(di, chan1 + x);
+					auto vv = Load(di, chan2 + x);
+					auto g = vy - ShiftRight<2>(vu + vv);
+					auto r = vv + g;
+					auto b = vu + g;
+					r = Clamp(r + vdcr, minr, maxr);
+					g = Clamp(g + vdcg, ming, maxg);
+					b = Clamp(b + vdcb, minb, maxb);
+					dest0.store(di, convertPrecision(di, r, precShift[0]), x);
+					dest1.store(di, convertPrecision(di, g, precShift[1]), x);
+					dest2.store(di, convertPrecision(di, b, precShift[2]), x);
+				}
+				dest0.flush();
+				dest1.flush();
+				dest2.flush();
 			}
 		}
 	};
@@ -151,18 +239,13 @@ namespace HWY_NAMESPACE
 	  public:
 		void transform(ScheduleInfo info)
 		{
-			auto highestResBufferStride =
-				info.tile->comps[info.compno].getWindow()->getResWindowBufferHighestStride();
-			auto index = (uint64_t)info.yBegin * highestResBufferStride;
-			auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * highestResBufferStride;
+			auto window = info.tile->comps[info.compno].getWindow();
+			auto highestResBufferStride = window->getResWindowBufferHighestStride();
+			auto width = window->bounds().width();
 			std::vector<ShiftInfo>& shiftInfo = info.shiftInfo;
-			auto chan0 = info.tile->comps[0].getWindow()->getResWindowBufferHighestSimpleF().buf_;
-			auto chan1 = info.tile->comps[1].getWindow()->getResWindowBufferHighestSimpleF().buf_;
-			auto chan2 = info.tile->comps[2].getWindow()->getResWindowBufferHighestSimpleF().buf_;
-
-			auto c0 = (int32_t*)chan0;
-			auto c1 = (int32_t*)chan1;
-			auto c2 = (int32_t*)chan2;
+			auto buf0 = info.tile->comps[0].getWindow()->getResWindowBufferHighestSimpleF().buf_;
+			auto buf1 = info.tile->comps[1].getWindow()->getResWindowBufferHighestSimpleF().buf_;
+			auto buf2 = info.tile->comps[2].getWindow()->getResWindowBufferHighestSimpleF().buf_;
 
 			const HWY_FULL(float) df;
 			const HWY_FULL(int32_t) di;
@@ -170,6 +253,8 @@ namespace HWY_NAMESPACE
 			int32_t shift[3] = {shiftInfo[0]._shift, shiftInfo[1]._shift, shiftInfo[2]._shift};
 			int32_t _min[3] = {shiftInfo[0]._min, shiftInfo[1]._min, shiftInfo[2]._min};
 			int32_t _max[3] = {shiftInfo[0]._max, shiftInfo[1]._max, shiftInfo[2]._max};
+			int32_t precShift[3] = {shiftInfo[0]._precShift, shiftInfo[1]._precShift,
+									shiftInfo[2]._precShift};
 			auto vdcr = Set(di, shift[0]);
 			auto vdcg = Set(di, shift[1]);
 			auto vdcb = Set(di, shift[2]);
@@ -185,19 +270,34 @@ namespace HWY_NAMESPACE
 			auto vgv = Set(df, 0.71414f);
 			auto vbu = Set(df, 1.772f);
 
-			size_t begin = index;
-			for(auto j = begin; j < begin + chunkSize; j += Lanes(di))
+			for(uint32_t y = info.yBegin; y < info.yEnd; ++y)
 			{
-				auto vy = Load(df, chan0 + j);
-				auto vu = Load(df, chan1 + j);
-				auto vv = Load(df, chan2 + j);
-				auto vr = vy + vv * vrv;
-				auto vg = vy - vu * vgu - vv * vgv;
-				auto vb = vy + vu * vbu;
-
-				Store(Clamp(NearestInt(vr) + vdcr, minr, maxr), di, c0 + j);
-				Store(Clamp(NearestInt(vg) + vdcg, ming, maxg), di, c1 + j);
-				Store(Clamp(NearestInt(vb) + vdcb, minb, maxb), di, c2 + j);
+				auto index = (uint64_t)y * highestResBufferStride;
+				auto chan0 = buf0 + index;
+				auto chan1 = buf1 + index;
+				auto chan2 = buf2 + index;
+				DestRow dest0(info, 0, (int32_t*)chan0, y, width);
+				DestRow dest1(info, 1, (int32_t*)chan1, y, width);
+				DestRow dest2(info, 2, (int32_t*)chan2, y, width);
+				for(size_t x = 0; x < width; x += Lanes(di))
+				{
+					auto vy = Load(df, chan0 + x);
+					auto vu = Load(df, chan1 + x);
+					auto vv = Load(df, chan2 + x);
+					auto vr = vy + vv * vrv;
+					auto vg = vy - vu * vgu - vv * vgv;
+					auto vb = vy + vu * vbu;
+
+					auto r = Clamp(NearestInt(vr) + vdcr, minr, maxr);
+					auto g = Clamp(NearestInt(vg) + vdcg, ming, maxg);
+					auto b = Clamp(NearestInt(vb) + vdcb, minb, maxb);
+					dest0.store(di, convertPrecision(di, r, precShift[0]), x);
+					dest1.store(di, convertPrecision(di, g, precShift[1]), x);
+					dest2.store(di, convertPrecision(di, b, precShift[2]), x);
+				}
+				dest0.flush();
+				dest1.flush();
+				dest2.flush();
 			}
 		}
 	};
@@ -281,7 +381,9 @@ namespace HWY_NAMESPACE
 				auto g = ConvertTo(df, Load(di, chan1 + j) + vdcg);
 				auto b = ConvertTo(df, Load(di, chan2 + j) + vdcb);
 
-				auto y = va_r * r + va_g * g + va_b * b;
+				// this file is compiled without floating point contraction,
+				// so fused multiply-adds are explicit
+				auto y = MulAdd(va_b, b, MulAdd(va_g, g, va_r * r));
 				auto u = vcb * (b - y);
 				auto v = vcr * (r - y);
 
@@ -353,6 +455,140 @@ namespace HWY_NAMESPACE
 			}
 		}
 	}
+	/**
+	 * Inverse custom MCT of rows [row, row + R) of matrix, for samples [begin, end)
+	 * of all components. Each output sample is accumulated over input components
+	 * in component order, with separate multiply and add, so result is identical
+	 * to scalar transform.
+	 */
+	template<size_t R>
+	void inverseCustomRows(const float* matrix, uint16_t numComps, uint16_t row, float** data,
+						   size_t begin, size_t end, float* out)
+	{
+		const HWY_FULL(float) df;
+		const size_t N = Lanes(df);
+		const size_t width = end - begin;
+		size_t x = 0;
+		for(; x + 2 * N <= width; x += 2 * N)
+		{
+			Vec<decltype(df)> acc[R][2];
+			for(size_t r = 0; r < R; ++r)
+				acc[r][0] = acc[r][1] = Zero(df);
+			for(uint16_t k = 0; k < numComps; ++k)
+			{
+				auto in = data[k] + begin + x;
+				auto v0 = LoadU(df, in);
+				auto v1 = LoadU(df, in + N);
+				for(size_t r = 0; r < R; ++r)
+				{
+					auto m = Set(df, matrix[(size_t)(row + r) * numComps + k]);
+					acc[r][0] = acc[r][0] + m * v0;
+					acc[r][1] = acc[r][1] + m * v1;
+				}
+			}
+			for(size_t r = 0; r < R; ++r)
+			{
+				StoreU(acc[r][0], df, out + (row + r) * width + x);
+				StoreU(acc[r][1], df, out + (row + r) * width + x + N);
+			}
+		}
+		for(; x < width; ++x)
+		{
+			for(size_t r = 0; r < R; ++r)
+			{
+				float acc = 0;
+				for(uint16_t k = 0; k < numComps; ++k)
+					acc += matrix[(size_t)(row + r) * numComps + k] * data[k][begin + x];
+				out[(row + r) * width + x] = acc;
+			}
+		}
+	}
+
+	/**
+	 * Forward custom MCT of rows [row, row + R) of fixed point matrix, for samples
+	 * [begin, end) of all components. Fixed point products are calculated exactly
+	 * in double precision, and rounded as fix_mul rounds them.
+	 */
+	template<size_t R>
+	void forwardCustomRows(const double* matrix, uint16_t numComps, uint16_t row,
+						   int32_t** data, size_t begin, size_t end, int32_t* out)
+	{
+		const HWY_FULL(double) dd;
+		const Rebind<int32_t, decltype(dd)> di;
+		const size_t N = Lanes(dd);
+		const size_t width = end - begin;
+		auto half = Set(dd, 4096.0);
+		auto scale = Set(dd, 1.0 / 8192.0);
+		size_t x = 0;
+		for(; x + N <= width; x += N)
+		{
+			Vec<decltype(di)> acc[R];
+			for(size_t r = 0; r < R; ++r)
+				acc[r] = Zero(di);
+			for(uint16_t k = 0; k < numComps; ++k)
+			{
+				auto v = PromoteTo(dd, LoadU(di, data[k] + begin + x));
+				for(size_t r = 0; r < R; ++r)
+				{
+					auto m = Set(dd, matrix[(size_t)(row + r) * numComps + k]);
+					acc[r] = acc[r] + DemoteTo(di, Floor((m * v + half) * scale));
+				}
+			}
+			for(size_t r = 0; r < R; ++r)
+				StoreU(acc[r], di, out + (row + r) * width + x);
+		}
+		for(; x < width; ++x)
+		{
+			for(size_t r = 0; r < R; ++r)
+			{
+				int32_t acc = 0;
+				for(uint16_t k = 0; k < numComps; ++k)
+					acc += fix_mul((int32_t)matrix[(size_t)(row + r) * numComps + k],
+								   data[k][begin + x]);
+				out[(row + r) * width + x] = acc;
+			}
+		}
+	}
+
+	/**
+	 * Apply custom MCT to block of samples [begin, end) of all components,
+	 * four matrix rows at a time. Block is transformed into scratch buffer,
+	 * which is then copied back to the components.
+	 */
+	template<typename T, typename M>
+	void customBlock(const M* matrix, uint16_t numComps, T** data, size_t begin, size_t end,
+					 T* out,
+					 void (*rows[4])(const M*, uint16_t, uint16_t, T**, size_t, size_t, T*))
+	{
+		for(uint16_t row = 0; row < numComps;)
+		{
+			uint16_t numRows = (uint16_t)std::min<uint32_t>(4U, (uint32_t)(numComps - row));
+			rows[numRows - 1](matrix, numComps, row, data, begin, end, out);
+			row = (uint16_t)(row + numRows);
+		}
+		size_t width = end - begin;
+		for(uint16_t j = 0; j < numComps; ++j)
+			memcpy(data[j] + begin, out + (size_t)j * width, width * sizeof(T));
+	}
+
+	void hwy_decompress_custom_block(const float* matrix, uint16_t numComps, float** data,
+									 size_t begin, size_t end, float* out)
+	{
+		void (*rows[4])(const float*, uint16_t, uint16_t, float**, size_t, size_t, float*) = {
+			inverseCustomRows<1>, inverseCustomRows<2>, inverseCustomRows<3>,
+			inverseCustomRows<4>};
+		customBlock(matrix, numComps, data, begin, end, out, rows);
+	}
+
+	void hwy_compress_custom_block(const double* matrix, uint16_t numComps, int32_t** data,
+								   size_t begin, size_t end, int32_t* out)
+	{
+		void (*rows[4])(const double*, uint16_t, uint16_t, int32_t**, size_t, size_t,
+						int32_t*) = {forwardCustomRows<1>, forwardCustomRows<2>,
+									 forwardCustomRows<3>, forwardCustomRows<4>};
+		customBlock(matrix, numComps, data, begin, end, out, rows);
+	}
+
 	void hwy_compress_rev(ScheduleInfo info)
 	{
 		vscheduler<CompressRev>(info);
@@ -395,6 +631,8 @@ HWY_EXPORT(hwy_decompress_rev);
 HWY_EXPORT(hwy_decompress_irrev);
 HWY_EXPORT(hwy_decompress_dc_shift_irrev);
 HWY_EXPORT(hwy_decompress_dc_shift_rev);
+HWY_EXPORT(hwy_decompress_custom_block);
+HWY_EXPORT(hwy_compress_custom_block);
 
 mct::mct(Tile* tile, GrkImage* image, TileCodingParams* tcp, StripCache* stripCache)
 	: tile_(tile), image_(image), tcp_(tcp), stripCache_(stripCache)
@@ -407,6 +645,7 @@ void mct::decompress_dc_shift_irrev(FlowComponent* flow, uint16_t compno)
 	ScheduleInfo info(tile_, flow, stripCache_, image_->rowsPerTask);
 	info.compno = compno;
 	genShift(compno, 1, info.shiftInfo);
+	genDest(compno, info.dest);
 	HWY_DYNAMIC_DISPATCH(hwy_decompress_dc_shift_irrev)(info);
 }
 /***
@@ -417,18 +656,19 @@ void mct::decompress_dc_shift_rev(FlowComponent* flow, uint16_t compno)
 	ScheduleInfo info(tile_, flow, stripCache_, image_->rowsPerTask);
 	info.compno = compno;
 	genShift(compno, 1, info.shiftInfo);
+	genDest(compno, info.dest);
 	HWY_DYNAMIC_DISPATCH(hwy_decompress_dc_shift_rev)(info);
 }
 
 /**
  * inverse irreversible MCT (with dc shift)
- * (vector routines are disabled)
  */
 void mct::decompress_irrev(FlowComponent* flow)
 {
 	ScheduleInfo info(tile_, flow, stripCache_, image_->rowsPerTask);
-	hwy::DisableTargets(uint32_t(~HWY_SCALAR));
 	genShift(1, info.shiftInfo);
+	for(uint16_t i = 0; i < 3; ++i)
+		genDest(i, info.dest);
 	HWY_DYNAMIC_DISPATCH(hwy_decompress_irrev)
 	(info);
 }
@@ -440,6 +680,8 @@ void mct::decompress_rev(FlowComponent* flow)
 {
 	ScheduleInfo info(tile_, flow, stripCache_, image_->rowsPerTask);
 	genShift(1, info.shiftInfo);
+	for(uint16_t i = 0; i < 3; ++i)
+		genDest(i, info.dest);
 	HWY_DYNAMIC_DISPATCH(hwy_decompress_rev)
 	(info);
 }
@@ -480,13 +722,27 @@ void mct::genShift(uint16_t compno, int32_t sign, std::vector<ShiftInfo>& shiftI
 	}
 	auto tccp = tcp_->tccps + compno;
 	shift = sign * tccp->dc_level_shift_;
-	shiftInfo.push_back({_min, _max, shift});
+	int32_t precShift = compno < precShift_.size() ? precShift_[compno] : 0;
+	shiftInfo.push_back({_min, _max, shift, precShift});
 }
 void mct::genShift(int32_t sign, std::vector<ShiftInfo>& shiftInfo)
 {
 	for(uint16_t i = 0; i < 3; ++i)
 		genShift(i, sign, shiftInfo);
 }
+void mct::setCompositeDest(const std::vector<CompositeDest>& dest)
+{
+	compositeDest_ = dest;
+}
+void mct::setPrecisionShift(const std::vector<int8_t>& shift)
+{
+	precShift_ = shift;
+}
+void mct::genDest(uint16_t compno, std::vector<CompositeDest>& dest)
+{
+	if(compno < compositeDest_.size())
+		dest.push_back(compositeDest_[compno]);
+}
 
 void mct::calculate_norms(double* pNorms, uint16_t pNbComps, float* pMatrix)
 {
@@ -510,6 +766,40 @@ void mct::calculate_norms(double* pNorms, uint16_t pNbComps, float* pMatrix)
 	}
 }
 
+/**
+ * Width of block of samples transformed at a time by custom MCT:
+ * inputs and outputs of all components in a block stay in cache
+ */
+static size_t customBlockWidth(uint16_t numComps)
+{
+	return std::clamp<size_t>(((size_t)64 * 1024 / numComps) & ~(size_t)63, 64, 1024);
+}
+
+/**
+ * Run custom MCT over all samples, in parallel strips of blocks
+ *
+ * @param n number of samples in each component
+ * @param numComps number of components
+ * @param transform function transforming samples [begin, end), using scratch buffer
+ */
+template<typename T>
+static void customStrips(uint64_t n, uint16_t numComps,
+						 const std::function<void(size_t begin, size_t end, T* out)>& transform)
+{
+	const uint32_t blocksPerStrip = 16;
+	size_t blockWidth = customBlockWidth(numComps);
+	uint64_t numBlocks = (n + blockWidth - 1) / blockWidth;
+	convertStrips((uint32_t)numBlocks, blocksPerStrip,
+				  [n, numComps, blockWidth, &transform](uint32_t blockBegin, uint32_t blockEnd) {
+					  std::unique_ptr<T[]> out(new T[blockWidth * numComps]);
+					  for(uint32_t b = blockBegin; b < blockEnd; ++b)
+					  {
+						  size_t begin = (size_t)b * blockWidth;
+						  transform(begin, std::min<size_t>(begin + blockWidth, n), out.get());
+					  }
+				  });
+}
+
 bool mct::compress_custom(uint8_t* mct_matrix, uint64_t n, uint8_t** pData, uint16_t pNbComp,
 						  [[maybe_unused]] uint32_t isSigned)
 {
@@ -517,32 +807,15 @@ bool mct::compress_custom(uint8_t* mct_matrix, uint64_t n, uint8_t** pData, uint
 	uint32_t NbMatCoeff = pNbComp * pNbComp;
 	auto data = (int32_t**)pData;
 	uint32_t Multiplicator = 1 << 13;
-	auto CurrentData = (int32_t*)grk_malloc((pNbComp + NbMatCoeff) * sizeof(int32_t));
-	if(!CurrentData)
-		return false;
-
-	auto CurrentMatrix = CurrentData + pNbComp;
-
+	// fixed point matrix, stored as double for exact products
+	std::vector<double> CurrentMatrix(NbMatCoeff);
 	for(uint64_t i = 0; i < NbMatCoeff; ++i)
 		CurrentMatrix[i] = (int32_t)(*(Mct++) * (float)Multiplicator);
-
-	for(uint64_t i = 0; i < n; ++i)
-	{
-		for(uint32_t j = 0; j < pNbComp; ++j)
-			CurrentData[j] = (*(data[j]));
-		for(uint32_t j = 0; j < pNbComp; ++j)
-		{
-			auto MctPtr = CurrentMatrix;
-			*(data[j]) = 0;
-			for(uint32_t k = 0; k < pNbComp; ++k)
-			{
-				*(data[j]) += fix_mul(*MctPtr, CurrentData[k]);
-				++MctPtr;
-			}
-			++data[j];
-		}
-	}
-	grk_free(CurrentData);
+	auto matrix = CurrentMatrix.data();
+	customStrips<int32_t>(n, pNbComp, [matrix, data, pNbComp](size_t begin, size_t end,
+															   int32_t* out) {
+		HWY_DYNAMIC_DISPATCH(hwy_compress_custom_block)(matrix, pNbComp, data, begin, end, out);
+	});
 
 	return true;
 }
@@ -550,27 +823,14 @@ bool mct::compress_custom(uint8_t* mct_matrix, uint64_t n, uint8_t** pData, uint
 bool mct::decompress_custom(uint8_t* mct_matrix, uint64_t n, uint8_t** pData, uint16_t num_comps,
 							[[maybe_unused]] uint32_t is_signed)
 {
+	auto matrix = (const float*)mct_matrix;
 	auto data = (float**)pData;
-	auto pixel = new float[2 * num_comps];
-	auto current_pixel = pixel + num_comps;
-
-	for(uint64_t i = 0; i < n; ++i)
-	{
-		auto Mct = (float*)mct_matrix;
-		for(uint32_t j = 0; j < num_comps; ++j)
-		{
-			pixel[j] = (float)(*(data[j]));
-		}
-		for(uint32_t j = 0; j < num_comps; ++j)
-		{
-			current_pixel[j] = 0;
-			for(uint32_t k = 0; k < num_comps; ++k)
-				current_pixel[j] += *(Mct++) * pixel[k];
-			*(data[j]++) = (float)(current_pixel[j]);
-		}
-	}
-	delete[] pixel;
+	customStrips<float>(n, num_comps, [matrix, data, num_comps](size_t begin, size_t end,
+																float* out) {
+		HWY_DYNAMIC_DISPATCH(hwy_decompress_custom_block)(matrix, num_comps, data, begin, end, out);
+	});
 	delete[] pData;
+
 	return true;
 }
 
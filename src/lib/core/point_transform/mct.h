@@ -26,11 +26,34 @@ namespace grk
 {
 struct ShiftInfo
 {
-	ShiftInfo(int32_t mn, int32_t mx, int32_t shift) : _min(mn), _max(mx), _shift(shift) {}
-	ShiftInfo() : ShiftInfo(0, 0, 0) {}
+	ShiftInfo(int32_t mn, int32_t mx, int32_t shift, int32_t precShift)
+		: _min(mn), _max(mx), _shift(shift), _precShift(precShift)
+	{}
+	ShiftInfo() : ShiftInfo(0, 0, 0, 0) {}
 	int32_t _min;
 	int32_t _max;
 	int32_t _shift;
+	// precision conversion of clamped samples: left shift,
+	// or right shift rounding towards zero if negative
+	int32_t _precShift;
+};
+
+/**
+ * Strided destination window in composite image for a tile component
+ */
+struct CompositeDest
+{
+	CompositeDest() : CompositeDest(nullptr, 0, 0, GRK_INT_32) {}
+	CompositeDest(void* buf, uint32_t stride, uint32_t height, GRK_DATA_TYPE dataType)
+		: buf_(buf), stride_(stride), height_(height), dataType_(dataType)
+	{}
+	/* top left corner of tile component window */
+	void* buf_;
+	/* stride in samples */
+	uint32_t stride_;
+	/* number of rows in window */
+	uint32_t height_;
+	GRK_DATA_TYPE dataType_;
 };
 
 struct ScheduleInfo
@@ -42,6 +65,7 @@ struct ScheduleInfo
 	Tile* tile;
 	uint16_t compno;
 	std::vector<ShiftInfo> shiftInfo;
+	std::vector<CompositeDest> dest;
 	FlowComponent* flow_;
 	uint32_t linesPerTask_;
 	StripCache* stripCache_;
@@ -82,6 +106,19 @@ class mct
 	 */
 	void decompress_dc_shift_irrev(FlowComponent* flow, uint16_t compno);
 
+	/**
+	 Set destination windows in composite image, one per component, for
+	 output of inverse transforms and dc shifts. If empty, output is written
+	 back to the tile buffers.
+	 */
+	void setCompositeDest(const std::vector<CompositeDest>& dest);
+
+	/**
+	 Set precision conversion shift, one per component, applied after clamping
+	 by inverse transforms and dc shifts. If empty, precision is unchanged.
+	 */
+	void setPrecisionShift(const std::vector<int8_t>& shift);
+
 	/**
 	 Get wavelet norms for reversible transform
 	 */
@@ -125,11 +162,14 @@ class mct
   private:
 	void genShift(uint16_t compno, int32_t sign, std::vector<ShiftInfo>& shiftInfo);
 	void genShift(int32_t sign, std::vector<ShiftInfo>& shiftInfo);
+	void genDest(uint16_t compno, std::vector<CompositeDest>& dest);
 
 	Tile* tile_;
 	GrkImage* image_;
 	TileCodingParams* tcp_;
 	StripCache* stripCache_;
+	std::vector<CompositeDest> compositeDest_;
+	std::vector<int8_t> precShift_;
 };
 
 /* ----------------------------------------------------------------------- */
@@ -20,9 +20,11 @@
 namespace grk
 {
 CompressScheduler::CompressScheduler(Tile* tile, bool needsRateControl, TileCodingParams* tcp,
-									 const double* mct_norms, uint16_t mct_numcomps)
+									 const double* mct_norms, uint16_t mct_numcomps,
+									 SlopeThresholdEstimator* slopeEstimator)
 	: Scheduler(tile), tile(tile), needsRateControl(needsRateControl), encodeBlocks(nullptr),
-	  blockCount(-1), tcp_(tcp), mct_norms_(mct_norms), mct_numcomps_(mct_numcomps)
+	  blockCount(-1), tcp_(tcp), mct_norms_(mct_norms), mct_numcomps_(mct_numcomps),
+	  slopeEstimator_(slopeEstimator)
 {
 	for(uint16_t compno = 0; compno < numcomps_; ++compno)
 	{
@@ -30,6 +32,10 @@ CompressScheduler::CompressScheduler(Tile* tile, bool needsRateControl, TileCodi
 		imageComponentFlows_[compno] = new ImageComponentFlow(numResolutions);
 	}
 }
+CompressScheduler::~CompressScheduler()
+{
+	delete slopeEstimator_;
+}
 bool CompressScheduler::schedule(uint16_t compno)
 {
 	return scheduleBlocks(compno);
@@ -65,6 +71,7 @@ bool CompressScheduler::scheduleBlocks(uint16_t compno)
 						auto block = new CompressBlockExec();
 						block->tile = tile;
 						block->doRateControl = needsRateControl;
+						block->slopeEstimator = slopeEstimator_;
 						block->x = cblk->x0;
 						block->y = cblk->y0;
 						tilec->getWindow()->toRelativeCoordinates(resno, band->orientation,
@@ -72,6 +79,7 @@ bool CompressScheduler::scheduleBlocks(uint16_t compno)
 						auto highest = tilec->getWindow()->getResWindowBufferHighestSimple();
 						block->tiledp = highest.buf_ + (uint64_t)block->x +
 										block->y * (uint64_t)highest.stride_;
+						block->stride = highest.stride_;
 						maxCblkW = std::max<uint32_t>(maxCblkW, (uint32_t)(1 << tccp->cblkw));
 						maxCblkH = std::max<uint32_t>(maxCblkH, (uint32_t)(1 << tccp->cblkh));
 						block->compno = compno;
@@ -22,8 +22,9 @@ class CompressScheduler : public Scheduler
 {
   public:
 	CompressScheduler(Tile* tile, bool needsRateControl, TileCodingParams* tcp,
-					  const double* mct_norms, uint16_t mct_numcomps);
-	~CompressScheduler() = default;
+					  const double* mct_norms, uint16_t mct_numcomps,
+					  SlopeThresholdEstimator* slopeEstimator);
+	~CompressScheduler();
 	bool schedule(uint16_t compno) override;
 
   private:
@@ -40,6 +41,7 @@ class CompressScheduler : public Scheduler
 	TileCodingParams* tcp_;
 	const double* mct_norms_;
 	uint16_t mct_numcomps_;
+	SlopeThresholdEstimator* slopeEstimator_;
 };
 
 } // namespace grk
@@ -93,6 +93,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 	ResDecompressBlocks resBlocks;
 	auto tccp = tcp_->tccps + compno;
 	auto tilec = tile_->comps + compno;
+	auto stateCache = tileProcessor_->getCodeblockStateCache();
 	bool wholeTileDecoding = tilec->isWholeTileDecoding();
 	uint8_t resno = 0;
 	for(; resno <= tilec->highestResolutionDecompressed; ++resno)
@@ -123,11 +124,13 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 						block->cblk = cblk;
 						block->cblk_sty = tccp->cblk_sty;
 						block->qmfbid = tccp->qmfbid;
+						block->compno = compno;
 						block->resno = resno;
 						block->roishift = tccp->roishift;
 						block->stepsize = band->stepsize;
 						block->k_msbs = (uint8_t)(band->numbps - cblk->numbps);
 						block->R_b = prec_ + gain_b[band->orientation];
+						block->stateCache = stateCache;
 						resBlocks.blocks_.push_back(block);
 					}
 				}
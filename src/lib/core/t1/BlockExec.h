@@ -43,21 +43,27 @@ struct BlockExec
 };
 struct DecompressBlockExec : public BlockExec
 {
-	DecompressBlockExec() : cblk(nullptr), resno(0), roishift(0) {}
+	DecompressBlockExec()
+		: cblk(nullptr), compno(0), resno(0), roishift(0), stateCache(nullptr)
+	{}
 	bool open(T1Interface* t1)
 	{
 		return t1->decompress(this);
 	}
 	void close(void) {}
 	DecompressCodeblock* cblk;
+	uint16_t compno;
 	uint8_t resno;
 	uint8_t roishift;
+	// decoder state retained for refinement (null if not refining)
+	CodeblockStateCache* stateCache;
 };
 struct CompressBlockExec : public BlockExec
 {
 	CompressBlockExec()
-		: cblk(nullptr), tile(nullptr), doRateControl(false), distortion(0), tiledp(nullptr),
-		  compno(0), resno(0), precinctIndex(0), cblkno(0), inv_step_ht(0), mct_norms(nullptr),
+		: cblk(nullptr), tile(nullptr), doRateControl(false), slopeEstimator(nullptr),
+		  distortion(0), tiledp(nullptr), stride(0), compno(0), resno(0), precinctIndex(0),
+		  cblkno(0), inv_step_ht(0), mct_norms(nullptr),
 #ifdef DEBUG_LOSSLESS_T1
 		  unencodedData(nullptr),
 #endif
@@ -71,8 +77,12 @@ struct CompressBlockExec : public BlockExec
 	CompressCodeblock* cblk;
 	Tile* tile;
 	bool doRateControl;
+	// bound used to skip passes that rate control will discard (null if disabled)
+	SlopeThresholdEstimator* slopeEstimator;
 	double distortion;
 	int32_t* tiledp;
+	// row stride of tiledp
+	uint32_t stride;
 	uint16_t compno;
 	uint8_t resno;
 	uint64_t precinctIndex;
@@ -29,18 +29,40 @@ struct Segment
 	void clear()
 	{
 		numpasses = 0;
+		numPassesSignalled = 0;
 		len = 0;
 		maxpasses = 0;
 		numPassesInPacket = 0;
 		numBytesInPacket = 0;
 	}
 	uint32_t numpasses; // number of passes in segment
+	uint32_t numPassesSignalled; // number of passes signalled in parsed packet headers
 	uint32_t len; // total length of segment
 	uint32_t maxpasses; // maximum number of passes in segment
 	uint32_t numPassesInPacket; // number of passes contributed by current packet
 	uint32_t numBytesInPacket; // number of bytes contributed by current packet
 };
 
+// view onto compressed code block data contributed by a packet:
+// data is owned by the tile's compressed data buffer
+struct SegmentBuffer
+{
+	SegmentBuffer(uint8_t* buffer, size_t length) : buf(buffer), len(length) {}
+	uint8_t* buf;
+	size_t len;
+};
+
+// code segment data contributed by a single packet
+struct SegmentContribution
+{
+	SegmentContribution(uint16_t layer, uint32_t passes, uint32_t bytes)
+		: layno(layer), numPasses(passes), numBytes(bytes)
+	{}
+	uint16_t layno; // layer of contributing packet
+	uint32_t numPasses; // number of passes contributed
+	uint32_t numBytes; // number of bytes contributed
+};
+
 // compressing/decoding pass
 struct CodePass
 {
@@ -129,6 +151,21 @@ struct Codeblock : public grk_buf2d<int32_t, AllocatorAligned>, public ICacheabl
 		assert(layno < numPassesInPacket.size());
 		numPassesInPacket[layno] += delta;
 	}
+	/**
+	 * @return true if the first numPasses passes of the code block end a layer
+	 */
+	bool endsLayer(uint32_t numPasses) const
+	{
+		uint32_t passes = 0;
+		for(auto layerPasses : numPassesInPacket)
+		{
+			passes += layerPasses;
+			if(passes >= numPasses)
+				return passes == numPasses;
+		}
+
+		return false;
+	}
 
   protected:
 	std::vector<uint8_t> numPassesInPacket;
@@ -160,7 +197,7 @@ struct CompressCodeblock : public Codeblock
 		}
 		if(!passes)
 		{
-			passes = (CodePass*)grk_calloc(100, sizeof(CodePass));
+			passes = (CodePass*)grk_calloc(maxCompressPassesGRK, sizeof(CodePass));
 			if(!passes)
 				return false;
 		}
@@ -200,7 +237,7 @@ struct CompressCodeblock : public Codeblock
 struct DecompressCodeblock : public Codeblock
 {
 	DecompressCodeblock(uint16_t numLayers)
-		: Codeblock(numLayers), segs(nullptr), numSegments(0),
+		: Codeblock(numLayers), segs(nullptr), numSegments(0), numSignalledSegments(0),
 #ifdef DEBUG_LOSSLESS_T2
 		  included(0),
 #endif
@@ -247,29 +284,70 @@ struct DecompressCodeblock : public Codeblock
 		numSegments++;
 		return getCurrentSegment();
 	}
+	/**
+	 * Packet headers of skipped packets are parsed without reading packet data,
+	 * so segments signalled in headers are tracked separately from segments
+	 * with data
+	 */
+	uint32_t getNumSignalledSegments(void)
+	{
+		return numSignalledSegments;
+	}
+	Segment* signalSegment(uint32_t segmentIndex)
+	{
+		numSignalledSegments = segmentIndex + 1;
+		return getSegment(segmentIndex);
+	}
+	/**
+	 * Discard signalled segments and passes whose data was not read
+	 */
+	void resetSignalledSegments(void)
+	{
+		numSignalledSegments = numSegments;
+		auto seg = getCurrentSegment();
+		if(seg)
+			seg->numPassesSignalled = seg->numpasses;
+	}
+	/**
+	 * Add compressed data view. Data that directly follows the previous
+	 * view in the compressed stream is merged into that view.
+	 */
+	void pushSegBuffer(uint8_t* buf, size_t len)
+	{
+		if(!seg_buffers.empty())
+		{
+			auto& last = seg_buffers.back();
+			if(last.buf + last.len == buf)
+			{
+				last.len += len;
+				return;
+			}
+		}
+		seg_buffers.emplace_back(buf, len);
+	}
 	void cleanUpSegBuffers()
 	{
-		for(auto& b : seg_buffers)
-			delete b;
 		seg_buffers.clear();
+		contributions.clear();
 		numSegments = 0;
+		numSignalledSegments = 0;
 	}
 	size_t getSegBuffersLen()
 	{
 		return std::accumulate(seg_buffers.begin(), seg_buffers.end(), (size_t)0,
-							   [](const size_t s, grk_buf8* a) { return (s + a->len); });
+							   [](const size_t s, const SegmentBuffer& a) { return (s + a.len); });
 	}
 	bool copyToContiguousBuffer(uint8_t* buffer)
 	{
 		if(!buffer)
 			return false;
 		size_t offset = 0;
-		for(auto& buf : seg_buffers)
+		for(auto& b : seg_buffers)
 		{
-			if(buf->len)
+			if(b.len)
 			{
-				memcpy(buffer + offset, buf->buf, buf->len);
-				offset += buf->len;
+				memcpy(buffer + offset, b.buf, b.len);
+				offset += b.len;
 			}
 		}
 		return true;
@@ -281,11 +359,15 @@ struct DecompressCodeblock : public Codeblock
 		segs = nullptr;
 		grk_buf2d::dealloc();
 	}
-	std::vector<grk_buf8*> seg_buffers;
+	std::vector<SegmentBuffer> seg_buffers;
+	// per-packet segment contributions, in code stream order:
+	// only recorded when transcoding
+	std::vector<SegmentContribution> contributions;
 
   private:
 	Segment* segs; /* information on segments */
 	uint32_t numSegments; /* number of segment in block*/
+	uint32_t numSignalledSegments; // number of segments signalled in parsed packet headers
 	uint32_t numSegmentsAllocated; // number of segments allocated for segs array
 };
 
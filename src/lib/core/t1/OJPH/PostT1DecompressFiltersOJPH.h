@@ -1,6 +1,7 @@
 #pragma once
 
 #include "grk_includes.h"
+#include "PostT1Dequantize.h"
 
 namespace ojph
 {
@@ -36,12 +37,7 @@ class ShiftOJPHFilter
 	ShiftOJPHFilter(grk::DecompressBlockExec* block) : shift(31U - (block->k_msbs + 1U)) {}
 	inline void copy(T* dest, T* src, uint32_t len)
 	{
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			T val = src[i];
-			T val_shifted = (val & 0x7FFFFFFF) >> shift;
-			dest[i] = (T)(((uint32_t)val & 0x80000000) ? -val_shifted : val_shifted);
-		}
+		grk::postT1DequantizeHT(dest, src, len, shift, true, 0);
 	}
 
   private:
@@ -88,12 +84,7 @@ class ScaleOJPHFilter
 	}
 	inline void copy(T* dest, T* src, uint32_t len)
 	{
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			int32_t val = src[i];
-			float val_scaled = (float)(val & 0x7FFFFFFF) * scale;
-			((float*)dest)[i] = ((uint32_t)val & 0x80000000) ? -val_scaled : val_scaled;
-		}
+		grk::postT1DequantizeHT(dest, src, len, 0, false, scale);
 	}
 
   private:
@@ -22,16 +22,46 @@
 #include "T1OJPH.h"
 
 #include "grk_includes.h"
+#include "hwy/targets.h"
 
 const uint8_t grk_cblk_dec_compressed_data_pad_ht = 8;
+// SIMD decoders load 16 bytes at a time past the end of the forward growing bit streams
+const uint8_t grk_cblk_dec_compressed_data_tail_pad_ht = 16;
 
 namespace ojph
 {
+typedef bool (*DecodeCodeblockFn)(ui8* coded_data, ui32* decoded_data, ui32 missing_msbs,
+								  ui32 num_passes, ui32 lengths1, ui32 lengths2, ui32 width,
+								  ui32 height, ui32 stride, bool stripe_causal);
+/**
+ * Select fastest HT block decoder supported by this CPU
+ */
+static DecodeCodeblockFn selectDecoder(void)
+{
+#ifdef GRK_HT_SIMD_DECODE
+	auto targets = hwy::SupportedTargets();
+	if(targets & HWY_AVX3)
+		return local::ojph_decode_codeblock_avx512;
+	if(targets & HWY_AVX2)
+		return local::ojph_decode_codeblock_avx2;
+	if(targets & HWY_SSSE3)
+		return local::ojph_decode_codeblock_ssse3;
+#endif
+	return local::ojph_decode_codeblock;
+}
+// selected once at load time, before any target is disabled
+static const DecodeCodeblockFn decodeCodeblock = selectDecoder();
+
 T1OJPH::T1OJPH(bool isCompressor, [[maybe_unused]] grk::TileCodingParams* tcp, uint32_t maxCblkW,
 			   uint32_t maxCblkH)
 	: coded_data_size(isCompressor ? 0 : (uint32_t)(maxCblkW * maxCblkH * sizeof(int32_t))),
-	  coded_data(isCompressor ? nullptr : new uint8_t[coded_data_size]),
-	  unencoded_data_size(maxCblkW * maxCblkH), unencoded_data(new int32_t[unencoded_data_size]),
+	  coded_data(isCompressor ? nullptr
+							  : new uint8_t[grk_cblk_dec_compressed_data_pad_ht + coded_data_size +
+											grk_cblk_dec_compressed_data_tail_pad_ht]),
+	  unencoded_data_size(isCompressor ? 0 : maxCblkW * maxCblkH),
+	  unencoded_data(isCompressor ? nullptr
+								  : (int32_t*)grk::grk_aligned_malloc(unencoded_data_size *
+																	  sizeof(int32_t))),
 	  allocator(new mem_fixed_allocator), elastic_alloc(new mem_elastic_allocator(1048576))
 {
 	if(!isCompressor)
@@ -40,62 +70,12 @@ T1OJPH::T1OJPH(bool isCompressor, [[maybe_unused]] grk::TileCodingParams* tcp, u
 T1OJPH::~T1OJPH()
 {
 	delete[] coded_data;
-	delete[] unencoded_data;
+	grk::grk_aligned_free(unencoded_data);
 	delete allocator;
 	delete elastic_alloc;
 }
-void T1OJPH::preCompress([[maybe_unused]] grk::CompressBlockExec* block,
-						 [[maybe_unused]] grk::Tile* tile)
-{
-	auto cblk = block->cblk;
-	uint16_t w = (uint16_t)cblk->width();
-	uint16_t h = (uint16_t)cblk->height();
-	uint32_t tile_width =
-		(tile->comps + block->compno)->getWindow()->getResWindowBufferHighestStride();
-	auto tileLineAdvance = tile_width - w;
-	uint32_t cblk_index = 0;
-	int32_t shift = 31 - (block->k_msbs + 1);
-
-	// convert to sign-magnitude
-	if(block->qmfbid == 1)
-	{
-		auto tiledp = block->tiledp;
-		for(auto j = 0U; j < h; ++j)
-		{
-			for(auto i = 0U; i < w; ++i)
-			{
-				int32_t temp = *tiledp++;
-				int32_t val = temp >= 0 ? temp : -temp;
-				int32_t sign = (int32_t)((temp >= 0) ? 0U : 0x80000000);
-				int32_t res = sign | (val << shift);
-				unencoded_data[cblk_index] = res;
-				cblk_index++;
-			}
-			tiledp += tileLineAdvance;
-		}
-	}
-	else
-	{
-		auto tiledp = (float*)block->tiledp;
-		for(auto j = 0U; j < h; ++j)
-		{
-			for(auto i = 0U; i < w; ++i)
-			{
-				int32_t t = (int32_t)((float)*tiledp++ * block->inv_step_ht * (float)(1 << shift));
-				int32_t val = t >= 0 ? t : -t;
-				int32_t sign = t >= 0 ? 0 : (int32_t)0x80000000;
-				int32_t res = sign | val;
-				unencoded_data[cblk_index] = res;
-				cblk_index++;
-			}
-			tiledp += tileLineAdvance;
-		}
-	}
-}
 bool T1OJPH::compress(grk::CompressBlockExec* block)
 {
-	preCompress(block, block->tile);
-
 	coded_lists* next_coded = nullptr;
 	auto cblk = block->cblk;
 	cblk->numbps = 0;
@@ -103,10 +83,16 @@ bool T1OJPH::compress(grk::CompressBlockExec* block)
 	// if (maximum >= (uint32_t)1<<(31 - (block->k_msbs+1)))
 	uint16_t w = (uint16_t)cblk->width();
 	uint16_t h = (uint16_t)cblk->height();
+	uint32_t tile_width = block->stride;
 
+	// quantization and sign-magnitude conversion are fused into the encoder,
+	// which reads samples directly from the tile buffer
+	bool reversible = block->qmfbid == 1;
+	float scale =
+		reversible ? 0.0f : block->inv_step_ht * (float)(1 << (31 - (block->k_msbs + 1)));
 	uint32_t pass_length[2] = {0, 0};
-	ojph::local::ojph_encode_codeblock((uint32_t*)unencoded_data, block->k_msbs, 1, w, h, w,
-									   pass_length, elastic_alloc, next_coded);
+	ojph::local::ojph_encode_codeblock(block->tiledp, reversible, scale, block->k_msbs, 1, w, h,
+									   tile_width, pass_length, elastic_alloc, next_coded);
 
 	cblk->numPassesTotal = 1;
 	cblk->passes[0].len = (uint16_t)pass_length[0];
@@ -122,25 +108,27 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 	auto cblk = block->cblk;
 	if(!cblk->area())
 		return true;
-	uint16_t stride = (uint16_t)cblk->width();
+	// SIMD decoders store four samples at a time
+	uint16_t stride = (uint16_t)((cblk->width() + 3) & ~3U);
 	if(!cblk->seg_buffers.empty())
 	{
-		size_t total_seg_len = 2 * grk_cblk_dec_compressed_data_pad_ht + cblk->getSegBuffersLen();
+		size_t total_seg_len = cblk->getSegBuffersLen();
 		if(coded_data_size < total_seg_len)
 		{
 			delete[] coded_data;
-			coded_data = new uint8_t[total_seg_len];
+			coded_data = new uint8_t[grk_cblk_dec_compressed_data_pad_ht + total_seg_len +
+									 grk_cblk_dec_compressed_data_tail_pad_ht];
 			coded_data_size = (uint32_t)total_seg_len;
 			memset(coded_data, 0, grk_cblk_dec_compressed_data_pad_ht);
 		}
-		memset(coded_data + grk_cblk_dec_compressed_data_pad_ht + cblk->getSegBuffersLen(), 0,
-			   grk_cblk_dec_compressed_data_pad_ht);
+		memset(coded_data + grk_cblk_dec_compressed_data_pad_ht + total_seg_len, 0,
+			   grk_cblk_dec_compressed_data_tail_pad_ht);
 		uint8_t* actual_coded_data = coded_data + grk_cblk_dec_compressed_data_pad_ht;
 		size_t offset = 0;
 		for(auto& b : cblk->seg_buffers)
 		{
-			memcpy(actual_coded_data + offset, b->buf, b->len);
-			offset += b->len;
+			memcpy(actual_coded_data + offset, b.buf, b.len);
+			offset += b.len;
 		}
 
 		size_t num_passes = 0;
@@ -153,9 +141,9 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 		bool rc = false;
 		if(num_passes && offset)
 		{
-			rc = ojph::local::ojph_decode_codeblock(
-				actual_coded_data, (uint32_t*)unencoded_data, block->k_msbs, (uint32_t)num_passes,
-				(uint32_t)offset, 0, cblk->width(), cblk->height(), stride, false);
+			rc = decodeCodeblock(actual_coded_data, (uint32_t*)unencoded_data, block->k_msbs,
+								 (uint32_t)num_passes, (uint32_t)offset, 0, cblk->width(),
+								 cblk->height(), stride, false);
 		}
 		else
 		{
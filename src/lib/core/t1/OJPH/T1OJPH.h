@@ -36,9 +36,9 @@ class T1OJPH : public grk::T1Interface
 	bool decompress(grk::DecompressBlockExec* block);
 
   private:
-	void preCompress(grk::CompressBlockExec* block, grk::Tile* tile);
 	bool postProcess(grk::DecompressBlockExec* block);
 
+	// capacity of coded_data, excluding head and tail padding
 	uint32_t coded_data_size;
 	uint8_t* coded_data;
 	uint32_t unencoded_data_size;
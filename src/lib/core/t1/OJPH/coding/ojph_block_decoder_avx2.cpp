@@ -0,0 +1,25 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * AVX2 build of the SSSE3 HT block decoder. Compiled with AVX2, BMI2 and LZCNT
+ * enabled, so that the bit stream readers use the newer scalar instructions, and the
+ * MagSgn decoding of 32 bit quads uses per-lane variable shifts.
+ */
+#define OJPH_DECODER_SIMD_NS avx2
+#define OJPH_DECODER_SIMD_ENTRY ojph_decode_codeblock_avx2
+#include "ojph_block_decoder_ssse3.cpp"
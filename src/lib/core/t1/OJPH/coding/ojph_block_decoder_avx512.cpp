@@ -0,0 +1,24 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * AVX-512 build of the SSSE3 HT block decoder. On top of the AVX2 build, the
+ * MagSgn decoding of 16 bit quad pairs uses the AVX-512BW/VL per-lane 16 bit shifts.
+ */
+#define OJPH_DECODER_SIMD_NS avx512
+#define OJPH_DECODER_SIMD_ENTRY ojph_decode_codeblock_avx512
+#include "ojph_block_decoder_ssse3.cpp"
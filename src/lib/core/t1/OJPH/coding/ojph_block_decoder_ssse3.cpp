@@ -54,8 +54,17 @@
 
 #include <immintrin.h>
 
+// This file is also compiled, with different instruction set flags, by
+// ojph_block_decoder_avx2.cpp. Internals live in a per-build namespace so
+// that the two builds never share inline functions at link time.
+#ifndef OJPH_DECODER_SIMD_NS
+#define OJPH_DECODER_SIMD_NS ssse3
+#define OJPH_DECODER_SIMD_ENTRY ojph_decode_codeblock_ssse3
+#endif
+
 namespace ojph {
   namespace local {
+  namespace OJPH_DECODER_SIMD_NS {
 
     //************************************************************************/
     /** @brief MEL state structure for reading and decoding the MEL bitstream
@@ -665,7 +674,7 @@ namespace ojph {
 
       // combine with earlier data
       assert(msp->bits >= 0 && msp->bits <= 128);
-      int cur_bytes = msp->bits >> 3;
+      int cur_bytes = (int)(msp->bits >> 3);
       int cur_bits = msp->bits & 7;
       __m128i b1, b2;
       b1 = _mm_sll_epi64(val, _mm_set1_epi64x(cur_bits));
@@ -677,7 +686,7 @@ namespace ojph {
       _mm_storeu_si128((__m128i*)(msp->tmp + cur_bytes), b2);
 
       int consumed_bits = bits < 128 - cur_bits ? bits : 128 - cur_bits;
-      cur_bytes = (msp->bits + (ui32)consumed_bits + 7) >> 3; // round up
+      cur_bytes = (int)((msp->bits + (ui32)consumed_bits + 7) >> 3); // round up
       int upper = _mm_extract_epi16(val, 7);
       upper >>= consumed_bits - 128 + 16;
       msp->tmp[cur_bytes] = (ui8)upper; // copy byte
@@ -829,6 +838,17 @@ namespace ojph {
           _mm_set_epi32(0x0C0C0C0C, 0x08080808, 0x04040404, 0x00000000));
         byte_idx = _mm_add_epi32(byte_idx, _mm_set1_epi32(0x03020100));
         __m128i d0 = _mm_shuffle_epi8(ms_vec, byte_idx);
+#ifdef __AVX2__
+        // bytes 4 to 7 from the start byte; only byte 4 contributes
+        byte_idx = _mm_add_epi32(byte_idx, _mm_set1_epi32(0x04040404));
+        __m128i d1 = _mm_shuffle_epi8(ms_vec, byte_idx);
+
+        // shift samples values to correct location, using per-lane shifts;
+        // a shift count of 32 (bit_idx == 0) yields zero
+        d0 = _mm_srlv_epi32(d0, bit_idx);
+        d1 = _mm_sllv_epi32(d1, _mm_sub_epi32(_mm_set1_epi32(32), bit_idx));
+        d0 = _mm_or_si128(d0, d1);
+#else
         byte_idx = _mm_add_epi32(byte_idx, _mm_set1_epi32(0x01010101));
         __m128i d1 = _mm_shuffle_epi8(ms_vec, byte_idx);
 
@@ -843,6 +863,7 @@ namespace ojph {
         d1 = _mm_mullo_epi16(d1, bit_shift);
         d1 = _mm_and_si128(d1, _mm_set1_epi32((si32)0xFF00FF00)); // 8 in MSB
         d0 = _mm_or_si128(d0, d1);
+#endif
 
         // find location of e_k and mask
         __m128i shift;
@@ -947,6 +968,30 @@ namespace ojph {
                         0x0606, 0x0404, 0x0202, 0x0000));
         byte_idx = _mm_add_epi16(byte_idx, _mm_set1_epi16(0x0100));
         __m128i d0 = _mm_shuffle_epi8(ms_vec, byte_idx);
+#if defined(__AVX512BW__) && defined(__AVX512VL__)
+        // byte 2 from the start byte, with a zero upper byte
+        byte_idx = _mm_or_si128(_mm_add_epi16(byte_idx, _mm_set1_epi16(0x0102)),
+                                _mm_set1_epi16((si16)0x8000));
+        __m128i d1 = _mm_shuffle_epi8(ms_vec, byte_idx);
+
+        // shift samples values to correct location, using per-lane shifts;
+        // a shift count of 16 (bit_idx == 0) yields zero
+        d0 = _mm_srlv_epi16(d0, bit_idx);
+        d1 = _mm_sllv_epi16(d1, _mm_sub_epi16(_mm_set1_epi16(16), bit_idx));
+        d0 = _mm_or_si128(d0, d1);
+
+        // find location of e_k and mask
+        __m128i shift;
+        __m128i ones = _mm_set1_epi16(1);
+        __m128i twos = _mm_set1_epi16(2);
+        // lanes 0 to 3 hold U_q of the first quad, and lanes 4 to 7 hold
+        // U_q of the second quad; shift counts above 15 yield zero
+        __m128i U_q_m1 = _mm_sub_epi16(U_q, ones);
+        U_q_m1 = _mm_and_si128(U_q_m1, _mm_set1_epi16(0x1F));
+        w0 = _mm_sub_epi16(twos, w0);
+        shift = _mm_sllv_epi16(w0, U_q_m1);
+        ms_vec = _mm_and_si128(d0, _mm_sub_epi16(shift, ones));
+#else
         byte_idx = _mm_add_epi16(byte_idx, _mm_set1_epi16(0x0101));
         __m128i d1 = _mm_shuffle_epi8(ms_vec, byte_idx);
 
@@ -975,6 +1020,7 @@ namespace ojph {
         t1 = _mm_sll_epi16(t1, Uq1);
         shift = _mm_or_si128(t0, t1);
         ms_vec = _mm_and_si128(d0, _mm_sub_epi16(shift, ones));
+#endif
 
         // next e_1
         w0 = _mm_and_si128(flags, _mm_set1_epi16(0x800));
@@ -1021,11 +1067,11 @@ namespace ojph {
      *  @param [in]   stride is the decoded codeblock buffer stride 
      *  @param [in]   stripe_causal is true for stripe causal mode
      */
-    bool ojph_decode_codeblock_ssse3(ui8* coded_data, ui32* decoded_data,
-                                     ui32 missing_msbs, ui32 num_passes,
-                                     ui32 lengths1, ui32 lengths2,
-                                     ui32 width, ui32 height, ui32 stride,
-                                     bool stripe_causal)
+    static bool decode_codeblock(ui8* coded_data, ui32* decoded_data,
+                                 ui32 missing_msbs, ui32 num_passes,
+                                 ui32 lengths1, ui32 lengths2,
+                                 ui32 width, ui32 height, ui32 stride,
+                                 bool stripe_causal)
     {
       static bool insufficient_precision = false;
       static bool modify_code = false;
@@ -1246,7 +1292,7 @@ namespace ojph {
           uvlc_entry >>= 3; 
           //extract suffixes for quad 0 and 1
           ui32 len = uvlc_entry & 0xF;           //suffix length for 2 quads
-          ui32 tmp = vlc_val & ((1 << len) - 1); //suffix value for 2 quads
+          ui32 tmp = vlc_val & ((1U << len) - 1); //suffix value for 2 quads
           vlc_val = rev_advance(&vlc, len);
           uvlc_entry >>= 4;
           // quad 0 length
@@ -1357,7 +1403,7 @@ namespace ojph {
             uvlc_entry >>= 3;
             //extract suffixes for quad 0 and 1
             ui32 len = uvlc_entry & 0xF;           //suffix length for 2 quads
-            ui32 tmp = vlc_val & ((1 << len) - 1); //suffix value for 2 quads
+            ui32 tmp = vlc_val & ((1U << len) - 1); //suffix value for 2 quads
             vlc_val = rev_advance(&vlc, len);
             uvlc_entry >>= 4;
             // quad 0 length
@@ -2064,5 +2110,17 @@ namespace ojph {
 
       return true;
     }
+  } // namespace OJPH_DECODER_SIMD_NS
+
+    bool OJPH_DECODER_SIMD_ENTRY(ui8* coded_data, ui32* decoded_data,
+                                 ui32 missing_msbs, ui32 num_passes,
+                                 ui32 lengths1, ui32 lengths2,
+                                 ui32 width, ui32 height, ui32 stride,
+                                 bool stripe_causal)
+    {
+      return OJPH_DECODER_SIMD_NS::decode_codeblock(coded_data, decoded_data,
+        missing_msbs, num_passes, lengths1, lengths2, width, height, stride,
+        stripe_causal);
+    }
   }
 }
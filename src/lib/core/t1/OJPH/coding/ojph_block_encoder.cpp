@@ -461,6 +461,30 @@ namespace ojph {
         msp->pos--;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    static inline int
+    quad_rho(const ui32* e_q)
+    {
+      return (int)((e_q[0] != 0) | ((e_q[1] != 0) << 1)
+                 | ((e_q[2] != 0) << 2) | ((e_q[3] != 0) << 3));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline int
+    quad_e_max(const ui32* e_q)
+    {
+      return (int)ojph_max(ojph_max(e_q[0], e_q[1]), ojph_max(e_q[2], e_q[3]));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline int
+    quad_eps(const ui32* e_q, int e_qmax)
+    {
+      ui32 e_max = (ui32)e_qmax;
+      return (int)((e_q[0] == e_max) | ((e_q[1] == e_max) << 1)
+                 | ((e_q[2] == e_max) << 2) | ((e_q[3] == e_max) << 3));
+    }
+
     //////////////////////////////////////////////////////////////////////////
     //
     //
@@ -468,7 +492,8 @@ namespace ojph {
     //
     //
     //////////////////////////////////////////////////////////////////////////
-    void ojph_encode_codeblock(ui32* buf, ui32 missing_msbs, ui32 num_passes,
+    void ojph_encode_codeblock(const void* buf, bool reversible, float scale,
+                               ui32 missing_msbs, ui32 num_passes,
                                ui32 width, ui32 height, ui32 stride,
                                ui32* lengths,
                                ojph::mem_elastic_allocator *elastic,
@@ -508,80 +533,37 @@ namespace ojph {
       ui8* lep = e_val;     lep[0] = 0;
       ui8* lcxp = cx_val;   lcxp[0] = 0;
 
+      //e_buf, s_buf: exponents and magnitude-sign values of a pair of
+      // lines, in quad order (top-left, bottom-left, top-right,
+      // bottom-right) and zero-padded to a multiple of four columns;
+      // insignificant samples have zero entries, so that quads beyond
+      // the end of the line have rho = 0
+      ui32 e_buf[2048];
+      ui32 s_buf[2048];
+      const ui32 *src = (const ui32*)buf;
+
       //initial row of quads
-      int e_qmax[2] = {0,0}, e_q[8] = {0,0,0,0,0,0,0,0};
+      int e_qmax[2] = {0,0};
       int rho[2] = {0,0};
       int c_q0 = 0;
-      ui32 s[8] = {0,0,0,0,0,0,0,0}, val, t;
       ui32 y = 0;
-      ui32 *sp = buf;
-      for (ui32 x = 0; x < width; x += 4)
+      ojph_prepare_ht_rows(src, stride, width, ojph_min(height, 2u), p,
+                           reversible, scale, e_buf, s_buf);
+      const ui32 *e_q = e_buf, *s = s_buf;
+      for (ui32 x = 0; x < width; x += 4, e_q += 8, s += 8)
       {
         //prepare two quads
-        t = sp[0];
-        val = t + t; //multiply by 2 and get rid of sign
-        val >>= p;  // 2 \mu_p + x
-        val &= ~1u; // 2 \mu_p
-        if (val)
-        {
-          rho[0] = 1;
-          e_q[0] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-          e_qmax[0] = e_q[0];
-          s[0] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-        }
-
-        t = height > 1 ? sp[stride] : 0;
-        ++sp;
-        val = t + t; //multiply by 2 and get rid of sign
-        val >>= p; // 2 \mu_p + x
-        val &= ~1u;// 2 \mu_p
-        if (val)
-        {
-          rho[0] += 2;
-          e_q[1] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-          e_qmax[0] = ojph_max(e_qmax[0], e_q[1]);
-          s[1] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-        }
-
-        if (x+1 < width)
-        {
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 4;
-            e_q[2] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[2]);
-            s[2] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = height > 1 ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 8;
-            e_q[3] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[3]);
-            s[3] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-        }
+        rho[0] = quad_rho(e_q);
+        e_qmax[0] = quad_e_max(e_q);
+        rho[1] = quad_rho(e_q + 4);
+        e_qmax[1] = quad_e_max(e_q + 4);
 
         int Uq0 = ojph_max(e_qmax[0], 1); //kappa_q = 1
         int u_q0 = Uq0 - 1, u_q1 = 0; //kappa_q = 1
 
         int eps0 = 0;
         if (u_q0 > 0)
-        {
-          eps0 |= (e_q[0] == e_qmax[0]);
-          eps0 |= (e_q[1] == e_qmax[0]) << 1;
-          eps0 |= (e_q[2] == e_qmax[0]) << 2;
-          eps0 |= (e_q[3] == e_qmax[0]) << 3;
-        }
+          eps0 = quad_eps(e_q, e_qmax[0]);
         lep[0] = ojph_max(lep[0], (ui8)e_q[1]); lep++;
         lep[0] = (ui8)e_q[3];
         lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho[0] & 2) >> 1)); lcxp++;
@@ -604,71 +586,13 @@ namespace ojph {
 
         if (x+2 < width)
         {
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[1] = 1;
-            e_q[4] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[1] = e_q[4];
-            s[4] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = height > 1 ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[1] += 2;
-            e_q[5] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[1] = ojph_max(e_qmax[1], e_q[5]);
-            s[5] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          if (x+3 < width)
-          {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 4;
-              e_q[6] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[6]);
-              s[6] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = height > 1 ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 8;
-              e_q[7] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[7]);
-              s[7] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-          }
-
           int c_q1 = (rho[0] >> 1) | (rho[0] & 1);
           int Uq1 = ojph_max(e_qmax[1], 1); //kappa_q = 1
           u_q1 = Uq1 - 1; //kappa_q = 1
 
           int eps1 = 0;
           if (u_q1 > 0)
-          {
-            eps1 |= (e_q[4] == e_qmax[1]);
-            eps1 |= (e_q[5] == e_qmax[1]) << 1;
-            eps1 |= (e_q[6] == e_qmax[1]) << 2;
-            eps1 |= (e_q[7] == e_qmax[1]) << 3;
-          }
+            eps1 = quad_eps(e_q + 4, e_qmax[1]);
           lep[0] = ojph_max(lep[0], (ui8)e_q[5]); lep++;
           lep[0] = (ui8)e_q[7];
           lcxp[0] |= (ui8)(lcxp[0] | (ui8)((rho[1] & 2) >> 1)); lcxp++;
@@ -715,9 +639,6 @@ namespace ojph {
 
         //prepare for next iteration
         c_q0 = (rho[1] >> 1) | (rho[1] & 1);
-        s[0] = s[1] = s[2] = s[3] = s[4] = s[5] = s[6] = s[7] = 0;
-        e_q[0]=e_q[1]=e_q[2]=e_q[3]=e_q[4]=e_q[5]=e_q[6]=e_q[7]=0;
-        rho[0] = rho[1] = 0; e_qmax[0] = e_qmax[1] = 0;
       }
 
       lep[1] = 0;
@@ -731,62 +652,18 @@ namespace ojph {
         c_q0 = lcxp[0] + (lcxp[1] << 2);
         lcxp[0] = 0;
 
-        sp = buf + y * stride;
-        for (ui32 x = 0; x < width; x += 4)
+        ojph_prepare_ht_rows(src + y * stride, stride, width,
+                             ojph_min(height - y, 2u), p, reversible, scale,
+                             e_buf, s_buf);
+        e_q = e_buf;
+        s = s_buf;
+        for (ui32 x = 0; x < width; x += 4, e_q += 8, s += 8)
         {
           //prepare two quads
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[0] = 1;
-            e_q[0] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = e_q[0];
-            s[0] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = y + 1 < height ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 2;
-            e_q[1] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[1]);
-            s[1] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          if (x+1 < width)
-          {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[0] += 4;
-              e_q[2] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[0] = ojph_max(e_qmax[0], e_q[2]);
-              s[2] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = y + 1 < height ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[0] += 8;
-              e_q[3] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[0] = ojph_max(e_qmax[0], e_q[3]);
-              s[3] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-          }
+          rho[0] = quad_rho(e_q);
+          e_qmax[0] = quad_e_max(e_q);
+          rho[1] = quad_rho(e_q + 4);
+          e_qmax[1] = quad_e_max(e_q + 4);
 
           int kappa = (rho[0] & (rho[0]-1)) ? ojph_max(1,max_e) : 1;
           int Uq0 = ojph_max(e_qmax[0], kappa);
@@ -794,12 +671,7 @@ namespace ojph {
 
           int eps0 = 0;
           if (u_q0 > 0)
-          {
-            eps0 |= (e_q[0] == e_qmax[0]);
-            eps0 |= (e_q[1] == e_qmax[0]) << 1;
-            eps0 |= (e_q[2] == e_qmax[0]) << 2;
-            eps0 |= (e_q[3] == e_qmax[0]) << 3;
-          }
+            eps0 = quad_eps(e_q, e_qmax[0]);
           lep[0] = ojph_max(lep[0], (ui8)e_q[1]); lep++;
           max_e = ojph_max(lep[0], lep[1]) - 1;
           lep[0] = (ui8)e_q[3];
@@ -823,59 +695,6 @@ namespace ojph {
 
           if (x+2 < width)
           {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[1] = 1;
-              e_q[4] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = e_q[4];
-              s[4] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = y + 1 < height ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 2;
-              e_q[5] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[5]);
-              s[5] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            if (x+3 < width)
-            {
-              t = sp[0];
-              val = t + t; //multiply by 2 and get rid of sign
-              val >>= p; // 2 \mu_p + x
-              val &= ~1u;// 2 \mu_p
-              if (val)
-              {
-                rho[1] += 4;
-                e_q[6] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-                e_qmax[1] = ojph_max(e_qmax[1], e_q[6]);
-                s[6] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-              }
-
-              t = y + 1 < height ? sp[stride] : 0;
-              ++sp;
-              val = t + t; //multiply by 2 and get rid of sign
-              val >>= p; // 2 \mu_p + x
-              val &= ~1u;// 2 \mu_p
-              if (val)
-              {
-                rho[1] += 8;
-                e_q[7] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-                e_qmax[1] = ojph_max(e_qmax[1], e_q[7]);
-                s[7] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-              }
-            }
-
             kappa = (rho[1] & (rho[1]-1)) ? ojph_max(1,max_e) : 1;
             c_q1 |= ((rho[0] & 4) >> 1) | ((rho[0] & 8) >> 2);
             int Uq1 = ojph_max(e_qmax[1], kappa);
@@ -883,12 +702,7 @@ namespace ojph {
 
             int eps1 = 0;
             if (u_q1 > 0)
-            {
-              eps1 |= (e_q[4] == e_qmax[1]);
-              eps1 |= (e_q[5] == e_qmax[1]) << 1;
-              eps1 |= (e_q[6] == e_qmax[1]) << 2;
-              eps1 |= (e_q[7] == e_qmax[1]) << 3;
-            }
+              eps1 = quad_eps(e_q + 4, e_qmax[1]);
             lep[0] = ojph_max(lep[0], (ui8)e_q[5]); lep++;
             max_e = ojph_max(lep[0], lep[1]) - 1;
             lep[0] = (ui8)e_q[7];
@@ -918,9 +732,6 @@ namespace ojph {
 
           //prepare for next iteration
           c_q0 |= ((rho[1] & 4) >> 1) | ((rho[1] & 8) >> 2);
-          s[0] = s[1] = s[2] = s[3] = s[4] = s[5] = s[6] = s[7] = 0;
-          e_q[0]=e_q[1]=e_q[2]=e_q[3]=e_q[4]=e_q[5]=e_q[6]=e_q[7]=0;
-          rho[0] = rho[1] = 0; e_qmax[0] = e_qmax[1] = 0;
         }
       }
 
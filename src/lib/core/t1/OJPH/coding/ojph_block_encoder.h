@@ -51,12 +51,26 @@ namespace ojph {
   namespace local {
 
     //////////////////////////////////////////////////////////////////////////
+    // Encodes the cleanup pass of a codeblock directly from wavelet
+    // coefficients; buf holds si32 samples when reversible is true, and
+    // float samples, quantized by multiplying with scale, otherwise
     void
-      ojph_encode_codeblock(ui32* buf, ui32 missing_msbs, ui32 num_passes,
+      ojph_encode_codeblock(const void* buf, bool reversible, float scale,
+                            ui32 missing_msbs, ui32 num_passes,
                             ui32 width, ui32 height, ui32 stride,
-                            ui32* lengths, 
+                            ui32* lengths,
                             ojph::mem_elastic_allocator *elastic,
                             ojph::coded_lists *& coded);
+
+    //////////////////////////////////////////////////////////////////////////
+    // Converts one or two rows of samples, laid out as for
+    // ojph_encode_codeblock, into exponents e and magnitude-sign values s,
+    // interleaved in quad order and zero-padded to a multiple of four
+    // columns; dispatched at run time to the widest supported SIMD target
+    void
+      ojph_prepare_ht_rows(const void* buf, ui32 stride, ui32 width,
+                           ui32 rows, ui32 p, bool reversible, float scale,
+                           ui32* e, ui32* s);
   }
 }
 
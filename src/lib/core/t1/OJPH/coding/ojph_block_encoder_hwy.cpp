@@ -0,0 +1,181 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Vectorized front end of the HT cleanup pass encoder: quantization,
+ * sign-magnitude conversion and generation of exponents and magnitude-sign
+ * values, read directly from the tile buffer.
+ */
+
+#include <cstdint>
+#include "ojph_arch.h"
+#include "ojph_block_encoder.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "t1/OJPH/coding/ojph_block_encoder_hwy.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace ojph
+{
+namespace local
+{
+	namespace HWY_NAMESPACE
+	{
+		using namespace hwy::HWY_NAMESPACE;
+
+		/**
+		 * Scalar version of prepare, used for row tails
+		 */
+		static HWY_INLINE void prepareSample(uint32_t mag, uint32_t sign, uint32_t p, uint32_t* e,
+											 uint32_t* s)
+		{
+			uint32_t val = ((mag << 1) >> p) & ~1U; // 2 \mu_p
+			if(val)
+			{
+				*e = 32 - (uint32_t)count_leading_zeros(val - 1); // 2\mu_p - 1
+				*s = val - 2 + sign; // v_n = 2(\mu_p-1) + s_n
+			}
+			else
+			{
+				*e = 0;
+				*s = 0;
+			}
+		}
+		static HWY_INLINE void loadSample(const void* buf, uint32_t index, bool reversible,
+										  float scale, uint32_t p, uint32_t* mag, uint32_t* sign)
+		{
+			int32_t t;
+			if(reversible)
+			{
+				t = ((const int32_t*)buf)[index];
+				*mag = (uint32_t)(t >= 0 ? t : -t) << p;
+			}
+			else
+			{
+				t = (int32_t)(((const float*)buf)[index] * scale);
+				*mag = (uint32_t)(t >= 0 ? t : -t);
+			}
+			*sign = (uint32_t)t >> 31;
+		}
+
+		/**
+		 * Compute exponents e and magnitude-sign values s of a vector of samples,
+		 * given their magnitudes and signs
+		 */
+		template<class DU, class V>
+		static HWY_INLINE void prepare(DU du, V mag, V sign, int p, V& e, V& s)
+		{
+			const RebindToSigned<DU> di;
+			const RebindToFloat<DU> df;
+			const auto one = Set(du, 1);
+			auto val = AndNot(one, ShiftRightSame(ShiftLeft<1>(mag), p)); // 2 \mu_p
+			auto significant = val != Zero(du);
+			// e = 1 + floor(log2(2\mu_p - 1)), taken from the float exponent of
+			// (2\mu_p - 1) / 2 with the bit below the leading one cleared, so
+			// that the conversion can not round up to the next power of two
+			auto w = ShiftRight<1>(val - one);
+			w = AndNot(ShiftRight<1>(w), w);
+			auto exponent = BitCast(di, ShiftRight<23>(BitCast(du, ConvertTo(df, BitCast(di, w)))));
+			exponent = Max(exponent - Set(di, 125), Set(di, 1));
+			e = IfThenElseZero(significant, BitCast(du, exponent));
+			s = IfThenElseZero(significant, val - Set(du, 2) + sign);
+		}
+
+		static void hwy_prepare_ht_rows(const void* buf, uint32_t stride, uint32_t width,
+										uint32_t rows, uint32_t p, bool reversible, float scale,
+										uint32_t* e, uint32_t* s)
+		{
+			const HWY_FULL(uint32_t) du;
+			const RebindToSigned<decltype(du)> di;
+			const RebindToFloat<decltype(du)> df;
+			const size_t N = Lanes(du);
+			const auto vscale = Set(df, scale);
+			const uint32_t bottom = rows > 1 ? stride : 0;
+			uint32_t x = 0;
+			for(; x + N <= width; x += (uint32_t)N)
+			{
+				Vec<decltype(du)> mag0, sign0, mag1, sign1;
+				if(reversible)
+				{
+					auto src = (const int32_t*)buf + x;
+					auto t = LoadU(di, src);
+					mag0 = ShiftLeftSame(BitCast(du, Abs(t)), (int)p);
+					sign0 = ShiftRight<31>(BitCast(du, t));
+					t = rows > 1 ? LoadU(di, src + bottom) : Zero(di);
+					mag1 = ShiftLeftSame(BitCast(du, Abs(t)), (int)p);
+					sign1 = ShiftRight<31>(BitCast(du, t));
+				}
+				else
+				{
+					auto src = (const float*)buf + x;
+					auto t = ConvertTo(di, Mul(LoadU(df, src), vscale));
+					mag0 = BitCast(du, Abs(t));
+					sign0 = ShiftRight<31>(BitCast(du, t));
+					t = rows > 1 ? ConvertTo(di, Mul(LoadU(df, src + bottom), vscale)) : Zero(di);
+					mag1 = BitCast(du, Abs(t));
+					sign1 = ShiftRight<31>(BitCast(du, t));
+				}
+				Vec<decltype(du)> e0, s0, e1, s1;
+				prepare(du, mag0, sign0, (int)p, e0, s0);
+				prepare(du, mag1, sign1, (int)p, e1, s1);
+				// quad order: top-left, bottom-left, top-right, bottom-right
+				StoreInterleaved2(e0, e1, du, e + 2 * x);
+				StoreInterleaved2(s0, s1, du, s + 2 * x);
+			}
+			for(; x < width; ++x)
+			{
+				uint32_t mag, sign;
+				loadSample(buf, x, reversible, scale, p, &mag, &sign);
+				prepareSample(mag, sign, p, e + 2 * x, s + 2 * x);
+				if(rows > 1)
+				{
+					loadSample(buf, x + bottom, reversible, scale, p, &mag, &sign);
+					prepareSample(mag, sign, p, e + 2 * x + 1, s + 2 * x + 1);
+				}
+				else
+				{
+					e[2 * x + 1] = 0;
+					s[2 * x + 1] = 0;
+				}
+			}
+			for(; x < ((width + 3) & ~3U); ++x)
+			{
+				e[2 * x] = e[2 * x + 1] = 0;
+				s[2 * x] = s[2 * x + 1] = 0;
+			}
+		}
+	} // namespace HWY_NAMESPACE
+} // namespace local
+} // namespace ojph
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace ojph
+{
+namespace local
+{
+	HWY_EXPORT(hwy_prepare_ht_rows);
+	void ojph_prepare_ht_rows(const void* buf, ui32 stride, ui32 width, ui32 rows, ui32 p,
+							  bool reversible, float scale, ui32* e, ui32* s)
+	{
+		HWY_DYNAMIC_DISPATCH(hwy_prepare_ht_rows)
+		(buf, stride, width, rows, p, reversible, scale, e, s);
+	}
+} // namespace local
+} // namespace ojph
+#endif
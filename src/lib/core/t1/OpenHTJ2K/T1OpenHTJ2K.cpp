@@ -52,8 +52,7 @@ void T1OpenHTJ2K::preCompress([[maybe_unused]] grk::CompressBlockExec* block,
 	auto cblk = block->cblk;
 	uint16_t w = (uint16_t)cblk->width();
 	uint16_t h = (uint16_t)cblk->height();
-	uint32_t tile_width =
-		(tile->comps + block->compno)->getWindow()->getResWindowBufferHighestStride();
+	uint32_t tile_width = block->stride;
 	auto tileLineAdvance = tile_width - w;
 	uint32_t cblk_index = 0;
 
@@ -127,8 +126,8 @@ bool T1OpenHTJ2K::decompress(grk::DecompressBlockExec* block)
 		size_t offset = 0;
 		for(auto& b : cblk->seg_buffers)
 		{
-			memcpy(coded_data + offset, b->buf, b->len);
-			offset += b->len;
+			memcpy(coded_data + offset, b.buf, b.len);
+			offset += b.len;
 		}
 
 		size_t num_passes = 0;
@@ -0,0 +1,150 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *    This source code incorporates work covered by the BSD 2-clause license.
+ *    Please see the LICENSE file in the root directory for details.
+ *
+ */
+#include <cstdlib>
+#include "PostT1Dequantize.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "t1/PostT1Dequantize.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	static void hwy_post_t1_dequantize_part1(int32_t* dest, const int32_t* src, uint32_t len,
+											 uint32_t roiShift, bool reversible, float scale)
+	{
+		const HWY_FULL(int32_t) di;
+		const RebindToUnsigned<decltype(di)> du;
+		const RebindToFloat<decltype(di)> df;
+		const size_t N = Lanes(di);
+		const int32_t thresh = 1 << roiShift;
+		const auto vthresh = Set(di, thresh);
+		const auto vscale = Set(df, scale);
+		uint32_t i = 0;
+		for(; i + N <= len; i += (uint32_t)N)
+		{
+			auto val = LoadU(di, src + i);
+			if(roiShift)
+			{
+				auto mag = Abs(val);
+				auto shifted = ShiftRightSame(mag, (int)roiShift);
+				shifted = IfThenElse(val < Zero(di), Neg(shifted), shifted);
+				val = IfThenElse(mag < vthresh, val, shifted);
+			}
+			if(reversible)
+			{
+				// round towards zero, as integer division by two does
+				auto bias = BitCast(di, ShiftRight<31>(BitCast(du, val)));
+				StoreU(ShiftRight<1>(val + bias), di, dest + i);
+			}
+			else
+			{
+				StoreU(Mul(ConvertTo(df, val), vscale), df, (float*)dest + i);
+			}
+		}
+		for(; i < len; ++i)
+		{
+			int32_t val = src[i];
+			if(roiShift)
+			{
+				int32_t mag = abs(val);
+				if(mag >= thresh)
+				{
+					mag >>= roiShift;
+					val = val < 0 ? -mag : mag;
+				}
+			}
+			if(reversible)
+				dest[i] = val / 2;
+			else
+				((float*)dest)[i] = (float)val * scale;
+		}
+	}
+
+	static void hwy_post_t1_dequantize_ht(int32_t* dest, const int32_t* src, uint32_t len,
+										  uint32_t shift, bool reversible, float scale)
+	{
+		const HWY_FULL(int32_t) di;
+		const RebindToFloat<decltype(di)> df;
+		const size_t N = Lanes(di);
+		const auto magMask = Set(di, 0x7FFFFFFF);
+		const auto signMask = Set(di, (int32_t)0x80000000);
+		const auto vscale = Set(df, scale);
+		uint32_t i = 0;
+		for(; i + N <= len; i += (uint32_t)N)
+		{
+			auto val = LoadU(di, src + i);
+			auto mag = And(val, magMask);
+			if(reversible)
+			{
+				auto shifted = ShiftRightSame(mag, (int)shift);
+				StoreU(IfThenElse(val < Zero(di), Neg(shifted), shifted), di, dest + i);
+			}
+			else
+			{
+				// negate by transferring the sign bit
+				auto scaled = BitCast(di, Mul(ConvertTo(df, mag), vscale));
+				StoreU(BitCast(df, Or(scaled, And(val, signMask))), df, (float*)dest + i);
+			}
+		}
+		for(; i < len; ++i)
+		{
+			int32_t val = src[i];
+			int32_t mag = val & 0x7FFFFFFF;
+			if(reversible)
+			{
+				int32_t shifted = mag >> shift;
+				dest[i] = val < 0 ? -shifted : shifted;
+			}
+			else
+			{
+				float scaled = (float)mag * scale;
+				((float*)dest)[i] = val < 0 ? -scaled : scaled;
+			}
+		}
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_post_t1_dequantize_part1);
+HWY_EXPORT(hwy_post_t1_dequantize_ht);
+
+void postT1DequantizePart1(int32_t* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+						   bool reversible, float scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_post_t1_dequantize_part1)
+	(dest, src, len, roiShift, reversible, scale);
+}
+void postT1DequantizeHT(int32_t* dest, const int32_t* src, uint32_t len, uint32_t shift,
+						bool reversible, float scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_post_t1_dequantize_ht)(dest, src, len, shift, reversible, scale);
+}
+} // namespace grk
+#endif
@@ -0,0 +1,56 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *    This source code incorporates work covered by the BSD 2-clause license.
+ *    Please see the LICENSE file in the root directory for details.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace grk
+{
+/**
+ * Convert a row of Part-1 T1 output, which carries one extra fractional bit,
+ * to reversible integer or irreversible float samples.
+ *
+ * @param dest destination row (float for irreversible)
+ * @param src source row; may equal dest
+ * @param len number of samples
+ * @param roiShift ROI shift, or zero if there is no ROI
+ * @param reversible true for integer output
+ * @param scale dequantization scale for irreversible output
+ */
+void postT1DequantizePart1(int32_t* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+						   bool reversible, float scale);
+
+/**
+ * Convert a row of HT T1 output, in sign-magnitude form with magnitudes
+ * shifted up to bit 30, to reversible integer or irreversible float samples.
+ *
+ * @param dest destination row (float for irreversible)
+ * @param src source row; may equal dest
+ * @param len number of samples
+ * @param shift magnitude down shift for reversible output
+ * @param reversible true for integer output
+ * @param scale dequantization scale for irreversible output
+ */
+void postT1DequantizeHT(int32_t* dest, const int32_t* src, uint32_t len, uint32_t shift,
+						bool reversible, float scale);
+
+} // namespace grk
@@ -26,14 +26,17 @@ T1Interface* T1Factory::makeT1(bool isCompressor, TileCodingParams* tcp, uint32_
 							   uint32_t maxCblkH)
 {
 	if(tcp->isHT())
-	{
+		return makeT1HT(isCompressor, tcp, maxCblkW, maxCblkH);
+	return (T1Interface*)(new t1_part1::T1Part1(isCompressor, maxCblkW, maxCblkH));
+}
+T1Interface* T1Factory::makeT1HT(bool isCompressor, TileCodingParams* tcp, uint32_t maxCblkW,
+								 uint32_t maxCblkH)
+{
 #ifdef OPENHTJ2K
-		return (T1Interface*)(new openhtj2k::T1OpenHTJ2K(isCompressor, tcp, maxCblkW, maxCblkH));
+	return (T1Interface*)(new openhtj2k::T1OpenHTJ2K(isCompressor, tcp, maxCblkW, maxCblkH));
 #else
-		return (T1Interface*)(new ojph::T1OJPH(isCompressor, tcp, maxCblkW, maxCblkH));
+	return (T1Interface*)(new ojph::T1OJPH(isCompressor, tcp, maxCblkW, maxCblkH));
 #endif
-	}
-	return (T1Interface*)(new t1_part1::T1Part1(isCompressor, maxCblkW, maxCblkH));
 }
 
 Quantizer* T1Factory::makeQuantizer(bool ht, bool reversible, uint8_t guardBits)
@@ -26,6 +26,11 @@ class T1Factory
   public:
 	static T1Interface* makeT1(bool isCompressor, TileCodingParams* tcp, uint32_t maxCblkW,
 							   uint32_t maxCblkH);
+	/**
+	 * Create HT block coder, regardless of code block style of tile coding parameters
+	 */
+	static T1Interface* makeT1HT(bool isCompressor, TileCodingParams* tcp, uint32_t maxCblkW,
+								 uint32_t maxCblkH);
 	static Quantizer* makeQuantizer(bool ht, bool reversible, uint8_t guardBits);
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "grk_includes.h"
+#include "PostT1Dequantize.h"
 
 namespace grk
 {
@@ -11,18 +12,7 @@ class RoiShiftFilter
 	RoiShiftFilter(DecompressBlockExec* block) : roiShift(block->roishift) {}
 	inline void copy(T* dest, T* src, uint32_t len)
 	{
-		T thresh = 1 << roiShift;
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			T val = src[i];
-			T mag = abs(val);
-			if(mag >= thresh)
-			{
-				mag >>= roiShift;
-				val = val < 0 ? -mag : mag;
-			}
-			dest[i] = val / 2;
-		}
+		postT1DequantizePart1(dest, src, len, roiShift, true, 0);
 	}
 
   private:
@@ -35,8 +25,7 @@ class ShiftFilter
 	ShiftFilter([[maybe_unused]] DecompressBlockExec* block) {}
 	inline void copy(T* dest, T* src, uint32_t len)
 	{
-		for(uint32_t i = 0; i < len; ++i)
-			dest[i] = src[i] / 2;
+		postT1DequantizePart1(dest, src, len, 0, true, 0);
 	}
 };
 
@@ -49,18 +38,7 @@ class RoiScaleFilter
 	{}
 	inline void copy(T* dest, T* src, uint32_t len)
 	{
-		T thresh = 1 << roiShift;
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			T val = src[i];
-			T mag = abs(val);
-			if(mag >= thresh)
-			{
-				mag >>= roiShift;
-				val = val < 0 ? -mag : mag;
-			}
-			((float*)dest)[i] = (float)val * scale;
-		}
+		postT1DequantizePart1(dest, src, len, roiShift, false, scale);
 	}
 
   private:
@@ -75,8 +53,7 @@ class ScaleFilter
 	ScaleFilter(DecompressBlockExec* block) : scale(block->stepsize / 2) {}
 	inline void copy(T* dest, T* src, uint32_t len)
 	{
-		for(uint32_t i = 0; i < len; ++i)
-			((float*)dest)[i] = (float)src[i] * scale;
+		postT1DequantizePart1(dest, src, len, 0, false, scale);
 	}
 
   private:
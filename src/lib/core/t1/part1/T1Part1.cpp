@@ -36,7 +36,6 @@ namespace t1_part1
 	}
 	bool T1Part1::preCompress(CompressBlockExec* block, uint32_t& maximum)
 	{
-		auto tile = block->tile;
 		auto cblk = block->cblk;
 		auto w = cblk->width();
 		auto h = cblk->height();
@@ -47,8 +46,7 @@ namespace t1_part1
 		}
 		if(!t1->alloc(w, h))
 			return false;
-		auto tileLineAdvance =
-			(tile->comps + block->compno)->getWindow()->getResWindowBufferHighestStride() - w;
+		auto tileLineAdvance = block->stride - w;
 		uint32_t tileIndex = 0;
 		uint32_t cblk_index = 0;
 		maximum = 0;
@@ -111,11 +109,13 @@ namespace t1_part1
 
 		cblkexp.data = cblk->paddedCompressedStream;
 
+		double truncationSlope =
+			block->slopeEstimator ? block->slopeEstimator->getTruncationSlope() : 0;
 		auto distortion = t1->compress_cblk(
 			&cblkexp, max, block->bandOrientation, block->compno,
 			(uint8_t)((block->tile->comps + block->compno)->numresolutions - 1 - block->resno),
 			block->qmfbid, block->stepsize, block->cblk_sty, block->mct_norms, block->mct_numcomps,
-			block->doRateControl);
+			block->doRateControl, truncationSlope);
 
 		cblk->numPassesTotal = cblkexp.numPassesTotal;
 		cblk->numbps = cblkexp.numbps;
@@ -128,6 +128,8 @@ namespace t1_part1
 			passgrk->rate = passexp->rate;
 			passgrk->term = passexp->term;
 		}
+		if(block->slopeEstimator)
+			block->slopeEstimator->update(cblk->passes, cblk->numPassesTotal);
 
 		t1->code_block_enc_deallocate(&cblkexp);
 		cblkexp.data = nullptr;
@@ -146,18 +148,19 @@ namespace t1_part1
 		{
 			if(!cblk->seg_buffers.empty())
 			{
-				size_t totalSegLen =
-					cblk->getSegBuffersLen() + grk_cblk_dec_compressed_data_pad_right;
-				t1->allocCompressedData(totalSegLen);
-				size_t offset = 0;
-				auto compressedData = t1->getCompressedDataBuffer();
-				for(auto& b : cblk->seg_buffers)
+				T1Checkpoint* checkpoint = nullptr;
+				if(block->stateCache)
 				{
-					memcpy(compressedData + offset, b->buf, b->len);
-					offset += b->len;
+					checkpoint = (T1Checkpoint*)block->stateCache->get(
+						block->compno, block->resno, block->bandIndex, block->x, block->y);
+					if(!checkpoint)
+					{
+						checkpoint = new T1Checkpoint();
+						block->stateCache->put(block->compno, block->resno, block->bandIndex,
+											   block->x, block->y, checkpoint);
+					}
 				}
-				bool ret = t1->decompress_cblk(cblk, compressedData, block->bandOrientation,
-											   block->cblk_sty);
+				bool ret = decompressSegments(block, checkpoint);
 				cblk->setCacheState(ret ? GRK_CACHE_STATE_OPEN : GRK_CACHE_STATE_ERROR);
 				if(!ret)
 					return false;
@@ -169,6 +172,33 @@ namespace t1_part1
 
 		return true;
 	}
+	bool T1Part1::decompressIndices(DecompressBlockExec* block, int32_t* dest)
+	{
+		auto cblk = block->cblk;
+		auto area = cblk->area();
+		memset(dest, 0, area * sizeof(int32_t));
+		if(cblk->seg_buffers.empty())
+			return true;
+		t1->attachUncompressedData(dest, cblk->width(), cblk->height());
+		if(!decompressSegments(block, nullptr))
+			return false;
+		// decoded samples carry one fractional bit: truncate towards zero
+		for(uint64_t i = 0; i < area; ++i)
+			dest[i] /= 2;
+
+		return true;
+	}
+	bool T1Part1::decompressSegments(DecompressBlockExec* block, T1Checkpoint* checkpoint)
+	{
+		auto cblk = block->cblk;
+		size_t totalSegLen = cblk->getSegBuffersLen() + grk_cblk_dec_compressed_data_pad_right;
+		t1->allocCompressedData(totalSegLen);
+		auto compressedData = t1->getCompressedDataBuffer();
+		cblk->copyToContiguousBuffer(compressedData);
+
+		return t1->decompress_cblk(cblk, compressedData, block->bandOrientation, block->cblk_sty,
+								   checkpoint);
+	}
 
 } // namespace t1_part1
 } // namespace grk
@@ -30,9 +30,18 @@ namespace t1_part1
 
 		bool compress(CompressBlockExec* block);
 		bool decompress(DecompressBlockExec* block);
+		/**
+		 * Decompress code block to quantization indices, without any post processing
+		 *
+		 * @param block code block to decompress
+		 * @param dest destination buffer of code block area, with stride equal to
+		 * code block width
+		 */
+		bool decompressIndices(DecompressBlockExec* block, int32_t* dest);
 
 	  private:
 		bool preCompress(CompressBlockExec* block, uint32_t& max);
+		bool decompressSegments(DecompressBlockExec* block, T1Checkpoint* checkpoint);
 		T1* t1;
 	};
 } // namespace t1_part1
@@ -754,7 +754,8 @@ void T1::enc_clnpass(int32_t bpno, int32_t* nmsedec, uint32_t cblksty)
 }
 double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint16_t compno,
 						 uint8_t level, uint8_t qmfbid, double stepsize, uint32_t cblksty,
-						 const double* mct_norms, uint16_t mct_numcomps, bool doRateControl)
+						 const double* mct_norms, uint16_t mct_numcomps, bool doRateControl,
+						 double truncationSlope)
 {
 	if(!code_block_enc_allocate(cblk))
 		return 0;
@@ -786,6 +787,10 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 	mqc_init_enc(mqc, cblk->data);
 
 	double cumwmsedec = 0.0;
+	// rate and distortion at end of previous bit plane
+	// (note: byte count starts at -1, so rate differences are taken modulo 2^32)
+	uint32_t planeRate = mqc_numbytes_enc(mqc);
+	double planeDistortion = 0.0;
 	uint32_t passno;
 	for(passno = 0; bpno >= 0; ++passno)
 	{
@@ -825,7 +830,20 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 			cumwmsedec += tempwmsedec;
 			pass->distortiondec = cumwmsedec;
 		}
-		if(enc_is_term_pass(cblk, cblksty, bpno, passtype))
+		// stop after a cleanup pass if the bit plane it completes has a distortion-rate
+		// slope below the truncation threshold: rate control will never include the
+		// remaining passes. Current pass is terminated, and becomes the final pass.
+		bool truncate = false;
+		if(doRateControl && truncationSlope > 0 && passtype == 2 && bpno > 0)
+		{
+			uint32_t numBytes = mqc_numbytes_enc(mqc);
+			uint32_t planeBytes = numBytes - planeRate;
+			if(planeBytes)
+				truncate = (cumwmsedec - planeDistortion) / planeBytes < truncationSlope;
+			planeRate = numBytes;
+			planeDistortion = cumwmsedec;
+		}
+		if(truncate || enc_is_term_pass(cblk, cblksty, bpno, passtype))
 		{
 			if(type == T1_TYPE_RAW)
 			{
@@ -867,6 +885,11 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 			pass->term = false;
 			pass->rate = mqc_numbytes_enc(mqc) + rate_extra_bytes;
 		}
+		if(truncate)
+		{
+			++passno;
+			break;
+		}
 		if(++passtype == 3)
 		{
 			passtype = 0;
@@ -1252,8 +1275,52 @@ void T1::dec_refpass_mqc(int32_t bpno)
 	if(w == 64 && h == 64)
 		dec_refpass_mqc_internal(bpno, 64, 64, 66) else dec_refpass_mqc_internal(bpno, w, h, w + 2U)
 }
+bool T1::canResume(DecompressCodeblock* cblk, T1Checkpoint* checkpoint)
+{
+	if(!checkpoint->valid || checkpoint->numbps != cblk->numbps || checkpoint->w != w ||
+	   checkpoint->h != h || checkpoint->segno > cblk->getNumSegments())
+		return false;
+	// compressed data preceding checkpoint must not have changed
+	uint32_t dataIndex = 0;
+	for(uint32_t segno = 0; segno < checkpoint->segno; ++segno)
+		dataIndex += cblk->getSegment(segno)->len;
+	if(dataIndex != checkpoint->dataIndex)
+		return false;
+	if(checkpoint->segPasses)
+	{
+		if(checkpoint->segno == cblk->getNumSegments())
+			return false;
+		auto seg = cblk->getSegment(checkpoint->segno);
+		if(seg->numpasses < checkpoint->segPasses || seg->len < checkpoint->segLen)
+			return false;
+	}
+
+	return true;
+}
+void T1::saveCheckpoint(T1Checkpoint* checkpoint)
+{
+	auto mqc = &coder;
+	checkpoint->c = mqc->c;
+	checkpoint->a = mqc->a;
+	checkpoint->ct = mqc->ct;
+	checkpoint->bpOffset = (uint32_t)(mqc->bp - mqc->start);
+	memcpy(checkpoint->ctxs, mqc->ctxs, sizeof(mqc->ctxs));
+	checkpoint->curctx = (uint32_t)(mqc->curctx - mqc->ctxs);
+	checkpoint->data.assign(uncompressedData, uncompressedData + (size_t)w * h);
+	checkpoint->flags.assign(flags, flags + flagssize);
+	checkpoint->w = w;
+	checkpoint->h = h;
+	checkpoint->valid = true;
+}
+void T1::restoreCheckpoint(T1Checkpoint* checkpoint)
+{
+	auto mqc = &coder;
+	memcpy(mqc->ctxs, checkpoint->ctxs, sizeof(mqc->ctxs));
+	memcpy(uncompressedData, checkpoint->data.data(), checkpoint->data.size() * sizeof(int32_t));
+	memcpy(flags, checkpoint->flags.data(), checkpoint->flags.size() * sizeof(grk_flag));
+}
 bool T1::decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData, uint8_t orientation,
-						 uint32_t cblksty)
+						 uint32_t cblksty, T1Checkpoint* checkpoint)
 {
 	auto mqc = &coder;
 	uint32_t cblkdataindex = 0;
@@ -1266,22 +1333,59 @@ bool T1::decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData, uin
 		return false;
 	}
 	uint32_t passtype = 2;
-	mqc_resetstates(mqc);
+	uint32_t segno = 0;
+	uint32_t resumePasses = 0;
+	uint32_t numSegments = cblk->getNumSegments();
+	if(checkpoint && canResume(cblk, checkpoint))
+	{
+		restoreCheckpoint(checkpoint);
+		segno = checkpoint->segno;
+		resumePasses = checkpoint->segPasses;
+		cblkdataindex = checkpoint->dataIndex;
+		passtype = checkpoint->passtype;
+		bpno_plus_one = checkpoint->bpno_plus_one;
+	}
+	else
+	{
+		mqc_resetstates(mqc);
+	}
 
-	for(uint32_t segno = 0; segno < cblk->getNumSegments(); ++segno)
+	for(; segno < numSegments; ++segno)
 	{
 		auto seg = cblk->getSegment(segno);
-		/* BYPASS mode */
-		uint8_t type = ((bpno_plus_one <= ((int32_t)(cblk->numbps)) - 4) && (passtype < 2) &&
-						(cblksty & GRK_CBLKSTY_LAZY))
-						   ? T1_TYPE_RAW
-						   : T1_TYPE_MQ;
-		if(type == T1_TYPE_RAW)
-			mqc_raw_init_dec(mqc, compressedData + cblkdataindex, seg->len);
+		uint32_t passno = 0;
+		uint8_t type;
+		if(resumePasses)
+		{
+			type = checkpoint->type;
+			mqc_resume_dec(mqc, compressedData + cblkdataindex, seg->len, checkpoint->bpOffset);
+			mqc->c = checkpoint->c;
+			mqc->a = checkpoint->a;
+			mqc->ct = checkpoint->ct;
+			mqc->curctx = mqc->ctxs + checkpoint->curctx;
+			passno = resumePasses;
+			resumePasses = 0;
+		}
 		else
-			mqc_init_dec(mqc, compressedData + cblkdataindex, seg->len);
-		cblkdataindex += seg->len;
-		for(uint32_t passno = 0; (passno < seg->numpasses) && (bpno_plus_one >= 1); ++passno)
+		{
+			/* BYPASS mode */
+			type = ((bpno_plus_one <= ((int32_t)(cblk->numbps)) - 4) && (passtype < 2) &&
+					(cblksty & GRK_CBLKSTY_LAZY))
+					   ? T1_TYPE_RAW
+					   : T1_TYPE_MQ;
+			if(type == T1_TYPE_RAW)
+				mqc_raw_init_dec(mqc, compressedData + cblkdataindex, seg->len);
+			else
+				mqc_init_dec(mqc, compressedData + cblkdataindex, seg->len);
+		}
+		// checkpoints are taken inside the final segment if more passes may be added to it,
+		// at layer boundaries, since refinement only adds whole layers
+		bool checkpointPasses =
+			checkpoint && segno == numSegments - 1 && seg->numpasses < seg->maxpasses;
+		uint32_t segStartPass = 0;
+		for(uint32_t i = 0; checkpointPasses && i < segno; ++i)
+			segStartPass += cblk->getSegment(i)->numpasses;
+		for(; (passno < seg->numpasses) && (bpno_plus_one >= 1); ++passno)
 		{
 			switch(passtype)
 			{
@@ -1309,9 +1413,40 @@ bool T1::decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData, uin
 				passtype = 0;
 				bpno_plus_one--;
 			}
+			// decoder state is only exact if no byte has been read
+			// from the synthetic marker at the end of the segment
+			if(checkpointPasses && cblk->endsLayer(segStartPass + passno + 1) &&
+			   mqc->bp < mqc->end &&
+			   (type == T1_TYPE_RAW || mqc->end_of_byte_stream_counter == 0))
+			{
+				checkpoint->segno = segno;
+				checkpoint->segPasses = passno + 1;
+				checkpoint->segLen = seg->len;
+				checkpoint->dataIndex = cblkdataindex;
+				checkpoint->passtype = passtype;
+				checkpoint->bpno_plus_one = bpno_plus_one;
+				checkpoint->type = type;
+				saveCheckpoint(checkpoint);
+			}
 		}
+		cblkdataindex += seg->len;
 		mqc_finish_dec(mqc);
+		if(checkpoint && segno == numSegments - 1 &&
+		   (seg->numpasses == seg->maxpasses || bpno_plus_one < 1))
+		{
+			// final segment is complete : resume from next segment
+			checkpoint->segno = numSegments;
+			checkpoint->segPasses = 0;
+			checkpoint->segLen = 0;
+			checkpoint->dataIndex = cblkdataindex;
+			checkpoint->passtype = passtype;
+			checkpoint->bpno_plus_one = bpno_plus_one;
+			checkpoint->type = type;
+			saveCheckpoint(checkpoint);
+		}
 	}
+	if(checkpoint)
+		checkpoint->numbps = cblk->numbps;
 	if(check_pterm)
 	{
 		if(mqc->bp + 2 < mqc->end)
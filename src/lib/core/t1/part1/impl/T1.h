@@ -28,18 +28,55 @@ namespace grk
 typedef uint32_t grk_flag;
 struct DecompressCodeblock;
 
+/**
+ * Decoder state of a code block at a coding pass boundary,
+ * from which decoding can resume when more passes become available
+ */
+struct T1Checkpoint : public ICodeblockState
+{
+	T1Checkpoint()
+		: valid(false), numbps(0), w(0), h(0), segno(0), segPasses(0), segLen(0), dataIndex(0),
+		  passtype(0), bpno_plus_one(0), type(0), c(0), a(0), ct(0), bpOffset(0), curctx(0)
+	{}
+	bool valid;
+	uint8_t numbps;
+	uint32_t w;
+	uint32_t h;
+	/** segment to resume from */
+	uint32_t segno;
+	/** number of passes of segment already decoded (0 to start a new segment) */
+	uint32_t segPasses;
+	/** segment length when checkpoint was taken */
+	uint32_t segLen;
+	/** offset of segment in code block data */
+	uint32_t dataIndex;
+	uint32_t passtype;
+	int32_t bpno_plus_one;
+	uint8_t type;
+	/** MQ/raw decoder registers */
+	uint32_t c;
+	uint32_t a;
+	uint32_t ct;
+	uint32_t bpOffset;
+	const mqc_state* ctxs[MQC_NUMCTXS];
+	uint32_t curctx;
+	std::vector<int32_t> data;
+	std::vector<grk_flag> flags;
+};
+
 struct T1
 {
 	T1(bool isCompressor, uint32_t maxCblkW, uint32_t maxCblkH);
 	~T1();
 
 	bool decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData, uint8_t orientation,
-						 uint32_t cblksty);
+						 uint32_t cblksty, T1Checkpoint* checkpoint);
 	void code_block_enc_deallocate(cblk_enc* p_code_block);
 	bool alloc(uint32_t w, uint32_t h);
 	double compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint16_t compno,
 						 uint8_t level, uint8_t qmfbid, double stepsize, uint32_t cblksty,
-						 const double* mct_norms, uint16_t mct_numcomps, bool doRateControl);
+						 const double* mct_norms, uint16_t mct_numcomps, bool doRateControl,
+						 double truncationSlope);
 	mqcoder coder;
 
 	int32_t* getUncompressedData(void);
@@ -73,6 +110,10 @@ struct T1
 	uint32_t flagssize;
 	bool compressor;
 
+	bool canResume(DecompressCodeblock* cblk, T1Checkpoint* checkpoint);
+	void saveCheckpoint(T1Checkpoint* checkpoint);
+	void restoreCheckpoint(T1Checkpoint* checkpoint);
+
 	template<uint32_t w, uint32_t h, bool vsc>
 	void dec_clnpass(int32_t bpno);
 	void dec_clnpass(int32_t bpno, int32_t cblksty);
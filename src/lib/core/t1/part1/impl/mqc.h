@@ -124,6 +124,19 @@ passes, so as to restore the bytes temporarily overwritten.
 */
 void mqc_raw_init_dec(mqcoder* mqc, uint8_t* bp, uint32_t len);
 
+/**
+Initialize the decoder to resume MQ or RAW decoding part way through a buffer.
+
+Decoder registers and contexts must then be restored by the caller, and
+mqc_finish_dec() must be called after finishing the decoding passes.
+
+@param mqc MQC handle
+@param bp Pointer to the start of the buffer
+@param len Length of the input buffer
+@param offset Offset in buffer of current position
+*/
+void mqc_resume_dec(mqcoder* mqc, uint8_t* bp, uint32_t len, uint32_t offset);
+
 /**
 Terminate RAW/MQC decoding
 
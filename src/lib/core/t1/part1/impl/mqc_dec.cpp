@@ -111,6 +111,13 @@ void mqc_raw_init_dec(mqcoder* mqc, uint8_t* bp, uint32_t len)
 	mqc->ct = 0;
 }
 
+void mqc_resume_dec(mqcoder* mqc, uint8_t* bp, uint32_t len, uint32_t offset)
+{
+	mqc_init_dec_common(mqc, bp, len);
+	mqc->bp = bp + offset;
+	mqc->end_of_byte_stream_counter = 0;
+}
+
 void mqc_finish_dec(mqcoder* mqc)
 {
 	/* Restore the bytes overwritten by mqc_init_dec_common() */
@@ -20,18 +20,57 @@
 
 #include "grk_includes.h"
 
+#include <array>
+#include <bit>
+
 namespace grk
 {
+/*
+ Pass count code words, indexed by next nine bits of packet header.
+ Each entry holds number of passes in its low byte and code word length in its high byte.
+ 37 passes signals a further seven bit extension.
+ */
+static constexpr auto numPassesTable = [] {
+	std::array<uint16_t, 512> table{};
+	for(uint32_t i = 0; i < 512; ++i)
+	{
+		uint32_t passes = 37, len = 9;
+		if(!(i >> 8))
+		{
+			passes = 1;
+			len = 1;
+		}
+		else if(!((i >> 7) & 1))
+		{
+			passes = 2;
+			len = 2;
+		}
+		else if(((i >> 5) & 3) != 3)
+		{
+			passes = 3 + ((i >> 5) & 3);
+			len = 4;
+		}
+		else if((i & 31) != 31)
+		{
+			passes = 6 + (i & 31);
+		}
+		table[i] = (uint16_t)(passes | (len << 8));
+	}
+	return table;
+}();
+
 BitIO::BitIO(uint8_t* bp, uint64_t len, bool isCompressor)
 	: start(bp), offset(0), buf_len(len), buf(0), ct(isCompressor ? 8 : 0), stream(nullptr),
-	  read0xFF(false)
+	  read0xFF(false), bitBuf_(0), bitBufLen_(0), loadError_(GRK_BITIO_ERROR_NONE),
+	  readError_(GRK_BITIO_ERROR_NONE)
 {
 	assert(isCompressor || bp);
 }
 
 BitIO::BitIO(BufferedStream* strm, bool isCompressor)
 	: start(nullptr), offset(0), buf_len(0), buf(0), ct(isCompressor ? 8 : 0), stream(strm),
-	  read0xFF(false)
+	  read0xFF(false), bitBuf_(0), bitBufLen_(0), loadError_(GRK_BITIO_ERROR_NONE),
+	  readError_(GRK_BITIO_ERROR_NONE)
 {}
 
 bool BitIO::writeByte(void)
@@ -55,24 +94,82 @@ bool BitIO::writeByte(void)
 	return true;
 }
 
-void BitIO::bytein(void)
+bool BitIO::loadByte(void)
 {
 	if(offset == buf_len)
-		throw TruncatedPacketHeaderException();
+	{
+		loadError_ = GRK_BITIO_ERROR_TRUNCATED;
+		return false;
+	}
 	if(read0xFF && (buf >= 0x90))
 	{
-		uint16_t marker = (uint16_t)(((uint16_t)0xFF << 8) | (uint16_t)buf);
-		if(marker != J2K_MS_EPH && marker != J2K_MS_SOP)
-			GRK_WARN("Invalid marker 0x%x detected in packet header", marker);
-		else
-			GRK_WARN("Unexpected SOP/EPH marker 0x%x detected in packet header", marker);
-
-		throw InvalidMarkerException(marker);
+		loadError_ = GRK_BITIO_ERROR_MARKER;
+		return false;
 	}
 	read0xFF = (buf == 0xff);
-	ct = read0xFF ? 7 : 8;
+	uint8_t width = read0xFF ? 7 : 8;
 	buf = start[offset];
 	offset++;
+	bitBufLen_ = (uint8_t)(bitBufLen_ + width);
+	bitBuf_ |= (uint64_t)(buf & ((1 << width) - 1)) << (64 - bitBufLen_);
+
+	return true;
+}
+
+void BitIO::fill(void)
+{
+	while(bitBufLen_ <= 56)
+	{
+		// no 0xFF in next eight bytes, so no stuffed bits or markers:
+		// load as many of them as will fit in a single step
+		if(!read0xFF && buf != 0xff && buf_len - offset >= 8)
+		{
+			uint64_t bytes;
+			grk_read<uint64_t>(start + offset, &bytes);
+			auto inverted = ~bytes;
+			if(!((inverted - 0x0101010101010101ULL) & ~inverted & 0x8080808080808080ULL))
+			{
+				uint8_t numBytes = (uint8_t)((64 - bitBufLen_) >> 3);
+				uint8_t numBits = (uint8_t)(numBytes << 3);
+				bitBuf_ |= (bytes >> (64 - numBits)) << (64 - bitBufLen_ - numBits);
+				bitBufLen_ = (uint8_t)(bitBufLen_ + numBits);
+				offset += numBytes;
+				buf = start[offset - 1];
+				continue;
+			}
+		}
+		if(!loadByte())
+			break;
+	}
+}
+
+void BitIO::setReadError(void)
+{
+	assert(loadError_ != GRK_BITIO_ERROR_NONE);
+	if(readError_ == GRK_BITIO_ERROR_NONE)
+	{
+		readError_ = loadError_;
+		if(readError_ == GRK_BITIO_ERROR_MARKER)
+		{
+			uint16_t marker = (uint16_t)(((uint16_t)0xFF << 8) | (uint16_t)buf);
+			if(marker != J2K_MS_EPH && marker != J2K_MS_SOP)
+				GRK_WARN("Invalid marker 0x%x detected in packet header", marker);
+			else
+				GRK_WARN("Unexpected SOP/EPH marker 0x%x detected in packet header", marker);
+		}
+	}
+	bitBuf_ = 0;
+	bitBufLen_ = 0;
+}
+
+GrkBitIOError BitIO::readError(void)
+{
+	return readError_;
+}
+
+uint8_t BitIO::byteWidth(size_t pos)
+{
+	return (pos > 0 && start[pos - 1] == 0xff) ? 7 : 8;
 }
 
 bool BitIO::putbit(uint8_t b)
@@ -85,22 +182,60 @@ bool BitIO::putbit(uint8_t b)
 	return true;
 }
 
-void BitIO::getbit(uint32_t* bits, uint8_t pos)
+uint32_t BitIO::peek(uint8_t n)
+{
+	assert(n != 0 && n <= 32U);
+	if(bitBufLen_ < n)
+		fill();
+
+	return (uint32_t)(bitBuf_ >> (64 - n));
+}
+
+void BitIO::skip(uint8_t n)
 {
-	if(ct == 0)
-		bytein();
-	assert(ct > 0);
-	ct = (uint8_t)(ct - 1);
-	*bits |= (uint32_t)(((buf >> ct) & 1) << pos);
+	if(n > bitBufLen_)
+	{
+		setReadError();
+		return;
+	}
+	bitBuf_ = n < 64 ? bitBuf_ << n : 0;
+	bitBufLen_ = (uint8_t)(bitBufLen_ - n);
 }
-uint8_t BitIO::getbit(void)
+
+uint32_t BitIO::readRun(bool ones, uint32_t maxRun)
 {
-	if(ct == 0)
-		bytein();
-	assert(ct > 0);
-	ct = (uint8_t)(ct - 1);
+	uint32_t run = 0;
+	while(run < maxRun)
+	{
+		if(!bitBufLen_)
+		{
+			fill();
+			if(!bitBufLen_)
+			{
+				setReadError();
+				break;
+			}
+		}
+		// bits past end of buffer are zero, so they terminate a run of ones,
+		// but not a run of zeros
+		auto lz = std::min<uint32_t>(
+			(uint32_t)std::countl_zero(ones ? ~bitBuf_ : bitBuf_), bitBufLen_);
+		auto avail = std::min<uint32_t>(maxRun - run, bitBufLen_);
+		if(lz < avail)
+		{
+			skip((uint8_t)(lz + 1));
+			return run + lz;
+		}
+		skip((uint8_t)avail);
+		run += avail;
+	}
 
-	return (buf >> ct) & 1;
+	return run;
+}
+
+uint32_t BitIO::readZeroRun(uint32_t maxRun)
+{
+	return readRun(false, maxRun);
 }
 
 size_t BitIO::numBytes(void)
@@ -126,22 +261,16 @@ bool BitIO::write(uint32_t v)
 
 uint8_t BitIO::read(void)
 {
-	return getbit();
+	auto bit = (uint8_t)peek(1);
+	skip(1);
+
+	return bit;
 }
 
 void BitIO::read(uint32_t* bits, uint8_t n)
 {
-	assert(n != 0 && n <= 32U);
-#ifdef GRK_UBSAN_BUILD
-	/* This assert fails for some corrupted images which are gracefully rejected */
-	/* Add this assert only for ubsan build. */
-	/* This is the condition for overflow not to occur below which is needed because of
-	 * GROK_NOSANITIZE */
-	assert(n <= 32U);
-#endif
-	*bits = 0U;
-	for(int8_t i = (int8_t)(n - 1); i >= 0; i--)
-		getbit(bits, static_cast<uint8_t>(i));
+	*bits = peek(n);
+	skip(n);
 }
 
 bool BitIO::flush()
@@ -154,9 +283,25 @@ bool BitIO::flush()
 
 void BitIO::inalign()
 {
-	if(buf == 0xff)
-		bytein();
-	ct = 0;
+	// step back over bytes that were loaded into bit buffer but not read
+	size_t pos = offset;
+	uint32_t unread = bitBufLen_;
+	while(pos && unread >= byteWidth(pos - 1))
+	{
+		unread -= byteWidth(pos - 1);
+		pos--;
+	}
+	offset = pos;
+	buf = pos ? start[pos - 1] : 0;
+	read0xFF = pos > 1 && start[pos - 2] == 0xff;
+	bitBuf_ = 0;
+	bitBufLen_ = 0;
+	loadError_ = GRK_BITIO_ERROR_NONE;
+	// pass stuffed bits following 0xFF
+	if(buf == 0xff && !loadByte())
+		setReadError();
+	bitBuf_ = 0;
+	bitBufLen_ = 0;
 }
 
 bool BitIO::putcommacode(uint8_t n)
@@ -173,15 +318,7 @@ bool BitIO::putcommacode(uint8_t n)
 
 uint8_t BitIO::getcommacode(void)
 {
-	uint8_t n = 0;
-	uint8_t temp = read();
-	while(temp)
-	{
-		n++;
-		temp = read();
-	}
-
-	return n;
+	return (uint8_t)readRun(true, UINT8_MAX);
 }
 
 bool BitIO::putnumpasses(uint32_t n)
@@ -217,32 +354,15 @@ bool BitIO::putnumpasses(uint32_t n)
 
 void BitIO::getnumpasses(uint32_t* numpasses)
 {
-	uint32_t n = read();
-	if(!n)
-	{
-		*numpasses = 1;
-		return;
-	}
-	n = read();
-	if(!n)
+	auto entry = numPassesTable[peek(9)];
+	skip((uint8_t)(entry >> 8));
+	*numpasses = entry & 0xFF;
+	if(*numpasses == 37)
 	{
-		*numpasses = 2;
-		return;
-	}
-	read(&n, 2);
-	if(n != 3)
-	{
-		*numpasses = n + 3;
-		return;
-	}
-	read(&n, 5);
-	if(n != 31)
-	{
-		*numpasses = n + 6;
-		return;
+		uint32_t n;
+		read(&n, 7);
+		*numpasses += n;
 	}
-	read(&n, 7);
-	*numpasses = n + 37;
 }
 
 } // namespace grk
@@ -26,8 +26,23 @@
 
 namespace grk
 {
+/*
+ Read error: reported once a read needs bits that lie past the end of the buffer,
+ or past a marker
+ */
+enum GrkBitIOError
+{
+	GRK_BITIO_ERROR_NONE,
+	GRK_BITIO_ERROR_TRUNCATED,
+	GRK_BITIO_ERROR_MARKER
+};
+
 /*
  Bit input/output
+
+ The decoder buffers up to 64 bits at a time. A read past the end of the data
+ does not throw: it returns zero bits and sets a sticky error, to be checked
+ by the caller once the field it is decoding is complete.
  */
 class BitIO : public IBitIO
 {
@@ -36,8 +51,8 @@ class BitIO : public IBitIO
 	BitIO(BufferedStream* stream, bool isCompressor);
 
 	/*
-	 Number of bytes written.
-	 @return the number of bytes written
+	 Number of bytes written or, for decoder, number of bytes read up to last alignment
+	 @return the number of bytes
 	 */
 	size_t numBytes(void) override;
 
@@ -73,6 +88,20 @@ class BitIO : public IBitIO
 	bool putnumpasses(uint32_t n);
 	void getnumpasses(uint32_t* numpasses);
 
+	/*
+	 Read run of zero bits terminated by a one bit
+	 @param maxRun maximum number of zero bits to read
+	 @return number of zero bits read. If less than maxRun,
+	 then the terminating one bit has also been read
+	 */
+	uint32_t readZeroRun(uint32_t maxRun);
+
+	/*
+	 Read error
+	 @return GRK_BITIO_ERROR_NONE if all reads so far have succeeded
+	 */
+	GrkBitIOError readError(void);
+
   private:
 	/* pointer to the start of the buffer */
 	uint8_t* start;
@@ -80,15 +109,25 @@ class BitIO : public IBitIO
 	size_t offset;
 	size_t buf_len;
 
-	/* temporary place where each byte is read or written */
+	/* coder : byte being written. decoder : last byte loaded into bit buffer */
 	uint8_t buf;
-	/* coder : number of bits free to write. decoder : number of bits read */
+	/* coder : number of bits free to write */
 	uint8_t ct;
 
 	BufferedStream* stream;
 
+	/* decoder : true if byte preceding buf is 0xFF */
 	bool read0xFF;
 
+	/* decoder : bits loaded but not yet read, most significant bit first */
+	uint64_t bitBuf_;
+	/* decoder : number of bits in bitBuf_ */
+	uint8_t bitBufLen_;
+	/* decoder : reason why next byte can't be loaded, if any */
+	GrkBitIOError loadError_;
+	/* decoder : sticky read error */
+	GrkBitIOError readError_;
+
 	/*
 	 Write a bit
 	 @param bio BIO handle
@@ -96,12 +135,23 @@ class BitIO : public IBitIO
 	 */
 	bool putbit(uint8_t b);
 	/*
-	 Read a bit
-	 @param bio BIO handle
+	 Peek at next bits, without reading them
+	 @param n number of bits (at most 32)
+	 @return bits, padded with zeros past end of data
 	 */
-	void getbit(uint32_t* bits, uint8_t pos);
-
-	uint8_t getbit(void);
+	uint32_t peek(uint8_t n);
+	/*
+	 Skip bits that have been peeked at
+	 @param n number of bits
+	 */
+	void skip(uint8_t n);
+	/*
+	 Read run of identical bits terminated by a different bit
+	 @param ones true if run is made of one bits
+	 @param maxRun maximum run length
+	 @return run length
+	 */
+	uint32_t readRun(bool ones, uint32_t maxRun);
 
 	/*
 	 Write a byte
@@ -110,10 +160,23 @@ class BitIO : public IBitIO
 	 */
 	bool writeByte(void);
 	/*
-	 Read a byte
-	 @param bio BIO handle
+	 Load bytes into bit buffer until it holds more than 56 bits,
+	 or no more bytes can be loaded
+	 */
+	void fill(void);
+	/*
+	 Load a byte into bit buffer, removing stuffed bit that follows 0xFF
+	 @return true if successful, otherwise loadError_ is set
+	 */
+	bool loadByte(void);
+	/*
+	 Flag read past end of loadable data
+	 */
+	void setReadError(void);
+	/*
+	 Width of byte at position pos, once stuffed bit is removed
 	 */
-	void bytein(void);
+	uint8_t byteWidth(size_t pos);
 };
 
 } // namespace grk
@@ -98,7 +98,8 @@ void ResPrecinctInfo::print(void)
 PacketIter::PacketIter()
 	: compno(0), resno(0), precinctIndex(0), layno(0), numcomps(0), comps(nullptr), x(0), y(0),
 	  dx(0), dy(0), dxActive(0), dyActive(0), incrementInner(false), packetManager(nullptr),
-	  maxNumDecompositionResolutions(0), singleProgression_(false), compression_(false),
+	  maxNumDecompositionResolutions(0), numLayersToDecompress_(0), singleProgression_(false),
+	  compression_(false),
 	  precinctInfoOPT_(nullptr), px0grid_(0), py0grid_(0), skippedLeft_(false)
 {
 	memset(&prog, 0, sizeof(prog));
@@ -800,6 +801,7 @@ void PacketIter::init(PacketManager* packetMan, uint32_t pino, TileCodingParams*
 	packetManager = packetMan;
 	maxNumDecompositionResolutions =
 		packetManager->getTileProcessor()->getMaxNumDecompressResolutions();
+	numLayersToDecompress_ = compression ? tcp->numlayers : tcp->numLayersToDecompress;
 	singleProgression_ = packetManager->getNumProgressions() == 1;
 	compression_ = compression;
 	auto image = packetMan->getImage();
@@ -857,7 +859,9 @@ void PacketIter::init(PacketManager* packetMan, uint32_t pino, TileCodingParams*
 	genPrecinctInfo();
 	update_dxy();
 
-	if(singleProgression_)
+	// no packets are read after the final progression, so it can end
+	// at the last layer or resolution that is decompressed
+	if(singleProgression_ || (!compression && pino == packetManager->getNumProgressions() - 1))
 	{
 		switch(prog.progression)
 		{
@@ -1176,12 +1180,44 @@ bool PacketIter::skipPackets(SparseBuffer* src, uint64_t numPackets)
 
 	return true;
 }
-bool PacketIter::next_lrcpOPT([[maybe_unused]] SparseBuffer* src)
+uint16_t PacketIter::getLayerEnd(SparseBuffer* src)
+{
+	if(!src)
+		return prog.layE;
+	if(resno >= maxNumDecompositionResolutions)
+		return prog.layS;
+
+	return std::clamp<uint16_t>(numLayersToDecompress_, prog.layS, prog.layE);
+}
+bool PacketIter::skipLayers(SparseBuffer* src, uint16_t layE, uint64_t packetsPerLayer)
+{
+	if(layE >= prog.layE)
+		return true;
+
+	return skipPackets(src, (uint64_t)(prog.layE - layE) * packetsPerLayer);
+}
+bool PacketIter::next_lrcpOPT(SparseBuffer* src)
 {
 	for(; layno < prog.layE; layno++)
 	{
 		for(; resno < prog.resE; resno++)
 		{
+			// skip all packets of this layer in resolutions that are not decompressed
+			if(src && resno >= maxNumDecompositionResolutions)
+			{
+				uint64_t numPackets = 0;
+				for(uint8_t r = resno; r < prog.resE; ++r)
+				{
+					auto info = precinctInfoOPT_ + r;
+					auto res = comps->resolutions + r;
+					if(r < comps->numresolutions && info->valid && res->precinctGridWidth > 0 &&
+					   res->precinctGridHeight > 0)
+						numPackets += info->numPrecincts_;
+				}
+				if(!skipPackets(src, numPackets * (uint64_t)(prog.compE - prog.compS)))
+					return false;
+				break;
+			}
 			auto precInfo = precinctInfoOPT_ + resno;
 			if(!precInfoCheck(precInfo))
 				continue;
@@ -1206,7 +1242,7 @@ bool PacketIter::next_lrcpOPT([[maybe_unused]] SparseBuffer* src)
 
 	return false;
 }
-bool PacketIter::next_rlcpOPT([[maybe_unused]] SparseBuffer* src)
+bool PacketIter::next_rlcpOPT(SparseBuffer* src)
 {
 	for(; resno < prog.resE; resno++)
 	{
@@ -1215,7 +1251,8 @@ bool PacketIter::next_rlcpOPT([[maybe_unused]] SparseBuffer* src)
 			continue;
 
 		uint64_t precE = precInfo->numPrecincts_;
-		for(; layno < prog.layE; layno++)
+		auto layE = getLayerEnd(src);
+		for(; layno < layE; layno++)
 		{
 			for(; compno < prog.compE; compno++)
 			{
@@ -1231,6 +1268,8 @@ bool PacketIter::next_rlcpOPT([[maybe_unused]] SparseBuffer* src)
 			}
 			compno = prog.compS;
 		}
+		if(!skipLayers(src, layE, (uint64_t)(prog.compE - prog.compS) * precE))
+			return false;
 		layno = prog.layS;
 	}
 
@@ -1293,13 +1332,16 @@ bool PacketIter::next_cprlOPT(SparseBuffer* src)
 					if(!genPrecinctX0GridPCRL_OPT(rpInfo))
 						continue;
 					precinctIndex = px0grid_ + (uint64_t)py0grid_ * res->precinctGridWidth;
+					auto layE = getLayerEnd(src);
 					if(incrementInner)
 						layno++;
-					if(layno < prog.layE)
+					if(layno < layE)
 					{
 						incrementInner = true;
 						return true;
 					}
+					if(!skipLayers(src, layE, 1))
+						return false;
 					layno = prog.layS;
 					incrementInner = false;
 				}
@@ -1352,13 +1394,16 @@ bool PacketIter::next_pcrlOPT([[maybe_unused]] SparseBuffer* src)
 					if(!genPrecinctX0GridPCRL_OPT(rpInfo))
 						continue;
 					precinctIndex = px0grid_ + (uint64_t)py0grid_ * res->precinctGridWidth;
+					auto layE = getLayerEnd(src);
 					if(incrementInner)
 						layno++;
-					if(layno < prog.layE)
+					if(layno < layE)
 					{
 						incrementInner = true;
 						return true;
 					}
+					if(!skipLayers(src, layE, 1))
+						return false;
 					layno = prog.layS;
 					incrementInner = false;
 				}
@@ -1433,16 +1478,19 @@ bool PacketIter::next_rpclOPT(SparseBuffer* src)
 						return false;
 				}
 				genPrecinctX0GridRPCL_OPT(precInfo);
+				auto layE = getLayerEnd(src);
 				for(; compno < prog.compE; compno++)
 				{
 					if(incrementInner)
 						layno++;
-					if(layno < prog.layE)
+					if(layno < layE)
 					{
 						incrementInner = true;
 						precinctIndex = px0grid_ + precIndexY;
 						return true;
 					}
+					if(!skipLayers(src, layE, 1))
+						return false;
 					layno = prog.layS;
 					incrementInner = false;
 				}
@@ -277,6 +277,7 @@ struct PacketIter
 
 	PacketManager* packetManager;
 	uint8_t maxNumDecompositionResolutions;
+	uint16_t numLayersToDecompress_;
 	bool singleProgression_;
 	bool compression_;
 	ResPrecinctInfo* precinctInfoOPT_;
@@ -330,6 +331,16 @@ struct PacketIter
 	bool next_rpclOPT(SparseBuffer* src);
 
 	bool skipPackets(SparseBuffer* src, uint64_t numPackets);
+	/**
+	 * Get end of layer range returned for current precinct.
+	 * When packet lengths are known, packets of layers and resolutions
+	 * that are not decompressed are skipped rather than returned.
+	 */
+	uint16_t getLayerEnd(SparseBuffer* src);
+	/**
+	 * Skip packets of layers at or beyond layE of current precinct
+	 */
+	bool skipLayers(SparseBuffer* src, uint16_t layE, uint64_t packetsPerLayer);
 };
 
 } // namespace grk
@@ -27,7 +27,8 @@ PacketParser::PacketParser(TileProcessor* tileProcessor, uint16_t packetSequence
 	  resno_(resno), precinctIndex_(precinctIndex), layno_(layno), data_(data),
 	  tileBytes_(tileBytes), remainingTilePartBytes_(remainingTilePartBytes),
 	  tagBitsPresent_(false), packetHeaderBytes_(0), signalledDataBytes_(0), readDataBytes_(0),
-	  lengthFromMarker_(lengthFromMarker), parsedHeader_(false), headerError_(false)
+	  lengthFromMarker_(lengthFromMarker), parsedHeader_(false),
+	  headerStatus_(GRK_PACKET_STATUS_OK)
 {}
 void PacketParser::print(void)
 {
@@ -61,19 +62,41 @@ uint32_t PacketParser::numSignalledBytes(void)
 {
 	return packetHeaderBytes_ + signalledDataBytes_;
 }
+uint32_t PacketParser::lengthFromMarker(void)
+{
+	return lengthFromMarker_;
+}
 
-void PacketParser::readHeader(void)
+/**
+ * Map bit reader error to packet status
+ */
+static GrkPacketStatus headerReadStatus(BitIO* bio)
 {
-	if(parsedHeader_)
-		return;
+	return bio->readError() == GRK_BITIO_ERROR_TRUNCATED ? GRK_PACKET_STATUS_TRUNCATED
+														 : GRK_PACKET_STATUS_CORRUPT;
+}
+
+GrkPacketStatus PacketParser::readHeader(void)
+{
+	if(!parsedHeader_)
+	{
+		parsedHeader_ = true;
+		headerStatus_ = readHeaderImpl();
+		if(headerStatus_ != GRK_PACKET_STATUS_OK)
+			resetSignalledSegments();
+	}
+
+	return headerStatus_;
+}
 
+GrkPacketStatus PacketParser::readHeaderImpl(void)
+{
 	auto currentData = data_;
 	auto tilePtr = tileProcessor_->getTile();
 	auto res = tilePtr->comps[compno_].resolutions_ + resno_;
 	auto tcp = tileProcessor_->getTileCodingParams();
 	bool mayHaveSOP = tcp->csty & J2K_CP_CSTY_SOP;
 	bool hasEPH = tcp->csty & J2K_CP_CSTY_EPH;
-	parsedHeader_ = true;
 	// check for optional SOP marker
 	// (present in packet even with packed packet headers)
 	if(mayHaveSOP && remainingTilePartBytes_ >= 2)
@@ -83,18 +106,14 @@ void PacketParser::readHeader(void)
 		if(marker == J2K_MS_SOP)
 		{
 			if(remainingTilePartBytes_ < 6)
-			{
-				headerError_ = true;
-				throw TruncatedPacketHeaderException();
-			}
+				return GRK_PACKET_STATUS_TRUNCATED;
 			uint16_t signalledPacketSequenceNumber =
 				(uint16_t)(((uint16_t)currentData[4] << 8) | currentData[5]);
 			if(signalledPacketSequenceNumber != (packetSequenceNumber_))
 			{
 				GRK_WARN("SOP marker packet counter %u does not match expected counter %u",
 						 signalledPacketSequenceNumber, packetSequenceNumber_);
-				headerError_ = true;
-				throw CorruptPacketHeaderException();
+				return GRK_PACKET_STATUS_CORRUPT;
 			}
 			currentData += 6;
 			remainingTilePartBytes_ -= 6;
@@ -109,8 +128,7 @@ void PacketParser::readHeader(void)
 		{
 			GRK_ERROR("PPM marker has no packed packet header data for tile %u",
 					  tileProcessor_->getIndex() + 1);
-			headerError_ = true;
-			throw CorruptPacketHeaderException();
+			return GRK_PACKET_STATUS_CORRUPT;
 		}
 		auto header = &cp->ppm_marker->packetHeaders[tileProcessor_->getIndex()];
 		headerStart = &header->buf;
@@ -122,192 +140,175 @@ void PacketParser::readHeader(void)
 		remainingBytes = &tcp->ppt_len;
 	}
 	if(*remainingBytes == 0)
-		throw TruncatedPacketHeaderException();
+		return GRK_PACKET_STATUS_TRUNCATED;
 	auto currentHeaderPtr = *headerStart;
-	std::unique_ptr<BitIO> bio(new BitIO(currentHeaderPtr, *remainingBytes, false));
+	BitIO bitIO(currentHeaderPtr, *remainingBytes, false);
+	auto bio = &bitIO;
 	auto tccp = tcp->tccps + compno_;
-	try
+	tagBitsPresent_ = bio->read();
+	// GRK_INFO("present=%u ", present);
+	if(tagBitsPresent_)
 	{
-		tagBitsPresent_ = bio->read();
-		// GRK_INFO("present=%u ", present);
-		if(tagBitsPresent_)
+		for(uint32_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
 		{
-			for(uint32_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+			auto band = res->tileBand + bandIndex;
+			if(band->empty())
+				continue;
+			auto prc = band->getPrecinct(precinctIndex_);
+			if(!prc)
+				continue;
+			auto numPrecCodeBlocks = prc->getNumCblks();
+			// assuming 1 bit minimum encoded per code block,
+			// let's check if we have enough bytes
+			if((numPrecCodeBlocks >> 3) > tileBytes_)
+				return GRK_PACKET_STATUS_TRUNCATED;
+			for(uint64_t cblkno = 0; cblkno < numPrecCodeBlocks; cblkno++)
 			{
-				auto band = res->tileBand + bandIndex;
-				if(band->empty())
-					continue;
-				auto prc = band->getPrecinct(precinctIndex_);
-				if(!prc)
-					continue;
-				auto numPrecCodeBlocks = prc->getNumCblks();
-				// assuming 1 bit minimum encoded per code block,
-				// let's check if we have enough bytes
-				if((numPrecCodeBlocks >> 3) > tileBytes_)
+				auto cblk = prc->tryGetDecompressedBlockPtr(cblkno);
+				uint8_t included;
+				if(!cblk || !cblk->numlenbits)
 				{
-					headerError_ = true;
-					throw TruncatedPacketHeaderException();
+					uint16_t value;
+					auto incl = prc->getInclTree();
+					incl->decodeValue(bio, cblkno, layno_ + 1, &value);
+					if(bio->readError() != GRK_BITIO_ERROR_NONE)
+						return headerReadStatus(bio);
+					if(value != incl->getUninitializedValue() && value != layno_)
+					{
+						GRK_WARN("Tile number: %u", tileProcessor_->getIndex() + 1);
+						std::string msg =
+							"Corrupt inclusion tag tree found when decoding packet header.";
+						GRK_WARN("%s", msg.c_str());
+						return GRK_PACKET_STATUS_CORRUPT;
+					}
+					included = (value <= layno_) ? 1 : 0;
 				}
-				for(uint64_t cblkno = 0; cblkno < numPrecCodeBlocks; cblkno++)
+				else
 				{
-					auto cblk = prc->tryGetDecompressedBlockPtr(cblkno);
-					uint8_t included;
-					if(!cblk || !cblk->numlenbits)
+					included = bio->read();
+				}
+				if(!included)
+					continue;
+				if(!cblk)
+					cblk = prc->getDecompressedBlockPtr(cblkno);
+				if(!cblk->numlenbits)
+				{
+					uint8_t K_msbs;
+					auto imsb = prc->getImsbTree();
+
+					// see Taubman + Marcellin page 388
+					// decoding stops once number of missing bit planes is known
+					imsb->decodeValue(bio, cblkno, maxBitPlanesGRK, &K_msbs);
+					if(bio->readError() != GRK_BITIO_ERROR_NONE)
+						return headerReadStatus(bio);
+					if(K_msbs >= maxBitPlanesGRK)
 					{
-						uint16_t value;
-						auto incl = prc->getInclTree();
-						incl->decodeValue(bio.get(), cblkno, layno_ + 1, &value);
-						if(value != incl->getUninitializedValue() && value != layno_)
-						{
-							GRK_WARN("Tile number: %u", tileProcessor_->getIndex() + 1);
-							std::string msg =
-								"Corrupt inclusion tag tree found when decoding packet header.";
-							GRK_WARN("%s", msg.c_str());
-							headerError_ = true;
-							throw CorruptPacketHeaderException();
-						}
-						included = (value <= layno_) ? 1 : 0;
+						GRK_WARN("More missing code block bit planes"
+								 " than supported number of bit planes (%u) in library.",
+								 maxBitPlanesGRK);
+						return GRK_PACKET_STATUS_CORRUPT;
+					}
+					if(K_msbs > band->numbps)
+					{
+						GRK_WARN("More missing code block bit planes (%u) than band bit planes "
+								 "(%u).",
+								 K_msbs, band->numbps);
+						return GRK_PACKET_STATUS_CORRUPT;
 					}
 					else
 					{
-						included = bio->read();
+						cblk->numbps = band->numbps - K_msbs;
 					}
-					if(!included)
-						continue;
-					if(!cblk)
-						cblk = prc->getDecompressedBlockPtr(cblkno);
-					if(!cblk->numlenbits)
+					if(cblk->numbps > maxBitPlanesGRK)
 					{
-						uint8_t K_msbs = 0;
-						uint8_t value;
-						auto imsb = prc->getImsbTree();
-
-						// see Taubman + Marcellin page 388
-						// loop below stops at (# of missing bit planes  + 1)
-						imsb->decodeValue(bio.get(), cblkno, K_msbs, &value);
-						while(value >= K_msbs)
-						{
-							++K_msbs;
-							if(K_msbs > maxBitPlanesGRK)
-							{
-								GRK_WARN("More missing code block bit planes (%u)"
-										 " than supported number of bit planes (%u) in library.",
-										 K_msbs, maxBitPlanesGRK);
-								headerError_ = true;
-								throw CorruptPacketHeaderException();
-							}
-							imsb->decodeValue(bio.get(), cblkno, K_msbs, &value);
-						}
-						assert(K_msbs >= 1);
-						K_msbs--;
-						if(K_msbs > band->numbps)
+						GRK_WARN("Number of bit planes %u is larger than maximum %u",
+								 cblk->numbps, maxBitPlanesGRK);
+						return GRK_PACKET_STATUS_CORRUPT;
+					}
+					cblk->numlenbits = 3;
+				}
+				uint32_t numPassesInPacket = 0;
+				bio->getnumpasses(&numPassesInPacket);
+				cblk->setNumPassesInPacket(layno_, (uint8_t)numPassesInPacket);
+				uint8_t increment = bio->getcommacode();
+				if(bio->readError() != GRK_BITIO_ERROR_NONE)
+					return headerReadStatus(bio);
+				cblk->numlenbits += increment;
+				uint32_t segno = 0;
+				if(!cblk->getNumSignalledSegments())
+				{
+					initSegment(cblk, 0, tccp->cblk_sty, true);
+				}
+				else
+				{
+					segno = cblk->getNumSignalledSegments() - 1;
+					auto seg = cblk->getSegment(segno);
+					if(seg->numPassesSignalled == seg->maxpasses)
+						initSegment(cblk, ++segno, tccp->cblk_sty, false);
+				}
+				auto blockPassesInPacket = (int32_t)cblk->getNumPassesInPacket(layno_);
+				do
+				{
+					auto seg = cblk->getSegment(segno);
+					/* sanity check when there is no mode switch */
+					if(seg->maxpasses == maxPassesPerSegmentJ2K)
+					{
+						if(blockPassesInPacket > (int32_t)maxPassesPerSegmentJ2K)
 						{
-							GRK_WARN("More missing code block bit planes (%u) than band bit planes "
-									 "(%u).",
-									 K_msbs, band->numbps);
-							headerError_ = true;
-							throw CorruptPacketHeaderException();
+							GRK_WARN("Number of code block passes (%u) in packet is "
+									 "suspiciously large.",
+									 blockPassesInPacket);
+							return GRK_PACKET_STATUS_CORRUPT;
 						}
 						else
 						{
-							cblk->numbps = band->numbps - K_msbs;
-						}
-						if(cblk->numbps > maxBitPlanesGRK)
-						{
-							GRK_WARN("Number of bit planes %u is larger than maximum %u",
-									 cblk->numbps, maxBitPlanesGRK);
-							headerError_ = true;
-							throw CorruptPacketHeaderException();
+							seg->numPassesInPacket = (uint32_t)blockPassesInPacket;
 						}
-						cblk->numlenbits = 3;
-					}
-					uint32_t numPassesInPacket = 0;
-					bio->getnumpasses(&numPassesInPacket);
-					cblk->setNumPassesInPacket(layno_, (uint8_t)numPassesInPacket);
-					uint8_t increment = bio->getcommacode();
-					cblk->numlenbits += increment;
-					uint32_t segno = 0;
-					if(!cblk->getNumSegments())
-					{
-						initSegment(cblk, 0, tccp->cblk_sty, true);
 					}
 					else
 					{
-						segno = cblk->getNumSegments() - 1;
-						if(cblk->getSegment(segno)->numpasses == cblk->getSegment(segno)->maxpasses)
-							initSegment(cblk, ++segno, tccp->cblk_sty, false);
+						assert(seg->maxpasses >= seg->numPassesSignalled);
+						seg->numPassesInPacket = (uint32_t)std::min<int32_t>(
+							(int32_t)(seg->maxpasses - seg->numPassesSignalled),
+							blockPassesInPacket);
 					}
-					auto blockPassesInPacket = (int32_t)cblk->getNumPassesInPacket(layno_);
-					do
+					seg->numPassesSignalled += seg->numPassesInPacket;
+					uint8_t bits_to_read = cblk->numlenbits + floorlog2(seg->numPassesInPacket);
+					if(bits_to_read > 32)
 					{
-						auto seg = cblk->getSegment(segno);
-						/* sanity check when there is no mode switch */
-						if(seg->maxpasses == maxPassesPerSegmentJ2K)
-						{
-							if(blockPassesInPacket > (int32_t)maxPassesPerSegmentJ2K)
-							{
-								GRK_WARN("Number of code block passes (%u) in packet is "
-										 "suspiciously large.",
-										 blockPassesInPacket);
-								headerError_ = true;
-								throw CorruptPacketHeaderException();
-							}
-							else
-							{
-								seg->numPassesInPacket = (uint32_t)blockPassesInPacket;
-							}
-						}
-						else
-						{
-							assert(seg->maxpasses >= seg->numpasses);
-							seg->numPassesInPacket = (uint32_t)std::min<int32_t>(
-								(int32_t)(seg->maxpasses - seg->numpasses), blockPassesInPacket);
-						}
-						uint8_t bits_to_read = cblk->numlenbits + floorlog2(seg->numPassesInPacket);
-						if(bits_to_read > 32)
-						{
-							GRK_WARN("readHeader: too many bits in segment length ");
-							headerError_ = true;
-							throw CorruptPacketHeaderException();
-						}
-						bio->read(&seg->numBytesInPacket, bits_to_read);
-						signalledDataBytes_ += seg->numBytesInPacket;
+						GRK_WARN("readHeader: too many bits in segment length ");
+						return GRK_PACKET_STATUS_CORRUPT;
+					}
+					bio->read(&seg->numBytesInPacket, bits_to_read);
+					signalledDataBytes_ += seg->numBytesInPacket;
 #ifdef DEBUG_LOSSLESS_T2
-						cblk->packet_length_info.push_back(
-							PacketLengthInfo(seg->numBytesInPacket,
-											 cblk->numlenbits + floorlog2(seg->numPassesInPacket)));
+					cblk->packet_length_info.push_back(
+						PacketLengthInfo(seg->numBytesInPacket,
+										 cblk->numlenbits + floorlog2(seg->numPassesInPacket)));
 #endif
-						blockPassesInPacket -= (int32_t)seg->numPassesInPacket;
-						if(blockPassesInPacket > 0)
-							initSegment(cblk, ++segno, tccp->cblk_sty, false);
-					} while(blockPassesInPacket > 0);
-				}
+					blockPassesInPacket -= (int32_t)seg->numPassesInPacket;
+					if(blockPassesInPacket > 0)
+						initSegment(cblk, ++segno, tccp->cblk_sty, false);
+				} while(blockPassesInPacket > 0);
 			}
 		}
-		bio->inalign();
-		currentHeaderPtr += bio->numBytes();
-	}
-	catch([[maybe_unused]] InvalidMarkerException& ex)
-	{
-		headerError_ = true;
-		throw CorruptPacketHeaderException();
 	}
+	bio->inalign();
+	if(bio->readError() != GRK_BITIO_ERROR_NONE)
+		return headerReadStatus(bio);
+	currentHeaderPtr += bio->numBytes();
 
 	// EPH marker (absent from packet in case of packet packet headers)
 	if(hasEPH)
 	{
 		if((*remainingBytes - (uint32_t)(currentHeaderPtr - *headerStart)) < 2U)
-		{
-			headerError_ = true;
-			throw TruncatedPacketHeaderException();
-		}
+			return GRK_PACKET_STATUS_TRUNCATED;
 		uint16_t marker =
 			(uint16_t)(((uint16_t)(*currentHeaderPtr) << 8) | (uint16_t)(*(currentHeaderPtr + 1)));
 		if(marker != J2K_MS_EPH)
 		{
 			GRK_WARN("Expected EPH marker, but found 0x%x", marker);
-			headerError_ = true;
-			throw CorruptPacketHeaderException();
+			return GRK_PACKET_STATUS_CORRUPT;
 		}
 		else
 		{
@@ -324,15 +325,16 @@ void PacketParser::readHeader(void)
 		GRK_ERROR("Corrupt PL marker reports %u bytes for packet;"
 				  " parsed bytes are in fact %u",
 				  lengthFromMarker_, numSignalledBytes());
-		headerError_ = true;
-		throw CorruptPacketHeaderException();
+		return GRK_PACKET_STATUS_CORRUPT;
 	}
 	data_ += packetHeaderBytes_;
+
+	return GRK_PACKET_STATUS_OK;
 }
 void PacketParser::initSegment(DecompressCodeblock* cblk, uint32_t index, uint8_t cblk_sty,
 							   bool first)
 {
-	auto seg = cblk->getSegment(index);
+	auto seg = cblk->signalSegment(index);
 
 	seg->clear();
 	if(cblk_sty & GRK_CBLKSTY_TERMALL)
@@ -356,16 +358,17 @@ void PacketParser::initSegment(DecompressCodeblock* cblk, uint32_t index, uint8_
 		seg->maxpasses = maxPassesPerSegmentJ2K;
 	}
 }
-void PacketParser::readData(void)
+GrkPacketStatus PacketParser::readData(void)
 {
 	if(!tagBitsPresent_)
 	{
 		readDataFinalize();
-		return;
+		return GRK_PACKET_STATUS_OK;
 	}
 	uint32_t offset = 0;
 	auto tile = tileProcessor_->getTile();
 	auto res = tile->comps[compno_].resolutions_ + resno_;
+	bool transcoding = tileProcessor_->getTranscoder() != nullptr;
 	for(uint32_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
 	{
 		auto band = res->tileBand + bandIndex;
@@ -392,6 +395,7 @@ void PacketParser::readData(void)
 					GRK_WARN("at component=%02d resolution=%02d precinct=%03d "
 							 "layer=%02d",
 							 compno_, resno_, precinctIndex_, layno_);
+					resetSignalledSegments();
 					goto finish;
 				}
 				if(((seg->numBytesInPacket) > remainingTilePartBytes_))
@@ -402,6 +406,7 @@ void PacketParser::readData(void)
 						cblk->cleanUpSegBuffers();
 					seg->numBytesInPacket = 0;
 					seg->numpasses = 0;
+					cblk->resetSignalledSegments();
 					break;
 				}
 				if(seg->numBytesInPacket)
@@ -412,18 +417,21 @@ void PacketParser::readData(void)
 						GRK_ERROR("Segment packet length %u plus total segment length %u must be "
 								  "less than 2^32",
 								  seg->numBytesInPacket, seg->len);
-						throw CorruptPacketDataException();
+						resetSignalledSegments();
+						return GRK_PACKET_STATUS_CORRUPT;
 					}
 					// correct for truncated packet
 					if(seg->numBytesInPacket > remainingTilePartBytes_)
 						seg->numBytesInPacket = (uint32_t)remainingTilePartBytes_;
-					cblk->seg_buffers.push_back(
-						new grk_buf8(data_ + offset, seg->numBytesInPacket, false));
+					cblk->pushSegBuffer(data_ + offset, seg->numBytesInPacket);
 					offset += seg->numBytesInPacket;
 					cblk->compressedStream.len += seg->numBytesInPacket;
 					seg->len += seg->numBytesInPacket;
 					remainingTilePartBytes_ -= seg->numBytesInPacket;
 				}
+				if(transcoding)
+					cblk->contributions.emplace_back(layno_, seg->numPassesInPacket,
+													 seg->numBytesInPacket);
 				seg->numpasses += seg->numPassesInPacket;
 				numPassesInPacket -= seg->numPassesInPacket;
 				if(numPassesInPacket > 0)
@@ -435,6 +443,35 @@ void PacketParser::readData(void)
 finish:
 	readDataBytes_ = offset;
 	readDataFinalize();
+
+	return GRK_PACKET_STATUS_OK;
+}
+
+/**
+ * Packet headers signal segments ahead of the data read from the packet body,
+ * so header state must fall back to data state for code blocks whose data
+ * was not fully read. Packets that are skipped without reading their data
+ * keep their signalled segments, so that later packet headers are parsed
+ * correctly
+ */
+void PacketParser::resetSignalledSegments(void)
+{
+	auto res = tileProcessor_->getTile()->comps[compno_].resolutions_ + resno_;
+	for(uint32_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+	{
+		auto band = res->tileBand + bandIndex;
+		if(band->empty())
+			continue;
+		auto prc = band->getPrecinct(precinctIndex_);
+		if(!prc)
+			continue;
+		for(uint64_t cblkno = 0; cblkno < prc->getNumCblks(); ++cblkno)
+		{
+			auto cblk = prc->tryGetDecompressedBlockPtr(cblkno);
+			if(cblk && cblk->getNumPassesInPacket(layno_))
+				cblk->resetSignalledSegments();
+		}
+	}
 }
 
 template<typename T>
@@ -453,7 +490,8 @@ void PacketParser::readDataFinalize(void)
 }
 
 PrecinctPacketParsers::PrecinctPacketParsers(TileProcessor* tileProcessor)
-	: tileProcessor_(tileProcessor), parsers_(nullptr), numParsers_(0), allocatedParsers_(0)
+	: tileProcessor_(tileProcessor), parsers_(nullptr), numParsers_(0), allocatedParsers_(0),
+	  numBytes_(0)
 {
 	auto tcp = tileProcessor_->getTileCodingParams();
 	allocatedParsers_ = tcp->numlayers;
@@ -482,6 +520,26 @@ void PrecinctPacketParsers::pushParser(PacketParser* parser)
 		return;
 	}
 	parsers_[numParsers_++] = parser;
+	numBytes_ += parser->lengthFromMarker();
+}
+
+void PrecinctPacketParsers::parse(void)
+{
+	for(uint16_t i = 0; i < numParsers_; ++i)
+	{
+		auto parser = parsers_[i];
+		// tag tree allocation may still throw
+		try
+		{
+			if(parser->readHeader() != GRK_PACKET_STATUS_OK ||
+			   parser->readData() != GRK_PACKET_STATUS_OK)
+				break;
+		}
+		catch([[maybe_unused]] std::exception& ex)
+		{
+			break;
+		}
+	}
 }
 
 ParserMap::ParserMap(TileProcessor* tileProcessor) : tileProcessor_(tileProcessor) {}
@@ -24,6 +24,17 @@ namespace grk
 
 struct TileProcessor;
 
+/**
+ * Outcome of parsing a packet
+ */
+enum GrkPacketStatus
+{
+	GRK_PACKET_STATUS_OK,
+	GRK_PACKET_STATUS_TRUNCATED,
+	GRK_PACKET_STATUS_CORRUPT,
+	GRK_PACKET_STATUS_ERROR
+};
+
 class PacketParser
 {
   public:
@@ -31,16 +42,19 @@ class PacketParser
 				 uint8_t resno, uint64_t precinctIndex, uint16_t layno, uint8_t* data,
 				 uint32_t lengthFromMarker, size_t tileBytes, size_t remainingTilePartBytes);
 	virtual ~PacketParser(void) = default;
-	void readHeader(void);
-	void readData(void);
+	GrkPacketStatus readHeader(void);
+	GrkPacketStatus readData(void);
 	uint32_t numHeaderBytes(void);
 	uint32_t numSignalledDataBytes(void);
 	uint32_t numSignalledBytes(void);
 	uint32_t numReadDataBytes(void);
+	uint32_t lengthFromMarker(void);
 	void print(void);
 
   private:
+	GrkPacketStatus readHeaderImpl(void);
 	void readDataFinalize(void);
+	void resetSignalledSegments(void);
 	void initSegment(DecompressCodeblock* cblk, uint32_t index, uint8_t cblk_sty, bool first);
 	TileProcessor* tileProcessor_;
 	uint16_t packetSequenceNumber_;
@@ -58,7 +72,7 @@ class PacketParser
 	uint32_t readDataBytes_;
 	uint32_t lengthFromMarker_;
 	bool parsedHeader_;
-	bool headerError_;
+	GrkPacketStatus headerStatus_;
 };
 
 struct PrecinctPacketParsers
@@ -66,10 +80,17 @@ struct PrecinctPacketParsers
 	PrecinctPacketParsers(TileProcessor* tileProcessor);
 	~PrecinctPacketParsers(void);
 	void pushParser(PacketParser* parser);
+	/**
+	 * Parse headers and read data of all packets, in layer order.
+	 * Parsing stops at the first corrupt or truncated packet.
+	 */
+	void parse(void);
 	TileProcessor* tileProcessor_;
 	PacketParser** parsers_;
 	uint16_t numParsers_;
 	uint16_t allocatedParsers_;
+	// sum of signalled lengths of all packets
+	uint64_t numBytes_;
 };
 
 struct TileProcessor;
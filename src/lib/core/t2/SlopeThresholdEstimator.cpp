@@ -0,0 +1,100 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+SlopeThresholdEstimator::SlopeThresholdEstimator(double targetBytes, double margin)
+	: targetBytes_(targetBytes), margin_(margin), truncationSlope_(0)
+{
+	for(uint32_t i = 0; i < numBins; ++i)
+		bytes_[i] = 0;
+}
+uint32_t SlopeThresholdEstimator::getBin(double slope) const
+{
+	auto bin = (int32_t)floor(log2(slope) * binsPerOctave) - minLog2Slope * binsPerOctave;
+	if(bin < 0)
+		return 0;
+	if(bin >= (int32_t)numBins)
+		return numBins - 1;
+
+	return (uint32_t)bin;
+}
+void SlopeThresholdEstimator::update(const CodePass* passes, uint32_t numPasses)
+{
+	if(!numPasses)
+		return;
+
+	// upper convex hull of (rate, distortion) truncation points, starting from origin
+	// (see Taubman and Marcellin, Chapter 8)
+	struct Point
+	{
+		double rate;
+		double distortion;
+	};
+	std::vector<Point> hull;
+	hull.reserve(numPasses + 1);
+	hull.push_back({0, 0});
+	for(uint32_t passno = 0; passno < numPasses; ++passno)
+	{
+		Point p = {(double)passes[passno].rate, passes[passno].distortiondec};
+		if(p.distortion <= hull.back().distortion)
+			continue;
+		while(hull.size() > 1)
+		{
+			auto a = hull[hull.size() - 2];
+			auto b = hull.back();
+			if((p.distortion - a.distortion) * (b.rate - a.rate) <
+			   (b.distortion - a.distortion) * (p.rate - a.rate))
+				break;
+			hull.pop_back();
+		}
+		if(p.rate > hull.back().rate)
+			hull.push_back(p);
+	}
+	if(hull.size() == 1)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	for(size_t i = 1; i < hull.size(); ++i)
+	{
+		double dr = hull[i].rate - hull[i - 1].rate;
+		double dd = hull[i].distortion - hull[i - 1].distortion;
+		bytes_[getBin(dd / dr)] += dr;
+	}
+	// highest bin whose cumulative bytes (from the top) exceed the budget:
+	// rate control must select a threshold above the lower edge of this bin
+	double cumulativeBytes = 0;
+	for(uint32_t bin = numBins; bin > 0; --bin)
+	{
+		cumulativeBytes += bytes_[bin - 1];
+		if(cumulativeBytes > targetBytes_)
+		{
+			double bound = exp2((double)((int32_t)bin - 1 + minLog2Slope * binsPerOctave) /
+								binsPerOctave);
+			truncationSlope_.store(bound / margin_);
+			break;
+		}
+	}
+}
+double SlopeThresholdEstimator::getTruncationSlope(void) const
+{
+	return truncationSlope_.load();
+}
+
+} // namespace grk
@@ -0,0 +1,70 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+namespace grk
+{
+/**
+ * Running lower bound on the distortion-rate slope threshold that rate control
+ * will select for the final layer of a tile.
+ *
+ * Every compressed code block adds the bytes of its convex hull segments to a
+ * histogram of log slopes. As soon as the bytes at or above some slope exceed the
+ * tile's byte budget, rate control can never select a lower threshold, so code
+ * passes whose slope falls below this bound (divided by a safety margin) will
+ * never be included in any layer, and need not be coded.
+ *
+ * The bound only grows as blocks are added, so it is valid at every moment,
+ * and blocks may be compressed concurrently.
+ */
+class SlopeThresholdEstimator
+{
+  public:
+	/**
+	 * @param targetBytes byte budget of final layer
+	 * @param margin safety margin (>= 1) dividing the estimated bound
+	 */
+	SlopeThresholdEstimator(double targetBytes, double margin);
+	/**
+	 * Add passes of a compressed code block
+	 */
+	void update(const CodePass* passes, uint32_t numPasses);
+	/**
+	 * Get slope below which code passes may be dropped, or zero if
+	 * no bound is known yet
+	 */
+	double getTruncationSlope(void) const;
+
+  private:
+	static constexpr int32_t binsPerOctave = 4;
+	static constexpr int32_t minLog2Slope = -64;
+	static constexpr int32_t maxLog2Slope = 64;
+	static constexpr uint32_t numBins = (maxLog2Slope - minLog2Slope) * binsPerOctave;
+	uint32_t getBin(double slope) const;
+
+	std::mutex mutex_;
+	double bytes_[numBins];
+	double targetBytes_;
+	double margin_;
+	std::atomic<double> truncationSlope_;
+};
+
+} // namespace grk
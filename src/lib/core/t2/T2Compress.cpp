@@ -193,7 +193,6 @@ bool T2Compress::compressPackets(uint16_t tile_no, uint16_t max_layers, Buffered
 			if(!compressPacket(tcp, current_pi, stream, &numBytes))
 				return false;
 			*tileBytesWritten += numBytes;
-			tileProcessor->incNumProcessedPackets(1);
 		}
 	}
 
@@ -419,6 +418,9 @@ bool T2Compress::compressPacket(TileCodingParams* tcp, PacketIter* pi, BufferedS
 		}
 	}
 	*packet_bytes_written += (uint32_t)(stream->tell() - stream_start);
+	// packets already written to a previous tile part are not counted again,
+	// so that SOP packet sequence numbers are consecutive across tile parts
+	tileProcessor->incNumProcessedPackets(1);
 
 	return true;
 }
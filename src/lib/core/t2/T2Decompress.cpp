@@ -34,7 +34,8 @@ void T2Decompress::decompressPackets(uint16_t tile_no, SparseBuffer* src,
 								tileProcessor);
 	tileProcessor->packetLengthCache.rewind();
 	auto markers = tileProcessor->packetLengthCache.getMarkers();
-	if(markers && !markers->isEnabled())
+	// packet lengths from PLT are not used when PLM is also present
+	if(markers && (!markers->isEnabled() || cp->plm_markers))
 		markers = nullptr;
 	for(uint32_t pino = 0; pino < tcp->getNumProgressions(); ++pino)
 	{
@@ -47,16 +48,9 @@ void T2Decompress::decompressPackets(uint16_t tile_no, SparseBuffer* src,
 				*stopProcessionPackets = true;
 				break;
 			}
-			try
-			{
-				if(!processPacket(currPi->getCompno(), currPi->getResno(),
-								  currPi->getPrecinctIndex(), currPi->getLayno(), src))
-				{
-					*stopProcessionPackets = true;
-					break;
-				}
-			}
-			catch([[maybe_unused]] TruncatedPacketHeaderException& tex)
+			auto status = processPacket(currPi->getCompno(), currPi->getResno(),
+										currPi->getPrecinctIndex(), currPi->getLayno(), src);
+			if(status == GRK_PACKET_STATUS_TRUNCATED)
 			{
 				GRK_WARN("Truncated packet: tile=%u component=%02d resolution=%02d precinct=%03d "
 						 "layer=%02d",
@@ -65,41 +59,98 @@ void T2Decompress::decompressPackets(uint16_t tile_no, SparseBuffer* src,
 				*stopProcessionPackets = true;
 				break;
 			}
-			catch([[maybe_unused]] CorruptPacketException& cex)
+			else if(status == GRK_PACKET_STATUS_CORRUPT)
 			{
+				GRK_WARN("Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
+						 "layer=%02d",
+						 tile_no, currPi->getCompno(), currPi->getResno(),
+						 currPi->getPrecinctIndex(), currPi->getLayno());
 				// we can skip corrupt packet if PLT markers are present
+				// ToDo: skip corrupt packet if SOP marker is present
 				if(!tileProcessor->packetLengthCache.getMarkers())
 				{
-					GRK_WARN("Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
-							 "layer=%02d",
-							 tile_no, currPi->getCompno(), currPi->getResno(),
-							 currPi->getPrecinctIndex(), currPi->getLayno());
 					*stopProcessionPackets = true;
 					break;
 				}
-				else
-				{
-					GRK_WARN("Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
-							 "layer=%02d",
-							 tile_no, currPi->getCompno(), currPi->getResno(),
-							 currPi->getPrecinctIndex(), currPi->getLayno());
-				}
-				// ToDo: skip corrupt packet if SOP marker is present
+			}
+			else if(status != GRK_PACKET_STATUS_OK)
+			{
+				*stopProcessionPackets = true;
+				break;
 			}
 		}
 		if(*stopProcessionPackets)
 			break;
 	}
+	parseDeferredPackets();
 }
 
-bool T2Decompress::processPacket(uint16_t compno, uint8_t resno, uint64_t precinctIndex,
-								 uint16_t layno, SparseBuffer* src)
+void T2Decompress::parseDeferredPackets(void)
+{
+	// number of partitions per worker: more than one, to balance load
+	// when parsing cost is not proportional to packet length
+	const size_t partitionsPerWorker = 4;
+	auto tile = tileProcessor->getTile();
+	std::vector<PrecinctPacketParsers*> precinctParsers;
+	uint64_t totalWeight = 0;
+	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+	{
+		auto tilec = tile->comps + compno;
+		for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
+		{
+			auto res = tilec->resolutions_ + resno;
+			for(auto& pp : res->parserMap_->precinctParsers_)
+			{
+				precinctParsers.push_back(pp.second);
+				totalWeight += pp.second->numBytes_ + pp.second->numParsers_;
+			}
+		}
+	}
+	if(precinctParsers.empty())
+		return;
+	auto numPartitions = std::min<size_t>(
+		ExecSingleton::get()->num_workers() * partitionsPerWorker, precinctParsers.size());
+	if(ExecSingleton::get()->num_workers() == 1 || numPartitions == 1)
+	{
+		for(auto& pp : precinctParsers)
+			pp->parse();
+		return;
+	}
+	tf::Taskflow taskflow;
+	size_t begin = 0;
+	uint64_t weight = 0;
+	for(size_t partition = 0; partition < numPartitions && begin < precinctParsers.size();
+		++partition)
+	{
+		// end partition once its cumulative weight reaches its share of the total
+		auto targetWeight = (totalWeight * (partition + 1)) / numPartitions;
+		size_t end = begin;
+		do
+		{
+			auto pp = precinctParsers[end++];
+			weight += pp->numBytes_ + pp->numParsers_;
+		} while(end < precinctParsers.size() && weight < targetWeight);
+		if(partition == numPartitions - 1)
+			end = precinctParsers.size();
+		auto partitionParsers = precinctParsers.data();
+		taskflow.emplace([partitionParsers, begin, end] {
+			for(size_t i = begin; i < end; ++i)
+				partitionParsers[i]->parse();
+		});
+		begin = end;
+	}
+	ExecSingleton::get()->run(taskflow).wait();
+}
+
+GrkPacketStatus T2Decompress::processPacket(uint16_t compno, uint8_t resno,
+											uint64_t precinctIndex, uint16_t layno,
+											SparseBuffer* src)
 {
 	// read from PL marker, if available
 	PacketInfo p;
 	auto packetInfo = &p;
 	if(!tileProcessor->packetLengthCache.next(&packetInfo))
-		return false;
+		return GRK_PACKET_STATUS_ERROR;
 	auto tilec = tileProcessor->getTile()->comps + compno;
 	auto res = tilec->resolutions_ + resno;
 	auto tcp = tileProcessor->getTileCodingParams();
@@ -123,6 +174,21 @@ bool T2Decompress::processPacket(uint16_t compno, uint8_t resno, uint64_t precin
 			}
 		}
 	}
+	// packet length is known: step over skipped packet without parsing it
+	if(skip && packetInfo->packetLength)
+	{
+		try
+		{
+			src->incrementCurrentChunkOffset(packetInfo->packetLength);
+		}
+		catch([[maybe_unused]] SparseBufferOverrunException& sboe)
+		{
+			return GRK_PACKET_STATUS_ERROR;
+		}
+		tileProcessor->incNumProcessedPackets();
+
+		return GRK_PACKET_STATUS_OK;
+	}
 	if(!skip || !packetInfo->packetLength)
 	{
 		for(uint32_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
@@ -132,7 +198,7 @@ bool T2Decompress::processPacket(uint16_t compno, uint8_t resno, uint64_t precin
 				continue;
 			if(!band->createPrecinct(tileProcessor, precinctIndex, res->precinctPartitionTopLeft,
 									 res->precinctExpn, res->precinctGridWidth, res->cblkExpn))
-				return false;
+				return GRK_PACKET_STATUS_ERROR;
 		}
 	}
 	auto parser = new PacketParser(tileProcessor, tileProcessor->getNumProcessedPackets() & 0xFFFF,
@@ -142,14 +208,11 @@ bool T2Decompress::processPacket(uint16_t compno, uint8_t resno, uint64_t precin
 	uint32_t packetLen = packetInfo->packetLength;
 	if(!packetInfo->packetLength)
 	{
-		try
-		{
-			parser->readHeader();
-		}
-		catch([[maybe_unused]] std::exception& ex)
+		auto status = parser->readHeader();
+		if(status != GRK_PACKET_STATUS_OK)
 		{
 			delete parser;
-			throw;
+			return status;
 		}
 		packetLen = parser->numHeaderBytes() + parser->numSignalledDataBytes();
 	}
@@ -160,42 +223,44 @@ bool T2Decompress::processPacket(uint16_t compno, uint8_t resno, uint64_t precin
 	catch([[maybe_unused]] SparseBufferOverrunException& sboe)
 	{
 		delete parser;
-		return false;
+		return GRK_PACKET_STATUS_ERROR;
 	}
 	if(skip)
+	{
 		delete parser;
+	}
 	else
-		readPacketData(res, parser, precinctIndex, packetInfo->packetLength);
+	{
+		auto status = readPacketData(res, parser, precinctIndex, packetInfo->packetLength);
+		if(status != GRK_PACKET_STATUS_OK)
+			return status;
+	}
 	tileProcessor->incNumProcessedPackets();
 
-	return true;
+	return GRK_PACKET_STATUS_OK;
 }
-void T2Decompress::readPacketData(Resolution* res, PacketParser* parser, uint64_t precinctIndex,
-								  bool defer)
+GrkPacketStatus T2Decompress::readPacketData(Resolution* res, PacketParser* parser,
+											 uint64_t precinctIndex, bool defer)
 {
 	if(defer)
 	{
 		res->parserMap_->pushParser(precinctIndex, parser);
+
+		return GRK_PACKET_STATUS_OK;
 	}
-	else
-	{
-		try
-		{
-			parser->readHeader();
-			parser->readData();
-			delete parser;
-		}
-		catch([[maybe_unused]] std::exception& ex)
-		{
-			delete parser;
-			throw;
-		}
-	}
+	auto status = parser->readHeader();
+	if(status == GRK_PACKET_STATUS_OK)
+		status = parser->readData();
+	delete parser;
+
+	return status;
 }
-void T2Decompress::decompressPacket(PacketParser* parser, bool skipData)
+GrkPacketStatus T2Decompress::decompressPacket(PacketParser* parser, bool skipData)
 {
-	parser->readHeader();
-	if(!skipData)
-		parser->readData();
+	auto status = parser->readHeader();
+	if(status == GRK_PACKET_STATUS_OK && !skipData)
+		status = parser->readData();
+
+	return status;
 }
 } // namespace grk
@@ -33,10 +33,20 @@ struct T2Decompress
 
   private:
 	TileProcessor* tileProcessor;
-	void decompressPacket(PacketParser* parser, bool skipData);
-	bool processPacket(uint16_t compno, uint8_t resno, uint64_t precinctIndex, uint16_t layno,
-					   SparseBuffer* src);
-	void readPacketData(Resolution* res, PacketParser* parser, uint64_t precinctIndex, bool defer);
+	/**
+	 * Parse packets whose lengths were known from PL markers, and whose
+	 * parsing was therefore deferred.
+	 *
+	 * Precincts are independent of each other, so they are split into
+	 * contiguous partitions of roughly equal byte count, and partitions
+	 * are parsed concurrently.
+	 */
+	void parseDeferredPackets(void);
+	GrkPacketStatus decompressPacket(PacketParser* parser, bool skipData);
+	GrkPacketStatus processPacket(uint16_t compno, uint8_t resno, uint64_t precinctIndex,
+								  uint16_t layno, SparseBuffer* src);
+	GrkPacketStatus readPacketData(Resolution* res, PacketParser* parser, uint64_t precinctIndex,
+								   bool defer);
 };
 
 } // namespace grk
@@ -204,7 +204,9 @@ class TagTree
 		return true;
 	}
 	/**
-	 Decompress the value of a leaf of the tag tree up to a given threshold
+	 Decompress the value of a leaf of the tag tree up to a given threshold.
+	 Each node's bits are a run of zeros terminated by a one, so they are
+	 read as a single run rather than bit by bit.
 	 @param bio Pointer to a BIO handle
 	 @param leafno Number that identifies the leaf to decompress
 	 @param threshold Threshold to use when decoding value of the leaf
@@ -230,14 +232,12 @@ class TagTree
 				node->low = low;
 			else
 				low = node->low;
-			while(low < threshold && low < node->value)
+			T limit = std::min<T>(threshold, node->value);
+			if(low < limit)
 			{
-				if(bio->read())
-				{
+				low = (T)(low + bio->readZeroRun((uint32_t)(limit - low)));
+				if(low < limit)
 					node->value = low;
-					break;
-				}
-				low++;
 			}
 			node->low = low;
 			if(nodeStackPtr == nodeStack)
@@ -0,0 +1,89 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <mutex>
+
+namespace grk
+{
+
+/**
+ * Pool of sparse canvas block buffers.
+ *
+ * Owned by the decompressor and shared by all of its region windows, so that
+ * blocks released when a tile component window is torn down are handed to the next
+ * region decode (of the same or of another tile) instead of going back to the heap.
+ * All pooled buffers have the same area; buffers of any other area bypass the pool.
+ */
+class SparseBlockPool
+{
+  public:
+	SparseBlockPool(void) : blockArea_(0) {}
+	~SparseBlockPool(void)
+	{
+		for(auto b : pool_)
+			delete[] b;
+	}
+	/**
+	 * Get buffer of block_area samples. Contents are undefined.
+	 */
+	int32_t* get(uint32_t block_area)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(block_area == blockArea_ && !pool_.empty())
+			{
+				auto b = pool_.back();
+				pool_.pop_back();
+				return b;
+			}
+		}
+		return new int32_t[block_area];
+	}
+	/**
+	 * Return buffers of block_area samples to the pool
+	 */
+	void put(std::vector<int32_t*>& buffers, uint32_t block_area)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(!blockArea_)
+				blockArea_ = block_area;
+			if(block_area == blockArea_)
+			{
+				while(!buffers.empty() && pool_.size() < maxPooledBlocks)
+				{
+					pool_.push_back(buffers.back());
+					buffers.pop_back();
+				}
+			}
+		}
+		for(auto b : buffers)
+			delete[] b;
+		buffers.clear();
+	}
+
+  private:
+	// upper bound on retained blocks : 64 MB for 64x64 blocks
+	static constexpr size_t maxPooledBlocks = 4096;
+	std::mutex mutex_;
+	std::vector<int32_t*> pool_;
+	uint32_t blockArea_;
+};
+
+} // namespace grk
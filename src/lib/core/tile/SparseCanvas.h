@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <algorithm>
+#include "SparseBlockPool.h"
 
 // SparseCanvas stores blocks in the canvas coordinate system. It covers the active sub-bands for
 // all (reduced) resolutions
@@ -59,11 +60,9 @@ struct SparseBlock
 	{
 		delete[] data;
 	}
-	void alloc(uint32_t block_area, bool zeroOutBuffer)
+	void alloc(uint32_t block_area, SparseBlockPool* pool)
 	{
-		data = new int32_t[block_area];
-		if(zeroOutBuffer)
-			memset(data, 0, block_area * sizeof(int32_t));
+		data = pool ? pool->get(block_area) : new int32_t[block_area];
 	}
 	int32_t* data;
 };
@@ -71,8 +70,8 @@ template<uint32_t LBW, uint32_t LBH>
 class SparseCanvas : public ISparseCanvas
 {
   public:
-	SparseCanvas(grk_rect32 bds)
-		: blockWidth(1 << LBW), blockHeight(1 << LBH), blocks(nullptr), bounds(bds)
+	SparseCanvas(grk_rect32 bds, SparseBlockPool* pool)
+		: blockWidth(1 << LBW), blockHeight(1 << LBH), blocks(nullptr), bounds(bds), pool_(pool)
 	{
 		if(!bounds.width() || !bounds.height() || !LBW || !LBH)
 			throw std::runtime_error("invalid window for sparse canvas");
@@ -82,17 +81,26 @@ class SparseCanvas : public ISparseCanvas
 		for(uint64_t i = 0; i < blockCount; ++i)
 			blocks[i] = nullptr;
 	}
+	explicit SparseCanvas(grk_rect32 bds) : SparseCanvas(bds, nullptr) {}
 	SparseCanvas(uint32_t width, uint32_t height) : SparseCanvas(grk_rect32(0, 0, width, height)) {}
 	~SparseCanvas()
 	{
 		if(blocks)
 		{
+			std::vector<int32_t*> recycled;
 			for(uint64_t i = 0; i < (uint64_t)grid.width() * grid.height(); i++)
 			{
+				if(pool_ && blocks[i])
+				{
+					recycled.push_back(blocks[i]->data);
+					blocks[i]->data = nullptr;
+				}
 				delete(blocks[i]);
 				blocks[i] = nullptr;
 			}
 			delete[] blocks;
+			if(pool_)
+				pool_->put(recycled, blockWidth * blockHeight);
 		}
 	}
 	bool read(uint8_t resno, grk_rect32 window, int32_t* dest, const uint32_t destChunkY,
@@ -134,7 +142,12 @@ class SparseCanvas : public ISparseCanvas
 				if(!srcBlock)
 				{
 					auto b = new SparseBlock();
-					b->alloc(blockWidth * blockHeight, zeroOutBuffer);
+					b->alloc(blockWidth * blockHeight, pool_);
+					if(zeroOutBuffer)
+						memset(b->data, 0, blockWidth * blockHeight * sizeof(int32_t));
+					else
+						zeroBorder(b->data, x & (blockWidth - 1), y & (blockHeight - 1),
+								   blockWinWidth, blockWinHeight);
 					assert(grid.contains(gridX, gridY));
 					assert(b->data);
 					uint64_t blockInd =
@@ -147,6 +160,27 @@ class SparseCanvas : public ISparseCanvas
 	}
 
   private:
+	/**
+	 * Zero the part of a (possibly recycled) block lying outside of the window
+	 * (x,y,w,h), in block coordinates. The window itself will be fully overwritten
+	 * by its owner, so only the border needs clearing.
+	 */
+	void zeroBorder(int32_t* data, uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+	{
+		for(uint32_t j = 0; j < blockHeight; ++j)
+		{
+			auto row = data + ((uint64_t)j << LBW);
+			if(j < y || j >= y + h)
+			{
+				memset(row, 0, blockWidth * sizeof(int32_t));
+				continue;
+			}
+			if(x)
+				memset(row, 0, x * sizeof(int32_t));
+			if(x + w < blockWidth)
+				memset(row + x + w, 0, (blockWidth - x - w) * sizeof(int32_t));
+		}
+	}
 	inline SparseBlock* getBlock(uint32_t block_x, uint32_t block_y)
 	{
 		uint64_t index = (uint64_t)(block_y - grid.y0) * grid.width() + (block_x - grid.x0);
@@ -274,6 +308,7 @@ class SparseCanvas : public ISparseCanvas
 	SparseBlock** blocks;
 	grk_rect32 bounds; // canvas bounds
 	grk_rect32 grid; // block grid bounds
+	SparseBlockPool* pool_; // optional pool that blocks are drawn from and returned to
 };
 
 } // namespace grk
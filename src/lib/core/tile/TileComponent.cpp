@@ -190,7 +190,8 @@ bool TileComponent::subbandIntersectsAOI(uint8_t resno, eBandOrientation orient,
 {
 	return window_->getBandWindowPadded(resno, orient)->nonEmptyIntersection(aoi);
 }
-bool TileComponent::allocRegionWindow(uint32_t numres, bool truncatedTile)
+bool TileComponent::allocRegionWindow(uint32_t numres, bool truncatedTile,
+									  SparseBlockPool* pool)
 {
 	grk_rect32 temp(0, 0, 0, 0);
 	bool first = true;
@@ -252,10 +253,11 @@ bool TileComponent::allocRegionWindow(uint32_t numres, bool truncatedTile)
 		}
 	}
 
-	// 2. create (padded) sparse canvas, in buffer space,
+	// 2. create (padded) sparse canvas, in buffer space, drawing its blocks
+	// from the decompressor's pool
 	const uint32_t blockSizeExp = 6;
 	temp.grow_IN_PLACE(8);
-	auto regionWindow = new SparseCanvas<blockSizeExp, blockSizeExp>(temp);
+	auto regionWindow = new SparseCanvas<blockSizeExp, blockSizeExp>(temp, pool);
 
 	// 3. allocate sparse blocks
 	for(uint8_t resno = 0; resno < numres; ++resno)
@@ -429,8 +431,7 @@ void TileComponent::postDecompressImpl(int32_t* srcData, DecompressBlockExec* bl
 		}
 	}
 	if(regionWindow_)
-		regionWindow_->write(block->resno, blockBounds, empty ? nullptr : srcData, 1,
-							 blockBounds.width());
+		regionWindow_->write(block->resno, blockBounds, empty ? nullptr : srcData, 1, stride);
 }
 
 } // namespace grk
@@ -28,7 +28,7 @@ struct TileComponent : public grk_rect32
 {
 	TileComponent();
 	~TileComponent();
-	bool allocRegionWindow(uint32_t numres, bool truncatedTile);
+	bool allocRegionWindow(uint32_t numres, bool truncatedTile, SparseBlockPool* pool);
 	bool canCreateWindow(grk_rect32 unreducedTileCompOrImageCompWindow);
 	void createWindow(grk_rect32 unreducedTileCompOrImageCompWindow);
 	void dealloc(void);
@@ -22,7 +22,8 @@
 namespace grk
 {
 TileProcessor::TileProcessor(uint16_t tileIndex, CodeStream* codeStream, BufferedStream* stream,
-							 bool isCompressor, StripCache* stripCache)
+							 bool isCompressor, StripCache* stripCache,
+							 SparseBlockPool* sparseBlockPool)
 	: first_poc_tile_part_(true), tilePartCounter_(0), pino(0),
 	  headerImage(codeStream->getHeaderImage()),
 	  current_plugin_tile(codeStream->getCurrentPluginTile()), cp_(codeStream->getCodingParams()),
@@ -31,7 +32,9 @@ TileProcessor::TileProcessor(uint16_t tileIndex, CodeStream* codeStream, Buffere
 	  tileIndex_(tileIndex), stream_(stream),
 	  newTilePartProgressionPosition(cp_->coding_params_.enc_.newTilePartProgressionPosition),
 	  tcp_(cp_->tcps + tileIndex_), truncated(false), image_(nullptr), isCompressor_(isCompressor),
-	  preCalculatedTileLen(0), mct_(new mct(tile, headerImage, tcp_, stripCache))
+	  preCalculatedTileLen(0), mct_(new mct(tile, headerImage, tcp_, stripCache)),
+	  stripCache_(stripCache), sparseBlockPool_(sparseBlockPool),
+	  transcoder_(codeStream->getTranscoder())
 {}
 TileProcessor::~TileProcessor()
 {
@@ -161,8 +164,8 @@ GrkImage* TileProcessor::getImage(void)
 }
 void TileProcessor::release(GRK_TILE_CACHE_STRATEGY strategy)
 {
-	// delete image in absence of tile cache strategy
-	if(strategy == GRK_TILE_CACHE_NONE)
+	// delete image unless it is cached
+	if(strategy != GRK_TILE_CACHE_IMAGE)
 	{
 		if(image_)
 			grk_object_unref(&image_->obj);
@@ -206,6 +209,14 @@ bool TileProcessor::init(void)
 	if(tcp->compressedTileData_)
 		tcp->compressedTileData_->rewind();
 
+	// tile components are released after each decompression
+	if(!tile)
+	{
+		tile = new Tile(headerImage->numcomps);
+		delete mct_;
+		mct_ = new mct(tile, headerImage, tcp_, stripCache_);
+	}
+
 	// generate tile bounds from tile grid coordinates
 	uint32_t tile_x = tileIndex_ % cp_->t_grid_width;
 	uint32_t tile_y = tileIndex_ / cp_->t_grid_width;
@@ -264,6 +275,32 @@ bool TileProcessor::init(void)
 
 	return true;
 }
+/**
+ * Prepare to decompress tile again with more layers.
+ *
+ * Packet headers are parsed again from the start of the cached tile data,
+ * while code blocks resume from their cached decoder state
+ */
+bool TileProcessor::prepareRefine(void)
+{
+	auto tcp = getTileCodingParams();
+	if(tcp->ppt_buffer)
+	{
+		tcp->ppt_data = tcp->ppt_buffer;
+		tcp->ppt_len = tcp->ppt_data_size;
+	}
+	numDecompressedPackets = 0;
+
+	return init();
+}
+Transcoder* TileProcessor::getTranscoder(void)
+{
+	return transcoder_;
+}
+CodeblockStateCache* TileProcessor::getCodeblockStateCache(void)
+{
+	return cp_->coding_params_.dec_.refine_ ? &codeblockStateCache_ : nullptr;
+}
 bool TileProcessor::createWindowBuffers(const GrkImage* outputImage)
 {
 	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
@@ -322,7 +359,12 @@ bool TileProcessor::doCompress(void)
 	bool debugEncode = state & GRK_PLUGIN_STATE_DEBUG;
 	bool debugMCT = (state & GRK_PLUGIN_STATE_MCT_ONLY) ? true : false;
 
-	if(!current_plugin_tile || debugEncode)
+	if(transcoder_)
+	{
+		if(!transcoder_->fill(this))
+			return false;
+	}
+	else if(!current_plugin_tile || debugEncode)
 	{
 		if(!debugEncode)
 		{
@@ -344,7 +386,17 @@ bool TileProcessor::doCompress(void)
 		packetLengthCache.createMarkers(stream_);
 	// 2. rate control
 	uint32_t allPacketBytes = 0;
-	if(!rateAllocate(&allPacketBytes))
+	if(transcoder_)
+	{
+		// layers are fixed by transcoded code block data:
+		// simulation will generate correct PLT lengths and correct tile length
+		auto t2 = T2Compress(this);
+		if(!t2.compressPacketsSimulate(tileIndex_, tcp_->numlayers, &allPacketBytes, UINT_MAX,
+									   newTilePartProgressionPosition,
+									   packetLengthCache.getMarkers(), true))
+			return false;
+	}
+	else if(!rateAllocate(&allPacketBytes))
 		return false;
 	packetTracker_.clear();
 
@@ -428,6 +480,7 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 	bool doT1 = !current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_T1);
 	bool doPostT1 =
 		!current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_POST_T1);
+	bool directComposite = false;
 
 	// create window buffers
 	// (no buffer allocation)
@@ -452,90 +505,12 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 		// synch plugin with T2 data
 		// todo re-enable decompress synch
 		// decompress_synch_plugin_with_host(this);
-
-		// 1. count parsers
-		auto tile = getTile();
-		uint64_t parserCount = 0;
-		for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
-		{
-			auto tilec = tile->comps + compno;
-			for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
-			{
-				auto res = tilec->resolutions_ + resno;
-				parserCount += res->parserMap_->precinctParsers_.size();
-			}
-		}
-		// 2.create and populate tasks, and execute
-		if(parserCount)
-		{
-			auto numThreads = std::min<size_t>(ExecSingleton::get()->num_workers(), parserCount);
-			if(numThreads == 1)
-			{
-				for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
-				{
-					auto tilec = tile->comps + compno;
-					for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
-					{
-						auto res = tilec->resolutions_ + resno;
-						for(auto& pp : res->parserMap_->precinctParsers_)
-						{
-							for(uint64_t j = 0; j < pp.second->numParsers_; ++j)
-							{
-								try
-								{
-									auto parser = pp.second->parsers_[j];
-									parser->readHeader();
-									parser->readData();
-								}
-								catch([[maybe_unused]] std::exception& ex)
-								{
-									break;
-								}
-							}
-						}
-					}
-				}
-			}
-			else
-			{
-				tf::Taskflow taskflow;
-				auto numTasks = parserCount;
-				auto tasks = new tf::Task[numTasks];
-				for(uint64_t i = 0; i < numTasks; i++)
-					tasks[i] = taskflow.placeholder();
-				uint64_t i = 0;
-				for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
-				{
-					auto tilec = tile->comps + compno;
-					for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
-					{
-						auto res = tilec->resolutions_ + resno;
-						for(auto& pp : res->parserMap_->precinctParsers_)
-						{
-							auto& ppair = pp;
-							auto decompressor = [ppair]() {
-								for(uint64_t j = 0; j < ppair.second->numParsers_; ++j)
-								{
-									try
-									{
-										auto parser = ppair.second->parsers_[j];
-										parser->readHeader();
-										parser->readData();
-									}
-									catch([[maybe_unused]] std::exception& ex)
-									{
-										break;
-									}
-								}
-							};
-							tasks[i++].work(decompressor);
-						}
-					}
-				}
-				ExecSingleton::get()->run(taskflow).wait();
-				delete[] tasks;
-			}
-		}
+	}
+	if(transcoder_)
+	{
+		bool rc = transcoder_->ingest(this);
+		releaseTilePartData();
+		return rc;
 	}
 	// T1
 	if(doT1)
@@ -554,7 +529,8 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 			{
 				try
 				{
-					tilec->allocRegionWindow(tilec->highestResolutionDecompressed + 1U, truncated);
+					tilec->allocRegionWindow(tilec->highestResolutionDecompressed + 1U, truncated,
+											 sparseBlockPool_);
 				}
 				catch([[maybe_unused]] std::runtime_error& ex)
 				{
@@ -572,7 +548,24 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 			}
 			if(!scheduler_->schedule(compno))
 				return false;
+		}
+		// final stage of post processing writes directly into composite image,
+		// if every component has a final stage
+		bool hasFinalStage = doPostT1;
+		for(uint16_t compno = 0; compno < tile->numcomps_ && hasFinalStage; ++compno)
+			hasFinalStage = scheduler_->getImageComponentFlow(compno) != nullptr;
+		std::vector<CompositeDest> compositeDest;
+		directComposite = hasFinalStage && genCompositeDest(outputImage, compositeDest);
+		if(!directComposite)
+			compositeDest.clear();
+		mct_->setCompositeDest(compositeDest);
+		// fuse precision conversion with final stage
+		std::vector<int8_t> precShift;
+		outputImage->getFusedPrecisionShift(cp_, headerImage, precShift);
+		mct_->setPrecisionShift(precShift);
 
+		for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+		{
 			// post processing
 			auto compFlow = scheduler_->getImageComponentFlow(compno);
 			if(compFlow)
@@ -606,13 +599,17 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 		delete scheduler_;
 		scheduler_ = nullptr;
 	}
+	releaseTilePartData();
 	// 4. post T1
 	bool doPost =
 		!current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_POST_T1);
 	if(doPost)
 	{
 		if(outputImage->hasMultipleTiles)
-			generateImage(outputImage, tile);
+		{
+			if(!directComposite)
+				generateImage(outputImage, tile);
+		}
 		else
 			outputImage->transferDataFrom(tile);
 		deallocBuffers();
@@ -626,6 +623,18 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 	return true;
 }
 
+/**
+ * Advise stream that compressed tile data has been consumed, if enabled
+ */
+void TileProcessor::releaseTilePartData(void)
+{
+	if(cp_->coding_params_.dec_.randomAccessFlags_ & GRK_RANDOM_ACCESS_RELEASE)
+	{
+		for(auto& range : tilePartDataRanges_)
+			stream_->advise(range.first, range.second, GRK_STREAM_ADVICE_DONTNEED);
+	}
+	tilePartDataRanges_.clear();
+}
 void TileProcessor::ingestImage()
 {
 	for(uint16_t i = 0; i < headerImage->numcomps; ++i)
@@ -700,6 +709,41 @@ bool TileProcessor::mctDecompress(FlowComponent* flow)
 
 	return true;
 }
+/**
+ * Generate destination windows in composite image for tile components,
+ * so that the final post processing stage can skip the tile image and write
+ * straight into the composite
+ *
+ * @param outputImage composite image
+ * @param dest destination window for each component
+ *
+ * @return true if tile can be composited directly
+ */
+bool TileProcessor::genCompositeDest(GrkImage* outputImage, std::vector<CompositeDest>& dest)
+{
+	// tile image is needed for plugin, custom MCT, tile caching and strip cache
+	if(!outputImage->hasMultipleTiles || current_plugin_tile || tcp_->mct == 2 ||
+	   cp_->coding_params_.dec_.cacheTileImages_ || outputImage->interleavedData.data_ ||
+	   outputImage->numcomps != tile->numcomps_ || outputImage->supportsStripCache(cp_))
+		return false;
+	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+	{
+		auto destComp = outputImage->comps + compno;
+		if(!destComp->data)
+			return false;
+		auto bounds = tile->comps[compno].getWindow()->bounds();
+		grk_rect32 destWin;
+		if(!outputImage->generateCompositeBounds(bounds, compno, &destWin) ||
+		   destWin.width() != bounds.width() || destWin.height() != bounds.height())
+			return false;
+		auto offset = (size_t)destWin.x0 + (size_t)destWin.y0 * destComp->stride;
+		dest.push_back(CompositeDest((uint8_t*)destComp->data +
+										 offset * dataTypeSize(destComp->data_type),
+									 destComp->stride, destWin.height(), destComp->data_type));
+	}
+
+	return true;
+}
 bool TileProcessor::dcLevelShiftCompress()
 {
 	for(uint16_t compno = 0; compno < tile->numcomps_; compno++)
@@ -807,7 +851,18 @@ void TileProcessor::t1_encode()
 		mct_norms = (const double*)(tcp->mct_norms);
 	}
 
-	scheduler_ = new CompressScheduler(tile, needsRateControl(), tcp, mct_norms, mct_numcomps);
+	// passes can only be skipped when the final layer has a byte budget, since
+	// that budget bounds the slope threshold chosen by rate control
+	SlopeThresholdEstimator* slopeEstimator = nullptr;
+	auto enc_params = &cp_->coding_params_.enc_;
+	if(enc_params->passTruncationMargin >= 1.0 && enc_params->allocationByRateDistortion_ &&
+	   layerNeedsRateControl(tcp->numlayers - 1U))
+	{
+		slopeEstimator = new SlopeThresholdEstimator(tcp->rates[tcp->numlayers - 1],
+													 enc_params->passTruncationMargin);
+	}
+	scheduler_ = new CompressScheduler(tile, needsRateControl(), tcp, mct_norms, mct_numcomps,
+									   slopeEstimator);
 	scheduler_->schedule(0);
 }
 bool TileProcessor::encodeT2(uint32_t* tileBytesWritten)
@@ -926,6 +981,9 @@ bool TileProcessor::preCompressTile()
 	rc = createWindowBuffers(nullptr);
 	if(!rc)
 		return false;
+	// transcoded tiles have no image data
+	if(transcoder_)
+		return true;
 	uint32_t numTiles = (uint32_t)cp_->t_grid_height * cp_->t_grid_width;
 	bool transfer_image_to_tile = (numTiles == 1);
 	/* if we only have one tile, then simply set tile component data equal to
@@ -1107,8 +1165,10 @@ bool TileProcessor::cacheTilePartPackets(CodeStreamDecompress* codeStream)
 				return false;
 			}
 		}
+		auto dataPosition = stream_->tell();
 		current_read_size = stream_->read(zeroCopy ? nullptr : buff, len);
 		tcp->compressedTileData_->pushBack(buff, len, !zeroCopy);
+		tilePartDataRanges_.push_back({dataPosition, current_read_size});
 	}
 	if(current_read_size != tilePartDataLength)
 		codeStream->getDecompressorState()->setState(DECOMPRESS_STATE_NO_EOC);
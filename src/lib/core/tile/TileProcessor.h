@@ -73,13 +73,16 @@ struct PacketTracker
  */
 
 class mct;
+struct CompositeDest;
 
 struct TileProcessor
 {
 	explicit TileProcessor(uint16_t index, CodeStream* codeStream, BufferedStream* stream,
-						   bool isCompressor, StripCache* stripCache);
+						   bool isCompressor, StripCache* stripCache,
+						   SparseBlockPool* sparseBlockPool);
 	~TileProcessor();
 	bool init(void);
+	bool prepareRefine(void);
 	bool createWindowBuffers(const GrkImage* outputImage);
 	void deallocBuffers();
 	bool preCompressTile(void);
@@ -107,6 +110,8 @@ struct TileProcessor
 	Tile* getTile(void);
 	Scheduler* getScheduler(void);
 	bool isCompressor(void);
+	CodeblockStateCache* getCodeblockStateCache(void);
+	Transcoder* getTranscoder(void);
 
 	/** Compression Only
 	 *  true for first POC tile part, otherwise false*/
@@ -138,6 +143,8 @@ struct TileProcessor
 	bool needsMctDecompress(uint16_t compno);
 	bool needsMctDecompress(void);
 	bool mctDecompress(FlowComponent* flow);
+	bool genCompositeDest(GrkImage* outputImage, std::vector<CompositeDest>& dest);
+	void releaseTilePartData(void);
 	bool dcLevelShiftCompress();
 	bool mct_encode();
 	bool dwt_encode();
@@ -158,6 +165,8 @@ struct TileProcessor
 	std::atomic<uint64_t> numDecompressedPackets;
 	// Decompressing Only
 	uint64_t tilePartDataLength;
+	// stream (offset, length) of compressed data for each tile part read
+	std::vector<std::pair<uint64_t, uint64_t>> tilePartDataRanges_;
 	/** index of tile being currently compressed/decompressed */
 	uint16_t tileIndex_;
 	// Compressing only - track which packets have already been written
@@ -175,6 +184,14 @@ struct TileProcessor
 	grk_rect32 unreducedImageWindow;
 	uint32_t preCalculatedTileLen;
 	mct* mct_;
+	StripCache* stripCache_;
+	// Decompressing only - recycled sparse canvas blocks for region decoding
+	SparseBlockPool* sparseBlockPool_;
+	// Decompressing only - code block decoder state retained for refinement
+	CodeblockStateCache codeblockStateCache_;
+	// when set, code block data is transcoded: decompression stops after T2,
+	// and compression takes code block data from transcoder in place of T1
+	Transcoder* transcoder_;
 };
 
 } // namespace grk
@@ -47,6 +47,7 @@ struct BufferedStream
 	void setZeroCopyReadFunction(grk_stream_zero_copy_read_fn fn);
 	void setWriteFunction(grk_stream_write_fn fn);
 	void setSeekFunction(grk_stream_seek_fn fn);
+	void setAdviseFunction(grk_stream_advise_fn fn);
 	/**
 	 * Reads some bytes from the stream.
 	 * @param		buffer	pointer to the data buffer
@@ -112,6 +113,14 @@ struct BufferedStream
 	 */
 	bool hasSeek();
 	bool supportsZeroCopy();
+	/**
+	 * Advise stream of expected access pattern for a byte range.
+	 * No-op if stream does not support advice.
+	 * @param		offset		absolute offset of range
+	 * @param		length		length of range
+	 * @param		advice		access pattern advice
+	 */
+	void advise(uint64_t offset, uint64_t length, GRK_STREAM_ADVICE advice);
 	uint8_t* getZeroCopyPtr();
 
 	void setFormat(GRK_CODEC_FORMAT format);
@@ -191,6 +200,10 @@ struct BufferedStream
 	 * Pointer to actual seek function (if available).
 	 */
 	grk_stream_seek_fn seek_fn_;
+	/**
+	 * Pointer to access pattern advice function (if available).
+	 */
+	grk_stream_advise_fn advise_fn_;
 	/**
 	 * Stream status flags
 	 */
@@ -0,0 +1,298 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "util/ColourConversion.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	/*--------------------------------------------------------
+	 Matrix for sYCC, Amendment 1 to IEC 61966-2-1
+
+	 Y  |  0.299   0.587    0.114  |    R
+	 Cb | -0.1687 -0.3312   0.5    | x  G
+	 Cr |  0.5    -0.4187  -0.0812 |    B
+
+	 Inverse:
+
+	 R   |1        -3.68213e-05    1.40199     |    Y
+	 G = |1.00003  -0.344125      -0.714128    | x  Cb - 2^(prec - 1)
+	 B   |0.999823  1.77204       -8.04142e-06 |    Cr - 2^(prec - 1)
+
+	 Chroma products are calculated in double precision and truncated
+	 -----------------------------------------------------------*/
+	static void hwy_sycc_to_rgb_row(const int32_t* y, const int32_t* cb, const int32_t* cr,
+									int32_t* r, int32_t* g, int32_t* b, uint32_t width,
+									int32_t offset, int32_t upb)
+	{
+		uint32_t i = 0;
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) dd;
+		const Rebind<int32_t, decltype(dd)> di;
+		const size_t N = Lanes(dd);
+		auto voffset = Set(di, offset);
+		auto vzero = Zero(di);
+		auto vupb = Set(di, upb);
+		auto vrv = Set(dd, 1.402);
+		auto vgu = Set(dd, 0.344);
+		auto vgv = Set(dd, 0.714);
+		auto vbu = Set(dd, 1.772);
+		for(; i + N <= width; i += (uint32_t)N)
+		{
+			auto vy = LoadU(di, y + i);
+			auto vcb = PromoteTo(dd, LoadU(di, cb + i) - voffset);
+			auto vcr = PromoteTo(dd, LoadU(di, cr + i) - voffset);
+			auto vr = vy + DemoteTo(di, vrv * vcr);
+			auto vg = vy - DemoteTo(di, vgu * vcb + vgv * vcr);
+			auto vb = vy + DemoteTo(di, vbu * vcb);
+			StoreU(Min(Max(vr, vzero), vupb), di, r + i);
+			StoreU(Min(Max(vg, vzero), vupb), di, g + i);
+			StoreU(Min(Max(vb, vzero), vupb), di, b + i);
+		}
+#endif
+		for(; i < width; ++i)
+		{
+			int32_t ccb = cb[i] - offset;
+			int32_t ccr = cr[i] - offset;
+			int32_t yy = y[i];
+			r[i] = std::clamp<int32_t>(yy + (int32_t)(1.402 * ccr), 0, upb);
+			g[i] = std::clamp<int32_t>(yy - (int32_t)(0.344 * ccb + 0.714 * ccr), 0, upb);
+			b[i] = std::clamp<int32_t>(yy + (int32_t)(1.772 * ccb), 0, upb);
+		}
+	}
+
+	/**
+	 * Chroma terms of sYCC to RGB conversion, at chroma resolution
+	 */
+	static void hwy_sycc_chroma_row(const int32_t* cb, const int32_t* cr, int32_t* dr, int32_t* dg,
+									int32_t* db, uint32_t width, int32_t offset)
+	{
+		uint32_t i = 0;
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) dd;
+		const Rebind<int32_t, decltype(dd)> di;
+		const size_t N = Lanes(dd);
+		auto voffset = Set(di, offset);
+		auto vrv = Set(dd, 1.402);
+		auto vgu = Set(dd, 0.344);
+		auto vgv = Set(dd, 0.714);
+		auto vbu = Set(dd, 1.772);
+		for(; i + N <= width; i += (uint32_t)N)
+		{
+			auto vcb = PromoteTo(dd, LoadU(di, cb + i) - voffset);
+			auto vcr = PromoteTo(dd, LoadU(di, cr + i) - voffset);
+			StoreU(DemoteTo(di, vrv * vcr), di, dr + i);
+			StoreU(DemoteTo(di, vgu * vcb + vgv * vcr), di, dg + i);
+			StoreU(DemoteTo(di, vbu * vcb), di, db + i);
+		}
+#endif
+		for(; i < width; ++i)
+		{
+			int32_t ccb = cb[i] - offset;
+			int32_t ccr = cr[i] - offset;
+			dr[i] = (int32_t)(1.402 * ccr);
+			dg[i] = (int32_t)(0.344 * ccb + 0.714 * ccr);
+			db[i] = (int32_t)(1.772 * ccb);
+		}
+	}
+
+	/**
+	 * Add horizontally sub-sampled chroma terms to luma:
+	 * luma sample i uses chroma terms at i/2
+	 */
+	static void hwy_sycc_add_chroma_row(const int32_t* y, const int32_t* dr, const int32_t* dg,
+										const int32_t* db, int32_t* r, int32_t* g, int32_t* b,
+										uint32_t width, int32_t upb)
+	{
+		const HWY_FULL(int32_t) di;
+		const size_t N = Lanes(di);
+		auto vzero = Zero(di);
+		auto vupb = Set(di, upb);
+		// each chroma vector is duplicated into two luma vectors
+		auto idxLo = IndicesFromVec(di, ShiftRight<1>(Iota(di, 0)));
+		auto idxHi = IndicesFromVec(di, ShiftRight<1>(Iota(di, (int32_t)N)));
+		uint32_t i = 0;
+		for(; i + 2 * N <= width; i += 2 * (uint32_t)N)
+		{
+			auto vdr = LoadU(di, dr + i / 2);
+			auto vdg = LoadU(di, dg + i / 2);
+			auto vdb = LoadU(di, db + i / 2);
+			auto vy = LoadU(di, y + i);
+			auto vy2 = LoadU(di, y + i + N);
+			StoreU(Min(Max(vy + TableLookupLanes(vdr, idxLo), vzero), vupb), di, r + i);
+			StoreU(Min(Max(vy2 + TableLookupLanes(vdr, idxHi), vzero), vupb), di, r + i + N);
+			StoreU(Min(Max(vy - TableLookupLanes(vdg, idxLo), vzero), vupb), di, g + i);
+			StoreU(Min(Max(vy2 - TableLookupLanes(vdg, idxHi), vzero), vupb), di, g + i + N);
+			StoreU(Min(Max(vy + TableLookupLanes(vdb, idxLo), vzero), vupb), di, b + i);
+			StoreU(Min(Max(vy2 + TableLookupLanes(vdb, idxHi), vzero), vupb), di, b + i + N);
+		}
+		for(; i < width; ++i)
+		{
+			int32_t yy = y[i];
+			r[i] = std::clamp<int32_t>(yy + dr[i / 2], 0, upb);
+			g[i] = std::clamp<int32_t>(yy - dg[i / 2], 0, upb);
+			b[i] = std::clamp<int32_t>(yy + db[i / 2], 0, upb);
+		}
+	}
+
+	static void hwy_esycc_to_rgb_row(int32_t* y, int32_t* cb, int32_t* cr, uint32_t width,
+									 bool sgndCb, bool sgndCr, int32_t flip, int32_t upb)
+	{
+		int32_t flipCb = sgndCb ? 0 : flip;
+		int32_t flipCr = sgndCr ? 0 : flip;
+		uint32_t i = 0;
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) dd;
+		const Rebind<int32_t, decltype(dd)> di;
+		const size_t N = Lanes(dd);
+		auto vflipCb = Set(di, flipCb);
+		auto vflipCr = Set(di, flipCr);
+		auto vzero = Zero(di);
+		auto vupb = Set(di, upb);
+		auto vhalf = Set(dd, 0.5);
+		for(; i + N <= width; i += (uint32_t)N)
+		{
+			auto vy = PromoteTo(dd, LoadU(di, y + i));
+			auto vcb = PromoteTo(dd, LoadU(di, cb + i) - vflipCb);
+			auto vcr = PromoteTo(dd, LoadU(di, cr + i) - vflipCr);
+			auto vr = vy - Set(dd, 0.0000368) * vcb + Set(dd, 1.40199) * vcr + vhalf;
+			auto vg = Set(dd, 1.0003) * vy - Set(dd, 0.344125) * vcb -
+					  Set(dd, 0.7141128) * vcr + vhalf;
+			auto vb = Set(dd, 0.999823) * vy + Set(dd, 1.77204) * vcb -
+					  Set(dd, 0.000008) * vcr + vhalf;
+			StoreU(Min(Max(DemoteTo(di, vr), vzero), vupb), di, y + i);
+			StoreU(Min(Max(DemoteTo(di, vg), vzero), vupb), di, cb + i);
+			StoreU(Min(Max(DemoteTo(di, vb), vzero), vupb), di, cr + i);
+		}
+#endif
+		for(; i < width; ++i)
+		{
+			int32_t yy = y[i];
+			int32_t ccb = cb[i] - flipCb;
+			int32_t ccr = cr[i] - flipCr;
+			y[i] = std::clamp<int32_t>((int32_t)(yy - 0.0000368 * ccb + 1.40199 * ccr + 0.5), 0,
+									   upb);
+			cb[i] = std::clamp<int32_t>(
+				(int32_t)(1.0003 * yy - 0.344125 * ccb - 0.7141128 * ccr + 0.5), 0, upb);
+			cr[i] = std::clamp<int32_t>(
+				(int32_t)(0.999823 * yy + 1.77204 * ccb - 0.000008 * ccr + 0.5), 0, upb);
+		}
+	}
+
+	static void hwy_cmyk_to_rgb_row(int32_t* c, int32_t* m, int32_t* y, const int32_t* k,
+									uint32_t width, const float* scale)
+	{
+		const HWY_FULL(float) df;
+		const HWY_FULL(int32_t) di;
+		const size_t N = Lanes(di);
+		auto vsC = Set(df, scale[0]);
+		auto vsM = Set(df, scale[1]);
+		auto vsY = Set(df, scale[2]);
+		auto vsK = Set(df, scale[3]);
+		auto vone = Set(df, 1.0F);
+		auto v255 = Set(df, 255.0F);
+		uint32_t i = 0;
+		for(; i + N <= width; i += (uint32_t)N)
+		{
+			// invert CMYK values in [0,1], then map to RGB values in [0,255]
+			auto vC = vone - ConvertTo(df, LoadU(di, c + i)) * vsC;
+			auto vM = vone - ConvertTo(df, LoadU(di, m + i)) * vsM;
+			auto vY = vone - ConvertTo(df, LoadU(di, y + i)) * vsY;
+			auto vK = vone - ConvertTo(df, LoadU(di, k + i)) * vsK;
+			StoreU(ConvertTo(di, v255 * vC * vK), di, c + i);
+			StoreU(ConvertTo(di, v255 * vM * vK), di, m + i);
+			StoreU(ConvertTo(di, v255 * vY * vK), di, y + i);
+		}
+		for(; i < width; ++i)
+		{
+			float C = 1.0F - (float)(c[i]) * scale[0];
+			float M = 1.0F - (float)(m[i]) * scale[1];
+			float Y = 1.0F - (float)(y[i]) * scale[2];
+			float K = 1.0F - (float)(k[i]) * scale[3];
+			c[i] = (int32_t)(255.0F * C * K);
+			m[i] = (int32_t)(255.0F * M * K);
+			y[i] = (int32_t)(255.0F * Y * K);
+		}
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_sycc_to_rgb_row);
+HWY_EXPORT(hwy_sycc_chroma_row);
+HWY_EXPORT(hwy_sycc_add_chroma_row);
+HWY_EXPORT(hwy_esycc_to_rgb_row);
+HWY_EXPORT(hwy_cmyk_to_rgb_row);
+
+void syccToRgbRow(const int32_t* y, const int32_t* cb, const int32_t* cr, int32_t* r, int32_t* g,
+				  int32_t* b, uint32_t width, int32_t offset, int32_t upb)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_sycc_to_rgb_row)(y, cb, cr, r, g, b, width, offset, upb);
+}
+void syccChromaRow(const int32_t* cb, const int32_t* cr, int32_t* dr, int32_t* dg, int32_t* db,
+				   uint32_t width, int32_t offset)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_sycc_chroma_row)(cb, cr, dr, dg, db, width, offset);
+}
+void syccAddChromaRow(const int32_t* y, const int32_t* dr, const int32_t* dg, const int32_t* db,
+					  int32_t* r, int32_t* g, int32_t* b, uint32_t width, int32_t upb)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_sycc_add_chroma_row)(y, dr, dg, db, r, g, b, width, upb);
+}
+void esyccToRgbRow(int32_t* y, int32_t* cb, int32_t* cr, uint32_t width, bool sgndCb, bool sgndCr,
+				   int32_t flip, int32_t upb)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_esycc_to_rgb_row)(y, cb, cr, width, sgndCb, sgndCr, flip, upb);
+}
+void cmykToRgbRow(int32_t* c, int32_t* m, int32_t* y, const int32_t* k, uint32_t width,
+				  const float* scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_cmyk_to_rgb_row)(c, m, y, k, width, scale);
+}
+void convertStrips(uint32_t height, uint32_t rowsPerStrip,
+				   const std::function<void(uint32_t yBegin, uint32_t yEnd)>& convert)
+{
+	if(!height)
+		return;
+	uint32_t numStrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+	auto executor = ExecSingleton::get();
+	if(executor->num_workers() == 1 || numStrips == 1)
+	{
+		convert(0, height);
+		return;
+	}
+	tf::Taskflow taskflow;
+	for(uint32_t strip = 0; strip < numStrips; ++strip)
+	{
+		uint32_t yBegin = strip * rowsPerStrip;
+		uint32_t yEnd = std::min<uint32_t>(yBegin + rowsPerStrip, height);
+		taskflow.emplace([&convert, yBegin, yEnd] { convert(yBegin, yEnd); });
+	}
+	executor->run(taskflow).wait();
+}
+} // namespace grk
+#endif
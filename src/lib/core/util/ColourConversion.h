@@ -0,0 +1,114 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace grk
+{
+/**
+ * Convert a row of sYCC samples to RGB.
+ * Output rows may alias input rows.
+ *
+ * @param y luma row
+ * @param cb blue difference chroma row
+ * @param cr red difference chroma row
+ * @param r red output row
+ * @param g green output row
+ * @param b blue output row
+ * @param width number of samples
+ * @param offset chroma offset
+ * @param upb upper bound of output samples
+ */
+void syccToRgbRow(const int32_t* y, const int32_t* cb, const int32_t* cr, int32_t* r, int32_t* g,
+				  int32_t* b, uint32_t width, int32_t offset, int32_t upb);
+
+/**
+ * Calculate chroma terms of sYCC to RGB conversion for a row of chroma samples.
+ * Terms only depend on chroma, so sub-sampled chroma only needs to be
+ * converted once for all luma samples that share it.
+ *
+ * @param cb blue difference chroma row
+ * @param cr red difference chroma row
+ * @param dr red term row
+ * @param dg green term row
+ * @param db blue term row
+ * @param width number of chroma samples
+ * @param offset chroma offset
+ */
+void syccChromaRow(const int32_t* cb, const int32_t* cr, int32_t* dr, int32_t* dg, int32_t* db,
+				   uint32_t width, int32_t offset);
+
+/**
+ * Combine a row of luma samples with horizontally sub-sampled chroma terms
+ * from syccChromaRow: luma sample i uses the terms at i/2.
+ * Output rows may alias the luma row.
+ *
+ * @param y luma row
+ * @param dr red term row
+ * @param dg green term row
+ * @param db blue term row
+ * @param r red output row
+ * @param g green output row
+ * @param b blue output row
+ * @param width number of luma samples
+ * @param upb upper bound of output samples
+ */
+void syccAddChromaRow(const int32_t* y, const int32_t* dr, const int32_t* dg, const int32_t* db,
+					  int32_t* r, int32_t* g, int32_t* b, uint32_t width, int32_t upb);
+
+/**
+ * Convert a row of e-sYCC samples to RGB, in place
+ *
+ * @param y luma row, overwritten with red
+ * @param cb blue difference chroma row, overwritten with green
+ * @param cr red difference chroma row, overwritten with blue
+ * @param width number of samples
+ * @param sgndCb true if cb is signed
+ * @param sgndCr true if cr is signed
+ * @param flip chroma offset for unsigned chroma
+ * @param upb upper bound of output samples
+ */
+void esyccToRgbRow(int32_t* y, int32_t* cb, int32_t* cr, uint32_t width, bool sgndCb, bool sgndCr,
+				   int32_t flip, int32_t upb);
+
+/**
+ * Convert a row of CMYK samples to 8 bit RGB, in place
+ *
+ * @param c cyan row, overwritten with red
+ * @param m magenta row, overwritten with green
+ * @param y yellow row, overwritten with blue
+ * @param k black row
+ * @param width number of samples
+ * @param scale scale for each of C,M,Y,K, mapping samples to [0,1]
+ */
+void cmykToRgbRow(int32_t* c, int32_t* m, int32_t* y, const int32_t* k, uint32_t width,
+				  const float* scale);
+
+/**
+ * Run row conversion over image in parallel strips
+ *
+ * @param height number of rows
+ * @param rowsPerStrip number of rows in each strip
+ * @param convert function converting rows [yBegin, yEnd)
+ */
+void convertStrips(uint32_t height, uint32_t rowsPerStrip,
+				   const std::function<void(uint32_t yBegin, uint32_t yEnd)>& convert);
+
+} // namespace grk
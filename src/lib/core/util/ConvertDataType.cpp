@@ -0,0 +1,112 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "ConvertDataType.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "util/ConvertDataType.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	template<typename T>
+	static void hwy_demote(T* dest, const int32_t* src, uint32_t len)
+	{
+		const HWY_FULL(int32_t) di;
+		const Rebind<T, decltype(di)> dt;
+		const size_t N = Lanes(di);
+		uint32_t i = 0;
+		// demotion saturates to the range of T
+		for(; i + N <= len; i += (uint32_t)N)
+			StoreU(DemoteTo(dt, LoadU(di, src + i)), dt, dest + i);
+		for(; i < len; ++i)
+			dest[i] = (T)std::clamp<int32_t>(src[i], (std::numeric_limits<T>::min)(),
+											 (std::numeric_limits<T>::max)());
+	}
+
+	static void hwy_to_float(float* dest, const int32_t* src, uint32_t len)
+	{
+		const HWY_FULL(int32_t) di;
+		const RebindToFloat<decltype(di)> df;
+		const size_t N = Lanes(di);
+		uint32_t i = 0;
+		for(; i + N <= len; i += (uint32_t)N)
+			StoreU(ConvertTo(df, LoadU(di, src + i)), df, dest + i);
+		for(; i < len; ++i)
+			dest[i] = (float)src[i];
+	}
+
+	static void hwy_convert_data_type(void* dest, const int32_t* src, uint32_t len,
+									  GRK_DATA_TYPE dataType)
+	{
+		switch(dataType)
+		{
+			case GRK_UINT_8:
+				hwy_demote((uint8_t*)dest, src, len);
+				break;
+			case GRK_UINT_16:
+				hwy_demote((uint16_t*)dest, src, len);
+				break;
+			case GRK_INT_16:
+				hwy_demote((int16_t*)dest, src, len);
+				break;
+			case GRK_FLOAT_32:
+				hwy_to_float((float*)dest, src, len);
+				break;
+			default:
+				if(dest != src)
+					memcpy(dest, src, len * sizeof(int32_t));
+				break;
+		}
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_convert_data_type);
+
+size_t dataTypeSize(GRK_DATA_TYPE dataType)
+{
+	switch(dataType)
+	{
+		case GRK_UINT_8:
+			return sizeof(uint8_t);
+		case GRK_UINT_16:
+		case GRK_INT_16:
+			return sizeof(uint16_t);
+		case GRK_FLOAT_32:
+			return sizeof(float);
+		default:
+			return sizeof(int32_t);
+	}
+}
+void convertDataType(void* dest, const int32_t* src, uint32_t len, GRK_DATA_TYPE dataType)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_convert_data_type)(dest, src, len, dataType);
+}
+} // namespace grk
+#endif
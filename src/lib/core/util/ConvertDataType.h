@@ -0,0 +1,44 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "grok.h"
+
+namespace grk
+{
+/**
+ * Get size in bytes of a sample of given data type
+ *
+ * @param dataType data type
+ */
+size_t dataTypeSize(GRK_DATA_TYPE dataType);
+
+/**
+ * Convert a row of 32 bit integer samples to another data type,
+ * clamping samples to the range of that type.
+ *
+ * @param dest destination row, of type dataType
+ * @param src source row
+ * @param len number of samples
+ * @param dataType destination data type
+ */
+void convertDataType(void* dest, const int32_t* src, uint32_t len, GRK_DATA_TYPE dataType);
+
+} // namespace grk
@@ -101,8 +101,10 @@ GrkImage* GrkImage::create(grk_image* src, uint16_t numcmpts, grk_image_comp* cm
 		image->decompressFormat = src->decompressFormat;
 		image->forceRGB = src->forceRGB;
 		image->upsample = src->upsample;
+		image->upsampleFilter = src->upsampleFilter;
 		image->precision = src->precision;
 		image->numPrecision = src->numPrecision;
+		image->outputDataType = src->outputDataType;
 		image->rowsPerStrip = src->rowsPerStrip;
 		image->packedRowBytes = src->packedRowBytes;
 	}
@@ -243,6 +245,7 @@ void GrkImage::copyHeader(GrkImage* dest)
 	{
 		memcpy(&(dest->comps[compno]), &(comps[compno]), sizeof(grk_image_comp));
 		dest->comps[compno].data = nullptr;
+		dest->comps[compno].data_type = GRK_INT_32;
 	}
 
 	dest->color_space = color_space;
@@ -270,9 +273,11 @@ void GrkImage::copyHeader(GrkImage* dest)
 	dest->decompressColourSpace = decompressColourSpace;
 	dest->forceRGB = forceRGB;
 	dest->upsample = upsample;
+	dest->upsampleFilter = upsampleFilter;
 	dest->precision = precision;
 	dest->hasMultipleTiles = hasMultipleTiles;
 	dest->numPrecision = numPrecision;
+	dest->outputDataType = outputDataType;
 	dest->rowsPerStrip = rowsPerStrip;
 	dest->packedRowBytes = packedRowBytes;
 }
@@ -288,7 +293,7 @@ bool GrkImage::allocData(grk_image_comp* comp, bool clear)
 	assert(comp->stride);
 	assert(!comp->data);
 
-	size_t dataSize = (uint64_t)comp->stride * comp->h * sizeof(uint32_t);
+	size_t dataSize = (uint64_t)comp->stride * comp->h * dataTypeSize(comp->data_type);
 	auto data = (int32_t*)grk_aligned_malloc(dataSize);
 	if(!data)
 	{
@@ -297,7 +302,7 @@ bool GrkImage::allocData(grk_image_comp* comp, bool clear)
 		return false;
 	}
 	if(clear)
-		memset(data, 0, dataSize);
+		grk_clear(data, dataSize);
 	single_component_data_free(comp);
 	comp->data = data;
 
@@ -331,15 +336,48 @@ bool GrkImage::supportsStripCache(CodingParams* cp)
 
 	bool supportedFileFormat =
 		decompressFormat == GRK_FMT_TIF || (decompressFormat == GRK_FMT_PXM && !splitByComponent);
-	if(isSubsampled() || precision || upsample || needsConversionToRGB() || !supportedFileFormat ||
+	// PNG and JPEG encoders only support unsigned samples of their native precisions
+	if(decompressFormat == GRK_FMT_PNG)
+		supportedFileFormat = !comps->sgnd && (comps->prec == 8 || comps->prec == 16);
+	else if(decompressFormat == GRK_FMT_JPG)
+		supportedFileFormat = !comps->sgnd && comps->prec == 8 && (numcomps == 1 || numcomps == 3);
+	if(precision || needsConversionToRGB() || !supportedFileFormat ||
 	   (meta && (meta->color.palette || meta->color.icc_profile_buf)))
 	{
 		return false;
 	}
+	if(isSubsampled())
+		return supportsUpsampledStrips(cp);
 
 	return componentsEqual(true);
 }
 
+/**
+ * Check if sub-sampled tiles can be upsampled while they are interleaved into strips,
+ * without the full resolution components ever being composited.
+ *
+ * Each tile must cover whole component samples, so that the tiles can be upsampled
+ * independently: this rules out the bilinear filter, which interpolates across
+ * tile boundaries.
+ */
+bool GrkImage::supportsUpsampledStrips(CodingParams* cp)
+{
+	if(!upsample || upsampleFilter != GRK_UPSAMPLE_NEAREST || !hasMultipleTiles ||
+	   cp->coding_params_.dec_.reduce_)
+		return false;
+	for(uint16_t compno = 0; compno < numcomps; ++compno)
+	{
+		auto comp = comps + compno;
+		if((x0 % comp->dx) || (y0 % comp->dy) || (cp->tx0 % comp->dx) || (cp->ty0 % comp->dy) ||
+		   (cp->t_width % comp->dx) || (cp->t_height % comp->dy))
+			return false;
+		if(comp->prec != comps->prec || comp->sgnd != comps->sgnd)
+			return false;
+	}
+
+	return true;
+}
+
 bool GrkImage::isSubsampled()
 {
 	for(uint32_t i = 0; i < numcomps; ++i)
@@ -394,7 +432,8 @@ void GrkImage::postReadHeader(CodingParams* cp)
 	decompressColourSpace = color_space;
 	if(needsConversionToRGB())
 		decompressColourSpace = GRK_CLRSPC_SRGB;
-	bool tiffSubSampled = decompressFormat == GRK_FMT_TIF && isSubsampled() &&
+	bool tiffSubSampled = decompressFormat == GRK_FMT_TIF && isSubsampled() && !upsample &&
+						  !forceRGB &&
 						  (color_space == GRK_CLRSPC_EYCC || color_space == GRK_CLRSPC_SYCC);
 	if(tiffSubSampled)
 	{
@@ -845,6 +884,7 @@ bool GrkImage::allocCompositeData(void)
 	if(!hasMultipleTiles)
 		return true;
 
+	bool narrow = canCompositeToOutputDataType();
 	for(uint32_t i = 0; i < numcomps; i++)
 	{
 		auto destComp = comps + i;
@@ -856,6 +896,7 @@ bool GrkImage::allocCompositeData(void)
 		}
 		if(!destComp->data)
 		{
+			destComp->data_type = narrow ? outputDataType : GRK_INT_32;
 			if(!GrkImage::allocData(destComp, true))
 			{
 				GRK_ERROR("Failed to allocate pixel data for component %u, with dimensions %u x %u",
@@ -868,6 +909,59 @@ bool GrkImage::allocCompositeData(void)
 	return true;
 }
 
+/**
+ * Check if tiles can be composited directly into buffers of the output data type,
+ * i.e. no post processing step will read the composite image samples
+ */
+bool GrkImage::canCompositeToOutputDataType(void)
+{
+	if(outputDataType == GRK_INT_32 || decompressFormat != GRK_FMT_UNK)
+		return false;
+	if(forceRGB || precision || (upsample && isSubsampled()))
+		return false;
+	if(meta && (meta->color.palette || meta->color.icc_profile_buf))
+		return false;
+
+	return color_space != GRK_CLRSPC_SYCC && color_space != GRK_CLRSPC_EYCC &&
+		   color_space != GRK_CLRSPC_CMYK;
+}
+
+/**
+ * Convert components to output data type, once all post processing is complete
+ *
+ * @return true if successful
+ */
+bool GrkImage::convertToOutputDataType(void)
+{
+	if(outputDataType == GRK_INT_32 || decompressFormat != GRK_FMT_UNK)
+		return true;
+
+	for(uint16_t compno = 0; compno < numcomps; ++compno)
+	{
+		auto comp = comps + compno;
+		if(!comp->data || comp->data_type != GRK_INT_32)
+			continue;
+		auto stride = grk_make_aligned_width(comp->w);
+		auto destSampleSize = dataTypeSize(outputDataType);
+		auto dest = (uint8_t*)grk_aligned_malloc((size_t)stride * comp->h * destSampleSize);
+		if(!dest)
+		{
+			GRK_ERROR("Failed to allocate aligned memory buffer of dimensions %u x %u", stride,
+					  comp->h);
+			return false;
+		}
+		for(uint32_t j = 0; j < comp->h; ++j)
+			grk::convertDataType(dest + (size_t)j * stride * destSampleSize,
+								 comp->data + (size_t)j * comp->stride, comp->w, outputDataType);
+		single_component_data_free(comp);
+		comp->data = (int32_t*)dest;
+		comp->stride = stride;
+		comp->data_type = outputDataType;
+	}
+
+	return true;
+}
+
 /**
  Transfer data to dest for each component, and null out this data.
  Assumption:  this and dest have the same number of components
@@ -884,6 +978,8 @@ void GrkImage::transferDataTo(GrkImage* dest)
 
 		single_component_data_free(destComp);
 		destComp->data = srcComp->data;
+		destComp->data_type = srcComp->data_type;
+		srcComp->data_type = GRK_INT_32;
 		if(srcComp->stride)
 		{
 			destComp->stride = srcComp->stride;
@@ -941,6 +1037,7 @@ void GrkImage::transferDataFrom(const Tile* tile_src_data)
 		// transfer memory from tile component to output image
 		single_component_data_free(destComp);
 		srcComp->getWindow()->transfer(&destComp->data, &destComp->stride);
+		destComp->data_type = GRK_INT_32;
 		if(destComp->data)
 			assert(destComp->stride >= destComp->w);
 	}
@@ -983,6 +1080,8 @@ bool GrkImage::compositeInterleaved(const Tile* src, uint32_t yBegin, uint32_t y
 	switch(decompressFormat)
 	{
 		case GRK_FMT_TIF:
+		case GRK_FMT_PNG:
+		case GRK_FMT_JPG:
 			prec = destComp->prec;
 			break;
 		case GRK_FMT_PXM:
@@ -1029,11 +1128,6 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 	auto destComp = comps;
 	grk_rect32 destWin;
 
-	if(!generateCompositeBounds(srcComp, 0, &destWin))
-	{
-		GRK_WARN("GrkImage::compositeInterleaved: cannot generate composite bounds");
-		return false;
-	}
 	for(uint16_t i = 0; i < src->numcomps; ++i)
 	{
 		if(!(src->comps + i)->data)
@@ -1046,6 +1140,8 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 	switch(decompressFormat)
 	{
 		case GRK_FMT_TIF:
+		case GRK_FMT_PNG:
+		case GRK_FMT_JPG:
 			prec = destComp->prec;
 			break;
 		case GRK_FMT_PXM:
@@ -1055,6 +1151,13 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 			return false;
 			break;
 	}
+	if(upsample && isSubsampled())
+		return compositeUpsampledInterleaved(src, prec);
+	if(!generateCompositeBounds(srcComp, 0, &destWin))
+	{
+		GRK_WARN("GrkImage::compositeInterleaved: cannot generate composite bounds");
+		return false;
+	}
 	auto destStride =
 		grk::PlanarToInterleaved<int32_t>::getPackedBytes(src->numcomps, destComp->w, prec);
 	auto destx0 =
@@ -1074,6 +1177,50 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 	return true;
 }
 
+/**
+ * Upsample sub-sampled image data, one row at a time,
+ * and interleave into interleaved composite image
+ *
+ * @param src 	source image
+ * @param prec	packed precision
+ *
+ * @return:			true if successful
+ */
+bool GrkImage::compositeUpsampledInterleaved(const GrkImage* src, uint8_t prec)
+{
+	if(src->x0 < x0 || src->x1 > x1 || src->y0 < y0 || src->y1 > y1)
+	{
+		GRK_WARN("GrkImage::compositeInterleaved: cannot generate composite bounds");
+		return false;
+	}
+	uint32_t width = src->x1 - src->x0;
+	auto destStride =
+		grk::PlanarToInterleaved<int32_t>::getPackedBytes(src->numcomps, x1 - x0, prec);
+	auto destx0 =
+		grk::PlanarToInterleaved<int32_t>::getPackedBytes(src->numcomps, src->x0 - x0, prec);
+	auto iter = InterleaverFactory<int32_t>::makeInterleaver(prec == 16 ? packer16BitBE : prec);
+	if(!iter)
+		return false;
+	std::unique_ptr<int32_t[]> rows(new int32_t[(size_t)src->numcomps * width]);
+	int32_t* planes[grk::maxNumPackComponents];
+	for(uint32_t y = src->y0; y < src->y1; ++y)
+	{
+		// interleaver advances planes past the row
+		for(uint16_t i = 0; i < src->numcomps; ++i)
+		{
+			planes[i] = rows.get() + (size_t)i * width;
+			upsampleRow(src->comps + i, y, src->x0, width, GRK_UPSAMPLE_NEAREST, nullptr,
+						planes[i]);
+		}
+		iter->interleave(planes, src->numcomps,
+						 interleavedData.data_ + (uint64_t)(y - y0) * destStride + destx0, width,
+						 width, destStride, 1, 0);
+	}
+	delete iter;
+
+	return true;
+}
+
 /**
  * Copy planar image data to planar composite image
  *
@@ -1110,10 +1257,15 @@ bool GrkImage::compositePlanar(const GrkImage* src)
 		size_t destLineOffset = (size_t)destComp->stride - (size_t)destWin.width();
 		auto src_ptr = srcComp->data;
 		uint32_t srcLineOffset = srcComp->stride - srcComp->w;
+		auto destSampleSize = dataTypeSize(destComp->data_type);
 		for(uint32_t j = 0; j < destWin.height(); ++j)
 		{
-			memcpy(destComp->data + destIndex, src_ptr + srcIndex,
-				   destWin.width() * sizeof(int32_t));
+			if(destComp->data_type == GRK_INT_32)
+				memcpy(destComp->data + destIndex, src_ptr + srcIndex,
+					   destWin.width() * sizeof(int32_t));
+			else
+				grk::convertDataType((uint8_t*)destComp->data + destIndex * destSampleSize,
+									 src_ptr + srcIndex, destWin.width(), destComp->data_type);
 			destIndex += destLineOffset + destWin.width();
 			srcIndex += srcLineOffset + destWin.width();
 		}
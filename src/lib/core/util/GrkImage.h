@@ -11,6 +11,23 @@ struct TileComponent;
 
 const uint32_t singleTileRowsPerStrip = 32;
 
+/**
+ * Precision conversion of a component
+ */
+struct PrecisionConversion
+{
+	// precision of samples before conversion
+	uint8_t srcPrec;
+	// requested precision
+	uint8_t requestedPrec;
+	// requested precision is set by clipping
+	bool clip;
+	// requested precision is set by scaling
+	bool scale;
+	// precision supported by output file format
+	uint8_t formatPrec;
+};
+
 class GrkImageMeta : public grk_image_meta
 {
   public:
@@ -82,7 +99,11 @@ class GrkImage : public grk_image
     bool applyICC(void);
 	bool validateICC(void);
 	void convertPrecision(void);
+	bool getFusedPrecisionShift(CodingParams* cp, const GrkImage* headerImage,
+								std::vector<int8_t>& shift);
+	void setFusedPrecision(const GrkImage* headerImage);
 	bool execUpsample(void);
+	bool convertToOutputDataType(void);
 	void all_components_data_free(void);
 	void postReadHeader(CodingParams* cp);
 	void validateColourSpace(void);
@@ -98,6 +119,7 @@ class GrkImage : public grk_image
 	void print(void) const;
 	bool componentsEqual(bool checkPrecision);
 	bool componentsEqual(uint16_t firstNComponents, bool checkPrecision);
+	bool generateCompositeBounds(grk_rect32 src, uint16_t destCompno, grk_rect32* destWin);
 
   private:
 	~GrkImage();
@@ -106,18 +128,18 @@ class GrkImage : public grk_image
 	std::string getICCColourSpaceString(cmsColorSpaceSignature color_space);
 	bool isValidICCColourSpace(uint32_t signature);
 	bool needsConversionToRGB(void);
+	bool canCompositeToOutputDataType(void);
+	bool supportsUpsampledStrips(CodingParams* cp);
+	bool compositeUpsampledInterleaved(const GrkImage* src, uint8_t prec);
 	bool isOpacity(uint16_t compno);
 	bool compositePlanar(const GrkImage* srcImg);
 	bool generateCompositeBounds(const grk_image_comp* srcComp, uint16_t destCompno,
 								 grk_rect32* destWin);
-	bool generateCompositeBounds(grk_rect32 src, uint16_t destCompno, grk_rect32* destWin);
 	bool allComponentsSanityCheck(bool equalPrecision);
-	grk_image* createRGB(uint16_t numcmpts, uint32_t w, uint32_t h, uint8_t prec);
-	void sycc_to_rgb(int32_t offset, int32_t upb, int32_t y, int32_t cb, int32_t cr, int32_t* out_r,
-					 int32_t* out_g, int32_t* out_b);
 	bool sycc444_to_rgb(void);
 	bool sycc422_to_rgb(bool oddFirstX);
 	bool sycc420_to_rgb(bool oddFirstX, bool oddFirstY);
+	bool sycc_subsampled_to_rgb(bool oddFirstX, bool oddFirstY, bool subsampledY);
 	bool color_sycc_to_rgb(bool oddFirstX, bool oddFirstY);
 	bool color_cmyk_to_rgb(void);
 	bool color_esycc_to_rgb(void);
@@ -125,6 +147,7 @@ class GrkImage : public grk_image
 	bool componentsEqual(grk_image_comp* src, grk_image_comp* dest, bool checkPrecision);
 	static void copyComponent(grk_image_comp* src, grk_image_comp* dest);
 	void scaleComponent(grk_image_comp* component, uint8_t precision);
+	void planPrecision(const grk_image_comp* srcComps, std::vector<PrecisionConversion>& plan);
 };
 
 } // namespace grk
@@ -86,21 +86,20 @@ bool GrkImage::execUpsample(void)
 	if(!comps)
 		return false;
 
-	grk_image_comp* new_components = nullptr;
 	bool upsampleNeeded = false;
 
 	for(uint16_t compno = 0U; compno < numcomps; ++compno)
 	{
+		// upsampled samples have already been streamed to strip cache
+		if(!comps[compno].data)
+			return true;
 		if((comps[compno].dx > 1U) || (comps[compno].dy > 1U))
-		{
 			upsampleNeeded = true;
-			break;
-		}
 	}
 	if(!upsampleNeeded)
 		return true;
 
-	new_components = new grk_image_comp[numcomps];
+	auto new_components = new grk_image_comp[numcomps];
 	memset(new_components, 0, numcomps * sizeof(grk_image_comp));
 	for(uint16_t compno = 0U; compno < numcomps; ++compno)
 	{
@@ -112,6 +111,8 @@ bool GrkImage::execUpsample(void)
 		new_cmp->h = y1 - y0;
 		if(!allocData(new_cmp))
 		{
+			for(uint16_t i = 0; i < compno; ++i)
+				single_component_data_free(new_components + i);
 			delete[] new_components;
 			return false;
 		}
@@ -122,80 +123,18 @@ bool GrkImage::execUpsample(void)
 		auto org_cmp = comps + compno;
 		if((org_cmp->dx > 1U) || (org_cmp->dy > 1U))
 		{
-			auto src = org_cmp->data;
-			auto dst = new_cmp->data;
-
 			/* need to take into account dx & dy */
 			uint32_t xoff = org_cmp->dx * org_cmp->x0 - x0;
 			uint32_t yoff = org_cmp->dy * org_cmp->y0 - y0;
 			if((xoff >= org_cmp->dx) || (yoff >= org_cmp->dy))
 			{
 				GRK_ERROR("upsample: Invalid image/component parameters found when upsampling");
+				for(uint16_t i = 0; i < numcomps; ++i)
+					single_component_data_free(new_components + i);
 				delete[] new_components;
 				return false;
 			}
-
-			uint32_t y;
-			for(y = 0U; y < yoff; ++y)
-			{
-				memset(dst, 0U, new_cmp->w * sizeof(int32_t));
-				dst += new_cmp->stride;
-			}
-
-			if(new_cmp->h > (org_cmp->dy - 1U))
-			{ /* check subtraction overflow for really small images */
-				for(; y < new_cmp->h - (org_cmp->dy - 1U); y += org_cmp->dy)
-				{
-					uint32_t x, dy;
-					uint32_t xorg = 0;
-					for(x = 0U; x < xoff; ++x)
-						dst[x] = 0;
-
-					if(new_cmp->w > (org_cmp->dx - 1U))
-					{ /* check subtraction overflow for really small images */
-						for(; x < new_cmp->w - (org_cmp->dx - 1U); x += org_cmp->dx, ++xorg)
-						{
-							for(uint32_t dx = 0U; dx < org_cmp->dx; ++dx)
-								dst[x + dx] = src[xorg];
-						}
-					}
-					for(; x < new_cmp->w; ++x)
-						dst[x] = src[xorg];
-					dst += new_cmp->stride;
-
-					for(dy = 1U; dy < org_cmp->dy; ++dy)
-					{
-						memcpy(dst, dst - new_cmp->stride, new_cmp->w * sizeof(int32_t));
-						dst += new_cmp->stride;
-					}
-					src += org_cmp->stride;
-				}
-			}
-			if(y < new_cmp->h)
-			{
-				uint32_t x;
-				uint32_t xorg = 0;
-				for(x = 0U; x < xoff; ++x)
-					dst[x] = 0;
-
-				if(new_cmp->w > (org_cmp->dx - 1U))
-				{ /* check subtraction overflow for really small images */
-					for(; x < new_cmp->w - (org_cmp->dx - 1U); x += org_cmp->dx, ++xorg)
-					{
-						for(uint32_t dx = 0U; dx < org_cmp->dx; ++dx)
-							dst[x + dx] = src[xorg];
-					}
-				}
-				for(; x < new_cmp->w; ++x)
-					dst[x] = src[xorg];
-				dst += new_cmp->stride;
-				++y;
-				for(; y < new_cmp->h; ++y)
-				{
-					memcpy(dst, dst - new_cmp->stride, new_cmp->w * sizeof(int32_t));
-					dst += new_cmp->stride;
-				}
-			}
+			upsampleComponent(org_cmp, new_cmp, x0, y0, upsampleFilter);
 		}
 		else
 		{
@@ -261,43 +200,53 @@ void GrkImage::scaleComponent(grk_image_comp* component, uint8_t precision)
 	component->prec = precision;
 }
 
-void GrkImage::convertPrecision(void)
+/**
+ * Plan precision conversion of components: requested precision (clip or scale),
+ * followed by scaling to a precision supported by the output file format
+ *
+ * @param srcComps components with precision of samples before conversion
+ * @param plan conversion for each component
+ */
+void GrkImage::planPrecision(const grk_image_comp* srcComps, std::vector<PrecisionConversion>& plan)
 {
-	if(precision)
+	plan.resize(numcomps);
+	for(uint16_t compno = 0; compno < numcomps; ++compno)
 	{
-		for(uint16_t compno = 0; compno < numcomps; ++compno)
+		auto& conv = plan[compno];
+		conv.srcPrec = srcComps[compno].prec;
+		conv.requestedPrec = conv.srcPrec;
+		conv.clip = false;
+		conv.scale = false;
+		if(precision)
 		{
 			uint32_t precisionno = compno;
 			if(precisionno >= numPrecision)
 				precisionno = numPrecision - 1U;
 			uint8_t prec = precision[precisionno].prec;
-			auto comp = comps + compno;
 			if(prec == 0)
-				prec = comp->prec;
+				prec = conv.srcPrec;
 			switch(precision[precisionno].mode)
 			{
-				case GRK_PREC_MODE_CLIP: {
-					if(comp->sgnd)
-						clip<int32_t>(comp, prec);
-					else
-						clip<uint32_t>(comp, prec);
-				}
-				break;
+				case GRK_PREC_MODE_CLIP:
+					conv.clip = true;
+					conv.requestedPrec = prec;
+					break;
 				case GRK_PREC_MODE_SCALE:
-					scaleComponent(comp, prec);
+					conv.scale = true;
+					conv.requestedPrec = prec;
 					break;
 				default:
 					break;
 			}
 		}
+		conv.formatPrec = conv.requestedPrec;
 	}
+	uint16_t numFormatComps = numcomps;
+	uint8_t prec = plan[0].requestedPrec;
 	if(decompressFormat == GRK_FMT_JPG)
 	{
-		uint8_t prec = comps[0].prec;
 		if(prec < 8 && numcomps > 1)
 		{ /* GRAY_ALPHA, RGB, RGB_ALPHA */
-			for(uint16_t i = 0; i < numcomps; ++i)
-				scaleComponent(comps + i, 8);
 			prec = 8;
 		}
 		else if((prec > 1) && (prec < 8) && ((prec == 6) || ((prec & 1) == 1)))
@@ -306,26 +255,21 @@ void GrkImage::convertPrecision(void)
 				prec = 8;
 			else
 				prec++;
-			for(uint16_t i = 0; i < numcomps; ++i)
-				scaleComponent(comps + i, prec);
+		}
+		else
+		{
+			return;
 		}
 	}
 	else if(decompressFormat == GRK_FMT_PNG)
 	{
-		uint16_t nr_comp = numcomps;
-		if(nr_comp > 4)
-		{
-			GRK_WARN("PNG: number of components %d is "
-					 "greater than 4. Truncating to 4",
-					 nr_comp);
-			nr_comp = 4;
-		}
-		uint8_t prec = comps[0].prec;
+		if(numFormatComps > 4)
+			numFormatComps = 4;
 		if(prec > 8 && prec < 16)
 		{
 			prec = 16;
 		}
-		else if(prec < 8 && nr_comp > 1)
+		else if(prec < 8 && numFormatComps > 1)
 		{ /* GRAY_ALPHA, RGB, RGB_ALPHA */
 			prec = 8;
 		}
@@ -336,8 +280,97 @@ void GrkImage::convertPrecision(void)
 			else
 				prec++;
 		}
-		for(uint16_t i = 0; i < nr_comp; ++i)
-			scaleComponent(comps + i, prec);
+	}
+	else
+	{
+		return;
+	}
+	for(uint16_t compno = 0; compno < numFormatComps; ++compno)
+		plan[compno].formatPrec = prec;
+}
+
+/**
+ * Calculate shift of decompressed samples that is equivalent to convertPrecision,
+ * so that precision conversion can be fused with the final stage of tile decompression
+ * (inverse MCT or DC shift), rather than making another pass over the composite image.
+ *
+ * Scaling up is a left shift, and scaling down is a right shift rounding towards zero.
+ * Scaling down followed by scaling up cannot be fused into a single shift.
+ *
+ * @param cp coding parameters
+ * @param headerImage header image, with precision of decompressed samples
+ * @param shift left shift, or right shift if negative, for each component
+ *
+ * @return true if precision conversion can be fused
+ */
+bool GrkImage::getFusedPrecisionShift(CodingParams* cp, const GrkImage* headerImage,
+									  std::vector<int8_t>& shift)
+{
+	shift.clear();
+	// colour post processing, which precedes precision conversion,
+	// must not read samples
+	if(numcomps != headerImage->numcomps || cp->coding_params_.dec_.cacheTileImages_ ||
+	   forceRGB || needsConversionToRGB() || supportsStripCache(cp))
+		return false;
+	if(meta && (meta->color.palette || meta->color.icc_profile_buf ||
+				meta->color.channel_definition))
+		return false;
+	std::vector<PrecisionConversion> plan;
+	planPrecision(headerImage->comps, plan);
+	bool fused = false;
+	for(auto& conv : plan)
+	{
+		int32_t requestedShift = conv.scale ? conv.requestedPrec - conv.srcPrec : 0;
+		int32_t formatShift = conv.formatPrec - conv.requestedPrec;
+		if(requestedShift < 0 && formatShift > 0)
+			return false;
+		shift.push_back((int8_t)(requestedShift + formatShift));
+		fused |= shift.back() != 0;
+	}
+	if(!fused)
+		shift.clear();
+
+	return fused;
+}
+
+/**
+ * Set component precisions after precision conversion was fused with
+ * the final stage of tile decompression
+ *
+ * @param headerImage header image, with precision of decompressed samples
+ */
+void GrkImage::setFusedPrecision(const GrkImage* headerImage)
+{
+	std::vector<PrecisionConversion> plan;
+	planPrecision(headerImage->comps, plan);
+	for(uint16_t compno = 0; compno < numcomps; ++compno)
+		comps[compno].prec = plan[compno].formatPrec;
+}
+
+void GrkImage::convertPrecision(void)
+{
+	if(decompressFormat == GRK_FMT_PNG && numcomps > 4)
+		GRK_WARN("PNG: number of components %d is "
+				 "greater than 4. Truncating to 4",
+				 numcomps);
+	std::vector<PrecisionConversion> plan;
+	planPrecision(comps, plan);
+	for(uint16_t compno = 0; compno < numcomps; ++compno)
+	{
+		auto& conv = plan[compno];
+		auto comp = comps + compno;
+		if(conv.clip)
+		{
+			if(comp->sgnd)
+				clip<int32_t>(comp, conv.requestedPrec);
+			else
+				clip<uint32_t>(comp, conv.requestedPrec);
+		}
+		else if(conv.scale)
+		{
+			scaleComponent(comp, conv.requestedPrec);
+		}
+		scaleComponent(comp, conv.formatPrec);
 	}
 }
 
@@ -445,135 +478,37 @@ bool GrkImage::convertToRGB(bool wholeTileDecompress)
 	return true;
 }
 
-grk_image* GrkImage::createRGB(uint16_t numcmpts, uint32_t w, uint32_t h, uint8_t prec)
-{
-	if(!numcmpts)
-	{
-		GRK_WARN("createRGB: number of components cannot be zero.");
-		return nullptr;
-	}
-
-	auto cmptparms = new grk_image_comp[numcmpts];
-	uint16_t compno = 0U;
-	for(compno = 0U; compno < numcmpts; ++compno)
-	{
-		memset(cmptparms + compno, 0, sizeof(grk_image_comp));
-		cmptparms[compno].dx = 1;
-		cmptparms[compno].dy = 1;
-		cmptparms[compno].w = w;
-		cmptparms[compno].h = h;
-		cmptparms[compno].x0 = 0U;
-		cmptparms[compno].y0 = 0U;
-		cmptparms[compno].prec = prec;
-		cmptparms[compno].sgnd = 0U;
-	}
-	auto img = GrkImage::create(this, numcmpts, (grk_image_comp*)cmptparms, GRK_CLRSPC_SRGB, true);
-	delete[] cmptparms;
-
-	return img;
-}
-
-/*--------------------------------------------------------
- Matrix for sYCC, Amendment 1 to IEC 61966-2-1
-
- Y  |  0.299   0.587    0.114  |    R
- Cb | -0.1687 -0.3312   0.5    | x  G
- Cr |  0.5    -0.4187  -0.0812 |    B
-
- Inverse:
-
- R   |1        -3.68213e-05    1.40199     |    Y
- G = |1.00003  -0.344125      -0.714128    | x  Cb - 2^(prec - 1)
- B   |0.999823  1.77204       -8.04142e-06 |    Cr - 2^(prec - 1)
-
- -----------------------------------------------------------*/
-void GrkImage::sycc_to_rgb(int32_t offset, int32_t upb, int32_t y, int32_t cb, int32_t cr,
-						   int32_t* out_r, int32_t* out_g, int32_t* out_b)
-{
-	int32_t r, g, b;
-
-	cb -= offset;
-	cr -= offset;
-	r = y + (int32_t)(1.402 * cr);
-	if(r < 0)
-		r = 0;
-	else if(r > upb)
-		r = upb;
-	*out_r = r;
-
-	g = y - (int32_t)(0.344 * cb + 0.714 * cr);
-	if(g < 0)
-		g = 0;
-	else if(g > upb)
-		g = upb;
-	*out_g = g;
-
-	b = y + (int32_t)(1.772 * cb);
-	if(b < 0)
-		b = 0;
-	else if(b > upb)
-		b = upb;
-	*out_b = b;
-}
-
 bool GrkImage::sycc444_to_rgb(void)
 {
-	int32_t *d0, *d1, *d2, *r, *g, *b;
-	auto dst = createRGB(3, comps[0].w, comps[0].h, comps[0].prec);
-	if(!dst)
-		return false;
-
 	int32_t offset = 1 << (comps[0].prec - 1);
 	int32_t upb = (1 << comps[0].prec) - 1;
-
 	uint32_t w = comps[0].w;
-	uint32_t src_stride_diff = comps[0].stride - w;
-	uint32_t dst_stride_diff = dst->comps[0].stride - dst->comps[0].w;
-	uint32_t h = comps[0].h;
 
-	auto y = comps[0].data;
-	auto cb = comps[1].data;
-	auto cr = comps[2].data;
-
-	d0 = r = dst->comps[0].data;
-	d1 = g = dst->comps[1].data;
-	d2 = b = dst->comps[2].data;
-
-	dst->comps[0].data = nullptr;
-	dst->comps[1].data = nullptr;
-	dst->comps[2].data = nullptr;
-
-	for(uint32_t j = 0; j < h; ++j)
+	if(!comps[0].data || !comps[1].data || !comps[2].data)
 	{
-		for(uint32_t i = 0; i < w; ++i)
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-		y += src_stride_diff;
-		cb += src_stride_diff;
-		cr += src_stride_diff;
-		r += dst_stride_diff;
-		g += dst_stride_diff;
-		b += dst_stride_diff;
+		GRK_WARN("sycc444_to_rgb: null channel");
+		return false;
 	}
-
-	all_components_data_free();
-	comps[0].data = d0;
-	comps[1].data = d1;
-	comps[2].data = d2;
+	// convert in place
+	convertStrips(comps[0].h, singleTileRowsPerStrip, [this, w, offset, upb](uint32_t yBegin,
+																			  uint32_t yEnd) {
+		for(uint32_t j = yBegin; j < yEnd; ++j)
+		{
+			auto y = comps[0].data + (size_t)j * comps[0].stride;
+			auto cb = comps[1].data + (size_t)j * comps[1].stride;
+			auto cr = comps[2].data + (size_t)j * comps[2].stride;
+			syccToRgbRow(y, cb, cr, y, cb, cr, w, offset, upb);
+		}
+	});
 	color_space = GRK_CLRSPC_SRGB;
 
-	for(uint32_t i = 0; i < numcomps; ++i)
-		comps[i].stride = dst->comps[i].stride;
-	grk_object_unref(&dst->obj);
-
 	return true;
 } /* sycc444_to_rgb() */
 
 bool GrkImage::sycc422_to_rgb(bool oddFirstX)
 {
 	/* if img->x0 is odd, then first column shall use Cb/Cr = 0 */
-	uint32_t w = comps[0].w;
-	uint32_t h = comps[0].h;
-	uint32_t loopWidth = w;
+	uint32_t loopWidth = comps[0].w;
 	if(oddFirstX)
 		loopWidth--;
 	// sanity check
@@ -583,92 +518,16 @@ bool GrkImage::sycc422_to_rgb(bool oddFirstX)
 		return false;
 	}
 
-	auto dst = createRGB(3, w, h, comps[0].prec);
-	if(!dst)
-		return false;
-
-	int32_t offset = 1 << (comps[0].prec - 1);
-	int32_t upb = (1 << comps[0].prec) - 1;
-
-	uint32_t dst_stride_diff = dst->comps[0].stride - dst->comps[0].w;
-	uint32_t src_stride_diff = comps[0].stride - w;
-	uint32_t src_stride_diff_chroma = comps[1].stride - comps[1].w;
-
-	int32_t *d0, *d1, *d2, *r, *g, *b;
-
-	auto y = comps[0].data;
-	if(!y)
-	{
-		GRK_WARN("sycc422_to_rgb: null luma channel");
-		return false;
-	}
-	auto cb = comps[1].data;
-	auto cr = comps[2].data;
-	if(!cb || !cr)
-	{
-		GRK_WARN("sycc422_to_rgb: null chroma channel");
-		return false;
-	}
-
-	d0 = r = dst->comps[0].data;
-	d1 = g = dst->comps[1].data;
-	d2 = b = dst->comps[2].data;
-
-	dst->comps[0].data = nullptr;
-	dst->comps[1].data = nullptr;
-	dst->comps[2].data = nullptr;
-
-	for(uint32_t i = 0U; i < h; ++i)
-	{
-		if(oddFirstX)
-			sycc_to_rgb(offset, upb, *y++, 0, 0, r++, g++, b++);
-
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
-		{
-			sycc_to_rgb(offset, upb, *y++, *cb, *cr, r++, g++, b++);
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-		}
-		if(j < loopWidth)
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-
-		y += src_stride_diff;
-		cb += src_stride_diff_chroma;
-		cr += src_stride_diff_chroma;
-		r += dst_stride_diff;
-		g += dst_stride_diff;
-		b += dst_stride_diff;
-	}
-	all_components_data_free();
-
-	comps[0].data = d0;
-	comps[1].data = d1;
-	comps[2].data = d2;
-
-	comps[1].w = comps[2].w = w;
-	comps[1].h = comps[2].h = h;
-	comps[1].dx = comps[2].dx = comps[0].dx;
-	comps[1].dy = comps[2].dy = comps[0].dy;
-	color_space = GRK_CLRSPC_SRGB;
-
-	for(uint32_t i = 0; i < numcomps; ++i)
-		comps[i].stride = dst->comps[i].stride;
-	grk_object_unref(&dst->obj);
-
-	return true;
-
+	return sycc_subsampled_to_rgb(oddFirstX, false, false);
 } /* sycc422_to_rgb() */
 
 bool GrkImage::sycc420_to_rgb(bool oddFirstX, bool oddFirstY)
 {
-	uint32_t w = comps[0].w;
-	uint32_t h = comps[0].h;
-	uint32_t loopWidth = w;
+	uint32_t loopWidth = comps[0].w;
 	// if img->x0 is odd, then first column shall use Cb/Cr = 0
-	// this is handled in the loop below
 	if(oddFirstX)
 		loopWidth--;
-	uint32_t loopHeight = h;
+	uint32_t loopHeight = comps[0].h;
 	// if img->y0 is odd, then first line shall use Cb/Cr = 0
 	if(oddFirstY)
 		loopHeight--;
@@ -685,118 +544,118 @@ bool GrkImage::sycc420_to_rgb(bool oddFirstX, bool oddFirstY)
 		return false;
 	}
 
-	auto dst = createRGB(3, w, h, comps[0].prec);
-	if(!dst)
-		return false;
-
-	int32_t offset = 1 << (comps[0].prec - 1);
-	int32_t upb = (1 << comps[0].prec) - 1;
-
-	int32_t* src[3];
-	int32_t* dest[3];
-	int32_t* dest_ptr[3];
-	uint32_t stride_src[3];
-	uint32_t stride_src_diff[3];
-
-	uint32_t stride_dest = dst->comps[0].stride;
-	uint32_t stride_dest_diff = dst->comps[0].stride - w;
+	return sycc_subsampled_to_rgb(oddFirstX, oddFirstY, true);
+} /* sycc420_to_rgb() */
 
-	for(uint32_t i = 0; i < 3; ++i)
+/**
+ * Convert sYCC with horizontally (and optionally vertically) sub-sampled chroma.
+ *
+ * Chroma terms are calculated once per chroma row, and are then upsampled
+ * while being added to luma. Red is written in place of luma.
+ *
+ * If image x0 is odd, the first column uses Cb/Cr = 0, except for the second
+ * luma row of a vertically sub-sampled row pair, which uses the first chroma sample.
+ * If image y0 is odd, the first row uses Cb/Cr = 0.
+ */
+bool GrkImage::sycc_subsampled_to_rgb(bool oddFirstX, bool oddFirstY, bool subsampledY)
+{
+	if(!comps[0].data)
 	{
-		auto srcComp = comps + i;
-		src[i] = srcComp->data;
-		stride_src[i] = srcComp->stride;
-		stride_src_diff[i] = srcComp->stride - srcComp->w;
-
-		dest[i] = dest_ptr[i] = dst->comps[i].data;
-		dst->comps[i].data = nullptr;
+		GRK_WARN("sycc_to_rgb: null luma channel");
+		return false;
 	}
-	// if img->y0 is odd, then first line shall use Cb/Cr = 0
-	if(oddFirstY)
+	if(!comps[1].data || !comps[2].data)
 	{
-		for(size_t j = 0U; j < w; ++j)
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-		src[0] += stride_src_diff[0];
-		for(uint32_t i = 0; i < 3; ++i)
-			dest_ptr[i] += stride_dest_diff;
+		GRK_WARN("sycc_to_rgb: null chroma channel");
+		return false;
 	}
+	uint32_t w = comps[0].w;
+	uint32_t h = comps[0].h;
+	uint32_t chromaWidth = comps[1].w;
+	int32_t offset = 1 << (comps[0].prec - 1);
+	int32_t upb = (1 << comps[0].prec) - 1;
 
-	size_t i;
-	for(i = 0U; i < (loopHeight & ~(size_t)1U); i += 2U)
+	// full resolution green and blue
+	grk_image_comp green = comps[0];
+	grk_image_comp blue = comps[0];
+	green.data = nullptr;
+	blue.data = nullptr;
+	if(!allocData(&green))
+		return false;
+	if(!allocData(&blue))
 	{
-		auto nextY = src[0] + stride_src[0];
-		auto nextRed = dest_ptr[0] + stride_dest;
-		auto nextGreen = dest_ptr[1] + stride_dest;
-		auto nextBlue = dest_ptr[2] + stride_dest;
-		// if img->x0 is odd, then first column shall use Cb/Cr = 0
-		if(oddFirstX)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1], *src[2], nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1], *src[2], nextRed++, nextGreen++,
-						nextBlue++);
-
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1]++, *src[2]++, nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		if(j < loopWidth)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1]++, *src[2]++, nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		for(uint32_t k = 0; k < 3; ++k)
-		{
-			dest_ptr[k] += stride_dest_diff + stride_dest;
-			src[k] += stride_src_diff[k];
-		}
-		src[0] += stride_src[0];
+		single_component_data_free(&green);
+		return false;
 	}
-	// final odd row has no sub-sampling
-	if(i < loopHeight)
-	{
-		// if img->x0 is odd, then first column shall use Cb/Cr = 0
-		if(oddFirstX)
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
+
+	// chroma terms for Cb/Cr = 0
+	int32_t zero = 0;
+	int32_t zeroTerms[3];
+	syccChromaRow(&zero, &zero, zeroTerms, zeroTerms + 1, zeroTerms + 2, 1, offset);
+
+	uint32_t oddX = oddFirstX ? 1 : 0;
+	uint32_t firstChromaRow = (subsampledY && oddFirstY) ? 1 : 0;
+	convertStrips(h, singleTileRowsPerStrip, [&](uint32_t yBegin, uint32_t yEnd) {
+		uint32_t termsWidth = (w + 1) / 2;
+		std::unique_ptr<int32_t[]> terms(new int32_t[3 * (size_t)termsWidth]);
+		auto dr = terms.get();
+		auto dg = dr + termsWidth;
+		auto db = dg + termsWidth;
+		int64_t cachedChromaRow = -1;
+		for(uint32_t j = yBegin; j < yEnd; ++j)
 		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1]++, *src[2]++, dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
+			auto y = comps[0].data + (size_t)j * comps[0].stride;
+			auto g = green.data + (size_t)j * green.stride;
+			auto b = blue.data + (size_t)j * blue.stride;
+			if(j < firstChromaRow)
+			{
+				// no chroma for first row
+				std::fill(dr, dr + termsWidth, zeroTerms[0]);
+				std::fill(dg, dg + termsWidth, zeroTerms[1]);
+				std::fill(db, db + termsWidth, zeroTerms[2]);
+				cachedChromaRow = -1;
+				syccAddChromaRow(y, dr, dg, db, y, g, b, w, upb);
+				continue;
+			}
+			uint32_t chromaRow = j - firstChromaRow;
+			bool secondOfPair = false;
+			if(subsampledY)
+			{
+				secondOfPair = chromaRow & 1;
+				chromaRow >>= 1;
+			}
+			if(cachedChromaRow != chromaRow)
+			{
+				syccChromaRow(comps[1].data + (size_t)chromaRow * comps[1].stride,
+							  comps[2].data + (size_t)chromaRow * comps[2].stride, dr, dg, db,
+							  chromaWidth, offset);
+				cachedChromaRow = chromaRow;
+			}
+			if(oddX)
+			{
+				bool useChroma = secondOfPair && chromaWidth;
+				syccAddChromaRow(y, useChroma ? dr : zeroTerms, useChroma ? dg : zeroTerms + 1,
+								 useChroma ? db : zeroTerms + 2, y, g, b, 1, upb);
+			}
+			syccAddChromaRow(y + oddX, dr, dg, db, y + oddX, g + oddX, b + oddX, w - oddX, upb);
 		}
-		if(j < loopWidth)
-			sycc_to_rgb(offset, upb, *src[0], *src[1], *src[2], dest_ptr[0], dest_ptr[1],
-						dest_ptr[2]);
-	}
+	});
 
-	all_components_data_free();
-	for(uint32_t k = 0; k < 3; ++k)
-	{
-		comps[k].data = dest[k];
-		comps[k].stride = dst->comps[k].stride;
-	}
-	comps[1].w = comps[2].w = comps[0].w;
-	comps[1].h = comps[2].h = comps[0].h;
+	single_component_data_free(comps + 1);
+	single_component_data_free(comps + 2);
+	comps[1].data = green.data;
+	comps[1].stride = green.stride;
+	comps[2].data = blue.data;
+	comps[2].stride = blue.stride;
+
+	comps[1].w = comps[2].w = w;
+	comps[1].h = comps[2].h = h;
 	comps[1].dx = comps[2].dx = comps[0].dx;
 	comps[1].dy = comps[2].dy = comps[0].dy;
 	color_space = GRK_CLRSPC_SRGB;
-	grk_object_unref(&dst->obj);
 
 	return true;
-
-} /* sycc420_to_rgb() */
+}
 
 bool GrkImage::color_sycc_to_rgb(bool oddFirstX, bool oddFirstY)
 {
@@ -847,37 +706,18 @@ bool GrkImage::color_cmyk_to_rgb(void)
 	if((numcomps < 4) || !allComponentsSanityCheck(true))
 		return false;
 
-	float sC = 1.0F / (float)((1 << comps[0].prec) - 1);
-	float sM = 1.0F / (float)((1 << comps[1].prec) - 1);
-	float sY = 1.0F / (float)((1 << comps[2].prec) - 1);
-	float sK = 1.0F / (float)((1 << comps[3].prec) - 1);
+	float scale[4];
+	for(uint32_t i = 0; i < 4; ++i)
+		scale[i] = 1.0F / (float)((1 << comps[i].prec) - 1);
 
-	uint32_t stride_diff = comps[0].stride - w;
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < h; ++j)
-	{
-		for(uint32_t i = 0; i < w; ++i)
+	convertStrips(h, singleTileRowsPerStrip, [this, w, &scale](uint32_t yBegin, uint32_t yEnd) {
+		for(uint32_t j = yBegin; j < yEnd; ++j)
 		{
-			/* CMYK values from 0 to 1 */
-			float C = (float)(comps[0].data[dest_index]) * sC;
-			float M = (float)(comps[1].data[dest_index]) * sM;
-			float Y = (float)(comps[2].data[dest_index]) * sY;
-			float K = (float)(comps[3].data[dest_index]) * sK;
-
-			/* Invert all CMYK values */
-			C = 1.0F - C;
-			M = 1.0F - M;
-			Y = 1.0F - Y;
-			K = 1.0F - K;
-
-			/* CMYK -> RGB : RGB results from 0 to 255 */
-			comps[0].data[dest_index] = (int32_t)(255.0F * C * K); /* R */
-			comps[1].data[dest_index] = (int32_t)(255.0F * M * K); /* G */
-			comps[2].data[dest_index] = (int32_t)(255.0F * Y * K); /* B */
-			dest_index++;
+			size_t index = (size_t)j * comps[0].stride;
+			cmykToRgbRow(comps[0].data + index, comps[1].data + index, comps[2].data + index,
+						 comps[3].data + index, w, scale);
 		}
-		dest_index += stride_diff;
-	}
+	});
 
 	single_component_data_free(comps + 3);
 	comps[0].prec = 8;
@@ -908,48 +748,16 @@ bool GrkImage::color_esycc_to_rgb(void)
 	bool sign1 = comps[1].sgnd;
 	bool sign2 = comps[2].sgnd;
 
-	uint32_t stride_diff = comps[0].stride - w;
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < h; ++j)
-	{
-		for(uint32_t i = 0; i < w; ++i)
-		{
-			int32_t y = comps[0].data[dest_index];
-			int32_t cb = comps[1].data[dest_index];
-			int32_t cr = comps[2].data[dest_index];
-
-			if(!sign1)
-				cb -= flip_value;
-			if(!sign2)
-				cr -= flip_value;
-
-			int32_t val = (int32_t)(y - 0.0000368 * cb + 1.40199 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[0].data[dest_index] = val;
-
-			val = (int32_t)(1.0003 * y - 0.344125 * cb - 0.7141128 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[1].data[dest_index] = val;
-
-			val = (int32_t)(0.999823 * y + 1.77204 * cb - 0.000008 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[2].data[dest_index] = val;
-			dest_index++;
-		}
-		dest_index += stride_diff;
-	}
+	convertStrips(h, singleTileRowsPerStrip,
+				  [this, w, sign1, sign2, flip_value, max_value](uint32_t yBegin, uint32_t yEnd) {
+					  for(uint32_t j = yBegin; j < yEnd; ++j)
+					  {
+						  size_t index = (size_t)j * comps[0].stride;
+						  esyccToRgbRow(comps[0].data + index, comps[1].data + index,
+										comps[2].data + index, w, sign1, sign2, flip_value,
+										max_value);
+					  }
+				  });
 	color_space = GRK_CLRSPC_SRGB;
 
 	return true;
@@ -1201,17 +1009,59 @@ bool GrkImage::applyColourManagement(void)
 	return true;
 }
 
+/**
+ * Apply colour transform to interleaved pixels of RGB planes, in parallel strips
+ */
+template<typename T>
+static void transformRGB(cmsHTRANSFORM transform, int32_t* r, int32_t* g, int32_t* b, uint32_t w,
+						 uint32_t h, uint32_t stride)
+{
+	convertStrips(h, singleTileRowsPerStrip, [=](uint32_t yBegin, uint32_t yEnd) {
+		size_t numPixels = (size_t)w * (yEnd - yBegin);
+		auto inbuf = new T[numPixels * 3U];
+		auto outbuf = new T[numPixels * 3U];
+
+		size_t dest_index = 0;
+		for(uint32_t j = yBegin; j < yEnd; ++j)
+		{
+			size_t src_index = (size_t)j * stride;
+			for(uint32_t i = 0; i < w; ++i)
+			{
+				inbuf[dest_index++] = (T)r[src_index];
+				inbuf[dest_index++] = (T)g[src_index];
+				inbuf[dest_index++] = (T)b[src_index];
+				src_index++;
+			}
+		}
+
+		cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)numPixels);
+
+		size_t src_index = 0;
+		for(uint32_t j = yBegin; j < yEnd; ++j)
+		{
+			dest_index = (size_t)j * stride;
+			for(uint32_t i = 0; i < w; ++i)
+			{
+				r[dest_index] = (int32_t)outbuf[src_index++];
+				g[dest_index] = (int32_t)outbuf[src_index++];
+				b[dest_index] = (int32_t)outbuf[src_index++];
+				dest_index++;
+			}
+		}
+		delete[] inbuf;
+		delete[] outbuf;
+	});
+}
+
 /*#define DEBUG_PROFILE*/
 bool GrkImage::applyICC(void)
 {
 	cmsUInt32Number out_space;
 	cmsUInt32Number intent = 0;
-	cmsHTRANSFORM transform = nullptr;
+	std::shared_ptr<void> transform;
 	cmsHPROFILE in_prof = nullptr;
-	cmsHPROFILE out_prof = nullptr;
 	cmsUInt32Number in_type, out_type;
-	size_t nr_samples, componentSize;
-	uint32_t prec, w, stride_diff, h;
+	uint32_t prec, w, stride, h;
 	GRK_COLOR_SPACE oldspace;
 	bool rc = false;
 
@@ -1228,11 +1078,10 @@ bool GrkImage::applyICC(void)
 	intent = cmsGetHeaderRenderingIntent(in_prof);
 
 	w = comps[0].w;
-	stride_diff = comps[0].stride - w;
+	stride = comps[0].stride;
 	h = comps[0].h;
 	if(!w || !h)
 		goto cleanup;
-	componentSize = (size_t)w * h;
 
 	prec = comps[0].prec;
 	oldspace = color_space;
@@ -1267,14 +1116,12 @@ bool GrkImage::applyICC(void)
 			in_type = TYPE_RGB_16;
 			out_type = TYPE_RGB_16;
 		}
-		out_prof = cmsCreate_sRGBProfile();
 		color_space = GRK_CLRSPC_SRGB;
 	}
 	else if(out_space == cmsSigGrayData)
 	{ /* enumCS 17 */
 		in_type = TYPE_GRAY_8;
 		out_type = TYPE_RGB_8;
-		out_prof = cmsCreate_sRGBProfile();
 		if(forceRGB)
 			color_space = GRK_CLRSPC_SRGB;
 		else
@@ -1284,7 +1131,6 @@ bool GrkImage::applyICC(void)
 	{ /* enumCS 18 */
 		in_type = TYPE_YCbCr_16;
 		out_type = TYPE_RGB_16;
-		out_prof = cmsCreate_sRGBProfile();
 		color_space = GRK_CLRSPC_SRGB;
 	}
 	else
@@ -1294,7 +1140,18 @@ bool GrkImage::applyICC(void)
 				 out_space);
 		goto cleanup;
 	}
-	transform = cmsCreateTransform(in_prof, in_type, out_prof, out_type, intent, 0);
+	// transform to sRGB is shared by all strips, and by later images with the same profile
+	transform = ColourTransformCache::get()->getTransform(
+		meta->color.icc_profile_buf, meta->color.icc_profile_len, in_type, out_type, intent,
+		[in_prof, in_type, out_type, intent]() -> void* {
+			auto out_prof = cmsCreate_sRGBProfile();
+			if(!out_prof)
+				return nullptr;
+			auto t = cmsCreateTransform(in_prof, in_type, out_prof, out_type, intent,
+										cmsFLAGS_NOCACHE);
+			cmsCloseProfile(out_prof);
+			return t;
+		});
 	if(!transform)
 	{
 		color_space = oldspace;
@@ -1304,91 +1161,14 @@ bool GrkImage::applyICC(void)
 	if(numcomps > 2)
 	{ /* RGB, RGBA */
 		if(prec <= 8)
-		{
-			nr_samples = componentSize * 3U;
-			auto inbuf = new uint8_t[nr_samples];
-			auto outbuf = new uint8_t[nr_samples];
-
-			auto r = comps[0].data;
-			auto g = comps[1].data;
-			auto b = comps[2].data;
-
-			size_t src_index = 0;
-			size_t dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					inbuf[dest_index++] = (uint8_t)r[src_index];
-					inbuf[dest_index++] = (uint8_t)g[src_index];
-					inbuf[dest_index++] = (uint8_t)b[src_index];
-					src_index++;
-				}
-				src_index += stride_diff;
-			}
-
-			cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
-
-			src_index = 0;
-			dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					r[dest_index] = (int32_t)outbuf[src_index++];
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
-					dest_index++;
-				}
-				dest_index += stride_diff;
-			}
-			delete[] inbuf;
-			delete[] outbuf;
-		}
+			transformRGB<uint8_t>(transform.get(), comps[0].data, comps[1].data, comps[2].data, w,
+								  h, stride);
 		else
-		{
-			nr_samples = componentSize * 3U * sizeof(uint16_t);
-			auto inbuf = new uint16_t[nr_samples];
-			auto outbuf = new uint16_t[nr_samples];
-
-			auto r = comps[0].data;
-			auto g = comps[1].data;
-			auto b = comps[2].data;
-
-			size_t src_index = 0;
-			size_t dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					inbuf[dest_index++] = (uint16_t)r[src_index];
-					inbuf[dest_index++] = (uint16_t)g[src_index];
-					inbuf[dest_index++] = (uint16_t)b[src_index];
-					src_index++;
-				}
-				src_index += stride_diff;
-			}
-			cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
-			src_index = 0;
-			dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					r[dest_index] = (int32_t)outbuf[src_index++];
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
-					dest_index++;
-				}
-				dest_index += stride_diff;
-			}
-			delete[] inbuf;
-			delete[] outbuf;
-		}
+			transformRGB<uint16_t>(transform.get(), comps[0].data, comps[1].data, comps[2].data,
+								   w, h, stride);
 	}
 	else
 	{ /* GRAY, GRAYA */
-		nr_samples = componentSize * 3U;
 		auto newComps = new grk_image_comp[numcomps + 2U];
 		for(uint32_t i = 0; i < numcomps + 2U; ++i)
 		{
@@ -1399,8 +1179,6 @@ bool GrkImage::applyICC(void)
 		}
 		delete[] comps;
 		comps = newComps;
-		auto inbuf = new uint8_t[nr_samples];
-		auto outbuf = new uint8_t[nr_samples];
 		if(forceRGB)
 		{
 			if(numcomps == 2)
@@ -1414,43 +1192,48 @@ bool GrkImage::applyICC(void)
 			numcomps = (uint16_t)(2 + numcomps);
 		}
 		auto r = comps[0].data;
-		size_t src_index = 0;
-		size_t dest_index = 0;
-		for(uint32_t j = 0; j < h; ++j)
-		{
-			for(uint32_t i = 0; i < w; ++i)
-				inbuf[dest_index++] = (uint8_t)r[src_index++];
-			src_index += stride_diff;
-		}
-		cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
 		int32_t *g = nullptr, *b = nullptr;
 		if(forceRGB)
 		{
 			g = comps[1].data;
 			b = comps[2].data;
 		}
-		src_index = 0;
-		dest_index = 0;
-		for(uint32_t j = 0; j < h; ++j)
-		{
-			for(uint32_t i = 0; i < w; ++i)
+		auto t = transform.get();
+		bool rgb = forceRGB;
+		convertStrips(h, singleTileRowsPerStrip, [=](uint32_t yBegin, uint32_t yEnd) {
+			size_t numPixels = (size_t)w * (yEnd - yBegin);
+			auto inbuf = new uint8_t[numPixels];
+			auto outbuf = new uint8_t[numPixels * 3U];
+			size_t dest_index = 0;
+			for(uint32_t j = yBegin; j < yEnd; ++j)
 			{
-				r[dest_index] = (int32_t)outbuf[src_index++];
-				if(forceRGB)
-				{
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
-				}
-				else
+				size_t src_index = (size_t)j * stride;
+				for(uint32_t i = 0; i < w; ++i)
+					inbuf[dest_index++] = (uint8_t)r[src_index++];
+			}
+			cmsDoTransform(t, inbuf, outbuf, (cmsUInt32Number)numPixels);
+			size_t src_index = 0;
+			for(uint32_t j = yBegin; j < yEnd; ++j)
+			{
+				dest_index = (size_t)j * stride;
+				for(uint32_t i = 0; i < w; ++i)
 				{
-					src_index += 2;
+					r[dest_index] = (int32_t)outbuf[src_index++];
+					if(rgb)
+					{
+						g[dest_index] = (int32_t)outbuf[src_index++];
+						b[dest_index] = (int32_t)outbuf[src_index++];
+					}
+					else
+					{
+						src_index += 2;
+					}
+					dest_index++;
 				}
-				dest_index++;
 			}
-			dest_index += stride_diff;
-		}
-		delete[] inbuf;
-		delete[] outbuf;
+			delete[] inbuf;
+			delete[] outbuf;
+		});
 	} /* if(image->numcomps */
 	rc = true;
 	delete[] meta->color.icc_profile_buf;
@@ -1459,10 +1242,6 @@ bool GrkImage::applyICC(void)
 cleanup:
 	if(in_prof)
 		cmsCloseProfile(in_prof);
-	if(out_prof)
-		cmsCloseProfile(out_prof);
-	if(transform)
-		cmsDeleteTransform(transform);
 
 	return rc;
 } /* applyICC() */
@@ -1515,11 +1294,10 @@ bool GrkImage::cieLabToRGB(void)
 	bool defaultType = true;
 	color_space = GRK_CLRSPC_SRGB;
 	defaultType = row[1] == GRK_DEFAULT_CIELAB_SPACE;
-	int32_t *L, *a, *b, *red, *green, *blue;
+	int32_t *L, *a, *b;
 	// range, offset and precision for L,a and b coordinates
 	double r_L, o_L, r_a, o_a, r_b, o_b, prec_L, prec_a, prec_b;
 	double minL, maxL, mina, maxa, minb, maxb;
-	cmsUInt16Number RGB[3];
 	prec_L = (double)comps[0].prec;
 	prec_a = (double)comps[1].prec;
 	prec_b = (double)comps[2].prec;
@@ -1544,7 +1322,7 @@ bool GrkImage::cieLabToRGB(void)
 		o_b = row[7];
 		illuminant = row[8];
 	}
-	cmsCIExyY WhitePoint;
+	cmsCIExyY WhitePoint = {};
 	switch(illuminant)
 	{
 		case GRK_CIE_D50:
@@ -1578,15 +1356,22 @@ bool GrkImage::cieLabToRGB(void)
 			break;
 	}
 
-	// Lab input profile
-	auto in = cmsCreateLab4Profile(illuminant == GRK_CIE_D50 ? nullptr : &WhitePoint);
-	// sRGB output profile
-	auto out = cmsCreate_sRGBProfile();
-	auto transform = cmsCreateTransform(in, TYPE_Lab_DBL, out, TYPE_RGB_16, INTENT_PERCEPTUAL, 0);
-
-	cmsCloseProfile(in);
-	cmsCloseProfile(out);
-	if(transform == nullptr)
+	// Lab to sRGB transform is shared by all strips, and by later images with the same illuminant
+	uint32_t labId[2] = {GRK_ENUM_CLRSPC_CIE, illuminant};
+	auto transform = ColourTransformCache::get()->getTransform(
+		(const uint8_t*)labId, sizeof(labId), TYPE_Lab_DBL, TYPE_RGB_16, INTENT_PERCEPTUAL,
+		[illuminant, WhitePoint]() -> void* {
+			// Lab input profile
+			auto in = cmsCreateLab4Profile(illuminant == GRK_CIE_D50 ? nullptr : &WhitePoint);
+			// sRGB output profile
+			auto out = cmsCreate_sRGBProfile();
+			auto t = cmsCreateTransform(in, TYPE_Lab_DBL, out, TYPE_RGB_16, INTENT_PERCEPTUAL,
+										cmsFLAGS_NOCACHE);
+			cmsCloseProfile(in);
+			cmsCloseProfile(out);
+			return t;
+		});
+	if(!transform)
 		return false;
 
 	L = comps[0].data;
@@ -1599,17 +1384,6 @@ bool GrkImage::cieLabToRGB(void)
 		return false;
 	}
 
-	auto dest_img = createRGB(3, comps[0].w, comps[0].h, comps[0].prec);
-	if(!dest_img)
-		return false;
-
-	red = dest_img->comps[0].data;
-	green = dest_img->comps[1].data;
-	blue = dest_img->comps[2].data;
-
-	uint32_t src_stride_diff = comps[0].stride - comps[0].w;
-	uint32_t dest_stride_diff = dest_img->comps[0].stride - dest_img->comps[0].w;
-
 	minL = -(r_L * o_L) / (pow(2, prec_L) - 1);
 	maxL = minL + r_L;
 
@@ -1619,51 +1393,44 @@ bool GrkImage::cieLabToRGB(void)
 	minb = -(r_b * o_b) / (pow(2, prec_b) - 1);
 	maxb = minb + r_b;
 
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < comps[0].h; ++j)
-	{
-		for(uint32_t k = 0; k < comps[0].w; ++k)
+	double rangeL = maxL - minL, divL = pow(2, prec_L) - 1;
+	double rangea = maxa - mina, diva = pow(2, prec_a) - 1;
+	double rangeb = maxb - minb, divb = pow(2, prec_b) - 1;
+	uint32_t w = comps[0].w;
+	uint32_t stride = comps[0].stride;
+
+	// RGB overwrites L*a*b, one row at a time
+	auto t = transform.get();
+	convertStrips(comps[0].h, singleTileRowsPerStrip, [=](uint32_t yBegin, uint32_t yEnd) {
+		auto Lab = new cmsCIELab[w];
+		auto RGB = new cmsUInt16Number[3 * (size_t)w];
+		for(uint32_t j = yBegin; j < yEnd; ++j)
 		{
-			cmsCIELab Lab;
-			Lab.L = minL + (double)(*L) * (maxL - minL) / (pow(2, prec_L) - 1);
-			++L;
-			Lab.a = mina + (double)(*a) * (maxa - mina) / (pow(2, prec_a) - 1);
-			++a;
-			Lab.b = minb + (double)(*b) * (maxb - minb) / (pow(2, prec_b) - 1);
-			++b;
-
-			cmsDoTransform(transform, &Lab, RGB, 1);
-
-			red[dest_index] = RGB[0];
-			green[dest_index] = RGB[1];
-			blue[dest_index] = RGB[2];
-			dest_index++;
+			size_t index = (size_t)j * stride;
+			for(uint32_t k = 0; k < w; ++k)
+			{
+				Lab[k].L = minL + (double)L[index + k] * rangeL / divL;
+				Lab[k].a = mina + (double)a[index + k] * rangea / diva;
+				Lab[k].b = minb + (double)b[index + k] * rangeb / divb;
+			}
+			cmsDoTransform(t, Lab, RGB, w);
+			for(uint32_t k = 0; k < w; ++k)
+			{
+				L[index + k] = RGB[3 * k];
+				a[index + k] = RGB[3 * k + 1];
+				b[index + k] = RGB[3 * k + 2];
+			}
 		}
-		dest_index += dest_stride_diff;
-		L += src_stride_diff;
-		a += src_stride_diff;
-		b += src_stride_diff;
-	}
-	cmsDeleteTransform(transform);
+		delete[] Lab;
+		delete[] RGB;
+	});
 
-	for(i = 0; i < numcomps; ++i)
+	for(i = 3; i < numcomps; ++i)
 		single_component_data_free(comps + i);
 
 	numcomps = 3;
 	for(i = 0; i < numcomps; ++i)
-	{
-		auto srcComp = comps + i;
-		auto destComp = dest_img->comps + i;
-
-		srcComp->prec = 16;
-		srcComp->stride = destComp->stride;
-		srcComp->data = destComp->data;
-	}
-	// clean up dest image
-	dest_img->comps[0].data = nullptr;
-	dest_img->comps[1].data = nullptr;
-	dest_img->comps[2].data = nullptr;
-	grk_object_unref(&dest_img->obj);
+		comps[i].prec = 16;
 
 	color_space = GRK_CLRSPC_SRGB;
 
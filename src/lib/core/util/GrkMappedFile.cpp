@@ -64,6 +64,12 @@ static void* grk_map(grk_handle fd, size_t len, bool do_read)
 	return ptr;
 }
 
+static void advise([[maybe_unused]] void* ptr, [[maybe_unused]] size_t len,
+				   [[maybe_unused]] GRK_STREAM_ADVICE advice)
+{
+	// not currently supported
+}
+
 static int32_t unmap(void* ptr, [[maybe_unused]] size_t len)
 {
 	int32_t rc = -1;
@@ -145,6 +151,31 @@ static void* grk_map(grk_handle fd, [[maybe_unused]] size_t len, bool do_read)
 	return ptr == (void*)-1 ? nullptr : ptr;
 }
 
+static void advise(void* ptr, size_t len, GRK_STREAM_ADVICE advice)
+{
+	// madvise requires page-aligned start address : widen range to whole pages
+	// for WILLNEED, and narrow range to whole pages for DONTNEED, so that
+	// pages shared with neighbouring unconsumed data are kept
+	static const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+	auto start = (uintptr_t)ptr;
+	auto end = start + len;
+	int adv = MADV_WILLNEED;
+	if(advice == GRK_STREAM_ADVICE_WILLNEED)
+	{
+		start &= ~(pageSize - 1);
+	}
+	else
+	{
+		start = (start + pageSize - 1) & ~(pageSize - 1);
+		end &= ~(pageSize - 1);
+		adv = MADV_DONTNEED;
+	}
+	if(end <= start)
+		return;
+	if(madvise((void*)start, end - start, adv))
+		GRK_WARN("madvise failed with error %s", strerror(errno));
+}
+
 static int32_t unmap(void* ptr, size_t len)
 {
 	int32_t rc = -1;
@@ -202,6 +233,16 @@ static void mem_map_free(void* user_data)
 	}
 }
 
+static void mem_map_advise(uint64_t offset, uint64_t length, GRK_STREAM_ADVICE advice,
+						   void* user_data)
+{
+	auto buffer_info = (MemStream*)user_data;
+	if(!buffer_info || !buffer_info->buf || offset >= buffer_info->len)
+		return;
+	length = std::min<uint64_t>(length, buffer_info->len - offset);
+	advise(buffer_info->buf + offset, (size_t)length, advice);
+}
+
 grk_stream* create_mapped_file_read_stream(const char* fname)
 {
 	grk_handle fd = open_fd(fname, "r");
@@ -242,6 +283,7 @@ grk_stream* create_mapped_file_read_stream(const char* fname)
 	auto stream = streamImpl->getWrapper();
 	grk_stream_set_user_data(stream, memStream, (grk_stream_free_user_data_fn)mem_map_free);
 	set_up_mem_stream(stream, memStream->len, true);
+	streamImpl->setAdviseFunction(mem_map_advise);
 
 	return stream;
 }
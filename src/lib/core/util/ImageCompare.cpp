@@ -0,0 +1,305 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "grk_includes.h"
+#include <limits>
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "util/ImageCompare.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	static void hwy_compare_row(const int32_t* base, const int32_t* test, uint32_t width,
+								CompareStats* stats)
+	{
+		uint32_t i = 0;
+		uint64_t numDiff = 0;
+		double sumDiff = 0;
+		double sumSqDiff = 0;
+		double peak = 0;
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) dd;
+		const Rebind<int32_t, decltype(dd)> di;
+		const size_t N = Lanes(dd);
+		auto vzero = Zero(dd);
+		auto vsum = Zero(dd);
+		auto vsumSq = Zero(dd);
+		auto vpeak = Zero(dd);
+		// differences are exact in double precision
+		for(; i + N <= width; i += (uint32_t)N)
+		{
+			auto vdiff = PromoteTo(dd, LoadU(di, base + i)) - PromoteTo(dd, LoadU(di, test + i));
+			numDiff += CountTrue(dd, vdiff != vzero);
+			vsum = vsum + vdiff;
+			vsumSq = MulAdd(vdiff, vdiff, vsumSq);
+			vpeak = Max(vpeak, Abs(vdiff));
+		}
+		sumDiff = GetLane(SumOfLanes(dd, vsum));
+		sumSqDiff = GetLane(SumOfLanes(dd, vsumSq));
+		peak = GetLane(MaxOfLanes(dd, vpeak));
+#endif
+		for(; i < width; ++i)
+		{
+			double diff = (double)base[i] - (double)test[i];
+			if(diff != 0)
+				numDiff++;
+			sumDiff += diff;
+			sumSqDiff += diff * diff;
+			peak = std::max<double>(peak, std::abs(diff));
+		}
+		stats->numDiff += numDiff;
+		stats->sumDiff += sumDiff;
+		stats->sumSqDiff += sumSqDiff;
+		stats->peak = std::max<double>(stats->peak, peak);
+	}
+
+	static void hwy_ssim_accumulate_row(const int32_t* base, const int32_t* test, uint32_t width,
+										double* sumBase, double* sumTest, double* sumBaseSq,
+										double* sumTestSq, double* sumCross)
+	{
+		uint32_t i = 0;
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) dd;
+		const Rebind<int32_t, decltype(dd)> di;
+		const size_t N = Lanes(dd);
+		for(; i + N <= width; i += (uint32_t)N)
+		{
+			auto vb = PromoteTo(dd, LoadU(di, base + i));
+			auto vt = PromoteTo(dd, LoadU(di, test + i));
+			StoreU(LoadU(dd, sumBase + i) + vb, dd, sumBase + i);
+			StoreU(LoadU(dd, sumTest + i) + vt, dd, sumTest + i);
+			StoreU(MulAdd(vb, vb, LoadU(dd, sumBaseSq + i)), dd, sumBaseSq + i);
+			StoreU(MulAdd(vt, vt, LoadU(dd, sumTestSq + i)), dd, sumTestSq + i);
+			StoreU(MulAdd(vb, vt, LoadU(dd, sumCross + i)), dd, sumCross + i);
+		}
+#endif
+		for(; i < width; ++i)
+		{
+			double b = base[i];
+			double t = test[i];
+			sumBase[i] += b;
+			sumTest[i] += t;
+			sumBaseSq[i] += b * b;
+			sumTestSq[i] += t * t;
+			sumCross[i] += b * t;
+		}
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_compare_row);
+HWY_EXPORT(hwy_ssim_accumulate_row);
+
+void CompareStats::add(const CompareStats& rhs)
+{
+	numDiff += rhs.numDiff;
+	sumDiff += rhs.sumDiff;
+	sumSqDiff += rhs.sumSqDiff;
+	peak = std::max<double>(peak, rhs.peak);
+}
+void compareRow(const int32_t* base, const int32_t* test, uint32_t width, CompareStats* stats)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_compare_row)(base, test, width, stats);
+}
+void ssimAccumulateRow(const int32_t* base, const int32_t* test, uint32_t width, double* sumBase,
+					   double* sumTest, double* sumBaseSq, double* sumTestSq, double* sumCross)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_ssim_accumulate_row)
+	(base, test, width, sumBase, sumTest, sumBaseSq, sumTestSq, sumCross);
+}
+
+// SSIM is calculated over non-overlapping blocks of this size, clipped at component bounds
+const uint32_t ssimBlockSize = 8;
+
+/**
+ * Sum of SSIM over the blocks of a strip
+ */
+struct SSIMStats
+{
+	SSIMStats() : sum(0), numBlocks(0) {}
+	double sum;
+	uint64_t numBlocks;
+};
+
+static void ssimStrip(const int32_t* base, uint32_t baseStride, const int32_t* test,
+					  uint32_t testStride, uint32_t width, uint32_t height, double maxValue,
+					  SSIMStats* stats)
+{
+	const double c1 = (0.01 * maxValue) * (0.01 * maxValue);
+	const double c2 = (0.03 * maxValue) * (0.03 * maxValue);
+	std::vector<double> sums(5 * (size_t)width);
+	auto sumBase = sums.data();
+	auto sumTest = sumBase + width;
+	auto sumBaseSq = sumTest + width;
+	auto sumTestSq = sumBaseSq + width;
+	auto sumCross = sumTestSq + width;
+	for(uint32_t y = 0; y < height; y += ssimBlockSize)
+	{
+		uint32_t blockHeight = std::min<uint32_t>(ssimBlockSize, height - y);
+		std::fill(sums.begin(), sums.end(), 0.0);
+		for(uint32_t j = y; j < y + blockHeight; ++j)
+			ssimAccumulateRow(base + (size_t)j * baseStride, test + (size_t)j * testStride, width,
+							  sumBase, sumTest, sumBaseSq, sumTestSq, sumCross);
+		for(uint32_t x = 0; x < width; x += ssimBlockSize)
+		{
+			uint32_t blockWidth = std::min<uint32_t>(ssimBlockSize, width - x);
+			double sb = 0, st = 0, sbb = 0, stt = 0, sbt = 0;
+			for(uint32_t i = x; i < x + blockWidth; ++i)
+			{
+				sb += sumBase[i];
+				st += sumTest[i];
+				sbb += sumBaseSq[i];
+				stt += sumTestSq[i];
+				sbt += sumCross[i];
+			}
+			double n = (double)blockWidth * blockHeight;
+			double meanBase = sb / n;
+			double meanTest = st / n;
+			double varBase = sbb / n - meanBase * meanBase;
+			double varTest = stt / n - meanTest * meanTest;
+			double covariance = sbt / n - meanBase * meanTest;
+			double numerator = (2 * meanBase * meanTest + c1) * (2 * covariance + c2);
+			double denominator =
+				(meanBase * meanBase + meanTest * meanTest + c1) * (varBase + varTest + c2);
+			stats->sum += numerator / denominator;
+			stats->numBlocks++;
+		}
+	}
+}
+
+static void compareComponent(const grk_image_comp* baseComp, const grk_image_comp* testComp,
+							 grk_rect32 bounds, bool ssim, grk_image_comp_metrics* metrics)
+{
+	uint32_t width = bounds.width();
+	uint32_t height = bounds.height();
+	auto base = baseComp->data + bounds.x0 + (size_t)bounds.y0 * baseComp->stride;
+	auto test = testComp->data;
+
+	// strips hold roughly 64K samples, and are aligned with SSIM blocks
+	uint32_t rowsPerStrip = std::max<uint32_t>(1, (1U << 16) / width);
+	rowsPerStrip = (rowsPerStrip + ssimBlockSize - 1) & ~(ssimBlockSize - 1);
+	uint32_t numStrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+	std::vector<CompareStats> stripStats(numStrips);
+	std::vector<SSIMStats> stripSSIM(ssim ? numStrips : 0);
+	double maxValue = (double)((1ULL << baseComp->prec) - 1);
+	convertStrips(height, rowsPerStrip, [&](uint32_t yBegin, uint32_t yEnd) {
+		for(uint32_t y = yBegin; y < yEnd; y += rowsPerStrip)
+		{
+			uint32_t strip = y / rowsPerStrip;
+			uint32_t stripEnd = std::min<uint32_t>(y + rowsPerStrip, yEnd);
+			for(uint32_t j = y; j < stripEnd; ++j)
+				compareRow(base + (size_t)j * baseComp->stride,
+						   test + (size_t)j * testComp->stride, width, &stripStats[strip]);
+			if(ssim)
+				ssimStrip(base + (size_t)y * baseComp->stride, baseComp->stride,
+						  test + (size_t)y * testComp->stride, testComp->stride, width,
+						  stripEnd - y, maxValue, &stripSSIM[strip]);
+		}
+	});
+
+	// strips are combined in order, so metrics do not depend on number of threads
+	CompareStats stats;
+	for(auto& s : stripStats)
+		stats.add(s);
+	metrics->num_diff = stats.numDiff;
+	metrics->sum_diff = stats.sumDiff;
+	metrics->peak = stats.peak;
+	metrics->mse = stats.sumSqDiff / ((double)width * height);
+	metrics->psnr = metrics->mse > 0 ? 10.0 * log10(maxValue * maxValue / metrics->mse)
+									 : std::numeric_limits<double>::infinity();
+	metrics->ssim = 0;
+	if(ssim)
+	{
+		SSIMStats total;
+		for(auto& s : stripSSIM)
+		{
+			total.sum += s.sum;
+			total.numBlocks += s.numBlocks;
+		}
+		if(total.numBlocks)
+			metrics->ssim = total.sum / (double)total.numBlocks;
+	}
+}
+
+static grk_rect32 compareBounds(const grk_image_comp* baseComp, const uint32_t* region)
+{
+	return region ? grk_rect32(region[0], region[1], region[2], region[3])
+				  : grk_rect32(0, 0, baseComp->w, baseComp->h);
+}
+bool compareImages(const grk_image* base, const grk_image* test, const uint32_t* region, bool ssim,
+				   grk_image_comp_metrics* metrics)
+{
+	if(!base || !test || !metrics)
+		return false;
+	if(base->numcomps != test->numcomps)
+	{
+		GRK_ERROR("Compare: number of components %u differs from base number of components %u",
+				  test->numcomps, base->numcomps);
+		return false;
+	}
+	for(uint16_t compno = 0; compno < base->numcomps; ++compno)
+	{
+		auto baseComp = base->comps + compno;
+		auto testComp = test->comps + compno;
+		if(!baseComp->data || !testComp->data || !testComp->w || !testComp->h)
+		{
+			GRK_ERROR("Compare: component %u has no data", compno);
+			return false;
+		}
+		if(baseComp->data_type != GRK_INT_32 || testComp->data_type != GRK_INT_32)
+		{
+			GRK_ERROR("Compare: component %u data types (%u,%u) are not both GRK_INT_32", compno,
+					  baseComp->data_type, testComp->data_type);
+			return false;
+		}
+		if(baseComp->sgnd != testComp->sgnd || baseComp->prec != testComp->prec)
+		{
+			GRK_ERROR("Compare: component %u sign and precision (%u,%u) differ from base (%u,%u)",
+					  compno, testComp->sgnd, testComp->prec, baseComp->sgnd, baseComp->prec);
+			return false;
+		}
+		auto bounds = compareBounds(baseComp, region);
+		if(!bounds.valid() || bounds.x1 > baseComp->w || bounds.y1 > baseComp->h ||
+		   bounds.width() != testComp->w || bounds.height() != testComp->h)
+		{
+			GRK_ERROR("Compare: component %u dimensions (%u,%u) differ from base dimensions "
+					  "(%u,%u)",
+					  compno, testComp->w, testComp->h, bounds.width(), bounds.height());
+			return false;
+		}
+	}
+	for(uint16_t compno = 0; compno < base->numcomps; ++compno)
+	{
+		auto baseComp = base->comps + compno;
+		compareComponent(baseComp, test->comps + compno, compareBounds(baseComp, region), ssim,
+						 metrics + compno);
+	}
+
+	return true;
+}
+} // namespace grk
+#endif
@@ -0,0 +1,81 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace grk
+{
+/**
+ * Difference statistics of base and test samples
+ */
+struct CompareStats
+{
+	CompareStats() : numDiff(0), sumDiff(0), sumSqDiff(0), peak(0) {}
+	void add(const CompareStats& rhs);
+	// number of differing samples
+	uint64_t numDiff;
+	// sum of differences (base - test)
+	double sumDiff;
+	// sum of squared differences
+	double sumSqDiff;
+	// maximum absolute difference
+	double peak;
+};
+
+/**
+ * Accumulate difference statistics for a row of samples
+ *
+ * @param base base row
+ * @param test test row
+ * @param width number of samples
+ * @param stats statistics to accumulate into
+ */
+void compareRow(const int32_t* base, const int32_t* test, uint32_t width, CompareStats* stats);
+
+/**
+ * Accumulate per-column sums needed for SSIM, for a row of samples
+ *
+ * @param base base row
+ * @param test test row
+ * @param width number of samples
+ * @param sumBase column sums of base samples
+ * @param sumTest column sums of test samples
+ * @param sumBaseSq column sums of squared base samples
+ * @param sumTestSq column sums of squared test samples
+ * @param sumCross column sums of base and test sample products
+ */
+void ssimAccumulateRow(const int32_t* base, const int32_t* test, uint32_t width, double* sumBase,
+					   double* sumTest, double* sumBaseSq, double* sumTestSq, double* sumCross);
+
+/**
+ * Compare components of test image with base image, in parallel strips
+ *
+ * @param base base image
+ * @param test test image
+ * @param region base image region x0,y0,x1,y1 compared with test image,
+ * or nullptr to compare whole components
+ * @param ssim if true, calculate SSIM
+ * @param metrics array of metrics, one per component
+ *
+ * @return true if images can be compared
+ */
+bool compareImages(const grk_image* base, const grk_image* test, const uint32_t* region, bool ssim,
+				   grk_image_comp_metrics* metrics);
+
+} // namespace grk
@@ -29,6 +29,21 @@ typedef int32_t grk_handle;
  */
 typedef size_t (*grk_stream_zero_copy_read_fn)(uint8_t** buffer, size_t numBytes, void* user_data);
 
+/*
+ * Access pattern advice for a range of the underlying stream
+ */
+enum GRK_STREAM_ADVICE
+{
+	GRK_STREAM_ADVICE_WILLNEED, /* range will be read soon */
+	GRK_STREAM_ADVICE_DONTNEED /* range has been consumed */
+};
+
+/*
+ * Callback function prototype for stream access pattern advice
+ */
+typedef void (*grk_stream_advise_fn)(uint64_t offset, uint64_t length, GRK_STREAM_ADVICE advice,
+									 void* user_data);
+
 struct MemStream
 {
 	MemStream(uint8_t* buffer, size_t offset, size_t length, bool owns);
@@ -0,0 +1,221 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "grk_includes.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "util/Upsampler.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	/**
+	 * Nearest neighbour upsampling of a component row
+	 *
+	 * @param src component row
+	 * @param srcX0 component x coordinate of first sample in row
+	 * @param dx horizontal sub-sampling factor
+	 * @param x0 reference grid x coordinate of first output sample
+	 * @param width number of output samples
+	 * @param dest output row
+	 */
+	static void hwy_upsample_nearest_row(const int32_t* src, uint32_t srcX0, uint32_t dx,
+										 uint32_t x0, uint32_t width, int32_t* dest)
+	{
+		uint32_t i = 0;
+		// no sample before first component sample
+		for(; i < width && (x0 + i) / dx < srcX0; ++i)
+			dest[i] = 0;
+		if(dx == 1)
+		{
+			if(i < width)
+				memcpy(dest + i, src + (x0 + i - srcX0), (width - i) * sizeof(int32_t));
+			return;
+		}
+		if(dx == 2)
+		{
+			if(i < width && ((x0 + i) & 1))
+			{
+				dest[i] = src[(x0 + i) / 2 - srcX0];
+				++i;
+			}
+			// each sample vector is duplicated into two output vectors
+			const HWY_FULL(int32_t) di;
+			const size_t N = Lanes(di);
+			auto idxLo = IndicesFromVec(di, ShiftRight<1>(Iota(di, 0)));
+			auto idxHi = IndicesFromVec(di, ShiftRight<1>(Iota(di, (int32_t)N)));
+			for(; i + 2 * N <= width; i += 2 * (uint32_t)N)
+			{
+				auto v = LoadU(di, src + (x0 + i) / 2 - srcX0);
+				StoreU(TableLookupLanes(v, idxLo), di, dest + i);
+				StoreU(TableLookupLanes(v, idxHi), di, dest + i + N);
+			}
+		}
+		for(; i < width; ++i)
+			dest[i] = src[(x0 + i) / dx - srcX0];
+	}
+
+	/**
+	 * Interpolate between two component rows
+	 *
+	 * @param row0 first row
+	 * @param row1 second row
+	 * @param w1 weight of second row
+	 * @param width number of samples
+	 * @param dest interpolated row
+	 */
+	static void hwy_interpolate_rows(const int32_t* row0, const int32_t* row1, float w1,
+									 uint32_t width, float* dest)
+	{
+		float w0 = 1.0f - w1;
+		const HWY_FULL(float) df;
+		const RebindToSigned<decltype(df)> di;
+		const size_t N = Lanes(df);
+		auto vw0 = Set(df, w0);
+		auto vw1 = Set(df, w1);
+		uint32_t i = 0;
+		for(; i + N <= width; i += (uint32_t)N)
+		{
+			auto v0 = ConvertTo(df, LoadU(di, row0 + i));
+			auto v1 = ConvertTo(df, LoadU(di, row1 + i));
+			StoreU(v0 * vw0 + v1 * vw1, df, dest + i);
+		}
+		for(; i < width; ++i)
+			dest[i] = (float)row0[i] * w0 + (float)row1[i] * w1;
+	}
+
+	/**
+	 * Bilinear upsampling of a vertically interpolated component row
+	 *
+	 * @param src interpolated row, with final sample replicated once past the end
+	 * @param srcX0 component x coordinate of first sample in row
+	 * @param dx horizontal sub-sampling factor
+	 * @param x0 reference grid x coordinate of first output sample
+	 * @param width number of output samples
+	 * @param dest output row
+	 */
+	static void hwy_upsample_bilinear_row(const float* src, uint32_t srcX0, uint32_t dx,
+										  uint32_t x0, uint32_t width, int32_t* dest)
+	{
+		auto interpolate = [src, srcX0, dx](uint32_t x) {
+			uint32_t q = x / dx;
+			uint32_t r = x - q * dx;
+			uint32_t s = 0;
+			// replicate first sample
+			if(q < srcX0)
+				r = 0;
+			else
+				s = q - srcX0;
+			float w1 = (float)r / (float)dx;
+			float w0 = 1.0f - w1;
+
+			return (int32_t)std::floor(src[s] * w0 + src[s + 1] * w1 + 0.5f);
+		};
+		uint32_t i = 0;
+		for(; i < width && (x0 + i) / dx < srcX0; ++i)
+			dest[i] = interpolate(x0 + i);
+		if(dx == 2)
+		{
+			if(i < width && ((x0 + i) & 1))
+			{
+				dest[i] = interpolate(x0 + i);
+				++i;
+			}
+			const HWY_FULL(float) df;
+			const RebindToSigned<decltype(df)> di;
+			const size_t N = Lanes(df);
+			auto idxLo = IndicesFromVec(df, ShiftRight<1>(Iota(di, 0)));
+			auto idxHi = IndicesFromVec(df, ShiftRight<1>(Iota(di, (int32_t)N)));
+			// odd outputs lie half way between samples
+			auto vw1 = ConvertTo(df, And(Iota(di, 0), Set(di, 1))) * Set(df, 0.5f);
+			auto vw0 = Set(df, 1.0f) - vw1;
+			auto vhalf = Set(df, 0.5f);
+			for(; i + 2 * N <= width; i += 2 * (uint32_t)N)
+			{
+				auto s = src + (x0 + i) / 2 - srcX0;
+				auto va = LoadU(df, s);
+				auto vb = LoadU(df, s + 1);
+				auto lo = TableLookupLanes(va, idxLo) * vw0 + TableLookupLanes(vb, idxLo) * vw1;
+				auto hi = TableLookupLanes(va, idxHi) * vw0 + TableLookupLanes(vb, idxHi) * vw1;
+				StoreU(ConvertTo(di, Floor(lo + vhalf)), di, dest + i);
+				StoreU(ConvertTo(di, Floor(hi + vhalf)), di, dest + i + N);
+			}
+		}
+		for(; i < width; ++i)
+			dest[i] = interpolate(x0 + i);
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_upsample_nearest_row);
+HWY_EXPORT(hwy_interpolate_rows);
+HWY_EXPORT(hwy_upsample_bilinear_row);
+
+void upsampleRow(const grk_image_comp* comp, uint32_t y, uint32_t x0, uint32_t width,
+				 GRK_UPSAMPLE_FILTER filter, float* scratch, int32_t* dest)
+{
+	uint32_t q = y / comp->dy;
+	if(!comp->w || !comp->h || (filter != GRK_UPSAMPLE_BILINEAR && q < comp->y0))
+	{
+		memset(dest, 0, width * sizeof(int32_t));
+		return;
+	}
+	if(filter == GRK_UPSAMPLE_BILINEAR)
+	{
+		uint32_t r = y - q * comp->dy;
+		uint32_t row = 0;
+		// replicate first row
+		if(q < comp->y0)
+			r = 0;
+		else
+			row = std::min<uint32_t>(q - comp->y0, comp->h - 1);
+		uint32_t nextRow = std::min<uint32_t>(row + 1, comp->h - 1);
+		HWY_DYNAMIC_DISPATCH(hwy_interpolate_rows)
+		(comp->data + (size_t)row * comp->stride, comp->data + (size_t)nextRow * comp->stride,
+		 (float)r / (float)comp->dy, comp->w, scratch);
+		scratch[comp->w] = scratch[comp->w - 1];
+		HWY_DYNAMIC_DISPATCH(hwy_upsample_bilinear_row)
+		(scratch, comp->x0, comp->dx, x0, width, dest);
+	}
+	else
+	{
+		HWY_DYNAMIC_DISPATCH(hwy_upsample_nearest_row)
+		(comp->data + (size_t)(q - comp->y0) * comp->stride, comp->x0, comp->dx, x0, width, dest);
+	}
+}
+void upsampleComponent(const grk_image_comp* src, grk_image_comp* dest, uint32_t x0, uint32_t y0,
+					   GRK_UPSAMPLE_FILTER filter)
+{
+	convertStrips(dest->h, singleTileRowsPerStrip, [&](uint32_t yBegin, uint32_t yEnd) {
+		std::unique_ptr<float[]> scratch(filter == GRK_UPSAMPLE_BILINEAR ? new float[src->w + 1]
+																		  : nullptr);
+		for(uint32_t y = yBegin; y < yEnd; ++y)
+			upsampleRow(src, y0 + y, x0, dest->w, filter, scratch.get(),
+						dest->data + (size_t)y * dest->stride);
+	});
+}
+} // namespace grk
+#endif
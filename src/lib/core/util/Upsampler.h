@@ -0,0 +1,56 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace grk
+{
+/**
+ * Upsample a row of a sub-sampled component to image resolution.
+ *
+ * Component sample (i,j) sits at reference grid position (i * dx, j * dy).
+ * Nearest filter replicates sample (floor(x / dx), floor(y / dy)), and
+ * outputs zero for positions before the first component sample.
+ * Bilinear filter interpolates between neighbouring samples,
+ * replicating edge samples.
+ *
+ * @param comp sub-sampled component
+ * @param y reference grid y coordinate of output row
+ * @param x0 reference grid x coordinate of first output sample
+ * @param width number of output samples
+ * @param filter upsampling filter
+ * @param scratch scratch buffer of (comp->w + 1) floats, for bilinear filter
+ * @param dest output row
+ */
+void upsampleRow(const grk_image_comp* comp, uint32_t y, uint32_t x0, uint32_t width,
+				 GRK_UPSAMPLE_FILTER filter, float* scratch, int32_t* dest);
+
+/**
+ * Upsample component to image resolution, in parallel strips
+ *
+ * @param src sub-sampled component
+ * @param dest full resolution component, with allocated data
+ * @param x0 reference grid x coordinate of first column of dest
+ * @param y0 reference grid y coordinate of first row of dest
+ * @param filter upsampling filter
+ */
+void upsampleComponent(const grk_image_comp* src, grk_image_comp* dest, uint32_t x0, uint32_t y0,
+					   GRK_UPSAMPLE_FILTER filter);
+
+} // namespace grk
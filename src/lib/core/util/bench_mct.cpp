@@ -0,0 +1,149 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Benchmark of custom (Part 2) multi-component transform, for 3, 16 and 224
+ * component cubes. Transformed samples are checked against scalar reference
+ * transform.
+ *
+ * Usage: bench_mct [number of threads] [width] [height]
+ */
+
+#include "grk_includes.h"
+
+#include <chrono>
+#include <random>
+
+using namespace grk;
+
+static void referenceCompress(const float* mct, uint64_t n, int32_t** data, uint16_t numComps)
+{
+	std::vector<int32_t> matrix((size_t)numComps * numComps);
+	for(size_t i = 0; i < matrix.size(); ++i)
+		matrix[i] = (int32_t)(mct[i] * (float)(1 << 13));
+	std::vector<int32_t> pixel(numComps);
+	for(uint64_t i = 0; i < n; ++i)
+	{
+		for(uint16_t j = 0; j < numComps; ++j)
+			pixel[j] = data[j][i];
+		for(uint16_t j = 0; j < numComps; ++j)
+		{
+			int32_t acc = 0;
+			for(uint16_t k = 0; k < numComps; ++k)
+				acc += fix_mul(matrix[(size_t)j * numComps + k], pixel[k]);
+			data[j][i] = acc;
+		}
+	}
+}
+
+static void referenceDecompress(const float* mct, uint64_t n, float** data, uint16_t numComps)
+{
+	std::vector<float> pixel(numComps);
+	for(uint64_t i = 0; i < n; ++i)
+	{
+		for(uint16_t j = 0; j < numComps; ++j)
+			pixel[j] = data[j][i];
+		for(uint16_t j = 0; j < numComps; ++j)
+		{
+			float acc = 0;
+			for(uint16_t k = 0; k < numComps; ++k)
+				acc += mct[(size_t)j * numComps + k] * pixel[k];
+			data[j][i] = acc;
+		}
+	}
+}
+
+template<typename F>
+static double elapsedMs(F f)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	f();
+	std::chrono::duration<double, std::milli> elapsed =
+		std::chrono::high_resolution_clock::now() - start;
+
+	return elapsed.count();
+}
+
+static bool bench(uint16_t numComps, uint64_t n)
+{
+	std::mt19937 gen(numComps);
+	std::uniform_real_distribution<float> coeff(-1.0f, 1.0f);
+	std::uniform_int_distribution<int32_t> sample(-2048, 2047);
+	std::vector<float> mct((size_t)numComps * numComps);
+	for(auto& m : mct)
+		m = coeff(gen) / (float)numComps;
+
+	std::vector<std::vector<int32_t>> ints(numComps, std::vector<int32_t>(n));
+	std::vector<std::vector<float>> floats(numComps, std::vector<float>(n));
+	for(uint16_t j = 0; j < numComps; ++j)
+	{
+		for(uint64_t i = 0; i < n; ++i)
+		{
+			ints[j][i] = sample(gen);
+			floats[j][i] = (float)ints[j][i];
+		}
+	}
+	auto refInts = ints;
+	auto refFloats = floats;
+
+	std::vector<int32_t*> intPtrs(numComps), refIntPtrs(numComps);
+	std::vector<float*> refFloatPtrs(numComps);
+	// decompress_custom takes ownership of component array
+	auto floatPtrs = new float*[numComps];
+	for(uint16_t j = 0; j < numComps; ++j)
+	{
+		intPtrs[j] = ints[j].data();
+		refIntPtrs[j] = refInts[j].data();
+		floatPtrs[j] = floats[j].data();
+		refFloatPtrs[j] = refFloats[j].data();
+	}
+
+	double refCompress =
+		elapsedMs([&] { referenceCompress(mct.data(), n, refIntPtrs.data(), numComps); });
+	double compress = elapsedMs([&] {
+		mct::compress_custom((uint8_t*)mct.data(), n, (uint8_t**)intPtrs.data(), numComps, 1);
+	});
+	double refDecompress =
+		elapsedMs([&] { referenceDecompress(mct.data(), n, refFloatPtrs.data(), numComps); });
+	double decompress = elapsedMs([&] {
+		mct::decompress_custom((uint8_t*)mct.data(), n, (uint8_t**)floatPtrs, numComps, 1);
+	});
+
+	bool match = ints == refInts && floats == refFloats;
+	printf("%4u components: compress %9.2f ms (reference %9.2f ms), "
+		   "decompress %9.2f ms (reference %9.2f ms) %s\n",
+		   numComps, compress, refCompress, decompress, refDecompress,
+		   match ? "OK" : "MISMATCH");
+
+	return match;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t numThreads = argc > 1 ? (uint32_t)atoi(argv[1]) : 0;
+	uint64_t width = argc > 2 ? (uint64_t)atoi(argv[2]) : 256;
+	uint64_t height = argc > 3 ? (uint64_t)atoi(argv[3]) : 256;
+	ExecSingleton::instance(numThreads);
+	printf("%" PRIu64 " x %" PRIu64 " samples per component, %u threads\n", width, height,
+		   (uint32_t)ExecSingleton::get()->num_workers());
+	bool rc = true;
+	for(uint16_t numComps : {(uint16_t)3, (uint16_t)16, (uint16_t)224})
+		rc &= bench(numComps, width * height);
+	ExecSingleton::release();
+
+	return rc ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,214 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Benchmark of irreversible (9/7) region decompression, for 256x256 and 512x512
+ * windows typical of map tile viewports. A single tile RGB image is compressed
+ * at 40:1, and windows at random positions are decompressed and checked against
+ * a crop of the full image decompression.
+ *
+ * Usage: bench_region_decode [number of threads] [image dimension] [number of windows]
+ */
+
+#include "grok.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+const uint16_t numComps = 3;
+
+static bool compress(const char* outfile, uint32_t dim)
+{
+	grk_image_comp cmptparms[numComps];
+	memset(cmptparms, 0, sizeof(cmptparms));
+	for(uint16_t compno = 0; compno < numComps; ++compno)
+	{
+		auto cmptparm = cmptparms + compno;
+		cmptparm->dx = 1;
+		cmptparm->dy = 1;
+		cmptparm->w = dim;
+		cmptparm->h = dim;
+		cmptparm->prec = 8;
+	}
+	auto image = grk_image_new(numComps, cmptparms, GRK_CLRSPC_SRGB);
+	if(!image)
+		return false;
+	image->x1 = dim;
+	image->y1 = dim;
+
+	// smooth gradients with some texture, so that all sub-bands carry data
+	std::mt19937 gen(dim);
+	std::uniform_int_distribution<int32_t> noise(0, 15);
+	for(uint16_t compno = 0; compno < numComps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		for(uint32_t j = 0; j < comp->h; ++j)
+		{
+			for(uint32_t i = 0; i < comp->w; ++i)
+			{
+				int32_t val = (int32_t)(((i >> 2) * (compno + 1) + (j >> 1)) & 0xEF);
+				comp->data[(uint64_t)j * comp->stride + i] = val + noise(gen);
+			}
+		}
+	}
+
+	grk_cparameters parameters;
+	grk_compress_set_default_params(&parameters);
+	parameters.cod_format = GRK_FMT_J2K;
+	parameters.irreversible = true;
+	parameters.numlayers = 1;
+	parameters.layer_rate[0] = 40;
+	parameters.allocationByRateDistoration = true;
+
+	grk_stream_params stream_params;
+	memset(&stream_params, 0, sizeof(stream_params));
+	stream_params.file = outfile;
+	bool rc = false;
+	auto codec = grk_compress_init(&stream_params, &parameters, image);
+	if(codec)
+	{
+		rc = grk_compress(codec, nullptr);
+		grk_object_unref(codec);
+	}
+	grk_object_unref(&image->obj);
+
+	return rc;
+}
+
+/**
+ * Decompress window, or full image if window is empty, returning time in ms,
+ * or a negative value on failure
+ */
+static double decompress(const char* infile, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1,
+						 std::vector<std::vector<int32_t>>& data)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	grk_decompress_core_params parameters;
+	memset(&parameters, 0, sizeof(grk_decompress_core_params));
+	grk_decompress_set_default_params(&parameters);
+	grk_stream_params stream_params;
+	memset(&stream_params, 0, sizeof(stream_params));
+	stream_params.file = infile;
+	auto codec = grk_decompress_init(&stream_params, &parameters);
+	if(!codec)
+		return -1;
+	grk_header_info headerInfo;
+	memset(&headerInfo, 0, sizeof(grk_header_info));
+	bool rc = grk_decompress_read_header(codec, &headerInfo);
+	if(rc && x1 > x0)
+		rc = grk_decompress_set_window(codec, (float)x0, (float)y0, (float)x1, (float)y1);
+	rc = rc && grk_decompress(codec, nullptr);
+	std::chrono::duration<double, std::milli> elapsed =
+		std::chrono::high_resolution_clock::now() - start;
+	auto image = rc ? grk_decompress_get_composited_image(codec) : nullptr;
+	data.clear();
+	for(uint16_t compno = 0; image && compno < image->numcomps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		std::vector<int32_t> compData;
+		for(uint32_t j = 0; j < comp->h; ++j)
+		{
+			auto row = comp->data + (uint64_t)j * comp->stride;
+			compData.insert(compData.end(), row, row + comp->w);
+		}
+		data.push_back(compData);
+	}
+	grk_object_unref(codec);
+
+	return image ? elapsed.count() : -1;
+}
+
+static bool bench(const char* file, uint32_t dim, uint32_t window, uint32_t numWindows,
+				  const std::vector<std::vector<int32_t>>& full)
+{
+	std::mt19937 gen(window);
+	std::uniform_int_distribution<uint32_t> origin(0, dim - window);
+	std::vector<double> times;
+	bool match = true;
+	for(uint32_t w = 0; w < numWindows; ++w)
+	{
+		uint32_t x0 = origin(gen);
+		uint32_t y0 = origin(gen);
+		std::vector<std::vector<int32_t>> data;
+		double ms = decompress(file, x0, y0, x0 + window, y0 + window, data);
+		if(ms < 0 || data.size() != full.size())
+		{
+			fprintf(stderr, "failed to decompress window (%u,%u)\n", x0, y0);
+			return false;
+		}
+		times.push_back(ms);
+		for(uint16_t compno = 0; match && compno < full.size(); ++compno)
+		{
+			for(uint32_t j = 0; match && j < window; ++j)
+			{
+				auto crop = full[compno].begin() + (ptrdiff_t)((uint64_t)(y0 + j) * dim + x0);
+				match = std::equal(crop, crop + window,
+								   data[compno].begin() + (ptrdiff_t)((uint64_t)j * window));
+			}
+		}
+	}
+	std::sort(times.begin(), times.end());
+	double mean = 0;
+	for(auto t : times)
+		mean += t;
+	mean /= (double)times.size();
+	printf("%4u x %4u window: median %8.2f ms, mean %8.2f ms, min %8.2f ms %s\n", window, window,
+		   times[times.size() / 2], mean, times.front(), match ? "OK" : "MISMATCH");
+
+	return match;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t numThreads = argc > 1 ? (uint32_t)atoi(argv[1]) : 1;
+	uint32_t dim = argc > 2 ? (uint32_t)atoi(argv[2]) : 1024;
+	uint32_t numWindows = argc > 3 ? (uint32_t)atoi(argv[3]) : 40;
+	if(dim < 512 || numWindows == 0)
+	{
+		fprintf(stderr, "image dimension must be at least 512, with at least one window\n");
+		return EXIT_FAILURE;
+	}
+	grk_initialize(nullptr, numThreads);
+	auto file = (std::filesystem::temp_directory_path() / "bench_region_decode.j2k").string();
+	bool rc = compress(file.c_str(), dim);
+	std::vector<std::vector<int32_t>> full;
+	double fullMs = rc ? decompress(file.c_str(), 0, 0, 0, 0, full) : -1;
+	rc = fullMs >= 0;
+	if(rc)
+	{
+		printf("%u x %u RGB 9/7 at 40:1, %u threads, %u windows: full decompress %.2f ms\n", dim,
+			   dim, numThreads, numWindows, fullMs);
+		for(uint32_t window : {256U, 512U})
+			rc &= bench(file.c_str(), dim, window, numWindows, full);
+	}
+	else
+	{
+		fprintf(stderr, "failed to compress and decompress %s\n", file.c_str());
+	}
+	std::filesystem::remove(file);
+	grk_deinitialize();
+
+	return rc ? EXIT_SUCCESS : EXIT_FAILURE;
+}
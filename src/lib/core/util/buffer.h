@@ -284,7 +284,7 @@ struct grk_buf2d : protected grk_buf<T, A>, public grk_rect32
 				return false;
 			}
 			if(clear)
-				memset(this->buf, 0, data_size_needed);
+				grk_clear(this->buf, data_size_needed);
 		}
 
 		return true;
@@ -30,21 +30,9 @@ class PluginDecodeUnsupportedException : public std::exception
 class CorruptJP2BoxException : public std::exception
 {
 };
-class TruncatedPacketHeaderException : public std::exception
-{
-};
 class SparseBufferOverrunException : public std::exception
 {
 };
-class CorruptPacketException : public std::exception
-{
-};
-class CorruptPacketHeaderException : public CorruptPacketException
-{
-};
-class CorruptPacketDataException : public CorruptPacketException
-{
-};
 class InvalidMarkerException : public std::exception
 {
   public:
@@ -1788,7 +1788,7 @@ struct PartialBandInfo
  *  Width :  4
  *
  *  9/7
- *  Height : 1
+ *  Width :  4
  *
  ****************************************************************************
  *
@@ -1810,6 +1810,9 @@ bool WaveletReverse::decompress_partial_tile(ISparseCanvas* sa,
 
 	[[maybe_unused]] const uint16_t debug_compno = 0;
 	const uint32_t HORIZ_PASS_HEIGHT = sizeof(T) / sizeof(int32_t);
+	// number of columns in a vertical strip: each of the VERT_PASS_WIDTH elements
+	// of a strip row holds sizeof(T) / sizeof(int32_t) columns
+	const uint32_t VERT_PASS_STRIP_WIDTH = VERT_PASS_WIDTH * HORIZ_PASS_HEIGHT;
 	const uint32_t pad = FILTER_WIDTH * std::max<uint32_t>(HORIZ_PASS_HEIGHT, VERT_PASS_WIDTH) *
 						 sizeof(T) / sizeof(int32_t);
 	// reduce window
@@ -1902,9 +1905,10 @@ bool WaveletReverse::decompress_partial_tile(ISparseCanvas* sa,
 		};
 		auto executor_v = [resno, sa, bandInfo, &decompressor](TaskInfo<T, dwt_data<T>>* taskInfo) {
 			for(uint32_t xPos = taskInfo->indexMin_; xPos < taskInfo->indexMax_;
-				xPos += VERT_PASS_WIDTH)
+				xPos += VERT_PASS_STRIP_WIDTH)
 			{
-				auto width = std::min<uint32_t>(VERT_PASS_WIDTH, (taskInfo->indexMax_ - xPos));
+				auto width = std::min<uint32_t>((uint32_t)VERT_PASS_STRIP_WIDTH,
+												(taskInfo->indexMax_ - xPos));
 				taskInfo->data.memL =
 					taskInfo->data.mem + (taskInfo->data.parity) * VERT_PASS_WIDTH;
 				taskInfo->data.memH =
@@ -1930,7 +1934,7 @@ bool WaveletReverse::decompress_partial_tile(ISparseCanvas* sa,
 					   (int32_t*)(taskInfo->data.mem + ((int64_t)bandInfo.resWindowREL_.y0 -
 														2 * (int64_t)taskInfo->data.win_l.x0) *
 														   VERT_PASS_WIDTH),
-					   1, VERT_PASS_WIDTH * (sizeof(T) / sizeof(int32_t))))
+					   1, VERT_PASS_STRIP_WIDTH))
 				{
 					GRK_ERROR("Sparse array write failure");
 					return false;
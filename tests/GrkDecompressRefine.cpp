@@ -0,0 +1,272 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+#include "grk_config.h"
+#include "GrkDecompressRefine.h"
+
+namespace grk
+{
+
+static void errorCallback(const char* msg, [[maybe_unused]] void* client_data)
+{
+	fprintf(stderr, "Error: %s\n", msg);
+}
+
+const uint32_t imageWidth = 200;
+const uint32_t imageHeight = 136;
+const uint16_t numComps = 3;
+const uint16_t numLayers = 4;
+
+struct RefineConfig
+{
+	const char* name;
+	uint8_t cblk_sty;
+	bool irreversible;
+};
+
+/* code block styles whose pass segmentation differs from the default */
+const RefineConfig configs[] = {
+	{"default", 0, false},
+	{"default_irreversible", 0, true},
+	{"bypass", GRK_CBLKSTY_LAZY, false},
+	{"reset", GRK_CBLKSTY_RESET, true},
+	{"termall", GRK_CBLKSTY_TERMALL, false},
+	{"bypass_termall", GRK_CBLKSTY_LAZY | GRK_CBLKSTY_TERMALL, true},
+	{"bypass_reset_termall_segsym",
+	 GRK_CBLKSTY_LAZY | GRK_CBLKSTY_RESET | GRK_CBLKSTY_TERMALL | GRK_CBLKSTY_SEGSYM, false},
+	{"bypass_pterm_vsc", GRK_CBLKSTY_LAZY | GRK_CBLKSTY_PTERM | GRK_CBLKSTY_VSC, true},
+};
+
+typedef std::vector<std::vector<int32_t>> ImageData;
+
+static bool compress(const char* outfile, const RefineConfig& config)
+{
+	grk_image_comp cmptparms[numComps];
+	memset(cmptparms, 0, sizeof(cmptparms));
+	for(uint16_t compno = 0; compno < numComps; ++compno)
+	{
+		auto cmptparm = cmptparms + compno;
+		cmptparm->dx = 1;
+		cmptparm->dy = 1;
+		cmptparm->w = imageWidth;
+		cmptparm->h = imageHeight;
+		cmptparm->prec = 8;
+	}
+	auto image = grk_image_new(numComps, cmptparms, GRK_CLRSPC_SRGB);
+	if(!image)
+		return false;
+	image->x1 = imageWidth;
+	image->y1 = imageHeight;
+
+	/* gradient plus noise, so that every bit plane carries coding passes */
+	uint32_t seed = 0x2545F491;
+	for(uint16_t compno = 0; compno < numComps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		for(uint32_t j = 0; j < comp->h; ++j)
+		{
+			for(uint32_t i = 0; i < comp->w; ++i)
+			{
+				seed = seed * 1664525 + 1013904223;
+				int32_t val = (int32_t)((i * (compno + 1) + j * 2) & 0xFF);
+				val ^= (int32_t)((seed >> 24) & 0x3F);
+				comp->data[(uint64_t)j * comp->stride + i] = val;
+			}
+		}
+	}
+
+	grk_cparameters parameters;
+	grk_compress_set_default_params(&parameters);
+	parameters.cod_format = GRK_FMT_J2K;
+	parameters.cblockw_init = 32;
+	parameters.cblockh_init = 32;
+	parameters.cblk_sty = config.cblk_sty;
+	parameters.irreversible = config.irreversible;
+	parameters.numlayers = numLayers;
+	parameters.allocationByRateDistoration = true;
+	const double rates[numLayers] = {80, 30, 8, 0};
+	for(uint16_t i = 0; i < numLayers; ++i)
+		parameters.layer_rate[i] = rates[i];
+
+	grk_stream_params stream_params;
+	memset(&stream_params, 0, sizeof(stream_params));
+	stream_params.file = outfile;
+	bool rc = false;
+	auto codec = grk_compress_init(&stream_params, &parameters, image);
+	if(codec)
+	{
+		rc = grk_compress(codec, nullptr);
+		grk_object_unref(codec);
+	}
+	grk_object_unref(&image->obj);
+
+	return rc;
+}
+
+static bool copyImageData(grk_image* image, ImageData& data)
+{
+	if(!image)
+		return false;
+	data.clear();
+	for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		if(!comp->data)
+			return false;
+		std::vector<int32_t> compData;
+		compData.reserve((uint64_t)comp->w * comp->h);
+		for(uint32_t j = 0; j < comp->h; ++j)
+		{
+			auto row = comp->data + (uint64_t)j * comp->stride;
+			compData.insert(compData.end(), row, row + comp->w);
+		}
+		data.push_back(compData);
+	}
+
+	return true;
+}
+
+static grk_codec* initDecompress(const char* infile, uint16_t maxLayers,
+								 GRK_TILE_CACHE_STRATEGY strategy)
+{
+	grk_decompress_core_params parameters;
+	memset(&parameters, 0, sizeof(grk_decompress_core_params));
+	grk_decompress_set_default_params(&parameters);
+	parameters.max_layers = maxLayers;
+	parameters.tileCacheStrategy = strategy;
+
+	grk_stream_params stream_params;
+	memset(&stream_params, 0, sizeof(stream_params));
+	stream_params.file = infile;
+	auto codec = grk_decompress_init(&stream_params, &parameters);
+	if(!codec)
+		return nullptr;
+	grk_header_info headerInfo;
+	memset(&headerInfo, 0, sizeof(grk_header_info));
+	if(!grk_decompress_read_header(codec, &headerInfo))
+	{
+		grk_object_unref(codec);
+		return nullptr;
+	}
+
+	return codec;
+}
+
+static bool decompress(const char* infile, uint16_t maxLayers, ImageData& data)
+{
+	auto codec = initDecompress(infile, maxLayers, GRK_TILE_CACHE_NONE);
+	if(!codec)
+		return false;
+	bool rc = grk_decompress(codec, nullptr) &&
+			  copyImageData(grk_decompress_get_composited_image(codec), data);
+	grk_object_unref(codec);
+
+	return rc;
+}
+
+static bool testConfig(const std::string& outDir, const RefineConfig& config)
+{
+	auto file = outDir + "/decompress_refine_" + config.name + ".j2k";
+	auto infile = file.c_str();
+	if(!compress(infile, config))
+	{
+		fprintf(stderr, "%s: failed to compress %s\n", config.name, infile);
+		return false;
+	}
+
+	/* direct decompression of each number of layers, 0 signifying all layers */
+	ImageData direct[numLayers];
+	for(uint16_t layers = 0; layers < numLayers; ++layers)
+	{
+		if(!decompress(infile, layers, direct[layers]))
+		{
+			fprintf(stderr, "%s: failed to decompress %u layers\n", config.name, layers);
+			return false;
+		}
+	}
+
+	/* decompress first layers, then refine one layer at a time, then to all layers */
+	for(uint16_t initialLayers = 1; initialLayers < numLayers; ++initialLayers)
+	{
+		auto codec = initDecompress(infile, initialLayers, GRK_TILE_CACHE_REFINE);
+		if(!codec)
+		{
+			fprintf(stderr, "%s: failed to set up decompressor\n", config.name);
+			return false;
+		}
+		bool rc = grk_decompress(codec, nullptr);
+		for(uint16_t layers = initialLayers; rc; ++layers)
+		{
+			/* refining to the final layer requests all layers */
+			uint16_t index = layers == numLayers ? 0 : layers;
+			ImageData refined;
+			rc = copyImageData(grk_decompress_get_composited_image(codec), refined);
+			if(rc && refined != direct[index])
+			{
+				fprintf(stderr,
+						"%s: %u layers refined from %u layers differ from direct decompression\n",
+						config.name, index, initialLayers);
+				rc = false;
+			}
+			if(!rc || index == 0)
+				break;
+			rc = grk_decompress_refine(codec, (uint16_t)(layers + 1) == numLayers
+													? 0
+													: (uint16_t)(layers + 1));
+		}
+		grk_object_unref(codec);
+		if(!rc)
+		{
+			fprintf(stderr, "%s: refinement from %u layers failed\n", config.name, initialLayers);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int GrkDecompressRefine::main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		fprintf(stderr, "Usage: %s <output_directory>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	grk_initialize(nullptr, 0);
+	grk_set_msg_handlers(nullptr, nullptr, nullptr, nullptr, errorCallback, nullptr);
+
+	int ret = EXIT_SUCCESS;
+	for(const auto& config : configs)
+	{
+		if(testConfig(argv[1], config))
+			fprintf(stdout, "%s: refinement matches direct decompression\n", config.name);
+		else
+			ret = EXIT_FAILURE;
+	}
+	grk_deinitialize();
+
+	return ret;
+}
+
+} // namespace grk
@@ -0,0 +1,381 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+#include "grk_config.h"
+#include "GrkHTBlockCapacity.h"
+
+namespace grk
+{
+
+static void errorCallback(const char* msg, [[maybe_unused]] void* client_data)
+{
+	fprintf(stderr, "Error: %s\n", msg);
+}
+
+/* a single 4x4 code block, which the HT decoder buffers in
+ * four bytes per sample of the nominal code block */
+const uint32_t blockDim = 4;
+const uint32_t blockCapacity = blockDim * blockDim * sizeof(int32_t);
+
+typedef std::vector<uint8_t> Buffer;
+
+/* packet header bit reader, skipping the stuffed bit that follows 0xFF */
+class BitReader
+{
+  public:
+	BitReader(const Buffer& buf, size_t offset) : buf_(buf), pos_(offset), ct_(0), c_(0) {}
+	bool read(uint32_t nbits, uint32_t* val)
+	{
+		*val = 0;
+		for(uint32_t i = 0; i < nbits; ++i)
+		{
+			if(ct_ == 0)
+			{
+				if(pos_ == buf_.size())
+					return false;
+				ct_ = (c_ == 0xFF) ? 7 : 8;
+				c_ = buf_[pos_++];
+			}
+			ct_--;
+			*val = (*val << 1) | ((c_ >> ct_) & 1);
+		}
+		return true;
+	}
+	/* byte offset following the header, which is padded with a zero byte after 0xFF */
+	size_t end(void) const
+	{
+		return pos_ + (c_ == 0xFF ? 1 : 0);
+	}
+
+  private:
+	const Buffer& buf_;
+	size_t pos_;
+	uint32_t ct_;
+	uint8_t c_;
+};
+
+class BitWriter
+{
+  public:
+	BitWriter() : ct_(8), c_(0) {}
+	void write(uint32_t val, uint32_t nbits)
+	{
+		for(int32_t i = (int32_t)nbits - 1; i >= 0; --i)
+		{
+			if(ct_ == 0)
+				flushByte();
+			ct_--;
+			c_ = (uint8_t)(c_ | (((val >> i) & 1) << ct_));
+		}
+	}
+	Buffer flush(void)
+	{
+		if(ct_ != (isStuffed() ? 7 : 8))
+			flushByte();
+		if(!buf_.empty() && buf_.back() == 0xFF)
+			buf_.push_back(0);
+		return buf_;
+	}
+
+  private:
+	bool isStuffed(void) const
+	{
+		return !buf_.empty() && buf_.back() == 0xFF;
+	}
+	void flushByte(void)
+	{
+		buf_.push_back(c_);
+		c_ = 0;
+		ct_ = isStuffed() ? 7 : 8;
+	}
+	Buffer buf_;
+	uint32_t ct_;
+	uint8_t c_;
+};
+
+static uint16_t readShort(const Buffer& buf, size_t offset)
+{
+	return (uint16_t)((buf[offset] << 8) | buf[offset + 1]);
+}
+
+static bool compress(const char* outfile, std::vector<int32_t>& samples)
+{
+	grk_image_comp cmptparm;
+	memset(&cmptparm, 0, sizeof(cmptparm));
+	cmptparm.dx = 1;
+	cmptparm.dy = 1;
+	cmptparm.w = blockDim;
+	cmptparm.h = blockDim;
+	cmptparm.prec = 16;
+	auto image = grk_image_new(1, &cmptparm, GRK_CLRSPC_GRAY);
+	if(!image)
+		return false;
+	image->x1 = blockDim;
+	image->y1 = blockDim;
+
+	/* noise, so that the code block compresses to as many bytes as possible */
+	uint32_t seed = 0x2545F491;
+	auto comp = image->comps;
+	samples.clear();
+	for(uint32_t j = 0; j < comp->h; ++j)
+	{
+		for(uint32_t i = 0; i < comp->w; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			int32_t val = (int32_t)(seed >> 16);
+			comp->data[(uint64_t)j * comp->stride + i] = val;
+			samples.push_back(val);
+		}
+	}
+
+	grk_cparameters parameters;
+	grk_compress_set_default_params(&parameters);
+	parameters.cod_format = GRK_FMT_J2K;
+	parameters.cblockw_init = blockDim;
+	parameters.cblockh_init = blockDim;
+	parameters.numresolution = 1;
+	parameters.cblk_sty = GRK_CBLKSTY_HT;
+
+	grk_stream_params stream_params;
+	memset(&stream_params, 0, sizeof(stream_params));
+	stream_params.file = outfile;
+	bool rc = false;
+	auto codec = grk_compress_init(&stream_params, &parameters, image);
+	if(codec)
+	{
+		rc = grk_compress(codec, nullptr);
+		grk_object_unref(codec);
+	}
+	grk_object_unref(&image->obj);
+
+	return rc;
+}
+
+static bool readFile(const char* file, Buffer& buf)
+{
+	auto fp = fopen(file, "rb");
+	if(!fp)
+		return false;
+	fseek(fp, 0, SEEK_END);
+	auto len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf.resize((size_t)len);
+	bool rc = fread(buf.data(), 1, buf.size(), fp) == buf.size();
+	fclose(fp);
+
+	return rc;
+}
+
+static bool writeFile(const char* file, const Buffer& buf)
+{
+	auto fp = fopen(file, "wb");
+	if(!fp)
+		return false;
+	bool rc = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+	fclose(fp);
+
+	return rc;
+}
+
+/**
+ * Rewrite the single packet of the code stream so that its code block's
+ * HT cleanup segment is blockLength bytes long. Bytes inserted between the
+ * MagSgn bit stream and the MEL/VLC suffix are never consumed by the decoder,
+ * so the code block still decompresses to the original samples.
+ */
+static bool extendCodeblock(const Buffer& in, uint32_t blockLength, Buffer& out)
+{
+	/* skip main header and tile part header markers up to SOD */
+	size_t pos = 2;
+	size_t sot = 0;
+	while(pos + 4 <= in.size())
+	{
+		uint16_t marker = readShort(in, pos);
+		if(marker == 0xFF93)
+			break;
+		if(marker == 0xFF90)
+			sot = pos;
+		pos += 2 + readShort(in, pos + 2);
+	}
+	if(!sot || pos + 4 > in.size())
+		return false;
+	size_t sod = pos + 2;
+
+	/* packet header: non-empty packet, inclusion, zero bit planes, one coding pass,
+	 * Lblock increment and segment length */
+	BitReader reader(in, sod);
+	uint32_t present, included, bit, passes;
+	if(!reader.read(1, &present) || !reader.read(1, &included) || !present || !included)
+		return false;
+	uint32_t zeroBitPlanes = 0;
+	do
+	{
+		if(!reader.read(1, &bit))
+			return false;
+		if(!bit)
+			zeroBitPlanes++;
+	} while(!bit);
+	if(!reader.read(1, &passes) || passes)
+		return false;
+	uint32_t numLenBits = 3;
+	do
+	{
+		if(!reader.read(1, &bit))
+			return false;
+		numLenBits += bit;
+	} while(bit);
+	uint32_t segLength;
+	if(!reader.read(numLenBits, &segLength))
+		return false;
+	size_t data = reader.end();
+	if(segLength < 2 || segLength > blockLength || data + segLength > in.size())
+		return false;
+
+	BitWriter writer;
+	writer.write(1, 1);
+	writer.write(1, 1);
+	writer.write(1, zeroBitPlanes + 1);
+	writer.write(0, 1);
+	uint32_t newLenBits = numLenBits;
+	while((blockLength >> newLenBits) != 0)
+		newLenBits++;
+	for(uint32_t i = 3; i < newLenBits; ++i)
+		writer.write(1, 1);
+	writer.write(0, 1);
+	writer.write(blockLength, newLenBits);
+	auto header = writer.flush();
+
+	auto block = in.begin() + (ptrdiff_t)data;
+	uint32_t scup = (uint32_t)((block[segLength - 1] << 4) + (block[segLength - 2] & 0xF));
+	if(scup < 2 || scup > segLength)
+		return false;
+	out.assign(in.begin(), in.begin() + (ptrdiff_t)sod);
+	out.insert(out.end(), header.begin(), header.end());
+	out.insert(out.end(), block, block + (segLength - scup));
+	out.insert(out.end(), blockLength - segLength, 0);
+	out.insert(out.end(), block + (segLength - scup), block + segLength);
+	out.insert(out.end(), block + segLength, in.end());
+
+	/* adjust tile part length */
+	size_t psotPos = sot + 6;
+	uint32_t psot = ((uint32_t)in[psotPos] << 24) | ((uint32_t)in[psotPos + 1] << 16) |
+					((uint32_t)in[psotPos + 2] << 8) | in[psotPos + 3];
+	if(psot)
+	{
+		psot = (uint32_t)(psot + out.size() - in.size());
+		for(uint32_t i = 0; i < 4; ++i)
+			out[psotPos + i] = (uint8_t)(psot >> (24 - 8 * i));
+	}
+
+	return true;
+}
+
+static bool decompress(const char* infile, const std::vector<int32_t>& samples)
+{
+	grk_decompress_core_params parameters;
+	memset(&parameters, 0, sizeof(grk_decompress_core_params));
+	grk_decompress_set_default_params(&parameters);
+
+	grk_stream_params stream_params;
+	memset(&stream_params, 0, sizeof(stream_params));
+	stream_params.file = infile;
+	auto codec = grk_decompress_init(&stream_params, &parameters);
+	if(!codec)
+		return false;
+	grk_header_info headerInfo;
+	memset(&headerInfo, 0, sizeof(grk_header_info));
+	bool rc = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+	if(rc)
+	{
+		auto image = grk_decompress_get_composited_image(codec);
+		auto comp = image ? image->comps : nullptr;
+		rc = comp && comp->data && comp->w == blockDim && comp->h == blockDim;
+		for(uint32_t j = 0; rc && j < comp->h; ++j)
+		{
+			for(uint32_t i = 0; i < comp->w; ++i)
+			{
+				if(comp->data[(uint64_t)j * comp->stride + i] != samples[j * blockDim + i])
+				{
+					rc = false;
+					break;
+				}
+			}
+		}
+	}
+	grk_object_unref(codec);
+
+	return rc;
+}
+
+int GrkHTBlockCapacity::main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		fprintf(stderr, "Usage: %s <output_directory>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	grk_initialize(nullptr, 0);
+	grk_set_msg_handlers(nullptr, nullptr, nullptr, nullptr, errorCallback, nullptr);
+
+	int ret = EXIT_SUCCESS;
+	std::string outDir = argv[1];
+	auto file = outDir + "/ht_block_capacity.j2k";
+	std::vector<int32_t> samples;
+	Buffer original;
+	if(!compress(file.c_str(), samples) || !readFile(file.c_str(), original))
+	{
+		fprintf(stderr, "failed to compress %s\n", file.c_str());
+		ret = EXIT_FAILURE;
+	}
+	/* segment filling the decoder's buffer exactly, and one that forces reallocation */
+	const uint32_t blockLengths[] = {blockCapacity, blockCapacity + 1};
+	for(uint32_t i = 0; ret == EXIT_SUCCESS && i < 2; ++i)
+	{
+		auto blockLength = blockLengths[i];
+		auto extended = outDir + "/ht_block_capacity_" + std::to_string(blockLength) + ".j2k";
+		Buffer buf;
+		if(!extendCodeblock(original, blockLength, buf) || !writeFile(extended.c_str(), buf))
+		{
+			fprintf(stderr, "failed to extend code block to %u bytes\n", blockLength);
+			ret = EXIT_FAILURE;
+		}
+		else if(!decompress(extended.c_str(), samples))
+		{
+			fprintf(stderr, "%u byte code block does not decompress to original samples\n",
+					blockLength);
+			ret = EXIT_FAILURE;
+		}
+		else
+		{
+			fprintf(stdout, "%u byte code block decompresses to original samples\n",
+					blockLength);
+		}
+	}
+	grk_deinitialize();
+
+	return ret;
+}
+
+} // namespace grk